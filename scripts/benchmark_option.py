@@ -0,0 +1,115 @@
+#! /usr/bin/env python
+
+"""
+Script for comparing Blacklight run times and images with two values of a single input option.
+
+Examples:
+  benchmark_option.py blacklight run.input simulation_sort_samples false true
+  benchmark_option.py blacklight run.input plasma_tables false true -t 1.0e-3
+  benchmark_option.py blacklight run.input image_tau_max -1.0 10.0 -t 1.0e-2
+"""
+
+# Python standard modules
+import argparse
+import os
+import re
+import subprocess
+import tempfile
+
+# Numerical modules
+import numpy as np
+
+# Main function
+def main(**kwargs):
+
+  # Verify inputs
+  if kwargs['executable'] is None:
+    raise RuntimeError('Must supply Blacklight executable.')
+  if kwargs['input'] is None:
+    raise RuntimeError('Must supply base input file.')
+  if kwargs['key'] is None or kwargs['value_a'] is None or kwargs['value_b'] is None:
+    raise RuntimeError('Must supply option and both values.')
+  if kwargs['repeats'] < 1:
+    raise RuntimeError('Must run each case at least once.')
+  if kwargs['tolerance'] is not None and kwargs['tolerance'] < 0.0:
+    raise RuntimeError('Tolerance must be nonnegative.')
+
+  # Read base input file, removing any existing selection
+  key = kwargs['key']
+  with open(kwargs['input'], 'r') as f_in:
+    lines = [line for line in f_in.readlines() if line.split('=')[0].strip() != key]
+
+  # Run each case
+  values = (kwargs['value_a'], kwargs['value_b'])
+  timers = ('Sampling simulation', 'Integrating image', 'Elapsed time')
+  times = {}
+  with tempfile.TemporaryDirectory() as directory:
+    for case, value in enumerate(values):
+      filename_input = os.path.join(directory, 'case_{0}.input'.format(case))
+      filename_output = os.path.join(directory, 'case_{0}.npz'.format(case))
+      with open(filename_input, 'w') as f_out:
+        for line in lines:
+          if line.split('=')[0].strip() == 'output_file':
+            line = 'output_file = {0}\n'.format(filename_output)
+          f_out.write(line)
+        f_out.write('{0} = {1}\n'.format(key, value))
+      times[case] = {timer: [] for timer in timers}
+      for repeat in range(kwargs['repeats']):
+        result = subprocess.run([kwargs['executable'], filename_input], capture_output=True,
+            text=True, check=True)
+        if 'Ignoring {0} selection'.format(key) in result.stdout + result.stderr:
+          raise RuntimeError('Input file does not support {0}.'.format(key))
+        for timer in timers:
+          match = re.search(timer + r':\s*([0-9.eE+-]+) s', result.stdout)
+          if match is None:
+            raise RuntimeError('Could not find timing in output:\n' + result.stdout)
+          times[case][timer].append(float(match.group(1)))
+
+    # Compare images
+    errors = {}
+    identical = True
+    with np.load(os.path.join(directory, 'case_0.npz')) as f_a, \
+        np.load(os.path.join(directory, 'case_1.npz')) as f_b:
+      for name in f_a.files:
+        identical = identical and np.array_equal(f_a[name], f_b[name], equal_nan=True)
+        if name in ('mass_msun', 'width', 'frequency') or f_a[name].dtype.kind != 'f':
+          continue
+        scale = np.nanmax(np.abs(f_a[name]))
+        difference = np.nanmax(np.abs(f_b[name] - f_a[name]))
+        errors[name] = difference / scale if scale > 0.0 else difference
+
+  # Report results
+  width = max(12, max(len(value) for value in values))
+  print('Minimum times over {0} run(s) for each value of {1}:'.format(kwargs['repeats'], key))
+  print('  {0:20s} {1:>{4}s} {2:>{4}s} {3:>8s}'.format('', values[0], values[1], 'speedup',
+      width))
+  for timer in timers:
+    time_a = min(times[0][timer])
+    time_b = min(times[1][timer])
+    speedup = time_a / time_b if time_b > 0.0 else float('nan')
+    print('  {0:20s} {1:{4}.4f} s {2:{4}.4f} s {3:8.3f}'.format(timer + ':', time_a, time_b,
+        speedup, width - 2))
+  print('Maximum differences relative to largest value with {0} = {1}:'.format(key, values[0]))
+  for name, error in errors.items():
+    print('  {0:20s} {1:10.3e}'.format(name + ':', error))
+  print('Outputs identical: {0}'.format(identical))
+
+  # Check agreement
+  if kwargs['tolerance'] is not None \
+      and not all(error <= kwargs['tolerance'] for error in errors.values()):
+    raise RuntimeError('Images differ by more than {0}.'.format(kwargs['tolerance']))
+
+# Execute main function
+if __name__ == '__main__':
+  parser = argparse.ArgumentParser()
+  parser.add_argument('executable', help='Blacklight executable to run')
+  parser.add_argument('input', help='base input file')
+  parser.add_argument('key', help='input option to vary')
+  parser.add_argument('value_a', help='reference value of option')
+  parser.add_argument('value_b', help='value of option to compare against reference')
+  parser.add_argument('-r', '--repeats', type=int, default=3,
+      help='number of times to run each case')
+  parser.add_argument('-t', '--tolerance', type=float, default=None,
+      help='maximum allowed relative difference between images, if any is to be enforced')
+  args = parser.parse_args()
+  main(**vars(args))
@@ -0,0 +1,145 @@
+#! /usr/bin/env python
+
+"""
+Script for checking ghost cells used in interpolating across mesh-refined blocks.
+
+Generates a three-level Cartesian Kerr-Schild mesh with random cell values, renders it with
+simulation_block_interp and simulation_check_halos enabled, and reports whether Blacklight found
+every ghost cell equal to the leaf cell containing its center wherever that cell is at the same or
+a coarser level.
+"""
+
+# Python standard modules
+import argparse
+import os
+import subprocess
+import tempfile
+
+# Numerical modules
+import numpy as np
+
+# Other modules
+import h5py
+
+# Main function
+def main(**kwargs):
+
+  # Verify inputs
+  if kwargs['executable'] is None:
+    raise RuntimeError('Must supply Blacklight executable.')
+  if kwargs['input'] is None:
+    raise RuntimeError('Must supply base input file.')
+  if kwargs['block_size'] < 2 or kwargs['block_size'] % 2 != 0:
+    raise RuntimeError('Block size must be positive and even.')
+
+  # Construct mesh, refining blocks lying within successively smaller cubes
+  n_root = 4
+  x_max = kwargs['x_max']
+  block_width_root = 2.0 * x_max / n_root
+  def refine(level, location):
+    width = block_width_root / 2 ** level
+    x_min_block = [-x_max + location[d] * width for d in range(3)]
+    r_refine = x_max / 2 ** (level + 1)
+    if level < kwargs['max_level'] and all(x >= -r_refine and x + width <= r_refine
+        for x in x_min_block):
+      blocks = []
+      for child in range(8):
+        location_child = [2 * location[d] + (child >> d) % 2 for d in range(3)]
+        blocks += refine(level + 1, location_child)
+      return blocks
+    return [(level, location)]
+  blocks = []
+  for k in range(n_root):
+    for j in range(n_root):
+      for i in range(n_root):
+        blocks += refine(0, [i, j, k])
+  num_blocks = len(blocks)
+  n = kwargs['block_size']
+
+  # Calculate block coordinates
+  xf = np.empty((3, num_blocks, n + 1))
+  for b, (level, location) in enumerate(blocks):
+    width = block_width_root / 2 ** level
+    for d in range(3):
+      xf[d,b,:] = -x_max + location[d] * width + np.linspace(0.0, width, n + 1)
+  xv = 0.5 * (xf[:,:,:-1] + xf[:,:,1:])
+
+  # Generate random cell values
+  rng = np.random.default_rng(kwargs['seed'])
+  shape = (num_blocks, n, n, n)
+  rho = rng.uniform(0.5, 1.5, shape)
+  pgas = rng.uniform(0.05, 0.15, shape)
+  vel = rng.uniform(-0.1, 0.1, (3,) + shape)
+  bcc = rng.uniform(-0.1, 0.1, (3,) + shape)
+
+  with tempfile.TemporaryDirectory() as directory:
+
+    # Write athdf file
+    filename_data = os.path.join(directory, 'amr.athdf')
+    with h5py.File(filename_data, 'w') as f_out:
+      f_out.attrs.create('NumCycles', 0, dtype=np.int32)
+      f_out.attrs.create('Time', 0.0, dtype=np.float32)
+      f_out.attrs.create('Coordinates', 'cartesian', dtype='|S9')
+      for d in range(3):
+        f_out.attrs.create('RootGridX{0}'.format(d + 1), (-x_max, x_max, 1.0), dtype=np.float32)
+      f_out.attrs.create('RootGridSize', (n_root * n,) * 3, dtype=np.int32)
+      f_out.attrs.create('NumMeshBlocks', num_blocks, dtype=np.int32)
+      f_out.attrs.create('MeshBlockSize', (n,) * 3, dtype=np.int32)
+      f_out.attrs.create('MaxLevel', kwargs['max_level'], dtype=np.int32)
+      f_out.attrs.create('NumVariables', [5, 3], dtype=np.int32)
+      f_out.attrs.create('DatasetNames', ['prim', 'B'], dtype='|S21')
+      f_out.attrs.create('VariableNames',
+          ['rho', 'press', 'vel1', 'vel2', 'vel3', 'Bcc1', 'Bcc2', 'Bcc3'], dtype='|S21')
+      f_out.create_dataset('Levels', data=[level for level, _ in blocks], dtype=np.int32)
+      f_out.create_dataset('LogicalLocations', data=[location for _, location in blocks],
+          dtype=np.int64)
+      for d in range(3):
+        f_out.create_dataset('x{0}f'.format(d + 1), data=xf[d], dtype=np.float32)
+        f_out.create_dataset('x{0}v'.format(d + 1), data=xv[d], dtype=np.float32)
+      f_out.create_dataset('prim', data=np.concatenate((rho[None], pgas[None], vel)),
+          dtype=np.float32)
+      f_out.create_dataset('B', data=bcc, dtype=np.float32)
+
+    # Write input file
+    overrides = {'simulation_file': filename_data, 'simulation_multiple': 'false',
+        'simulation_coord': 'cks', 'simulation_interp': 'true',
+        'simulation_block_interp': 'true', 'simulation_check_halos': 'true',
+        'slow_light_on': 'false', 'adaptive_max_level': '0',
+        'output_file': os.path.join(directory, 'amr.npz'),
+        'camera_resolution': str(kwargs['resolution'])}
+    filename_input = os.path.join(directory, 'amr.input')
+    with open(kwargs['input'], 'r') as f_in, open(filename_input, 'w') as f_out:
+      for line in f_in.readlines():
+        if line.split('=')[0].strip() not in overrides:
+          f_out.write(line)
+      for key, val in overrides.items():
+        f_out.write('{0} = {1}\n'.format(key, val))
+
+    # Run Blacklight
+    result = subprocess.run([kwargs['executable'], filename_input], capture_output=True,
+        text=True)
+
+  # Report results
+  levels = [level for level, _ in blocks]
+  print('Blocks per level: {0}'.format([levels.count(level)
+      for level in range(kwargs['max_level'] + 1)]))
+  if result.returncode != 0:
+    print(result.stdout + result.stderr)
+    print('Ghost cell check failed.')
+    raise SystemExit(1)
+  print('Ghost cell check passed.')
+
+# Execute main function
+if __name__ == '__main__':
+  parser = argparse.ArgumentParser()
+  parser.add_argument('executable', help='Blacklight executable to run')
+  parser.add_argument('input', help='base input file for an Athena++ simulation')
+  parser.add_argument('--block_size', type=int, default=8,
+      help='number of cells along each dimension of each block')
+  parser.add_argument('--max_level', type=int, default=2, help='number of levels of refinement')
+  parser.add_argument('--x_max', type=float, default=32.0,
+      help='half width of domain in gravitational units')
+  parser.add_argument('--resolution', type=int, default=32, help='number of pixels per side')
+  parser.add_argument('--seed', type=int, default=0, help='seed for random cell values')
+  args = parser.parse_args()
+  main(**vars(args))
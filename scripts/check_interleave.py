@@ -0,0 +1,106 @@
+#! /usr/bin/env python
+
+"""
+Script for checking that interleaved cell storage reproduces the default layout over several files.
+
+Copies a single Athena++ file into a numbered series with increasing times and varying cell values,
+then renders a multi-file run and a slow-light run with simulation_interleave off and on, reporting
+whether corresponding outputs are identical.
+"""
+
+# Python standard modules
+import argparse
+import os
+import shutil
+import subprocess
+import tempfile
+
+# Numerical modules
+import numpy as np
+
+# Other modules
+import h5py
+
+# Main function
+def main(**kwargs):
+
+  # Verify inputs
+  if kwargs['executable'] is None:
+    raise RuntimeError('Must supply Blacklight executable.')
+  if kwargs['input'] is None:
+    raise RuntimeError('Must supply base input file.')
+  if kwargs['data'] is None:
+    raise RuntimeError('Must supply Athena++ data file.')
+
+  # Define cases
+  num_files = 24
+  cases = {
+      'multiple': {'simulation_start': '0', 'simulation_end': '2', 'slow_light_on': 'false'},
+      'slow_light': {'simulation_start': '0', 'simulation_end': str(num_files - 1),
+          'slow_light_on': 'true', 'slow_interp': 'true', 'slow_chunk_size': '17',
+          'slow_t_start': '170.0', 'slow_dt': '10.0', 'slow_num_images': '3',
+          'slow_offset': '0'}}
+
+  with tempfile.TemporaryDirectory() as directory:
+
+    # Write series of data files
+    for file_number in range(num_files):
+      filename = os.path.join(directory, 'data.{0:05d}.athdf'.format(file_number))
+      shutil.copy(kwargs['data'], filename)
+      with h5py.File(filename, 'r+') as f:
+        f.attrs['Time'] = np.float32(10.0 * file_number)
+        prim = f['prim'][...]
+        prim[0] *= 1.0 + 0.05 * file_number
+        f['prim'][...] = prim
+
+    # Run each case with each layout
+    identical = {}
+    for case, overrides_case in cases.items():
+      for interleave in ('false', 'true'):
+        overrides = {'model_type': 'simulation', 'simulation_format': 'athena',
+            'simulation_file': os.path.join(directory, 'data.{05d}.athdf'),
+            'simulation_multiple': 'true', 'simulation_interleave': interleave,
+            'simulation_precision': kwargs['precision'], 'adaptive_max_level': '0',
+            'output_file': os.path.join(directory, case + '_' + interleave + '.{05d}.npz')}
+        overrides.update(overrides_case)
+        filename_input = os.path.join(directory, case + '_' + interleave + '.input')
+        with open(kwargs['input'], 'r') as f_in, open(filename_input, 'w') as f_out:
+          for line in f_in.readlines():
+            if line.split('=')[0].strip() not in overrides:
+              f_out.write(line)
+          for key, val in overrides.items():
+            f_out.write('{0} = {1}\n'.format(key, val))
+        result = subprocess.run([kwargs['executable'], filename_input], capture_output=True,
+            text=True)
+        if result.returncode != 0:
+          raise RuntimeError('Run failed for {0} with simulation_interleave = {1}:\n{2}'
+              .format(case, interleave, result.stdout + result.stderr))
+
+      # Compare outputs
+      identical[case] = True
+      for filename in sorted(os.listdir(directory)):
+        if not (filename.startswith(case + '_false.') and filename.endswith('.npz')):
+          continue
+        filename_interleaved = filename.replace('_false.', '_true.')
+        with np.load(os.path.join(directory, filename)) as f_a, \
+            np.load(os.path.join(directory, filename_interleaved)) as f_b:
+          identical[case] = identical[case] and all(np.array_equal(f_a[name], f_b[name],
+              equal_nan=True) for name in f_a.files)
+
+  # Report results
+  for case in cases:
+    print('{0}: outputs identical: {1}'.format(case, identical[case]))
+  if not all(identical.values()):
+    raise SystemExit(1)
+
+# Execute main function
+if __name__ == '__main__':
+  parser = argparse.ArgumentParser()
+  parser.add_argument('executable', help='Blacklight executable to run')
+  parser.add_argument('input',
+      help='base input file, with camera_r near 50 so slow-light rays stay within the series')
+  parser.add_argument('data', help='Athena++ data file to copy into a series')
+  parser.add_argument('--precision', default='single',
+      help='storage precision (single, half, bfloat16, log16) used in all runs')
+  args = parser.parse_args()
+  main(**vars(args))
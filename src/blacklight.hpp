@@ -31,11 +31,43 @@ namespace CellValues
 {
   enum : int {rho, n_e, p_gas, theta_e, bb, sigma, beta_inv, num_cell_values};
 }
+namespace BatchValues
+{
+  enum : int {n_e, kb_tt_e, theta_e, nu_fluid, momentum_factor, nu_c, nu_s, sin_theta_b,
+      sin2_theta_b, cos_theta_b, thermal_jj_a, thermal_jj_d, thermal_jj_f, thermal_rho_tabulated,
+      thermal_rho_g, thermal_rho_h, thermal_rho_kk_0, thermal_rho_kk_2, thermal_rho_kk_2_inv,
+      power_cot_theta_b, power_aa_b, nu_kappa, kappa_aa_a, kappa_jj_d, kappa_jj_f, kappa_aa_d,
+      kappa_aa_f, num_batch_values};
+}
+namespace BatchCoefficients
+{
+  enum : int {nu, j_i, j_q, j_v, alpha_i, alpha_q, alpha_v, rho_q, rho_v, num_batch_coefficients};
+}
+namespace RenderIndices
+{
+  enum : int {image, quantity, type, num_render_indices};
+}
+namespace RenderValues
+{
+  enum : int {min, max, thresh, tau_scale, opacity, x, y, z, num_render_values};
+}
+namespace ImageFlags
+{
+  enum : int {light = 1 << 0, time = 1 << 1, length = 1 << 2, lambda = 1 << 3, emission = 1 << 4,
+      tau = 1 << 5, lambda_ave = 1 << 6, emission_ave = 1 << 7, tau_int = 1 << 8,
+      crossings = 1 << 9, runtime = 1 << 10};
+}
+namespace RaySpectra
+{
+  enum : int {frequency_scale, lambda_factor, intensity, transmittance, lambda, emission, tau,
+      num_ray_spectra};
+}
 
 // Scoped enumerations
 enum struct ModelType {simulation, formula};
 enum struct OutputFormat {npz, npy, raw};
 enum struct SimulationFormat {athena, athenak, iharm3d, harm3d};
+enum struct SimulationPrecision {single, half, bfloat16, log16};
 enum struct Coordinates {cks, sks, fmks};
 enum struct Camera {plane, pinhole};
 enum struct RayTerminate {photon, multiplicative, additive};
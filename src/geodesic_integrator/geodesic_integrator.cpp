@@ -103,6 +103,14 @@ GeodesicIntegrator::GeodesicIntegrator(const InputReader *p_input_reader)
       throw BlacklightException("Must have adaptive_block_size divide camera_resolution.");
   }
 
+  // Determine if proper lengths of samples are needed
+  store_dlen = p_input_reader->image_length.value();
+  if (model_type == ModelType::simulation)
+    for (int n_i = 0; n_i < p_input_reader->render_num_images.value(); n_i++)
+      for (int n_f = 0; n_f < p_input_reader->render_num_features[n_i].value(); n_f++)
+        if (p_input_reader->render_types[n_i][n_f].value() == RenderType::fill)
+          store_dlen = true;
+
   // Set and calculate geometry data
   if (model_type == ModelType::simulation)
   {
@@ -155,6 +163,7 @@ GeodesicIntegrator::GeodesicIntegrator(const InputReader *p_input_reader)
   sample_pos = new Array<double>[adaptive_max_level+1];
   sample_dir = new Array<double>[adaptive_max_level+1];
   sample_len = new Array<double>[adaptive_max_level+1];
+  sample_dlen = new Array<double>[adaptive_max_level+1];
 
   // Prepare bookkeeping for adaptive refinement
   if (adaptive_max_level > 0)
@@ -187,6 +196,7 @@ GeodesicIntegrator::~GeodesicIntegrator()
     sample_pos[level].Deallocate();
     sample_dir[level].Deallocate();
     sample_len[level].Deallocate();
+    sample_dlen[level].Deallocate();
   }
   delete[] camera_loc;
   delete[] camera_pos;
@@ -198,6 +208,7 @@ GeodesicIntegrator::~GeodesicIntegrator()
   delete[] sample_pos;
   delete[] sample_dir;
   delete[] sample_len;
+  delete[] sample_dlen;
   // delete[] custom_x_all;
   // delete[] custom_y_all;
 }
@@ -218,7 +229,11 @@ double GeodesicIntegrator::Integrate()
 
   // Load data from checkpoint
   if (checkpoint_geodesic_load)
+  {
     LoadGeodesics();
+    if (store_dlen)
+      CalculateSampleLengths();
+  }
 
   // Calculate geodesics
   if (not checkpoint_geodesic_load)
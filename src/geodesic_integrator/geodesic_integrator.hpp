@@ -98,15 +98,18 @@ struct GeodesicIntegrator
   Array<double> *momentum_factors = nullptr;
 
   // Geodesic data
+  bool store_dlen;
   int *geodesic_num_steps = nullptr;
   Array<double> geodesic_pos;
   Array<double> geodesic_dir;
   Array<double> geodesic_len;
+  Array<double> geodesic_dlen;
   Array<bool> *sample_flags = nullptr;
   Array<int> *sample_num = nullptr;
   Array<double> *sample_pos = nullptr;
   Array<double> *sample_dir = nullptr;
   Array<double> *sample_len = nullptr;
+  Array<double> *sample_dlen = nullptr;
 
   // Adaptive data
   int adaptive_level;
@@ -136,6 +139,8 @@ struct GeodesicIntegrator
   void IntegrateGeodesicsRK4();
   void IntegrateGeodesicsRK2();
   void ReverseGeodesics();
+  void CalculateSampleLengths();
+  double ProperLengthRate(double x1, double x2, double x3, const double kcov[4]);
   void GeodesicSubstepWithDistance(double y[9], double k[9]);
   void GeodesicSubstepWithoutDistance(double y[8], double k[8]);
 
@@ -23,6 +23,7 @@
 //   Initializes geodesic_num_steps[adaptive_level].
 //   Allocates and initializes geodesic_pos, geodesic_dir, geodesic_len,
 //       sample_flags[adaptive_level], and sample_num[adaptive_level].
+//   Allocates and initializes geodesic_dlen if store_dlen == true.
 //   Assumes x^0 is ignorable.
 //   Integrates via the Dormand-Prince method (5th-order adaptive Runge-Kutta).
 //     Method is RK5(4)7M of 1980 JCoAM 6 19.
@@ -36,6 +37,7 @@
 //     Interpolation is used to take steps small enough to satisfy user input ray_step, in that the
 //         proper length of a step must be less than the product of ray_step with the radial
 //         coordinate.
+//     Proper lengths of subdivided steps are differences of the interpolated proper distance.
 void GeodesicIntegrator::IntegrateGeodesicsDP()
 {
   // Define coefficients
@@ -85,6 +87,8 @@ void GeodesicIntegrator::IntegrateGeodesicsDP()
   geodesic_dir.Allocate(num_pix, ray_max_steps, 4);
   geodesic_len.Allocate(num_pix, ray_max_steps);
   geodesic_len.Zero();
+  if (store_dlen)
+    geodesic_dlen.Allocate(num_pix, ray_max_steps);
   sample_flags[adaptive_level].Allocate(num_pix);
   sample_flags[adaptive_level].Zero();
   sample_num[adaptive_level].Allocate(num_pix);
@@ -103,7 +107,7 @@ void GeodesicIntegrator::IntegrateGeodesicsDP()
     double y_vals_4[9];
     double y_vals_4m[8];
     double k_vals[7][9];
-    double r_vals[4][8];
+    double r_vals[4][9];
 
     // Go through pixels
     #pragma omp for schedule(static)
@@ -256,12 +260,14 @@ void GeodesicIntegrator::IntegrateGeodesicsDP()
           geodesic_dir(m,n,2) = y_vals_4m[6];
           geodesic_dir(m,n,3) = y_vals_4m[7];
           geodesic_len(m,n) = h;
+          if (store_dlen)
+            geodesic_dlen(m,n) = delta_s_full;
         }
 
         // Calculate interpolating coefficients for subdivisions
         if (num_steps_ideal > 1)
         {
-          for (int p = 0; p < 8; p++)
+          for (int p = 0; p < 9; p++)
           {
             r_vals[0][p] = y_vals_5[p] - y_vals[p];
             r_vals[1][p] = y_vals[p] - y_vals_5[p] + h * k_vals[0][p];
@@ -269,12 +275,14 @@ void GeodesicIntegrator::IntegrateGeodesicsDP()
             r_vals[3][p] = 0.0;
           }
           for (int q = 0; q < 7; q++)
-            for (int p = 0; p < 8; p++)
+            for (int p = 0; p < 9; p++)
               r_vals[3][p] += d_vals[q] * h * k_vals[q][p];
         }
 
         // Calculate subdivided steps
         if (num_steps_ideal > 1)
+        {
+          double s_end = 0.0;
           for (int nn = 0; nn < num_steps; nn++)
           {
             double frac = (nn + 0.5) / num_steps_ideal;
@@ -290,7 +298,16 @@ void GeodesicIntegrator::IntegrateGeodesicsDP()
             geodesic_dir(m,n+nn,2) = y_vals_temp[6];
             geodesic_dir(m,n+nn,3) = y_vals_temp[7];
             geodesic_len(m,n+nn) = h / num_steps_ideal;
+            if (store_dlen)
+            {
+              double s_start = s_end;
+              double frac_end = (nn + 1.0) / num_steps_ideal;
+              s_end = frac_end * (r_vals[0][8] + (1.0 - frac_end) * (r_vals[1][8]
+                  + frac_end * (r_vals[2][8] + (1.0 - frac_end) * r_vals[3][8])));
+              geodesic_dlen(m,n+nn) = s_end - s_start;
+            }
           }
+        }
 
         // Renormalize momentum
         ContravariantGeodesicMetric(y_vals_5[1], y_vals_5[2], y_vals_5[3], gcon);
@@ -405,6 +422,7 @@ void GeodesicIntegrator::IntegrateGeodesicsDP()
 //   Initializes geodesic_num_steps[adaptive_level].
 //   Allocates and initializes geodesic_pos, geodesic_dir, geodesic_len,
 //       sample_flags[adaptive_level], and sample_num[adaptive_level].
+//   Allocates and initializes geodesic_dlen if store_dlen == true.
 //   Assumes x^0 is ignorable.
 //   Integrates via 4th-order Runge-Kutta with Butcher tableau
 //        0  |
@@ -415,6 +433,7 @@ void GeodesicIntegrator::IntegrateGeodesicsDP()
 //             1/6 1/3 1/3 1/6
 //   Step size in affine parameter is taken to be the product of user input ray_step with the radial
 //       displacement above the horizon.
+//   Proper lengths are evaluated at step midpoints, since proper distance is not integrated.
 void GeodesicIntegrator::IntegrateGeodesicsRK4()
 {
   // Allocate arrays
@@ -425,6 +444,8 @@ void GeodesicIntegrator::IntegrateGeodesicsRK4()
   geodesic_dir.Allocate(num_pix, ray_max_steps, 4);
   geodesic_len.Allocate(num_pix, ray_max_steps);
   geodesic_len.Zero();
+  if (store_dlen)
+    geodesic_dlen.Allocate(num_pix, ray_max_steps);
   sample_flags[adaptive_level].Allocate(num_pix);
   sample_flags[adaptive_level].Zero();
   sample_num[adaptive_level].Allocate(num_pix);
@@ -578,6 +599,13 @@ void GeodesicIntegrator::IntegrateGeodesicsRK4()
             temp_b < 0.0 ? (temp_d - temp_b) / (2.0 * temp_a) : -2.0 * temp_c / (temp_b + temp_d);
         for (int a = 1; a < 4; a++)
           geodesic_dir(m,n,a) *= factor;
+        if (store_dlen)
+        {
+          double kcov[4] = {geodesic_dir(m,n,0), geodesic_dir(m,n,1), geodesic_dir(m,n,2),
+              geodesic_dir(m,n,3)};
+          geodesic_dlen(m,n) = ProperLengthRate(geodesic_pos(m,n,1), geodesic_pos(m,n,2),
+              geodesic_pos(m,n,3), kcov) * -geodesic_len(m,n);
+        }
       }
 
     // Calculate maximum number of steps actually taken
@@ -615,6 +643,7 @@ void GeodesicIntegrator::IntegrateGeodesicsRK4()
 //   Initializes geodesic_num_steps[adaptive_level].
 //   Allocates and initializes geodesic_pos, geodesic_dir, geodesic_len,
 //       sample_flags[adaptive_level], and sample_num[adaptive_level].
+//   Allocates and initializes geodesic_dlen if store_dlen == true.
 //   Assumes x^0 is ignorable.
 //   Integrates via 2nd-order Runge-Kutta (Heun's method) with Butcher tableau
 //       0 |
@@ -623,6 +652,7 @@ void GeodesicIntegrator::IntegrateGeodesicsRK4()
 //           1/2 1/2
 //   Step size in affine parameter is taken to be the product of user input ray_step with the radial
 //       displacement above the horizon.
+//   Proper lengths are evaluated at step midpoints, since proper distance is not integrated.
 void GeodesicIntegrator::IntegrateGeodesicsRK2()
 {
   // Allocate arrays
@@ -633,6 +663,8 @@ void GeodesicIntegrator::IntegrateGeodesicsRK2()
   geodesic_dir.Allocate(num_pix, ray_max_steps, 4);
   geodesic_len.Allocate(num_pix, ray_max_steps);
   geodesic_len.Zero();
+  if (store_dlen)
+    geodesic_dlen.Allocate(num_pix, ray_max_steps);
   sample_flags[adaptive_level].Allocate(num_pix);
   sample_flags[adaptive_level].Zero();
   sample_num[adaptive_level].Allocate(num_pix);
@@ -767,6 +799,13 @@ void GeodesicIntegrator::IntegrateGeodesicsRK2()
             temp_b < 0.0 ? (temp_d - temp_b) / (2.0 * temp_a) : -2.0 * temp_c / (temp_b + temp_d);
         for (int a = 1; a < 4; a++)
           geodesic_dir(m,n,a) *= factor;
+        if (store_dlen)
+        {
+          double kcov[4] = {geodesic_dir(m,n,0), geodesic_dir(m,n,1), geodesic_dir(m,n,2),
+              geodesic_dir(m,n,3)};
+          geodesic_dlen(m,n) = ProperLengthRate(geodesic_pos(m,n,1), geodesic_pos(m,n,2),
+              geodesic_pos(m,n,3), kcov) * -geodesic_len(m,n);
+        }
       }
 
     // Calculate maximum number of steps actually taken
@@ -804,7 +843,8 @@ void GeodesicIntegrator::IntegrateGeodesicsRK2()
 //       sample_num[adaptive_level] have been set.
 //   Allocates and initializes sample_pos[adaptive_level], sample_dir[adaptive_level], and
 //       sample_len[adaptive_level], except reversed in the sampling dimension.
-//   Deallocates geodesic_pos, geodesic_dir, and geodesic_len.
+//   Does the same for sample_dlen[adaptive_level] from geodesic_dlen if store_dlen == true.
+//   Deallocates geodesic_pos, geodesic_dir, geodesic_len, and geodesic_dlen.
 void GeodesicIntegrator::ReverseGeodesics()
 {
   // Allocate arrays
@@ -815,6 +855,11 @@ void GeodesicIntegrator::ReverseGeodesics()
   sample_dir[adaptive_level].Allocate(num_pix, geodesic_num_steps[adaptive_level], 4);
   sample_len[adaptive_level].Allocate(num_pix, geodesic_num_steps[adaptive_level]);
   sample_len[adaptive_level].Zero();
+  if (store_dlen)
+  {
+    sample_dlen[adaptive_level].Allocate(num_pix, geodesic_num_steps[adaptive_level]);
+    sample_dlen[adaptive_level].Zero();
+  }
 
   // Go through samples
   #pragma omp parallel for schedule(static)
@@ -838,6 +883,8 @@ void GeodesicIntegrator::ReverseGeodesics()
       sample_dir[adaptive_level](m,num_steps-1-n,2) = geodesic_dir(m,n,2);
       sample_dir[adaptive_level](m,num_steps-1-n,3) = geodesic_dir(m,n,3);
       sample_len[adaptive_level](m,num_steps-1-n) = -len;
+      if (store_dlen)
+        sample_dlen[adaptive_level](m,num_steps-1-n) = geodesic_dlen(m,n);
     }
   }
 
@@ -845,11 +892,69 @@ void GeodesicIntegrator::ReverseGeodesics()
   geodesic_pos.Deallocate();
   geodesic_dir.Deallocate();
   geodesic_len.Deallocate();
+  geodesic_dlen.Deallocate();
   return;
 }
 
 //--------------------------------------------------------------------------------------------------
 
+// Function for calculating proper lengths of samples from stored positions and directions
+// Inputs: (none)
+// Outputs: (none)
+// Notes:
+//   Assumes sample_num[0], sample_pos[0], sample_dir[0], and sample_len[0] have been set.
+//   Allocates and initializes sample_dlen[0].
+//   Used when geodesics are loaded from a checkpoint, which does not store proper lengths.
+void GeodesicIntegrator::CalculateSampleLengths()
+{
+  // Allocate array
+  int num_pix = camera_num_pix;
+  sample_dlen[0].Allocate(num_pix, geodesic_num_steps[0]);
+  sample_dlen[0].Zero();
+
+  // Go through samples
+  #pragma omp parallel for schedule(static)
+  for (int m = 0; m < num_pix; m++)
+    for (int n = 0; n < sample_num[0](m); n++)
+    {
+      double kcov[4] = {sample_dir[0](m,n,0), sample_dir[0](m,n,1), sample_dir[0](m,n,2),
+          sample_dir[0](m,n,3)};
+      sample_dlen[0](m,n) = ProperLengthRate(sample_pos[0](m,n,1), sample_pos[0](m,n,2),
+          sample_pos[0](m,n,3), kcov) * sample_len[0](m,n);
+    }
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for calculating rate of change of proper distance with affine parameter
+// Inputs:
+//   x1, x2, x3: coordinates
+//   kcov: covariant momentum
+// Outputs:
+//   returned value: magnitude of dl/d(lambda), with l the proper distance measured by normal
+//       observer
+// Notes:
+//   Agrees with the derivative of the proper distance in GeodesicSubstepWithDistance().
+double GeodesicIntegrator::ProperLengthRate(double x1, double x2, double x3, const double kcov[4])
+{
+  double gcov[4][4];
+  double gcon[4][4];
+  CovariantGeodesicMetric(x1, x2, x3, gcov);
+  ContravariantGeodesicMetric(x1, x2, x3, gcon);
+  double temp_a[4] = {};
+  for (int a = 1; a < 4; a++)
+    for (int mu = 0; mu < 4; mu++)
+      temp_a[a] += (gcon[a][mu] - gcon[0][a] * gcon[0][mu] / gcon[0][0]) * kcov[mu];
+  double dl_dlambda_sq = 0.0;
+  for (int a = 1; a < 4; a++)
+    for (int b = 1; b < 4; b++)
+      dl_dlambda_sq += gcov[a][b] * temp_a[a] * temp_a[b];
+  return std::sqrt(dl_dlambda_sq);
+}
+
+//--------------------------------------------------------------------------------------------------
+
 // Function for taking single forward-Euler substep in time while computing proper distance
 // Inputs:
 //   y: dependent variables (positions, momenta, proper distance)
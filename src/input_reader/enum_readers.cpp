@@ -82,6 +82,33 @@ SimulationFormat InputReader::ReadSimulationFormat(const std::string &string)
 
 //--------------------------------------------------------------------------------------------------
 
+// Function for interpreting strings as SimulationPrecision enums
+// Inputs:
+//   string: string to be interpreted
+// Outputs:
+//   returned value: valid SimulationPrecision
+// Notes:
+//   Valid options:
+//     "single": 32-bit floats, as read from file
+//     "half": IEEE 16-bit floats
+//     "bfloat16": 16-bit floats with 8-bit exponent and 7-bit mantissa
+//     "log16": 16-bit logarithmic encoding of positive quantities, bfloat16 for others
+SimulationPrecision InputReader::ReadSimulationPrecision(const std::string &string)
+{
+  if (string == "single")
+    return SimulationPrecision::single;
+  else if (string == "half")
+    return SimulationPrecision::half;
+  else if (string == "bfloat16")
+    return SimulationPrecision::bfloat16;
+  else if (string == "log16")
+    return SimulationPrecision::log16;
+  else
+    throw BlacklightException("Unknown string used for SimulationPrecision value.");
+}
+
+//--------------------------------------------------------------------------------------------------
+
 // Function for interpreting strings as Coordinates enums
 // Inputs:
 //   string: string to be interpreted
@@ -156,6 +156,18 @@ int InputReader::Read()
       simulation_interp = ReadBool(val);
     else if (key == "simulation_block_interp")
       simulation_block_interp = ReadBool(val);
+    else if (key == "simulation_check_halos")
+      simulation_check_halos = ReadBool(val);
+    else if (key == "simulation_precision")
+      simulation_precision = ReadSimulationPrecision(val);
+    else if (key == "simulation_interleave")
+      simulation_interleave = ReadBool(val);
+    else if (key == "simulation_sort_samples")
+      simulation_sort_samples = ReadBool(val);
+    else if (key == "simulation_batch")
+      simulation_batch = ReadBool(val);
+    else if (key == "simulation_sks_map_file")
+      simulation_sks_map_file = val;
 
     // Store formula parameters
     else if (key == "formula_mass")
@@ -248,6 +260,8 @@ int InputReader::Read()
       image_polarization = ReadBool(val);
     else if (key == "image_rotation_split")
       image_rotation_split = ReadBool(val);
+    else if (key == "image_stokes")
+      image_stokes = ReadBool(val);
     else if (key == "image_time")
       image_time = ReadBool(val);
     else if (key == "image_length")
@@ -268,6 +282,10 @@ int InputReader::Read()
       image_crossings = ReadBool(val);
     else if (key == "image_z_turnings")
       image_z_turnings = ReadBool(val);
+    else if (key == "image_streaming")
+      image_streaming = ReadBool(val);
+    else if (key == "image_tau_max")
+      image_tau_max = std::stod(val);
 
     // Store rendering parameters
     else if (key.compare(0, 7, "render_") == 0)
@@ -354,6 +372,8 @@ int InputReader::Read()
       plasma_kappa = std::stod(val);
     else if (key == "plasma_w")
       plasma_w = std::stod(val);
+    else if (key == "plasma_tables")
+      plasma_tables = ReadBool(val);
 
     // Store cut parameters
     else if (key == "cut_rho_min")
@@ -58,6 +58,12 @@ struct InputReader
   std::optional<std::string> simulation_kappa_name;
   std::optional<bool> simulation_interp;
   std::optional<bool> simulation_block_interp;
+  std::optional<bool> simulation_check_halos;
+  std::optional<SimulationPrecision> simulation_precision;
+  std::optional<bool> simulation_interleave;
+  std::optional<bool> simulation_sort_samples;
+  std::optional<bool> simulation_batch;
+  std::optional<std::string> simulation_sks_map_file;
 
   // Data - formula parameters
   std::optional<double> formula_mass;
@@ -109,6 +115,7 @@ struct InputReader
   std::optional<FrequencyNormalization> image_normalization;
   std::optional<bool> image_polarization;
   std::optional<bool> image_rotation_split;
+  std::optional<bool> image_stokes;
   std::optional<bool> image_time;
   std::optional<bool> image_length;
   std::optional<bool> image_lambda;
@@ -119,6 +126,8 @@ struct InputReader
   std::optional<bool> image_tau_int;
   std::optional<bool> image_crossings;
   std::optional<bool> image_z_turnings;
+  std::optional<bool> image_streaming;
+  std::optional<double> image_tau_max;
 
   // Data - rendering parameters
   std::optional<int> render_num_images;
@@ -181,6 +190,7 @@ struct InputReader
   std::optional<double> plasma_kappa_frac;
   std::optional<double> plasma_kappa;
   std::optional<double> plasma_w;
+  std::optional<bool> plasma_tables;
 
   // Data - cut parameters
   std::optional<double> cut_rho_min;
@@ -232,6 +242,7 @@ struct InputReader
   ModelType ReadModelType(const std::string &string);
   OutputFormat ReadOutputFormat(const std::string &string);
   SimulationFormat ReadSimulationFormat(const std::string &string);
+  SimulationPrecision ReadSimulationPrecision(const std::string &string);
   Coordinates ReadCoordinates(const std::string &string);
   Camera ReadCamera(const std::string &string);
   RayTerminate ReadRayTerminate(const std::string &string);
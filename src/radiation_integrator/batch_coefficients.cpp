@@ -0,0 +1,545 @@
+// Blacklight radiation integrator - batched simulation radiative transfer coefficients
+
+// C++ headers
+#include <algorithm>  // min
+#include <cmath>      // pow, sin, sqrt
+#include <limits>     // numeric_limits
+
+// Blacklight headers
+#include "radiation_integrator.hpp"
+#include "../blacklight.hpp"          // Math, Physics, enums
+#include "../utils/array.hpp"         // Array
+#include "../utils/vector_math.hpp"   // VectorCbrt, VectorExp, VectorExpm1, VectorLog, VectorPow
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for calculating frequency-dependent radiative transfer coefficients for batch of samples
+// Inputs:
+//   thread: index of thread whose batch should be processed
+// Outputs: (none)
+// Notes:
+//   Assumes batch_num(thread) samples have been placed in the given thread's rows of batch_inds and
+//       batch_vals by CalculateSampleCoefficients().
+//   Sets the same values of the allocated coefficient arrays as CalculateSampleCoefficients() does
+//       when simulation_batch == false, and resets batch_num(thread) to 0.
+//   Accumulates coefficients for all samples in the batch in batch_coefficients, one frequency at
+//       a time, before scattering them to the coefficient arrays.
+//   Each contribution is evaluated in its own function, keeping loop bodies small and free of
+//       branches so they can be vectorized. The functions in vector_math.hpp are used in place of
+//       standard library functions, so results differ from the unbatched calculation at the level
+//       of roundoff.
+void RadiationIntegrator::CalculateBatchCoefficients(int thread)
+{
+  // Check for empty batch
+  int num = batch_num(thread);
+  if (num == 0)
+    return;
+  batch_num(thread) = 0;
+
+  // Locate per-sample values
+  const int *rows = &batch_inds(thread,0,0);
+  const int *cols = &batch_inds(thread,1,0);
+  const double *vals = &batch_vals(thread,0,0);
+  const double *nu_fluid = vals + BatchValues::nu_fluid * batch_size;
+  const double *momentum_factor = vals + BatchValues::momentum_factor * batch_size;
+  double *coefficients = &batch_coefficients(thread,0,0);
+  double *nu_cgs = coefficients + BatchCoefficients::nu * batch_size;
+  const double *j_i_vals = coefficients + BatchCoefficients::j_i * batch_size;
+  const double *j_q_vals = coefficients + BatchCoefficients::j_q * batch_size;
+  const double *j_v_vals = coefficients + BatchCoefficients::j_v * batch_size;
+  const double *alpha_i_vals = coefficients + BatchCoefficients::alpha_i * batch_size;
+  const double *alpha_q_vals = coefficients + BatchCoefficients::alpha_q * batch_size;
+  const double *alpha_v_vals = coefficients + BatchCoefficients::alpha_v * batch_size;
+  const double *rho_q_vals = coefficients + BatchCoefficients::rho_q * batch_size;
+  const double *rho_v_vals = coefficients + BatchCoefficients::rho_v * batch_size;
+
+  // Prepare flags
+  bool polarized = image_light and image_polarization;
+  bool store_j_i = image_light or image_emission or image_emission_ave;
+  bool store_alpha_i = image_light or image_tau or image_tau_int;
+
+  // Go through frequencies
+  for (int l = 0; l < image_num_frequencies; l++)
+  {
+    // Calculate orthonormal-frame frequencies and initialize coefficients
+    double frequency = image_frequencies(l);
+    #pragma omp simd
+    for (int k = 0; k < num; k++)
+      nu_cgs[k] = nu_fluid[k] * (frequency * momentum_factor[k]);
+    for (int q = BatchCoefficients::nu + 1; q < BatchCoefficients::num_batch_coefficients; q++)
+      for (int k = 0; k < num; k++)
+        coefficients[q*batch_size+k] = 0.0;
+
+    // Calculate contributions from each population
+    if (plasma_thermal_frac != 0.0)
+      BatchThermalCoefficients(thread, num);
+    if (plasma_thermal_frac != 0.0 and polarized)
+      BatchThermalRotativities(thread, num);
+    if (plasma_power_frac != 0.0)
+      BatchPowerCoefficients(thread, num);
+    if (plasma_kappa_frac != 0.0)
+      BatchKappaCoefficients(thread, num);
+    if (plasma_kappa_frac != 0.0 and polarized)
+    {
+      BatchKappaPolarizedCoefficients(thread, num);
+      BatchKappaRotativities(thread, num);
+    }
+
+    // Store coefficients
+    for (int k = 0; k < num; k++)
+    {
+      int row = rows[k];
+      int c = cols[k];
+      if (store_j_i)
+        j_i[adaptive_level](row,c,l) = j_i_vals[k];
+      if (store_alpha_i)
+        alpha_i[adaptive_level](row,c,l) = alpha_i_vals[k];
+      if (polarized)
+      {
+        j_q[adaptive_level](row,c,l) = j_q_vals[k];
+        j_v[adaptive_level](row,c,l) = j_v_vals[k];
+        alpha_q[adaptive_level](row,c,l) = alpha_q_vals[k];
+        alpha_v[adaptive_level](row,c,l) = alpha_v_vals[k];
+        rho_q[adaptive_level](row,c,l) = rho_q_vals[k];
+        rho_v[adaptive_level](row,c,l) = rho_v_vals[k];
+      }
+    }
+  }
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for calculating thermal synchrotron emissivities and absorptivities for batch of samples
+// Inputs:
+//   thread: index of thread whose batch should be processed
+//   num: number of samples in batch
+// Outputs: (none)
+// Notes:
+//   Sets j_I, j_Q, j_V, alpha_I, alpha_Q, and alpha_V in batch_coefficients.
+//   Polarized coefficients are always calculated, since they require no additional function
+//       evaluations; they are only stored if needed.
+//   References 2021 ApJ 921 17 (M) for transfer coefficients.
+void RadiationIntegrator::BatchThermalCoefficients(int thread, int num)
+{
+  // Locate per-sample values
+  const double *vals = &batch_vals(thread,0,0);
+  const double *n_e_cgs = vals + BatchValues::n_e * batch_size;
+  const double *kb_tt_e_cgs = vals + BatchValues::kb_tt_e * batch_size;
+  const double *nu_c_cgs = vals + BatchValues::nu_c * batch_size;
+  const double *nu_s_cgs = vals + BatchValues::nu_s * batch_size;
+  const double *thermal_var_jj_a = vals + BatchValues::thermal_jj_a * batch_size;
+  const double *thermal_var_jj_d = vals + BatchValues::thermal_jj_d * batch_size;
+  const double *thermal_var_jj_f = vals + BatchValues::thermal_jj_f * batch_size;
+  double *coefficients = &batch_coefficients(thread,0,0);
+  const double *nu_cgs = coefficients + BatchCoefficients::nu * batch_size;
+  double *j_i_vals = coefficients + BatchCoefficients::j_i * batch_size;
+  double *j_q_vals = coefficients + BatchCoefficients::j_q * batch_size;
+  double *j_v_vals = coefficients + BatchCoefficients::j_v * batch_size;
+  double *alpha_i_vals = coefficients + BatchCoefficients::alpha_i * batch_size;
+  double *alpha_q_vals = coefficients + BatchCoefficients::alpha_q * batch_size;
+  double *alpha_v_vals = coefficients + BatchCoefficients::alpha_v * batch_size;
+
+  // Calculate emissivities and absorptivities (M 28,30,31)
+  double var_b = std::pow(2.0, 11.0 / 12.0);
+  #pragma omp simd
+  for (int k = 0; k < num; k++)
+  {
+    // Calculate emissivities
+    double nu_2_cgs = nu_cgs[k] * nu_cgs[k];
+    double xx = nu_cgs[k] / nu_s_cgs[k];
+    double xx_1_2 = std::sqrt(xx);
+    double xx_1_3 = VectorCbrt(xx);
+    double xx_1_6 = std::sqrt(xx_1_3);
+    double coefficient = plasma_thermal_frac * n_e_cgs[k] * Physics::e * Physics::e * nu_c_cgs[k]
+        / (Physics::c * nu_2_cgs) * VectorExp(-xx_1_3);
+    double var_c = xx_1_2 + var_b * xx_1_6;
+    double var_e = xx_1_2 + thermal_var_jj_d[k] * xx_1_6;
+    double var_g = Math::pi / 3.0 + Math::pi / 3.0 * xx_1_3 + 2.0 / 300.0 * xx_1_2
+        + 2.0 / 19.0 * Math::pi * xx_1_3 * xx_1_3;
+    double j_i_val = coefficient * thermal_var_jj_a[k] * var_c * var_c;
+    double j_q_val = -coefficient * thermal_var_jj_a[k] * var_e * var_e;
+    double j_v_val = coefficient * thermal_var_jj_f[k] * var_g;
+
+    // Calculate absorptivities from Kirchoff's law
+    double b_nu_nu_3_cgs = 2.0 * Physics::h / (Physics::c * Physics::c)
+        / VectorExpm1(Physics::h * nu_cgs[k] / kb_tt_e_cgs[k]);
+    double alpha_i_val = j_i_val / b_nu_nu_3_cgs;
+    double alpha_q_val = j_q_val / b_nu_nu_3_cgs;
+    double alpha_v_val = j_v_val / b_nu_nu_3_cgs;
+
+    // Account for numerical issues later arising from absorptivities being too small
+    bool underflow =
+        1.0 / (alpha_i_val * alpha_i_val) == std::numeric_limits<double>::infinity();
+    j_i_vals[k] = j_i_val;
+    j_q_vals[k] = j_q_val;
+    j_v_vals[k] = j_v_val;
+    alpha_i_vals[k] = underflow ? 0.0 : alpha_i_val;
+    alpha_q_vals[k] = underflow ? 0.0 : alpha_q_val;
+    alpha_v_vals[k] = underflow ? 0.0 : alpha_v_val;
+  }
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for calculating thermal synchrotron rotativities for batch of samples
+// Inputs:
+//   thread: index of thread whose batch should be processed
+//   num: number of samples in batch
+// Outputs: (none)
+// Notes:
+//   Sets rho_Q and rho_V in batch_coefficients.
+//   Interpolates frequency-dependent factors from tables where possible, evaluating the remaining
+//       factors with ThermalRotativityFits() one sample at a time.
+//   References 2021 ApJ 921 17 (M) for transfer coefficients.
+void RadiationIntegrator::BatchThermalRotativities(int thread, int num)
+{
+  // Locate per-sample values
+  const double *vals = &batch_vals(thread,0,0);
+  const double *n_e_cgs = vals + BatchValues::n_e * batch_size;
+  const double *theta_e = vals + BatchValues::theta_e * batch_size;
+  const double *nu_c_cgs = vals + BatchValues::nu_c * batch_size;
+  const double *nu_s_cgs = vals + BatchValues::nu_s * batch_size;
+  const double *sin2_theta_b = vals + BatchValues::sin2_theta_b * batch_size;
+  const double *cos_theta_b = vals + BatchValues::cos_theta_b * batch_size;
+  const double *thermal_rho_tabulated = vals + BatchValues::thermal_rho_tabulated * batch_size;
+  const double *thermal_rho_g = vals + BatchValues::thermal_rho_g * batch_size;
+  const double *thermal_rho_h = vals + BatchValues::thermal_rho_h * batch_size;
+  const double *thermal_rho_kk_0 = vals + BatchValues::thermal_rho_kk_0 * batch_size;
+  const double *thermal_rho_kk_2 = vals + BatchValues::thermal_rho_kk_2 * batch_size;
+  const double *thermal_rho_kk_2_inv = vals + BatchValues::thermal_rho_kk_2_inv * batch_size;
+  double *coefficients = &batch_coefficients(thread,0,0);
+  const double *nu_cgs = coefficients + BatchCoefficients::nu * batch_size;
+  double *rho_q_vals = coefficients + BatchCoefficients::rho_q * batch_size;
+  double *rho_v_vals = coefficients + BatchCoefficients::rho_v * batch_size;
+
+  // Initialize factors
+  double factor_q[batch_size];
+  double factor_v[batch_size];
+  bool direct[batch_size];
+  #pragma omp simd
+  for (int k = 0; k < num; k++)
+  {
+    factor_q[k] = 0.0;
+    factor_v[k] = 1.0;
+    direct[k] = theta_e[k] >= theta_e_zero;
+  }
+
+  // Interpolate factors from tables (M 35-37)
+  if (plasma_tables)
+  {
+    const double *table = table_xx_vals.data;
+    #pragma omp simd
+    for (int k = 0; k < num; k++)
+    {
+      double xx = nu_cgs[k] / nu_s_cgs[k];
+      double u = (VectorLog(xx) - table_xx_log_min) * table_xx_inv_dlog;
+      bool tabulated = thermal_rho_tabulated[k] != 0.0 and u >= 0.0 and u <= table_xx_num - 1;
+      u = tabulated ? u : 0.0;
+      int i = std::min(static_cast<int>(u), table_xx_num - 2);
+      double f = u - i;
+      double f_m = (1.0 - f) * table[2*i] + f * table[2*i+2];
+      double delta_jj_5 = (1.0 - f) * table[2*i+1] + f * table[2*i+3];
+      double factor_v_val = thermal_rho_h[k] - delta_jj_5 * thermal_rho_kk_2_inv[k];
+      factor_v_val = factor_v_val < 0.0 or factor_v_val > 1.0 ? 1.0 : factor_v_val;
+      factor_q[k] = tabulated ? f_m * thermal_rho_g[k] : factor_q[k];
+      factor_v[k] = tabulated ? factor_v_val : factor_v[k];
+      direct[k] = direct[k] and not tabulated;
+    }
+  }
+
+  // Evaluate remaining factors directly (M 35-37)
+  for (int k = 0; k < num; k++)
+    if (direct[k])
+    {
+      double f_m, f_m_scale, delta_jj_5;
+      ThermalRotativityFits(nu_cgs[k] / nu_s_cgs[k], &f_m, &f_m_scale, &delta_jj_5);
+      factor_q[k] = f_m * thermal_rho_g[k];
+      if (thermal_rho_tabulated[k] != 0.0)
+        factor_v[k] = thermal_rho_h[k] - delta_jj_5 * thermal_rho_kk_2_inv[k];
+      else
+        factor_v[k] = (thermal_rho_kk_0[k] - delta_jj_5) / thermal_rho_kk_2[k];
+      factor_v[k] = factor_v[k] < 0.0 or factor_v[k] > 1.0 ? 1.0 : factor_v[k];
+    }
+
+  // Calculate rotativities (M 33,34)
+  #pragma omp simd
+  for (int k = 0; k < num; k++)
+  {
+    double nu_2_cgs = nu_cgs[k] * nu_cgs[k];
+    double coefficient_q = -plasma_thermal_frac * n_e_cgs[k] * Physics::e * Physics::e
+        * nu_c_cgs[k] * nu_c_cgs[k] * sin2_theta_b[k] / (Physics::m_e * Physics::c * nu_2_cgs);
+    double coefficient_v = plasma_thermal_frac * 2.0 * n_e_cgs[k] * Physics::e * Physics::e
+        * nu_c_cgs[k] * cos_theta_b[k] / (Physics::m_e * Physics::c * nu_cgs[k]);
+    rho_q_vals[k] = coefficient_q * factor_q[k];
+    rho_v_vals[k] = coefficient_v * factor_v[k];
+  }
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for calculating power-law synchrotron coefficients for batch of samples
+// Inputs:
+//   thread: index of thread whose batch should be processed
+//   num: number of samples in batch
+// Outputs: (none)
+// Notes:
+//   Adds to j_I, j_Q, j_V, alpha_I, alpha_Q, alpha_V, and, for polarized images, rho_Q and rho_V in
+//       batch_coefficients.
+//   References 2021 ApJ 921 17 (M) for transfer coefficients.
+void RadiationIntegrator::BatchPowerCoefficients(int thread, int num)
+{
+  // Locate per-sample values
+  const double *vals = &batch_vals(thread,0,0);
+  const double *n_e_cgs = vals + BatchValues::n_e * batch_size;
+  const double *nu_c_cgs = vals + BatchValues::nu_c * batch_size;
+  const double *sin_theta_b = vals + BatchValues::sin_theta_b * batch_size;
+  const double *cos_theta_b = vals + BatchValues::cos_theta_b * batch_size;
+  const double *power_cot_theta_b = vals + BatchValues::power_cot_theta_b * batch_size;
+  const double *power_var_aa_b = vals + BatchValues::power_aa_b * batch_size;
+  double *coefficients = &batch_coefficients(thread,0,0);
+  const double *nu_cgs = coefficients + BatchCoefficients::nu * batch_size;
+  double *j_i_vals = coefficients + BatchCoefficients::j_i * batch_size;
+  double *j_q_vals = coefficients + BatchCoefficients::j_q * batch_size;
+  double *j_v_vals = coefficients + BatchCoefficients::j_v * batch_size;
+  double *alpha_i_vals = coefficients + BatchCoefficients::alpha_i * batch_size;
+  double *alpha_q_vals = coefficients + BatchCoefficients::alpha_q * batch_size;
+  double *alpha_v_vals = coefficients + BatchCoefficients::alpha_v * batch_size;
+  double *rho_q_vals = coefficients + BatchCoefficients::rho_q * batch_size;
+  double *rho_v_vals = coefficients + BatchCoefficients::rho_v * batch_size;
+
+  // Calculate emissivities and absorptivities (M 28,29,38,39)
+  #pragma omp simd
+  for (int k = 0; k < num; k++)
+  {
+    double nu_2_cgs = nu_cgs[k] * nu_cgs[k];
+    double nu_ratio = nu_cgs[k] / (nu_c_cgs[k] * sin_theta_b[k]);
+    double var_a_jj = VectorPow(nu_ratio, -(plasma_p - 1.0) / 2.0);
+    double coefficient_jj = plasma_power_frac * n_e_cgs[k] * Physics::e * Physics::e
+        * nu_c_cgs[k] / (Physics::c * nu_2_cgs) * power_jj * sin_theta_b[k] * var_a_jj;
+    double var_c_jj = 1.0 / std::sqrt(nu_cgs[k] / (3.0 * nu_c_cgs[k] * sin_theta_b[k]));
+    double var_a_aa = VectorPow(nu_ratio, -(plasma_p + 2.0) / 2.0);
+    double coefficient_aa = plasma_power_frac * n_e_cgs[k] * Physics::e * Physics::e
+        / (Physics::m_e * Physics::c) * power_aa * var_a_aa;
+    double var_c_aa = 1.0 / std::sqrt(nu_ratio);
+    double var_d_aa = cos_theta_b[k] >= 0.0 ? 1.0 : -1.0;
+    j_i_vals[k] += coefficient_jj;
+    j_q_vals[k] += coefficient_jj * power_jj_q;
+    j_v_vals[k] += coefficient_jj * power_jj_v * power_cot_theta_b[k] * var_c_jj;
+    alpha_i_vals[k] += coefficient_aa;
+    alpha_q_vals[k] += coefficient_aa * power_aa_q;
+    alpha_v_vals[k] += coefficient_aa * power_aa_v * power_var_aa_b[k] * var_c_aa * var_d_aa;
+  }
+
+  // Calculate rotativities (M 40-42)
+  if (image_light and image_polarization)
+  {
+    #pragma omp simd
+    for (int k = 0; k < num; k++)
+    {
+      double var_a = n_e_cgs[k] * Physics::e * Physics::e * nu_cgs[k]
+          / (Physics::m_e * Physics::c * nu_c_cgs[k] * sin_theta_b[k]);
+      double var_b = nu_c_cgs[k] * sin_theta_b[k] / nu_cgs[k];
+      double var_c = var_b * var_b;
+      double var_d = var_c * var_b;
+      double var_e = 1.0 - VectorPow(2.0 * nu_c_cgs[k] * plasma_gamma_min * plasma_gamma_min
+          * sin_theta_b[k] / (3.0 * nu_cgs[k]), plasma_p / 2.0 - 1.0);
+      double coefficient = plasma_power_frac * power_rho * var_a;
+      rho_q_vals[k] += coefficient * power_rho_q * var_d * var_e;
+      rho_v_vals[k] += coefficient * power_rho_v * var_c * power_cot_theta_b[k];
+    }
+  }
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for calculating kappa-distribution synchrotron unpolarized coefficients for batch
+// Inputs:
+//   thread: index of thread whose batch should be processed
+//   num: number of samples in batch
+// Outputs: (none)
+// Notes:
+//   Adds to j_I and alpha_I in batch_coefficients.
+//   References 2021 ApJ 921 17 (M) for transfer coefficients.
+void RadiationIntegrator::BatchKappaCoefficients(int thread, int num)
+{
+  // Locate per-sample values
+  const double *vals = &batch_vals(thread,0,0);
+  const double *n_e_cgs = vals + BatchValues::n_e * batch_size;
+  const double *nu_c_cgs = vals + BatchValues::nu_c * batch_size;
+  const double *sin_theta_b = vals + BatchValues::sin_theta_b * batch_size;
+  const double *nu_kappa_cgs = vals + BatchValues::nu_kappa * batch_size;
+  const double *kappa_var_aa_a = vals + BatchValues::kappa_aa_a * batch_size;
+  double *coefficients = &batch_coefficients(thread,0,0);
+  const double *nu_cgs = coefficients + BatchCoefficients::nu * batch_size;
+  double *j_i_vals = coefficients + BatchCoefficients::j_i * batch_size;
+  double *alpha_i_vals = coefficients + BatchCoefficients::alpha_i * batch_size;
+
+  // Calculate emissivities and absorptivities (M 28,29,43-50)
+  #pragma omp simd
+  for (int k = 0; k < num; k++)
+  {
+    double nu_2_cgs = nu_cgs[k] * nu_cgs[k];
+    double xx = nu_cgs[k] / nu_kappa_cgs[k];
+    double var_a = plasma_kappa_frac * n_e_cgs[k] * Physics::e * Physics::e * nu_c_cgs[k]
+        / (Physics::c * nu_2_cgs);
+    double var_b_jj = VectorCbrt(xx) * sin_theta_b[k];
+    double var_c_jj = VectorPow(xx, -(plasma_kappa - 2.0) / 2.0) * sin_theta_b[k];
+    double jj_low = kappa_jj_low * var_a * var_b_jj;
+    double jj_high = kappa_jj_high * var_a * var_c_jj;
+    double var_b_aa = VectorPow(xx, -2.0 / 3.0);
+    double var_c_aa = VectorPow(xx, -(1.0 + plasma_kappa) / 2.0);
+    double aa_i_low = kappa_aa_low * kappa_var_aa_a[k] * var_b_aa;
+    double aa_i_high = kappa_aa_high * kappa_var_aa_a[k] * var_c_aa * kappa_aa_high_i;
+    j_i_vals[k] += VectorPow(VectorPow(jj_low, -kappa_jj_x_i) + VectorPow(jj_high, -kappa_jj_x_i),
+        -1.0 / kappa_jj_x_i);
+    alpha_i_vals[k] += VectorPow(VectorPow(aa_i_low, -kappa_aa_x_i)
+        + VectorPow(aa_i_high, -kappa_aa_x_i), -1.0 / kappa_aa_x_i);
+  }
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for calculating kappa-distribution synchrotron polarized coefficients for batch
+// Inputs:
+//   thread: index of thread whose batch should be processed
+//   num: number of samples in batch
+// Outputs: (none)
+// Notes:
+//   Adds to j_Q, j_V, alpha_Q, and alpha_V in batch_coefficients.
+//   References 2021 ApJ 921 17 (M) for transfer coefficients.
+void RadiationIntegrator::BatchKappaPolarizedCoefficients(int thread, int num)
+{
+  // Locate per-sample values
+  const double *vals = &batch_vals(thread,0,0);
+  const double *n_e_cgs = vals + BatchValues::n_e * batch_size;
+  const double *nu_c_cgs = vals + BatchValues::nu_c * batch_size;
+  const double *sin_theta_b = vals + BatchValues::sin_theta_b * batch_size;
+  const double *cos_theta_b = vals + BatchValues::cos_theta_b * batch_size;
+  const double *nu_kappa_cgs = vals + BatchValues::nu_kappa * batch_size;
+  const double *kappa_var_aa_a = vals + BatchValues::kappa_aa_a * batch_size;
+  const double *kappa_var_jj_d = vals + BatchValues::kappa_jj_d * batch_size;
+  const double *kappa_var_jj_f = vals + BatchValues::kappa_jj_f * batch_size;
+  const double *kappa_var_aa_d = vals + BatchValues::kappa_aa_d * batch_size;
+  const double *kappa_var_aa_f = vals + BatchValues::kappa_aa_f * batch_size;
+  double *coefficients = &batch_coefficients(thread,0,0);
+  const double *nu_cgs = coefficients + BatchCoefficients::nu * batch_size;
+  double *j_q_vals = coefficients + BatchCoefficients::j_q * batch_size;
+  double *j_v_vals = coefficients + BatchCoefficients::j_v * batch_size;
+  double *alpha_q_vals = coefficients + BatchCoefficients::alpha_q * batch_size;
+  double *alpha_v_vals = coefficients + BatchCoefficients::alpha_v * batch_size;
+
+  // Calculate emissivities (M 28,43-46)
+  #pragma omp simd
+  for (int k = 0; k < num; k++)
+  {
+    double nu_2_cgs = nu_cgs[k] * nu_cgs[k];
+    double xx = nu_cgs[k] / nu_kappa_cgs[k];
+    double var_a = plasma_kappa_frac * n_e_cgs[k] * Physics::e * Physics::e * nu_c_cgs[k]
+        / (Physics::c * nu_2_cgs);
+    double var_b = VectorCbrt(xx) * sin_theta_b[k];
+    double var_c = VectorPow(xx, -(plasma_kappa - 2.0) / 2.0) * sin_theta_b[k];
+    double var_e = VectorPow(xx, -0.35);
+    double var_g = 1.0 / std::sqrt(xx);
+    double var_h = cos_theta_b[k] >= 0.0 ? 1.0 : -1.0;
+    double coefficient_low = kappa_jj_low * var_a * var_b;
+    double coefficient_high = kappa_jj_high * var_a * var_c;
+    double jj_q_low = coefficient_low * kappa_jj_low_q;
+    double jj_v_low = coefficient_low * kappa_jj_low_v * kappa_var_jj_d[k] * var_e;
+    double jj_q_high = coefficient_high * kappa_jj_high_q;
+    double jj_v_high = coefficient_high * kappa_jj_high_v * kappa_var_jj_f[k] * var_g;
+    j_q_vals[k] -= VectorPow(VectorPow(jj_q_low, -kappa_jj_x_q)
+        + VectorPow(jj_q_high, -kappa_jj_x_q), -1.0 / kappa_jj_x_q);
+    j_v_vals[k] += VectorPow(VectorPow(jj_v_low, -kappa_jj_x_v)
+        + VectorPow(jj_v_high, -kappa_jj_x_v), -1.0 / kappa_jj_x_v) * var_h;
+  }
+
+  // Calculate absorptivities (M 29,47-50)
+  #pragma omp simd
+  for (int k = 0; k < num; k++)
+  {
+    double xx = nu_cgs[k] / nu_kappa_cgs[k];
+    double var_b = VectorPow(xx, -2.0 / 3.0);
+    double var_c = VectorPow(xx, -(1.0 + plasma_kappa) / 2.0);
+    double var_e = VectorPow(xx, -0.35);
+    double var_g = 1.0 / std::sqrt(xx);
+    double var_h = cos_theta_b[k] >= 0.0 ? 1.0 : -1.0;
+    double coefficient_low = kappa_aa_low * kappa_var_aa_a[k] * var_b;
+    double coefficient_high = kappa_aa_high * kappa_var_aa_a[k] * var_c;
+    double aa_q_low = coefficient_low * kappa_aa_low_q;
+    double aa_v_low = coefficient_low * kappa_aa_low_v * kappa_var_aa_d[k] * var_e;
+    double aa_q_high = coefficient_high * kappa_aa_high_q;
+    double aa_v_high = coefficient_high * kappa_aa_high_v * kappa_var_aa_f[k] * var_g;
+    alpha_q_vals[k] -= VectorPow(VectorPow(aa_q_low, -kappa_aa_x_q)
+        + VectorPow(aa_q_high, -kappa_aa_x_q), -1.0 / kappa_aa_x_q);
+    alpha_v_vals[k] += VectorPow(VectorPow(aa_v_low, -kappa_aa_x_v)
+        + VectorPow(aa_v_high, -kappa_aa_x_v), -1.0 / kappa_aa_x_v) * var_h;
+  }
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for calculating kappa-distribution synchrotron rotativities for batch of samples
+// Inputs:
+//   thread: index of thread whose batch should be processed
+//   num: number of samples in batch
+// Outputs: (none)
+// Notes:
+//   Adds to rho_Q and rho_V in batch_coefficients.
+//   Sines are evaluated one sample at a time before the vectorized loop.
+//   References 2021 ApJ 921 17 (M) for transfer coefficients.
+void RadiationIntegrator::BatchKappaRotativities(int thread, int num)
+{
+  // Locate per-sample values
+  const double *vals = &batch_vals(thread,0,0);
+  const double *n_e_cgs = vals + BatchValues::n_e * batch_size;
+  const double *nu_c_cgs = vals + BatchValues::nu_c * batch_size;
+  const double *sin2_theta_b = vals + BatchValues::sin2_theta_b * batch_size;
+  const double *cos_theta_b = vals + BatchValues::cos_theta_b * batch_size;
+  const double *nu_kappa_cgs = vals + BatchValues::nu_kappa * batch_size;
+  double *coefficients = &batch_coefficients(thread,0,0);
+  const double *nu_cgs = coefficients + BatchCoefficients::nu * batch_size;
+  double *rho_q_vals = coefficients + BatchCoefficients::rho_q * batch_size;
+  double *rho_v_vals = coefficients + BatchCoefficients::rho_v * batch_size;
+
+  // Calculate sines
+  double sin_low[batch_size];
+  double sin_high[batch_size];
+  for (int k = 0; k < num; k++)
+  {
+    double xx = nu_cgs[k] / nu_kappa_cgs[k];
+    sin_low[k] = std::sin(kappa_rho_q_low_c * xx);
+    sin_high[k] = std::sin(kappa_rho_q_high_c * xx);
+  }
+
+  // Calculate rotativities (M 51-54)
+  #pragma omp simd
+  for (int k = 0; k < num; k++)
+  {
+    double nu_2_cgs = nu_cgs[k] * nu_cgs[k];
+    double xx = nu_cgs[k] / nu_kappa_cgs[k];
+    double var_a = -plasma_kappa_frac * n_e_cgs[k] * Physics::e * Physics::e * nu_c_cgs[k]
+        * nu_c_cgs[k] * sin2_theta_b[k] / (Physics::m_e * Physics::c * nu_2_cgs);
+    double var_b = plasma_kappa_frac * 2.0 * n_e_cgs[k] * Physics::e * Physics::e * nu_c_cgs[k]
+        * cos_theta_b[k] / (Physics::m_e * Physics::c * nu_cgs[k]);
+    double var_c = 1.0 / std::sqrt(xx);
+    double xx_0_84 = VectorPow(xx, 0.84);
+    double rho_q_low = var_a * kappa_rho_q_low_a * (1.0 - VectorExp(kappa_rho_q_low_b * xx_0_84)
+        - sin_low[k] * VectorExp(kappa_rho_q_low_d * VectorPow(xx, kappa_rho_q_low_e)));
+    double rho_q_high = var_a * kappa_rho_q_high_a * (1.0 - VectorExp(kappa_rho_q_high_b
+        * xx_0_84) - sin_high[k] * VectorExp(kappa_rho_q_high_d
+        * VectorPow(xx, kappa_rho_q_high_e)));
+    double rho_v_low = kappa_rho_v * var_b * kappa_rho_v_low_a
+        * (1.0 - 0.17 * VectorLog(1.0 + kappa_rho_v_low_b * var_c));
+    double rho_v_high = kappa_rho_v * var_b * kappa_rho_v_high_a
+        * (1.0 - 0.17 * VectorLog(1.0 + kappa_rho_v_high_b * var_c));
+    rho_q_vals[k] += (1.0 - kappa_rho_frac) * rho_q_low + kappa_rho_frac * rho_q_high;
+    rho_v_vals[k] += (1.0 - kappa_rho_frac) * rho_v_low + kappa_rho_frac * rho_v_high;
+  }
+  return;
+}
@@ -0,0 +1,414 @@
+// Blacklight radiation integrator - neighbor table and ghost-cell halos of simulation blocks
+
+// C++ headers
+#include <algorithm>  // max, min
+
+// Library headers
+#include <omp.h>  // pragmas
+
+// Blacklight headers
+#include "radiation_integrator.hpp"
+#include "../blacklight.hpp"         // enums
+#include "../utils/array.hpp"        // Array
+#include "../utils/exceptions.hpp"   // BlacklightException
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for building table of neighbors of each block
+// Inputs: (none)
+// Outputs: (none)
+// Notes:
+//   Assumes levels, locations, x1v, x2v, x3v, and grid_num_vars have been set.
+//   Assumes BuildBlockIndex() has been called.
+//   Directions are numbered 9 * (d_k + 1) + 3 * (d_j + 1) + (d_i + 1), with offsets d in
+//       {-1, 0, 1}; direction 13 refers to the block itself.
+//   Records for each direction the direction actually used, with offsets set to 0 along any
+//       dimension in which there is no grid beyond the face of the block, so that ghost cells
+//       there copy the nearest cell on the grid.
+//   Records for each used direction whether the neighbor is at the same level (0), is coarser
+//       (-1), or is finer (1), along with the neighboring block, or, if finer, up to 4 neighboring
+//       blocks numbered by which halves of the block they abut in the dimensions with 0 offset.
+//   In the case of simulation_coord being Coordinates::sks, neighboring blocks are understood to
+//       cross the periodic boundary in x^3 (phi), but the domain is not stitched together at the
+//       poles.
+//   Allocates grid_halo to hold values of all sampled quantities in a layer of ghost cells around
+//       each block, for all time slices.
+void RadiationIntegrator::BuildNeighborTable()
+{
+  // Allocate arrays
+  int n_b = x1f.n2;
+  int n_i = x1v.n1;
+  int n_j = x2v.n1;
+  int n_k = x3v.n1;
+  block_neighbor_dirs.Allocate(n_b, 27);
+  block_neighbor_levels.Allocate(n_b, 27);
+  block_neighbors.Allocate(n_b, 27, 4);
+
+  // Go through blocks
+  for (int b = 0; b < n_b; b++)
+  {
+    // Extract location data
+    int level = levels(b);
+    int location[3] = {locations(b,2), locations(b,1), locations(b,0)};
+
+    // Check for grid existing beyond each face
+    bool off_grid[3][2];
+    for (int d = 0; d < 3; d++)
+      for (int s = 0; s < 2; s++)
+      {
+        int offsets[3] = {0, 0, 0};
+        offsets[d] = s == 0 ? -1 : 1;
+        off_grid[d][s] = FindNeighborBlock(level, location, offsets, 0, 0) < 0
+            and FindNeighborBlock(level, location, offsets, -1, 0) < 0
+            and FindNeighborBlock(level, location, offsets, 1, 0) < 0;
+      }
+
+    // Go through directions
+    for (int dir = 0; dir < 27; dir++)
+    {
+      // Account for grid not existing
+      int offsets[3] = {dir / 9 - 1, dir / 3 % 3 - 1, dir % 3 - 1};
+      for (int d = 0; d < 3; d++)
+        if (offsets[d] != 0 and off_grid[d][offsets[d] < 0 ? 0 : 1])
+          offsets[d] = 0;
+      int dir_used = 9 * (offsets[0] + 1) + 3 * (offsets[1] + 1) + (offsets[2] + 1);
+      block_neighbor_dirs(b,dir) = dir_used;
+      if (dir_used != dir)
+        continue;
+      for (int child = 0; child < 4; child++)
+        block_neighbors(b,dir,child) = -1;
+
+      // Find block itself
+      if (dir == 13)
+      {
+        block_neighbor_levels(b,dir) = 0;
+        block_neighbors(b,dir,0) = b;
+        continue;
+      }
+
+      // Find neighbor at same level
+      int b_same = FindNeighborBlock(level, location, offsets, 0, 0);
+      if (b_same >= 0)
+      {
+        block_neighbor_levels(b,dir) = 0;
+        block_neighbors(b,dir,0) = b_same;
+        continue;
+      }
+
+      // Find neighbor at coarser level
+      int b_coarser = FindNeighborBlock(level, location, offsets, -1, 0);
+      if (b_coarser >= 0)
+      {
+        block_neighbor_levels(b,dir) = -1;
+        block_neighbors(b,dir,0) = b_coarser;
+        continue;
+      }
+
+      // Find neighbors at finer level
+      int num_children = 1;
+      for (int d = 0; d < 3; d++)
+        if (offsets[d] == 0)
+          num_children *= 2;
+      block_neighbor_levels(b,dir) = 1;
+      for (int child = 0; child < num_children; child++)
+      {
+        block_neighbors(b,dir,child) = FindNeighborBlock(level, location, offsets, 1, child);
+        if (block_neighbors(b,dir,child) < 0)
+          throw BlacklightException("Grid interpolation failed.");
+      }
+    }
+  }
+
+  // Allocate ghost cells
+  int num_times = slow_light_on ? slow_chunk_size : 1;
+  halo_num_cells = 2 * ((n_j + 2) * (n_i + 2) + n_k * (n_i + 2) + n_k * n_j);
+  grid_halo.Allocate(num_times, n_b, halo_num_cells, grid_num_vars);
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for finding block adjacent to a given block
+// Inputs:
+//   level: refinement level of given block
+//   location: x^3, x^2, and x^1 logical locations of given block
+//   offsets: x^3, x^2, and x^1 directions (-1, 0, or 1) in which to look
+//   level_offset: refinement level of sought block relative to given block (-1, 0, or 1)
+//   child: if level_offset == 1, which finer block to find, with bits (least significant for
+//       x^1) selecting lower (0) or upper (1) halves of given block in dimensions with 0 offset
+// Outputs:
+//   returned value: index of block, or -1 if no such block exists
+// Notes:
+//   Assumes BuildBlockIndex() has been called.
+//   In the case of simulation_coord being Coordinates::sks, wraps around the periodic boundary in
+//       x^3.
+int RadiationIntegrator::FindNeighborBlock(int level, const int location[3], const int offsets[3],
+    int level_offset, int child)
+{
+  // Calculate logical location at same level
+  int location_sought[3];
+  for (int d = 0; d < 3; d++)
+    location_sought[d] = location[d] + offsets[d];
+  bool periodic = simulation_format == SimulationFormat::athena
+      and simulation_coord == Coordinates::sks;
+  if (periodic and location_sought[0] == -1)
+    location_sought[0] = n_3_level(level) - 1;
+  if (periodic and location_sought[0] == n_3_level(level))
+    location_sought[0] = 0;
+
+  // Calculate logical location at coarser level
+  int level_sought = level + level_offset;
+  if (level_offset < 0)
+    for (int d = 0; d < 3; d++)
+      location_sought[d] = location_sought[d] < 0 ? -1 : location_sought[d] / 2;
+
+  // Calculate logical location at finer level
+  if (level_offset > 0)
+  {
+    for (int d = 2; d >= 0; d--)
+    {
+      if (offsets[d] == 0)
+      {
+        location_sought[d] = location[d] * 2 + child % 2;
+        child /= 2;
+      }
+      else
+        location_sought[d] = offsets[d] < 0 ? location[d] * 2 - 1 : location[d] * 2 + 2;
+    }
+    if (periodic and level_sought <= max_level and location_sought[0] == -1)
+      location_sought[0] = n_3_level(level_sought) - 1;
+    if (periodic and level_sought <= max_level and location_sought[0] == n_3_level(level_sought))
+      location_sought[0] = 0;
+  }
+
+  // Find block
+  return FindBlock(level_sought, location_sought[2], location_sought[1], location_sought[0]);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for filling ghost cells around each block from neighboring blocks
+// Inputs: (none)
+// Outputs: (none)
+// Notes:
+//   Assumes BuildNeighborTable() has been called.
+//   Must be called whenever cell data changes, i.e. once per snapshot.
+//   If neighbor is at the same refinement level, the corresponding cell there is copied.
+//   If neighbor is coarser, the coarse cell containing the ghost cell is copied.
+//   If neighbor is finer, the 8 fine cells making up the ghost cell are averaged.
+//   Along dimensions with no grid beyond the face of the block, the nearest cell on the grid is
+//       used instead, effectively resulting in constant (rather than linear) extrapolation near
+//       the edges of the grid.
+//   If simulation_check_halos == true, verifies the result with CheckHalos().
+void RadiationIntegrator::FillHalos()
+{
+  // Extract grid data
+  int n_b = x1f.n2;
+  int n_i = x1v.n1;
+  int n_j = x2v.n1;
+  int n_k = x3v.n1;
+  int num_times = grid_halo.n4;
+  int n[3] = {n_k, n_j, n_i};
+
+  // Go through blocks in parallel
+  #pragma omp parallel for schedule(dynamic)
+  for (int b = 0; b < n_b; b++)
+  {
+    int location[3] = {locations(b,2), locations(b,1), locations(b,0)};
+    for (int k = -1; k <= n_k; k++)
+      for (int j = -1; j <= n_j; j++)
+        for (int i = -1; i <= n_i; i++)
+        {
+          // Find direction of neighbor
+          int inds[3] = {k, j, i};
+          int offsets[3];
+          for (int d = 0; d < 3; d++)
+            offsets[d] = inds[d] < 0 ? -1 : inds[d] >= n[d] ? 1 : 0;
+          int dir = 9 * (offsets[0] + 1) + 3 * (offsets[1] + 1) + (offsets[2] + 1);
+          if (dir == 13)
+            continue;
+          int slot = GhostIndex(k, j, i);
+
+          // Account for grid not existing
+          int dir_used = block_neighbor_dirs(b,dir);
+          offsets[0] = dir_used / 9 - 1;
+          offsets[1] = dir_used / 3 % 3 - 1;
+          offsets[2] = dir_used % 3 - 1;
+          for (int d = 0; d < 3; d++)
+            if (offsets[d] == 0)
+              inds[d] = std::max(std::min(inds[d], n[d] - 1), 0);
+          int level_offset = block_neighbor_levels(b,dir_used);
+
+          // Copy cell at same or coarser level
+          if (level_offset <= 0)
+          {
+            int b_sought = block_neighbors(b,dir_used,0);
+            int inds_sought[3];
+            for (int d = 0; d < 3; d++)
+            {
+              if (level_offset < 0)
+                inds_sought[d] = (location[d] % 2 * n[d] + inds[d] + 2 * n[d]) / 2 % n[d];
+              else if (offsets[d] != 0)
+                inds_sought[d] = offsets[d] < 0 ? n[d] - 1 : 0;
+              else
+                inds_sought[d] = inds[d];
+            }
+            for (int t = 0; t < num_times; t++)
+            {
+              double vals[9];
+              GridValues(t, b_sought, inds_sought[0], inds_sought[1], inds_sought[2], vals);
+              for (int q = 0; q < grid_num_vars; q++)
+                grid_halo(t,b,slot,q) = static_cast<float>(vals[q]);
+            }
+          }
+
+          // Average cells at finer level
+          else
+          {
+            int child = 0;
+            int inds_sought[3];
+            for (int d = 0; d < 3; d++)
+            {
+              if (offsets[d] != 0)
+                inds_sought[d] = offsets[d] < 0 ? n[d] - 2 : 0;
+              else
+              {
+                bool upper = inds[d] >= n[d] / 2;
+                child = child * 2 + (upper ? 1 : 0);
+                inds_sought[d] = (inds[d] - (upper ? n[d] / 2 : 0)) * 2;
+              }
+            }
+            int b_sought = block_neighbors(b,dir_used,child);
+            for (int t = 0; t < num_times; t++)
+            {
+              double vals_sum[9] = {};
+              for (int p = 0; p < 8; p++)
+              {
+                double vals[9];
+                GridValues(t, b_sought, inds_sought[0] + p / 4, inds_sought[1] + p / 2 % 2,
+                    inds_sought[2] + p % 2, vals);
+                for (int q = 0; q < grid_num_vars; q++)
+                  vals_sum[q] += vals[q];
+              }
+              for (int q = 0; q < grid_num_vars; q++)
+                grid_halo(t,b,slot,q) = static_cast<float>(vals_sum[q] / 8.0);
+            }
+          }
+        }
+  }
+
+  // Check ghost cells
+  if (simulation_check_halos and CheckHalos() > 0)
+    throw BlacklightException("Ghost cells do not match cells containing them.");
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for checking ghost cells against the cells containing them
+// Inputs: (none)
+// Outputs:
+//   returned value: number of ghost cells differing from the cell containing them
+// Notes:
+//   Assumes FillHalos() has been called.
+//   Only checks ghost cells lying within a single block at the same or a coarser refinement level,
+//       whose values must be copied exactly; ghost cells covered by finer blocks or lying beyond
+//       the edges of the grid are skipped.
+//   Locates the containing cell directly from global logical indices rather than from the
+//       neighbor table.
+int RadiationIntegrator::CheckHalos()
+{
+  // Extract grid data
+  int n_b = x1f.n2;
+  int n_i = x1v.n1;
+  int n_j = x2v.n1;
+  int n_k = x3v.n1;
+  int num_times = grid_halo.n4;
+  int n[3] = {n_k, n_j, n_i};
+  bool periodic = simulation_format == SimulationFormat::athena
+      and simulation_coord == Coordinates::sks;
+
+  // Go through blocks in parallel
+  int num_bad = 0;
+  #pragma omp parallel for schedule(dynamic) reduction(+: num_bad)
+  for (int b = 0; b < n_b; b++)
+  {
+    int level = levels(b);
+    int location[3] = {locations(b,2), locations(b,1), locations(b,0)};
+    for (int k = -1; k <= n_k; k++)
+      for (int j = -1; j <= n_j; j++)
+        for (int i = -1; i <= n_i; i++)
+        {
+          // Skip interior cells
+          int inds[3] = {k, j, i};
+          if (k >= 0 and k < n_k and j >= 0 and j < n_j and i >= 0 and i < n_i)
+            continue;
+
+          // Calculate global indices at level of block
+          int inds_global[3];
+          for (int d = 0; d < 3; d++)
+            inds_global[d] = location[d] * n[d] + inds[d];
+          if (periodic)
+          {
+            int n_3 = n_3_level(level) * n_k;
+            inds_global[0] = (inds_global[0] + n_3) % n_3;
+          }
+          if (inds_global[0] < 0 or inds_global[1] < 0 or inds_global[2] < 0)
+            continue;
+
+          // Find block containing ghost cell at same or coarser level
+          int b_sought = -1;
+          for (int level_sought = level; level_sought >= 0 and b_sought < 0; level_sought--)
+          {
+            if (level_sought < level)
+              for (int d = 0; d < 3; d++)
+                inds_global[d] /= 2;
+            b_sought = FindBlock(level_sought, inds_global[2] / n_i, inds_global[1] / n_j,
+                inds_global[0] / n_k);
+          }
+          if (b_sought < 0)
+            continue;
+
+          // Compare values
+          int slot = GhostIndex(k, j, i);
+          bool bad = false;
+          for (int t = 0; t < num_times; t++)
+          {
+            double vals[9];
+            GridValues(t, b_sought, inds_global[0] % n_k, inds_global[1] % n_j,
+                inds_global[2] % n_i, vals);
+            for (int q = 0; q < grid_num_vars; q++)
+              if (grid_halo(t,b,slot,q) != static_cast<float>(vals[q]))
+                bad = true;
+          }
+          if (bad)
+            num_bad++;
+        }
+  }
+  return num_bad;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for locating ghost cell in halo around block
+// Inputs:
+//   k, j, i: cell indices, at least one of which is -1 or 1 beyond valid range
+// Outputs:
+//   returned value: index of ghost cell
+// Notes:
+//   Ghost cells are ordered with full layers below and above the block in x^3 first, followed by
+//       rows below and above in x^2 that are not in those layers, followed by remaining columns
+//       below and above in x^1.
+int RadiationIntegrator::GhostIndex(int k, int j, int i)
+{
+  int n_i = x1v.n1;
+  int n_j = x2v.n1;
+  int n_k = x3v.n1;
+  if (k < 0 or k >= n_k)
+    return ((k < 0 ? 0 : 1) * (n_j + 2) + j + 1) * (n_i + 2) + i + 1;
+  int offset = 2 * (n_j + 2) * (n_i + 2);
+  if (j < 0 or j >= n_j)
+    return offset + ((j < 0 ? 0 : 1) * n_k + k) * (n_i + 2) + i + 1;
+  offset += 2 * n_k * (n_i + 2);
+  return offset + ((i < 0 ? 0 : 1) * n_k + k) * n_j + j;
+}
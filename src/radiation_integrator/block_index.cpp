@@ -0,0 +1,383 @@
+// Blacklight radiation integrator - index of simulation blocks and cells
+
+// C++ headers
+#include <algorithm>  // max, min
+#include <cmath>      // abs, isnan, log
+#include <limits>     // numeric_limits
+
+// Blacklight headers
+#include "radiation_integrator.hpp"
+#include "../utils/array.hpp"        // Array
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for building index of blocks by logical location
+// Inputs: (none)
+// Outputs: (none)
+// Notes:
+//   Assumes levels, locations, x1f, x2f, and x3f have been set.
+//   Builds tree of all blocks and their ancestors down to coarsest level present, stored in hash
+//       table keyed by level and logical location.
+//   Records extent of each tree node as union of extents of its blocks.
+//   Records faces of coarsest tree level along each dimension, allowing the containing node to be
+//       found by bisection before descending the tree.
+//   If coarsest level does not tile a rectangular region, leaves block_root_level negative so that
+//       LocateBlock() falls back to a linear search.
+void RadiationIntegrator::BuildBlockIndex()
+{
+  // Calculate tree depth
+  int n_b = x1f.n2;
+  int n_i = x1v.n1;
+  int n_j = x2v.n1;
+  int n_k = x3v.n1;
+  int level_min = levels(0);
+  int level_max = levels(0);
+  for (int b = 1; b < n_b; b++)
+  {
+    level_min = std::min(level_min, levels(b));
+    level_max = std::max(level_max, levels(b));
+  }
+
+  // Allocate hash table and nodes
+  int num_nodes_max = n_b * (level_max - level_min + 1);
+  int num_slots = 1;
+  while (num_slots < 2 * num_nodes_max)
+    num_slots *= 2;
+  block_hash_mask = num_slots - 1;
+  block_hash_keys.Allocate(num_slots, 4);
+  block_hash_vals.Allocate(num_slots);
+  for (int s = 0; s < num_slots; s++)
+    block_hash_keys(s,0) = -1;
+  block_node_blocks.Allocate(num_nodes_max);
+  block_node_bounds.Allocate(num_nodes_max, 6);
+
+  // Insert blocks and their ancestors
+  int num_nodes = 0;
+  for (int b = 0; b < n_b; b++)
+  {
+    double bounds[6] = {x1f(b,0), x1f(b,n_i), x2f(b,0), x2f(b,n_j), x3f(b,0), x3f(b,n_k)};
+    for (int level = levels(b); level >= level_min; level--)
+    {
+      int shift = levels(b) - level;
+      int location_i = locations(b,0) >> shift;
+      int location_j = locations(b,1) >> shift;
+      int location_k = locations(b,2) >> shift;
+      int slot = static_cast<int>(HashBlockLocation(level, location_i, location_j, location_k));
+      while (block_hash_keys(slot,0) >= 0 and not (block_hash_keys(slot,0) == level
+          and block_hash_keys(slot,1) == location_i and block_hash_keys(slot,2) == location_j
+          and block_hash_keys(slot,3) == location_k))
+        slot = (slot + 1) & block_hash_mask;
+      if (block_hash_keys(slot,0) < 0)
+      {
+        block_hash_keys(slot,0) = level;
+        block_hash_keys(slot,1) = location_i;
+        block_hash_keys(slot,2) = location_j;
+        block_hash_keys(slot,3) = location_k;
+        block_hash_vals(slot) = num_nodes;
+        block_node_blocks(num_nodes) = shift == 0 ? b : -1;
+        for (int d = 0; d < 6; d++)
+          block_node_bounds(num_nodes,d) = bounds[d];
+        num_nodes++;
+      }
+      else
+      {
+        int node = block_hash_vals(slot);
+        for (int d = 0; d < 3; d++)
+        {
+          block_node_bounds(node,2*d) = std::min(block_node_bounds(node,2*d), bounds[2*d]);
+          block_node_bounds(node,2*d+1) = std::max(block_node_bounds(node,2*d+1), bounds[2*d+1]);
+        }
+      }
+    }
+  }
+
+  // Find extent of coarsest level
+  block_root_level = level_min;
+  int location_min[3] = {std::numeric_limits<int>::max(), std::numeric_limits<int>::max(),
+      std::numeric_limits<int>::max()};
+  int location_max[3] = {0, 0, 0};
+  for (int s = 0; s < num_slots; s++)
+    if (block_hash_keys(s,0) == level_min)
+      for (int d = 0; d < 3; d++)
+      {
+        location_min[d] = std::min(location_min[d], block_hash_keys(s,d+1));
+        location_max[d] = std::max(location_max[d], block_hash_keys(s,d+1));
+      }
+  int num_root_max = 0;
+  for (int d = 0; d < 3; d++)
+  {
+    block_root_offset[d] = location_min[d];
+    block_root_num[d] = location_max[d] - location_min[d] + 1;
+    num_root_max = std::max(num_root_max, block_root_num[d]);
+  }
+
+  // Record faces of coarsest level
+  block_root_faces.Allocate(3, num_root_max + 1);
+  block_root_faces.SetNaN();
+  int num_root_nodes = 0;
+  for (int s = 0; s < num_slots; s++)
+    if (block_hash_keys(s,0) == level_min)
+    {
+      int node = block_hash_vals(s);
+      for (int d = 0; d < 3; d++)
+      {
+        int l = block_hash_keys(s,d+1) - block_root_offset[d];
+        block_root_faces(d,l) = block_node_bounds(node,2*d);
+        block_root_faces(d,l+1) = block_node_bounds(node,2*d+1);
+      }
+      num_root_nodes++;
+    }
+
+  // Check coarsest level tiles region
+  if (num_root_nodes != block_root_num[0] * block_root_num[1] * block_root_num[2])
+    block_root_level = -1;
+  for (int d = 0; d < 3; d++)
+    for (int l = 0; l <= block_root_num[d]; l++)
+      if (std::isnan(block_root_faces(d,l)))
+        block_root_level = -1;
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for hashing logical location of block
+// Inputs:
+//   level: refinement level
+//   location_i, location_j, location_k: logical location at given level
+// Outputs:
+//   returned value: initial slot in hash table
+unsigned int RadiationIntegrator::HashBlockLocation(int level, int location_i, int location_j,
+    int location_k)
+{
+  unsigned int hash = static_cast<unsigned int>(level) * 0x9e3779b1u;
+  hash = (hash ^ static_cast<unsigned int>(location_i)) * 0x85ebca6bu;
+  hash = (hash ^ static_cast<unsigned int>(location_j)) * 0xc2b2ae35u;
+  hash = (hash ^ static_cast<unsigned int>(location_k)) * 0x27d4eb2fu;
+  hash ^= hash >> 15;
+  return hash & static_cast<unsigned int>(block_hash_mask);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for finding tree node with given logical location
+// Inputs:
+//   level: refinement level
+//   location_i, location_j, location_k: logical location at given level
+// Outputs:
+//   returned value: index of node, or -1 if no such node exists
+// Notes:
+//   Assumes BuildBlockIndex() has been called.
+int RadiationIntegrator::FindBlockNode(int level, int location_i, int location_j, int location_k)
+{
+  if (level < 0)
+    return -1;
+  int slot = static_cast<int>(HashBlockLocation(level, location_i, location_j, location_k));
+  while (block_hash_keys(slot,0) >= 0)
+  {
+    if (block_hash_keys(slot,0) == level and block_hash_keys(slot,1) == location_i
+        and block_hash_keys(slot,2) == location_j and block_hash_keys(slot,3) == location_k)
+      return block_hash_vals(slot);
+    slot = (slot + 1) & block_hash_mask;
+  }
+  return -1;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for finding block with given logical location
+// Inputs:
+//   level: refinement level
+//   location_i, location_j, location_k: logical location at given level
+// Outputs:
+//   returned value: index of block, or -1 if no such block exists
+// Notes:
+//   Assumes BuildBlockIndex() has been called.
+//   Returns -1 for locations that are refined into smaller blocks.
+int RadiationIntegrator::FindBlock(int level, int location_i, int location_j, int location_k)
+{
+  int node = FindBlockNode(level, location_i, location_j, location_k);
+  return node < 0 ? -1 : block_node_blocks(node);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for finding block containing given point
+// Inputs:
+//   x1, x2, x3: coordinates of point
+// Outputs:
+//   returned value: index of block, or -1 if point is not on grid
+// Notes:
+//   Assumes BuildBlockIndex() has been called.
+//   Bisects faces of coarsest level and then descends tree, taking O(log(n_b)) time.
+//   Block boundaries are inclusive, matching a linear search through all blocks up to the choice
+//       made for points lying exactly on shared faces.
+int RadiationIntegrator::LocateBlock(double x1, double x2, double x3)
+{
+  // Search linearly if index unavailable
+  double x[3] = {x1, x2, x3};
+  if (block_root_level < 0)
+  {
+    int n_b = x1f.n2;
+    int n_i = x1v.n1;
+    int n_j = x2v.n1;
+    int n_k = x3v.n1;
+    for (int b = 0; b < n_b; b++)
+      if (x1 >= x1f(b,0) and x1 <= x1f(b,n_i) and x2 >= x2f(b,0) and x2 <= x2f(b,n_j)
+          and x3 >= x3f(b,0) and x3 <= x3f(b,n_k))
+        return b;
+    return -1;
+  }
+
+  // Locate node at coarsest level
+  int location[3];
+  for (int d = 0; d < 3; d++)
+  {
+    int num_root = block_root_num[d];
+    if (x[d] < block_root_faces(d,0) or x[d] > block_root_faces(d,num_root))
+      return -1;
+    int l_lower = 0;
+    int l_upper = num_root;
+    while (l_upper - l_lower > 1)
+    {
+      int l_mid = (l_lower + l_upper) / 2;
+      if (block_root_faces(d,l_mid) <= x[d])
+        l_lower = l_mid;
+      else
+        l_upper = l_mid;
+    }
+    location[d] = l_lower + block_root_offset[d];
+  }
+
+  // Descend tree
+  int level = block_root_level;
+  int node = FindBlockNode(level, location[0], location[1], location[2]);
+  while (node >= 0 and block_node_blocks(node) < 0)
+  {
+    level++;
+    for (int d = 0; d < 3; d++)
+      location[d] *= 2;
+    int child = FindBlockNode(level, location[0], location[1], location[2]);
+    if (child < 0)
+      return -1;
+    for (int d = 0; d < 3; d++)
+      if (x[d] > block_node_bounds(child,2*d+1))
+        location[d]++;
+    node = FindBlockNode(level, location[0], location[1], location[2]);
+  }
+  return node < 0 ? -1 : block_node_blocks(node);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for detecting spacing of cells within blocks
+// Inputs: (none)
+// Outputs: (none)
+// Notes:
+//   Assumes x1f, x2f, and x3f have been set.
+//   Checks each dimension of each block for uniform spacing, followed by geometric spacing, recording
+//       coefficients such that the index of the cell containing x is approximately
+//       (x - c_0) * c_1 or (log(x) - c_0) * c_1 respectively.
+//   Dimensions matching neither spacing are marked as irregular.
+//   Tolerance only affects speed of FindCell(), not its result.
+void RadiationIntegrator::BuildCellIndex()
+{
+  // Allocate arrays
+  int n_b = x1f.n2;
+  cell_index_regular.Allocate(n_b, 3);
+  cell_index_log.Allocate(n_b, 3);
+  cell_index_coeffs.Allocate(n_b, 3, 2);
+
+  // Go through blocks and dimensions
+  for (int b = 0; b < n_b; b++)
+    for (int d = 0; d < 3; d++)
+    {
+      const Array<double> &xf = d == 0 ? x1f : d == 1 ? x2f : x3f;
+      int n = xf.n1 - 1;
+
+      // Check for uniform spacing
+      double x_0 = xf(b,0);
+      double dx = (xf(b,n) - x_0) / n;
+      bool uniform = dx > 0.0;
+      for (int i = 1; i < n and uniform; i++)
+        uniform = std::abs(xf(b,i) - (x_0 + i * dx)) <= cell_index_tol * dx;
+      if (uniform)
+      {
+        cell_index_regular(b,d) = true;
+        cell_index_log(b,d) = false;
+        cell_index_coeffs(b,d,0) = x_0;
+        cell_index_coeffs(b,d,1) = 1.0 / dx;
+        continue;
+      }
+
+      // Check for geometric spacing
+      bool geometric = x_0 > 0.0 and xf(b,n) > x_0;
+      double log_x_0 = 0.0;
+      double dlog_x = 0.0;
+      if (geometric)
+      {
+        log_x_0 = std::log(x_0);
+        dlog_x = (std::log(xf(b,n)) - log_x_0) / n;
+      }
+      for (int i = 1; i < n and geometric; i++)
+        geometric = xf(b,i) > 0.0
+            and std::abs(std::log(xf(b,i)) - (log_x_0 + i * dlog_x)) <= cell_index_tol * dlog_x;
+      cell_index_regular(b,d) = geometric;
+      cell_index_log(b,d) = geometric;
+      cell_index_coeffs(b,d,0) = log_x_0;
+      cell_index_coeffs(b,d,1) = geometric ? 1.0 / dlog_x : 0.0;
+    }
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for finding cell containing given coordinate within block
+// Inputs:
+//   b: block index
+//   d: dimension (0 for x^1, 1 for x^2, 2 for x^3)
+//   x: coordinate value, assumed to lie within block
+// Outputs:
+//   returned value: smallest cell index i such that x does not exceed x^d face i + 1
+// Notes:
+//   Assumes BuildCellIndex() has been called.
+//   For regular spacing, computes index in closed form and then corrects for roundoff by comparing
+//       with faces, so that result matches a linear search through faces.
+//   For irregular spacing, bisects faces.
+int RadiationIntegrator::FindCell(int b, int d, double x)
+{
+  // Prepare faces
+  const Array<double> &xf = d == 0 ? x1f : d == 1 ? x2f : x3f;
+  int n = xf.n1 - 1;
+
+  // Bisect irregular spacing
+  if (not cell_index_regular(b,d))
+  {
+    int i_lower = 0;
+    int i_upper = n - 1;
+    while (i_upper > i_lower)
+    {
+      int i_mid = (i_lower + i_upper) / 2;
+      if (x <= xf(b,i_mid+1))
+        i_upper = i_mid;
+      else
+        i_lower = i_mid + 1;
+    }
+    return i_lower;
+  }
+
+  // Calculate index for regular spacing
+  double x_val = cell_index_log(b,d) ? std::log(x) : x;
+  double i_val = (x_val - cell_index_coeffs(b,d,0)) * cell_index_coeffs(b,d,1);
+  int i = 0;
+  if (i_val >= n - 1)
+    i = n - 1;
+  else if (i_val > 0.0)
+    i = static_cast<int>(i_val);
+
+  // Correct for roundoff
+  while (i > 0 and x <= xf(b,i))
+    i--;
+  while (i < n - 1 and x > xf(b,i+1))
+    i++;
+  return i;
+}
@@ -0,0 +1,246 @@
+// Blacklight radiation integrator - tabulated radiative transfer coefficients
+
+// C++ headers
+#include <algorithm>  // max, min
+#include <cmath>      // abs, cos, cyl_bessel_k, exp, log, pow, sqrt, tanh
+#include <sstream>    // ostringstream
+
+// Blacklight headers
+#include "radiation_integrator.hpp"
+#include "../utils/array.hpp"        // Array
+#include "../utils/exceptions.hpp"   // BlacklightWarning
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for tabulating thermal synchrotron rotativity factors
+// Inputs: (none)
+// Outputs: (none)
+// Notes:
+//   Tabulates the electron-temperature-dependent Bessel function ratios on a grid uniform in
+//       log(theta_e) over [theta_e_zero, table_theta_e_max], and the frequency-dependent fits on a
+//       grid uniform in log(X) over [table_xx_min, table_xx_max], where X = nu / nu_s.
+//   Doubles the number of points in each table until linear interpolation matches direct
+//       evaluation to within table_tolerance at the midpoints and quarter points of all
+//       intervals, warning if table_num_max points are not enough.
+//   References 2021 ApJ 921 17 (M) for transfer coefficients.
+void RadiationIntegrator::BuildCoefficientTables()
+{
+  // Tabulate temperature dependence
+  double error_theta_e = 0.0;
+  for (table_theta_e_num = table_num_min; table_theta_e_num <= table_num_max;
+      table_theta_e_num *= 2)
+  {
+    error_theta_e = TabulateThetaE(table_theta_e_num);
+    if (error_theta_e <= table_tolerance)
+      break;
+  }
+  if (error_theta_e > table_tolerance)
+  {
+    std::ostringstream message;
+    message << "Thermal rotativity table in theta_e only accurate to " << error_theta_e << ".";
+    BlacklightWarning(message.str().c_str());
+  }
+
+  // Tabulate frequency dependence
+  double error_xx = 0.0;
+  for (table_xx_num = table_num_min; table_xx_num <= table_num_max; table_xx_num *= 2)
+  {
+    error_xx = TabulateXX(table_xx_num);
+    if (error_xx <= table_tolerance)
+      break;
+  }
+  if (error_xx > table_tolerance)
+  {
+    std::ostringstream message;
+    message << "Thermal rotativity table in X only accurate to " << error_xx << ".";
+    BlacklightWarning(message.str().c_str());
+  }
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for tabulating temperature-dependent thermal rotativity factors
+// Inputs:
+//   num: number of points in table
+// Outputs:
+//   returned value: maximum relative error of interpolated values
+// Notes:
+//   Stores K_1/K_2 + 6 theta_e, K_0/K_2, and log(1/K_2) in table_theta_e_vals, where K_n are
+//       modified Bessel functions of the second kind evaluated at 1/theta_e.
+//   The last of these is stored as a logarithm, since it varies by many orders of magnitude.
+double RadiationIntegrator::TabulateThetaE(int num)
+{
+  // Prepare grid
+  table_theta_e_num = num;
+  table_theta_e_log_min = std::log(theta_e_zero);
+  double dlog = (std::log(table_theta_e_max) - table_theta_e_log_min) / (num - 1);
+  table_theta_e_inv_dlog = 1.0 / dlog;
+  table_theta_e_vals.Deallocate();
+  table_theta_e_vals.Allocate(num, 3);
+
+  // Evaluate factors at grid points
+  #pragma omp parallel for schedule(static)
+  for (int i = 0; i < num; i++)
+  {
+    double theta_e = std::exp(table_theta_e_log_min + i * dlog);
+    double kk_0 = std::cyl_bessel_k(0.0, 1.0 / theta_e);
+    double kk_1 = std::cyl_bessel_k(1.0, 1.0 / theta_e);
+    double kk_2 = std::cyl_bessel_k(2.0, 1.0 / theta_e);
+    table_theta_e_vals(i,0) = kk_1 / kk_2 + 6.0 * theta_e;
+    table_theta_e_vals(i,1) = kk_0 / kk_2;
+    table_theta_e_vals(i,2) = -std::log(kk_2);
+  }
+
+  // Compare interpolated values to direct evaluation between grid points
+  double error = 0.0;
+  #pragma omp parallel for schedule(static) reduction(max: error)
+  for (int i = 0; i < num - 1; i++)
+    for (int p = 1; p < 4; p++)
+    {
+      double frac = p / 4.0;
+      double theta_e = std::exp(table_theta_e_log_min + (i + frac) * dlog);
+      double kk_0 = std::cyl_bessel_k(0.0, 1.0 / theta_e);
+      double kk_1 = std::cyl_bessel_k(1.0, 1.0 / theta_e);
+      double kk_2 = std::cyl_bessel_k(2.0, 1.0 / theta_e);
+      double vals[3];
+      for (int q = 0; q < 3; q++)
+        vals[q] = (1.0 - frac) * table_theta_e_vals(i,q) + frac * table_theta_e_vals(i+1,q);
+      double g = kk_1 / kk_2 + 6.0 * theta_e;
+      double h = kk_0 / kk_2;
+      error = std::max(error, std::abs(vals[0] - g) / g);
+      error = std::max(error, std::abs(vals[1] - h) / h);
+      error = std::max(error, std::abs(std::exp(vals[2] + std::log(kk_2)) - 1.0));
+    }
+  return error;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for tabulating frequency-dependent thermal rotativity factors
+// Inputs:
+//   num: number of points in table
+// Outputs:
+//   returned value: maximum relative error of interpolated values
+// Notes:
+//   Stores f_m and Delta J_5 in table_xx_vals.
+//   Errors in f_m are measured relative to the sum of the magnitudes of its terms, since f_m
+//       changes sign.
+double RadiationIntegrator::TabulateXX(int num)
+{
+  // Prepare grid
+  table_xx_num = num;
+  table_xx_log_min = std::log(table_xx_min);
+  double dlog = (std::log(table_xx_max) - table_xx_log_min) / (num - 1);
+  table_xx_inv_dlog = 1.0 / dlog;
+  table_xx_vals.Deallocate();
+  table_xx_vals.Allocate(num, 2);
+
+  // Evaluate factors at grid points
+  #pragma omp parallel for schedule(static)
+  for (int i = 0; i < num; i++)
+  {
+    double xx = std::exp(table_xx_log_min + i * dlog);
+    double f_m_scale;
+    ThermalRotativityFits(xx, &table_xx_vals(i,0), &f_m_scale, &table_xx_vals(i,1));
+  }
+
+  // Compare interpolated values to direct evaluation between grid points
+  double error = 0.0;
+  #pragma omp parallel for schedule(static) reduction(max: error)
+  for (int i = 0; i < num - 1; i++)
+    for (int p = 1; p < 4; p++)
+    {
+      double frac = p / 4.0;
+      double xx = std::exp(table_xx_log_min + (i + frac) * dlog);
+      double f_m, f_m_scale, delta_jj_5;
+      ThermalRotativityFits(xx, &f_m, &f_m_scale, &delta_jj_5);
+      double vals[2];
+      for (int q = 0; q < 2; q++)
+        vals[q] = (1.0 - frac) * table_xx_vals(i,q) + frac * table_xx_vals(i+1,q);
+      error = std::max(error, std::abs(vals[0] - f_m) / f_m_scale);
+      error = std::max(error, std::abs(vals[1] - delta_jj_5) / delta_jj_5);
+    }
+  return error;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for evaluating fitting formulas for thermal synchrotron rotativities
+// Inputs:
+//   xx: ratio X = nu / nu_s of frequency to synchrotron frequency
+// Outputs:
+//   *p_f_m: fitting function f_m (M 36)
+//   *p_f_m_scale: sum of magnitudes of terms in f_m
+//   *p_delta_jj_5: correction Delta J_5 (M 37)
+// Notes:
+//   References 2021 ApJ 921 17 (M) for transfer coefficients.
+void RadiationIntegrator::ThermalRotativityFits(double xx, double *p_f_m, double *p_f_m_scale,
+    double *p_delta_jj_5) const
+{
+  double xx_neg_1_2 = 1.0 / std::sqrt(xx);
+  double var_a = 2.011 * std::exp(-19.78 * std::pow(xx, -0.5175));
+  double var_b = std::cos(39.89 * xx_neg_1_2) * std::exp(-70.16 * std::pow(xx, -0.6));
+  double var_c = 0.011 * std::exp(-1.69 * xx_neg_1_2);
+  double var_d = 0.003135 * std::pow(xx, 4.0 / 3.0);
+  double var_e = 0.5 * (1.0 + std::tanh(10.0 * std::log(0.6648 * xx_neg_1_2)));
+  double f_0 = var_a - var_b - var_c;
+  *p_f_m = f_0 + (var_c - var_d) * var_e;
+  *p_f_m_scale = var_a + std::abs(var_b) + var_c + (var_c + var_d) * var_e;
+  *p_delta_jj_5 = 0.4379 * std::log(1.0 + 1.3414 * std::pow(xx, -0.7515));
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for interpolating temperature-dependent thermal rotativity factors from tables
+// Inputs:
+//   theta_e: dimensionless electron temperature
+// Outputs:
+//   returned value: flag indicating theta_e lies within tabulated range
+//   *p_g: K_1/K_2 + 6 theta_e
+//   *p_h: K_0/K_2
+//   *p_kk_2_inv: 1/K_2
+// Notes:
+//   Assumes BuildCoefficientTables() has been called.
+//   Outputs are unchanged if the returned value is false, in which case the factors should be
+//       evaluated directly.
+bool RadiationIntegrator::TabulatedThetaEFactors(double theta_e, double *p_g, double *p_h,
+    double *p_kk_2_inv) const
+{
+  double u = (std::log(theta_e) - table_theta_e_log_min) * table_theta_e_inv_dlog;
+  if (not (u >= 0.0 and u <= table_theta_e_num - 1))
+    return false;
+  int i = std::min(static_cast<int>(u), table_theta_e_num - 2);
+  double f = u - i;
+  *p_g = (1.0 - f) * table_theta_e_vals(i,0) + f * table_theta_e_vals(i+1,0);
+  *p_h = (1.0 - f) * table_theta_e_vals(i,1) + f * table_theta_e_vals(i+1,1);
+  *p_kk_2_inv = std::exp((1.0 - f) * table_theta_e_vals(i,2) + f * table_theta_e_vals(i+1,2));
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for interpolating frequency-dependent thermal rotativity factors from tables
+// Inputs:
+//   xx: ratio X = nu / nu_s of frequency to synchrotron frequency
+// Outputs:
+//   returned value: flag indicating xx lies within tabulated range
+//   *p_f_m: fitting function f_m (M 36)
+//   *p_delta_jj_5: correction Delta J_5 (M 37)
+// Notes:
+//   Assumes BuildCoefficientTables() has been called.
+//   Outputs are unchanged if the returned value is false, in which case the factors should be
+//       evaluated with ThermalRotativityFits().
+bool RadiationIntegrator::TabulatedXXFactors(double xx, double *p_f_m, double *p_delta_jj_5)
+    const
+{
+  double u = (std::log(xx) - table_xx_log_min) * table_xx_inv_dlog;
+  if (not (u >= 0.0 and u <= table_xx_num - 1))
+    return false;
+  int i = std::min(static_cast<int>(u), table_xx_num - 2);
+  double f = u - i;
+  *p_f_m = (1.0 - f) * table_xx_vals(i,0) + f * table_xx_vals(i+1,0);
+  *p_delta_jj_5 = (1.0 - f) * table_xx_vals(i,1) + f * table_xx_vals(i+1,1);
+  return true;
+}
@@ -30,10 +30,10 @@ void RadiationIntegrator::CalculateFormulaCoefficients()
     num_pix = block_counts[adaptive_level] * block_num_pix;
   if (first_time or adaptive_level > 0)
   {
-    j_i[adaptive_level].Allocate(image_num_frequencies, num_pix,
-        geodesic_num_steps[adaptive_level]);
-    alpha_i[adaptive_level].Allocate(image_num_frequencies, num_pix,
-        geodesic_num_steps[adaptive_level]);
+    j_i[adaptive_level].Allocate(num_pix, geodesic_num_steps[adaptive_level],
+        image_num_frequencies);
+    alpha_i[adaptive_level].Allocate(num_pix, geodesic_num_steps[adaptive_level],
+        image_num_frequencies);
   }
   j_i[adaptive_level].Zero();
   alpha_i[adaptive_level].Zero();
@@ -51,10 +51,11 @@ void RadiationIntegrator::CalculateFormulaCoefficients()
     if (fallback_nan and sample_flags[adaptive_level](m))
     {
       for (int n = 0; n < num_steps; n++)
-      {
-        j_i[adaptive_level](m,n) = std::numeric_limits<double>::quiet_NaN();
-        alpha_i[adaptive_level](m,n) = std::numeric_limits<double>::quiet_NaN();
-      }
+        for (int l = 0; l < image_num_frequencies; l++)
+        {
+          j_i[adaptive_level](m,n,l) = std::numeric_limits<double>::quiet_NaN();
+          alpha_i[adaptive_level](m,n,l) = std::numeric_limits<double>::quiet_NaN();
+        }
       continue;
     }
 
@@ -93,17 +94,11 @@ void RadiationIntegrator::CalculateFormulaCoefficients()
         double th = std::acos(z / r);
         if ((cut_midplane_theta > 0.0 and std::abs(th - Math::pi / 2.0) > cut_midplane_theta)
             or (cut_midplane_theta < 0.0 and std::abs(th - Math::pi / 2.0) < -cut_midplane_theta))
-        {
-          sample_cut[adaptive_level](m,n) = true;
           continue;
-        }
       }
       if ((cut_midplane_z > 0.0 and std::abs(z) > cut_midplane_z)
           or (cut_midplane_z < 0.0 and std::abs(z) < -cut_midplane_z))
-      {
-        sample_cut[adaptive_level](m,n) = true;
         continue;
-      }
 
       // Cut arbitrary plane
       if (cut_plane)
@@ -170,12 +165,12 @@ void RadiationIntegrator::CalculateFormulaCoefficients()
         // Calculate emission coefficient in CGS units (C 9-10)
         double j_nu_fluid_cgs =
             formula_cn0 * n_n0_fluid * std::pow(nu_fluid_cgs / formula_nup, -formula_alpha);
-        j_i[adaptive_level](l,m,n) = j_nu_fluid_cgs / (nu_fluid_cgs * nu_fluid_cgs);
+        j_i[adaptive_level](m,n,l) = j_nu_fluid_cgs / (nu_fluid_cgs * nu_fluid_cgs);
 
         // Calculate absorption coefficient in CGS units (C 11-12)
         double alpha_nu_fluid_cgs = formula_a * formula_cn0 * n_n0_fluid
             * std::pow(nu_fluid_cgs / formula_nup, -formula_beta - formula_alpha);
-        alpha_i[adaptive_level](l,m,n) = alpha_nu_fluid_cgs * nu_fluid_cgs;
+        alpha_i[adaptive_level](m,n,l) = alpha_nu_fluid_cgs * nu_fluid_cgs;
       }
     }
   }
@@ -28,13 +28,119 @@
 //       rho_v[adaptive_level], and momentum_factors[adaptive_level] have been set.
 //   Assumes cell_values[adaptive_level] has been set if image_lambda_ave == true or
 //       image_emission_ave == true or image_tau_int == true.
-//   Allocates and initializes image[adaptive_level].
+//   Assumes sample_dlen[adaptive_level] has been set if image_length == true.
+//   Allocates and initializes image[adaptive_level] and works on each ray with
+//       IntegratePolarizedRay(), or with IntegrateStokesRay() if image_stokes == true.
 //   Dealllocates sample_uu1[adaptive_level], sample_uu2[adaptive_level],
 //       sample_uu3[adaptive_level], sample_bb1[adaptive_level], sample_bb2[adaptive_level],
 //       sample_bb3[adaptive_level], j_i[adaptive_level], j_q[adaptive_level], j_v[adaptive_level],
 //       alpha_i[adaptive_level], alpha_q[adaptive_level], alpha_v[adaptive_level],
 //       rho_q[adaptive_level], and rho_v[adaptive_level] if adaptive_level > 0.
-//   Deallocates cell_values[adaptive_level] if render_num_images <= 0 and adaptive_level > 0.
+//   Deallocates sample_cut[adaptive_level] and cell_values[adaptive_level] if adaptive_level > 0,
+//       unless Render() still needs them.
+void RadiationIntegrator::IntegratePolarizedRadiation()
+{
+  // Allocate image array
+  int num_pix = camera_num_pix;
+  if (adaptive_level > 0)
+    num_pix = block_counts[adaptive_level] * block_num_pix;
+  if (first_time or adaptive_level > 0)
+    image[adaptive_level].Allocate(image_num_quantities, num_pix);
+  image[adaptive_level].Zero();
+
+  // Go through pixels in parallel
+  #pragma omp parallel for schedule(static)
+  for (int m = 0; m < num_pix; m++)
+  {
+    if (image_stokes)
+      IntegrateStokesRay(m, m);
+    else
+      IntegratePolarizedRay(m, m);
+  }
+
+  // Free memory
+  if (adaptive_level > 0)
+  {
+    sample_uu1[adaptive_level].Deallocate();
+    sample_uu2[adaptive_level].Deallocate();
+    sample_uu3[adaptive_level].Deallocate();
+    sample_bb1[adaptive_level].Deallocate();
+    sample_bb2[adaptive_level].Deallocate();
+    sample_bb3[adaptive_level].Deallocate();
+    j_i[adaptive_level].Deallocate();
+    j_q[adaptive_level].Deallocate();
+    j_v[adaptive_level].Deallocate();
+    alpha_i[adaptive_level].Deallocate();
+    alpha_q[adaptive_level].Deallocate();
+    alpha_v[adaptive_level].Deallocate();
+    rho_q[adaptive_level].Deallocate();
+    rho_v[adaptive_level].Deallocate();
+    if (render_num_images <= 0 or render_fused)
+    {
+      sample_cut[adaptive_level].Deallocate();
+      cell_values[adaptive_level].Deallocate();
+    }
+  }
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for integrating polarized radiative transfer equation along a single ray
+// Inputs:
+//   m: ray index
+//   row: row of per-sample arrays holding ray
+// Outputs: (none)
+// Notes:
+//   Works with IntegratePolarizedRayKernel(), specialized to image_flags if the combination of
+//       image quantities is a common one.
+void RadiationIntegrator::IntegratePolarizedRay(int m, int row)
+{
+  if (image_flags == ImageFlags::light)
+    IntegratePolarizedRayKernel<ImageFlags::light>(m, row);
+  else if (image_flags == (ImageFlags::light | ImageFlags::tau))
+    IntegratePolarizedRayKernel<ImageFlags::light | ImageFlags::tau>(m, row);
+  else if (image_flags == (ImageFlags::light | ImageFlags::lambda | ImageFlags::emission
+      | ImageFlags::tau))
+    IntegratePolarizedRayKernel<ImageFlags::light | ImageFlags::lambda | ImageFlags::emission
+        | ImageFlags::tau>(m, row);
+  else if (image_flags == (ImageFlags::light | ImageFlags::lambda_ave | ImageFlags::emission_ave
+      | ImageFlags::tau_int))
+    IntegratePolarizedRayKernel<ImageFlags::light | ImageFlags::lambda_ave
+        | ImageFlags::emission_ave | ImageFlags::tau_int>(m, row);
+  else
+    IntegratePolarizedRayKernel<ImageFlags::runtime>(m, row);
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for integrating polarized radiative transfer equation along a single ray, with image
+//     quantities fixed at compile time
+// Inputs:
+//   flags: bitwise combination of ImageFlags values for image quantities to produce, or
+//       ImageFlags::runtime to use the image_time, image_length, etc. flags
+//   m: ray index
+//   row: row of per-sample arrays holding ray
+// Outputs: (none)
+// Notes:
+//   Assumes camera_pos[adaptive_level], camera_dir[adaptive_level], sample_num[adaptive_level],
+//       sample_pos[adaptive_level], sample_dir[adaptive_level],
+//       sample_len[adaptive_level], and momentum_factors[adaptive_level] have been set, as has the
+//       given row of sample_uu1[adaptive_level], sample_uu2[adaptive_level],
+//       sample_uu3[adaptive_level], sample_bb1[adaptive_level], sample_bb2[adaptive_level],
+//       sample_bb3[adaptive_level], j_i[adaptive_level], j_q[adaptive_level], j_v[adaptive_level],
+//       alpha_i[adaptive_level], alpha_q[adaptive_level], alpha_v[adaptive_level],
+//       rho_q[adaptive_level], and rho_v[adaptive_level].
+//   Assumes given row of cell_values[adaptive_level] has been set if image_lambda_ave == true or
+//       image_emission_ave == true or image_tau_int == true.
+//   Assumes sample_dlen[adaptive_level] has been set if image_length == true.
+//   Assumes given row of sample_cut[adaptive_level] has been set if
+//       model_type == ModelType::simulation, in which case the per-sample arrays hold values only
+//       for samples outside the cut region, stored contiguously.
+//   Assumes image[adaptive_level] has been allocated and initialized.
+//   Assumes flags agrees with image_flags unless it is ImageFlags::runtime.
+//   Tests for image quantities not requested in flags are eliminated at compile time.
 //   References grtrans paper 2016 MNRAS 462 115 (G)
 //   References symphony paper 2016 ApJ 822 34 (S).
 //     J_V in (S 31) has an overall sign error that is corrected here and in the symphony code.
@@ -46,937 +152,1264 @@
 //       what (G) calls nu_B.
 //   Tetrad is chosen such that j_U, alpha_U, rho_U = 0.
 //   Integration proceeds via Strang splitting of coupling from transport as in (I).
-//   Optionally, coupling proceeds via Strang splitting of rotativity from emissivity and
-//       absorptivity as in the implementation of (I).
-void RadiationIntegrator::IntegratePolarizedRadiation()
+//   Couples to matter with CoupleStokes().
+template <int flags>
+void RadiationIntegrator::IntegratePolarizedRayKernel(int m, int row)
 {
-  // Allocate image array
-  int num_pix = camera_num_pix;
-  if (adaptive_level > 0)
-    num_pix = block_counts[adaptive_level] * block_num_pix;
-  if (first_time or adaptive_level > 0)
-    image[adaptive_level].Allocate(image_num_quantities, num_pix);
-  image[adaptive_level].Zero();
-
-  // Allocate coherency tensor array
-  Array<std::complex<double>> nn(image_num_frequencies, num_pix, 4, 4);
+  // Select image quantities, fixed at compile time unless runtime selection is requested
+  constexpr bool runtime = (flags & ImageFlags::runtime) != 0;
+  const bool do_time = runtime ? image_time : (flags & ImageFlags::time) != 0;
+  const bool do_length = runtime ? image_length : (flags & ImageFlags::length) != 0;
+  const bool do_lambda = runtime ? image_lambda : (flags & ImageFlags::lambda) != 0;
+  const bool do_emission = runtime ? image_emission : (flags & ImageFlags::emission) != 0;
+  const bool do_tau = runtime ? image_tau : (flags & ImageFlags::tau) != 0;
+  const bool do_lambda_ave = runtime ? image_lambda_ave : (flags & ImageFlags::lambda_ave) != 0;
+  const bool do_emission_ave =
+      runtime ? image_emission_ave : (flags & ImageFlags::emission_ave) != 0;
+  const bool do_tau_int = runtime ? image_tau_int : (flags & ImageFlags::tau_int) != 0;
+  const bool do_crossings = runtime ? image_crossings : (flags & ImageFlags::crossings) != 0;
 
   // Calculate units
   double x_unit = Physics::gg_msun * mass_msun / (Physics::c * Physics::c);
   double t_unit = x_unit / Physics::c;
 
-  // Work in parallel
-  #pragma omp parallel
+  // Allocate scratch space
+  double delta_lambda_old;
+  double kcon_old[4];
+  double gcov[4][4];
+  double gcon[4][4];
+  double connection[4][4][4];
+  double connection_old[4][4][4];
+  double tetrad[4][4];
+  std::complex<double> nn_con[4][4];
+  std::complex<double> nn_con_temp[4][4];
+  std::complex<double> nn_tet_cov[4][4];
+  std::complex<double> nn_tet_con[4][4];
+  double gcov_camera[4][4];
+  double tetrad_camera[4][4];
+
+  // Check number of steps
+  int num_steps = sample_num[adaptive_level](m);
+  if (num_steps <= 0)
+    return;
+  int n_start = -1;
+  int z_turnings_count = 0;
+  if (image_z_turnings)
+    FindZTurnings(m, num_steps, n_start, z_turnings_count);
+  if (n_start < 0)
+    n_start = 0;
+
+  // Locate stored values for first sample
+  bool compact = model_type == ModelType::simulation;
+  int c_start = 0;
+  for (int n = 0; n < n_start; n++)
+    if (not compact or not sample_cut[adaptive_level](row,n))
+      c_start++;
+
+  for (int l = 0; l < image_num_frequencies; l++)
   {
-    // Allocate scratch space
-    double delta_lambda_old;
-    double kcon_old[4];
-    double gcov[4][4];
-    double gcon[4][4];
-    double gcov_sim[4][4];
-    double gcon_sim[4][4];
-    double connection[4][4][4];
-    double connection_old[4][4][4];
-    double tetrad[4][4];
-    std::complex<double> nn_con[4][4];
-    std::complex<double> nn_con_temp[4][4];
-    std::complex<double> nn_tet_cov[4][4];
-    std::complex<double> nn_tet_con[4][4];
-    double jacobian[4][4];
-    int n_start;
-
-    // Go through frequencies and pixels
-    #pragma omp for schedule(static)
-    for (int m = 0; m < num_pix; m++)
-    {
-      // Check number of steps
-      int num_steps = sample_num[adaptive_level](m);
-      if (num_steps <= 0)
-        continue;
-      int n_start = -1;
-      int z_turnings_count = 0;
-      if (image_z_turnings)
-        FindZTurnings(m, num_steps, n_start, z_turnings_count);
-      if (n_start < 0)
-        n_start = 0;
-
-      for (int l = 0; l < image_num_frequencies; l++)
+    // Zero registers
+    delta_lambda_old = 0.0;
+    for (int mu = 0; mu < 4; mu++)
+      for (int nu = 0; nu < 4; nu++)
       {
-        // Zero registers
-        delta_lambda_old = 0.0;
-        for (int mu = 0; mu < 4; mu++)
-          for (int nu = 0; nu < 4; nu++)
-          {
-            nn_con[mu][nu] = 0.0;
-            nn_con_temp[mu][nu] = 0.0;
-          }
+        nn_con[mu][nu] = 0.0;
+        nn_con_temp[mu][nu] = 0.0;
+      }
 
-        // Prepare integrated quantities
-        double integrated_lambda = 0.0;
-        double integrated_emission = 0.0;
-        double x1_init = sample_pos[adaptive_level](m,0,1);
-        double x2_init = sample_pos[adaptive_level](m,0,2);
-        double x3_init = sample_pos[adaptive_level](m,0,3);
-        bool plane_sign =
-            camera_x[1] * x1_init + camera_x[2] * x2_init + camera_x[3] * x3_init > 0.0;
-        int crossings_count = 0;
-
-        // Go through samples
-        for (int n = n_start; n < num_steps; n++)
-        {
-          // Extract affine step size
-          double delta_lambda = sample_len[adaptive_level](m,n);
-          double delta_lambda_new = delta_lambda;
-          if (n < num_steps - 1)
-            delta_lambda_new = sample_len[adaptive_level](m,n+1);
-          double delta_lambda_cgs =
-              delta_lambda * x_unit / (image_frequencies(l) * momentum_factors[adaptive_level](m));
-
-          // Extract geodesic position and covariant momentum
-          double t_cgs = sample_pos[adaptive_level](m,n,0) * t_unit;
-          double x1 = sample_pos[adaptive_level](m,n,1);
-          double x2 = sample_pos[adaptive_level](m,n,2);
-          double x3 = sample_pos[adaptive_level](m,n,3);
-          double kcov[4];
-          kcov[0] = sample_dir[adaptive_level](m,n,0);
-          kcov[1] = sample_dir[adaptive_level](m,n,1);
-          kcov[2] = sample_dir[adaptive_level](m,n,2);
-          kcov[3] = sample_dir[adaptive_level](m,n,3);
-
-          // Extract model variables
-          double uu1_sim = sample_uu1[adaptive_level](m,n);
-          double uu2_sim = sample_uu2[adaptive_level](m,n);
-          double uu3_sim = sample_uu3[adaptive_level](m,n);
-          double bb1_sim = sample_bb1[adaptive_level](m,n);
-          double bb2_sim = sample_bb2[adaptive_level](m,n);
-          double bb3_sim = sample_bb3[adaptive_level](m,n);
-
-          // Calculate geodesic metric and connection
-          CovariantGeodesicMetric(x1, x2, x3, gcov);
-          ContravariantGeodesicMetric(x1, x2, x3, gcon);
-          GeodesicConnection(x1, x2, x3, connection);
-          if (n == 0)
-            for (int mu = 0; mu < 4; mu++)
-              for (int alpha = 0; alpha < 4; alpha++)
-                for (int beta = 0; beta < 4; beta++)
-                  connection_old[mu][alpha][beta] = connection[mu][alpha][beta];
-          else
-            for (int mu = 0; mu < 4; mu++)
-              for (int alpha = 0; alpha < 4; alpha++)
-                for (int beta = 0; beta < 4; beta++)
-                  connection_old[mu][alpha][beta] =
-                      0.5 * (connection_old[mu][alpha][beta] + connection[mu][alpha][beta]);
-
-          // Calculate geodesic contravariant momentum
-          double kcon[4] = {};
-          for (int mu = 0; mu < 4; mu++)
-            for (int nu = 0; nu < 4; nu++)
-              kcon[mu] += gcon[mu][nu] * kcov[nu];
-          if (n == 0)
-            for (int mu = 0; mu < 4; mu++)
-              kcon_old[mu] = kcon[mu];
-          else
-            for (int mu = 0; mu < 4; mu++)
-              kcon_old[mu] = 0.5 * (kcon_old[mu] + kcon[mu]);
-
-          // Parallel-transport N by first half step
-          double temp_a[4][4] = {};
-          for (int mu = 0; mu < 4; mu++)
+    // Prepare integrated quantities
+    double integrated_lambda = 0.0;
+    double integrated_emission = 0.0;
+    double x1_init = sample_pos[adaptive_level](m,0,1);
+    double x2_init = sample_pos[adaptive_level](m,0,2);
+    double x3_init = sample_pos[adaptive_level](m,0,3);
+    bool plane_sign =
+        camera_x[1] * x1_init + camera_x[2] * x2_init + camera_x[3] * x3_init > 0.0;
+    int crossings_count = 0;
+
+    // Go through samples
+    int c_next = c_start;
+    for (int n = n_start; n < num_steps; n++)
+    {
+      // Locate stored values, noting samples in cut region have none
+      bool live = not compact or not sample_cut[adaptive_level](row,n);
+      int c = live ? c_next++ : 0;
+
+      // Extract affine step size
+      double delta_lambda = sample_len[adaptive_level](m,n);
+      double delta_lambda_new = delta_lambda;
+      if (n < num_steps - 1)
+        delta_lambda_new = sample_len[adaptive_level](m,n+1);
+      double delta_lambda_cgs =
+          delta_lambda * x_unit / (image_frequencies(l) * momentum_factors[adaptive_level](m));
+
+      // Extract geodesic position and covariant momentum
+      double t_cgs = sample_pos[adaptive_level](m,n,0) * t_unit;
+      double x1 = sample_pos[adaptive_level](m,n,1);
+      double x2 = sample_pos[adaptive_level](m,n,2);
+      double x3 = sample_pos[adaptive_level](m,n,3);
+      double kcov[4];
+      kcov[0] = sample_dir[adaptive_level](m,n,0);
+      kcov[1] = sample_dir[adaptive_level](m,n,1);
+      kcov[2] = sample_dir[adaptive_level](m,n,2);
+      kcov[3] = sample_dir[adaptive_level](m,n,3);
+
+      // Extract model variables
+      double uu1_sim = live ? sample_uu1[adaptive_level](row,c) : 0.0f;
+      double uu2_sim = live ? sample_uu2[adaptive_level](row,c) : 0.0f;
+      double uu3_sim = live ? sample_uu3[adaptive_level](row,c) : 0.0f;
+      double bb1_sim = live ? sample_bb1[adaptive_level](row,c) : 0.0f;
+      double bb2_sim = live ? sample_bb2[adaptive_level](row,c) : 0.0f;
+      double bb3_sim = live ? sample_bb3[adaptive_level](row,c) : 0.0f;
+
+      // Calculate geodesic metric and connection
+      CovariantGeodesicMetric(x1, x2, x3, gcov);
+      ContravariantGeodesicMetric(x1, x2, x3, gcon);
+      GeodesicConnection(x1, x2, x3, connection);
+      if (n == 0)
+        for (int mu = 0; mu < 4; mu++)
+          for (int alpha = 0; alpha < 4; alpha++)
             for (int beta = 0; beta < 4; beta++)
-              for (int alpha = 0; alpha < 4; alpha++)
-                temp_a[mu][beta] += kcon_old[alpha] * connection_old[mu][alpha][beta];
-          double delta_lambda_local = (delta_lambda_old + delta_lambda) / 2.0;
-          for (int mu = 0; mu < 4; mu++)
-            for (int nu = 0; nu < 4; nu++)
-            {
-              std::complex<double> dnn_dlambda = 0.0;
-              for (int beta = 0; beta < 4; beta++)
-                dnn_dlambda -=
-                    temp_a[mu][beta] * nn_con[beta][nu] + temp_a[nu][beta] * nn_con[mu][beta];
-              nn_con_temp[mu][nu] += dnn_dlambda * delta_lambda_local;
-            }
-          for (int mu = 0; mu < 4; mu++)
-            for (int nu = 0; nu < 4; nu++)
-              nn_con[mu][nu] = nn_con_temp[mu][nu];
-
-          // Calculate simulation metric
-          CovariantSimulationMetric(x1, x2, x3, gcov_sim);
-          ContravariantSimulationMetric(x1, x2, x3, gcon_sim);
-
-          // Calculate simulation velocity
-          double uu0_sim = std::sqrt(1.0 + gcov_sim[1][1] * uu1_sim * uu1_sim
-              + 2.0 * gcov_sim[1][2] * uu1_sim * uu2_sim + 2.0 * gcov_sim[1][3] * uu1_sim * uu3_sim
-              + gcov_sim[2][2] * uu2_sim * uu2_sim + 2.0 * gcov_sim[2][3] * uu2_sim * uu3_sim
-              + gcov_sim[3][3] * uu3_sim * uu3_sim);
-          double lapse_sim = 1.0 / std::sqrt(-gcon_sim[0][0]);
-          double shift1_sim = -gcon_sim[0][1] / gcon_sim[0][0];
-          double shift2_sim = -gcon_sim[0][2] / gcon_sim[0][0];
-          double shift3_sim = -gcon_sim[0][3] / gcon_sim[0][0];
-          double ucon_sim[4];
-          ucon_sim[0] = uu0_sim / lapse_sim;
-          ucon_sim[1] = uu1_sim - shift1_sim * uu0_sim / lapse_sim;
-          ucon_sim[2] = uu2_sim - shift2_sim * uu0_sim / lapse_sim;
-          ucon_sim[3] = uu3_sim - shift3_sim * uu0_sim / lapse_sim;
-          double ucov_sim[4] = {};
-          for (int mu = 0; mu < 4; mu++)
-            for (int nu = 0; nu < 4; nu++)
-              ucov_sim[mu] += gcov_sim[mu][nu] * ucon_sim[nu];
-
-          // Calculate simulation magnetic field
-          double bcon_sim[4];
-          bcon_sim[0] = ucov_sim[1] * bb1_sim + ucov_sim[2] * bb2_sim + ucov_sim[3] * bb3_sim;
-          bcon_sim[1] = (bb1_sim + bcon_sim[0] * ucon_sim[1]) / ucon_sim[0];
-          bcon_sim[2] = (bb2_sim + bcon_sim[0] * ucon_sim[2]) / ucon_sim[0];
-          bcon_sim[3] = (bb3_sim + bcon_sim[0] * ucon_sim[3]) / ucon_sim[0];
-          double bcov_sim[4] = {};
-          for (int mu = 0; mu < 4; mu++)
-            for (int nu = 0; nu < 4; nu++)
-              bcov_sim[mu] += gcov_sim[mu][nu] * bcon_sim[nu];
-          double b_sq = 0.0;
-          for (int mu = 0; mu < 4; mu++)
-            b_sq += bcov_sim[mu] * bcon_sim[mu];
-
-          // Calculate Jacobian of transformation from simulation to geodesic coordinates
-          CoordinateJacobian(x1, x2, x3, jacobian);
+              connection_old[mu][alpha][beta] = connection[mu][alpha][beta];
+      else
+        for (int mu = 0; mu < 4; mu++)
+          for (int alpha = 0; alpha < 4; alpha++)
+            for (int beta = 0; beta < 4; beta++)
+              connection_old[mu][alpha][beta] =
+                  0.5 * (connection_old[mu][alpha][beta] + connection[mu][alpha][beta]);
 
-          // Transform contravariant velocity and magnetic field to geodesic coordinates
-          double ucon[4] = {};
-          for (int mu = 0; mu < 4; mu++)
-            for (int nu = 0; nu < 4; nu++)
-              ucon[mu] += jacobian[mu][nu] * ucon_sim[nu];
-          double bcon[4] = {};
-          for (int mu = 0; mu < 4; mu++)
-            for (int nu = 0; nu < 4; nu++)
-              bcon[mu] += jacobian[mu][nu] * bcon_sim[nu];
+      // Calculate geodesic contravariant momentum
+      double kcon[4] = {};
+      for (int mu = 0; mu < 4; mu++)
+        for (int nu = 0; nu < 4; nu++)
+          kcon[mu] += gcon[mu][nu] * kcov[nu];
+      if (n == 0)
+        for (int mu = 0; mu < 4; mu++)
+          kcon_old[mu] = kcon[mu];
+      else
+        for (int mu = 0; mu < 4; mu++)
+          kcon_old[mu] = 0.5 * (kcon_old[mu] + kcon[mu]);
 
-          // Calculate covariant velocity and magnetic field
-          double ucov[4] = {};
-          for (int mu = 0; mu < 4; mu++)
-            for (int nu = 0; nu < 4; nu++)
-              ucov[mu] += gcov[mu][nu] * ucon[nu];
-          double bcov[4] = {};
-          for (int mu = 0; mu < 4; mu++)
-            for (int nu = 0; nu < 4; nu++)
-              bcov[mu] += gcov[mu][nu] * bcon[nu];
-
-          // Calculate orthonormal tetrad
-          double upcon[4] = {};
-          if (bb1_sim == 0.0 and bb2_sim == 0.0 and bb3_sim == 0.0)
-            upcon[3] = 1.0;
-          else
-            for (int mu = 0; mu < 4; mu++)
-              upcon[mu] = bcon[mu];
-          Tetrad(ucon, ucov, kcon, kcov, upcon, gcov, gcon, tetrad);
-
-          // Transform N into orthonormal frame
-          std::complex<double> temp_b[4][4] = {};
+      // Parallel-transport N by first half step
+      double temp_a[4][4] = {};
+      for (int mu = 0; mu < 4; mu++)
+        for (int beta = 0; beta < 4; beta++)
+          for (int alpha = 0; alpha < 4; alpha++)
+            temp_a[mu][beta] += kcon_old[alpha] * connection_old[mu][alpha][beta];
+      double delta_lambda_local = (delta_lambda_old + delta_lambda) / 2.0;
+      for (int mu = 0; mu < 4; mu++)
+        for (int nu = 0; nu < 4; nu++)
+        {
+          std::complex<double> dnn_dlambda = 0.0;
+          for (int beta = 0; beta < 4; beta++)
+            dnn_dlambda -=
+                temp_a[mu][beta] * nn_con[beta][nu] + temp_a[nu][beta] * nn_con[mu][beta];
+          nn_con_temp[mu][nu] += dnn_dlambda * delta_lambda_local;
+        }
+      for (int mu = 0; mu < 4; mu++)
+        for (int nu = 0; nu < 4; nu++)
+          nn_con[mu][nu] = nn_con_temp[mu][nu];
+
+      // Calculate orthonormal tetrad
+      double uu_sim[3] = {uu1_sim, uu2_sim, uu3_sim};
+      double bb_sim[3] = {bb1_sim, bb2_sim, bb3_sim};
+      FluidTetrad(x1, x2, x3, kcon, kcov, gcov, gcon, uu_sim, bb_sim, tetrad);
+
+      // Transform N into orthonormal frame
+      std::complex<double> temp_b[4][4] = {};
+      for (int nu = 0; nu < 4; nu++)
+        for (int alpha = 0; alpha < 4; alpha++)
+          for (int beta = 0; beta < 4; beta++)
+            temp_b[nu][alpha] += gcov[nu][beta] * nn_con[alpha][beta];
+      std::complex<double> temp_c[4][4] = {};
+      for (int mu = 0; mu < 4; mu++)
+        for (int nu = 0; nu < 4; nu++)
+          for (int alpha = 0; alpha < 4; alpha++)
+            temp_c[mu][nu] += gcov[mu][alpha] * temp_b[nu][alpha];
+      std::complex<double> temp_d[4][4] = {};
+      for (int b = 0; b < 4; b++)
+        for (int mu = 0; mu < 4; mu++)
           for (int nu = 0; nu < 4; nu++)
-            for (int alpha = 0; alpha < 4; alpha++)
-              for (int beta = 0; beta < 4; beta++)
-                temp_b[nu][alpha] += gcov[nu][beta] * nn_con[alpha][beta];
-          std::complex<double> temp_c[4][4] = {};
+            temp_d[b][mu] += tetrad[b][nu] * temp_c[mu][nu];
+      for (int a = 0; a < 4; a++)
+        for (int b = 0; b < 4; b++)
+        {
+          nn_tet_cov[a][b] = 0.0;
           for (int mu = 0; mu < 4; mu++)
-            for (int nu = 0; nu < 4; nu++)
-              for (int alpha = 0; alpha < 4; alpha++)
-                temp_c[mu][nu] += gcov[mu][alpha] * temp_b[nu][alpha];
-          std::complex<double> temp_d[4][4] = {};
-          for (int b = 0; b < 4; b++)
-            for (int mu = 0; mu < 4; mu++)
-              for (int nu = 0; nu < 4; nu++)
-                temp_d[b][mu] += tetrad[b][nu] * temp_c[mu][nu];
-          for (int a = 0; a < 4; a++)
-            for (int b = 0; b < 4; b++)
-            {
-              nn_tet_cov[a][b] = 0.0;
-              for (int mu = 0; mu < 4; mu++)
-                nn_tet_cov[a][b] += tetrad[a][mu] * temp_d[b][mu];
-            }
-
-          // Calculate orthonormal-frame Stokes quantities before coupling to fluid (I 14)
-          double ss_start[4];
-          ss_start[0] = 0.5 * (nn_tet_cov[1][1] + nn_tet_cov[2][2]).real();
-          ss_start[1] = 0.5 * (nn_tet_cov[1][1] - nn_tet_cov[2][2]).real();
-          ss_start[2] = 0.5 * (nn_tet_cov[1][2] + nn_tet_cov[2][1]).real();
-          ss_start[3] = 0.5 * (nn_tet_cov[2][1] - nn_tet_cov[1][2]).imag();
-
-          // Extract emissivity coefficients
-          double j_s[4] = {};
-          j_s[0] = j_i[adaptive_level](l,m,n);
-          j_s[1] = j_q[adaptive_level](l,m,n);
-          j_s[3] = j_v[adaptive_level](l,m,n);
-
-          // Extract absorptivity coefficients
-          double alpha_s[4] = {};
-          alpha_s[0] = alpha_i[adaptive_level](l,m,n);
-          alpha_s[1] = alpha_q[adaptive_level](l,m,n);
-          alpha_s[3] = alpha_v[adaptive_level](l,m,n);
-
-          // Extract rotativity coefficients
-          double rho_s[4] = {};
-          rho_s[1] = rho_q[adaptive_level](l,m,n);
-          rho_s[3] = rho_v[adaptive_level](l,m,n);
-
-          // Calculate optical depth
-          double delta_tau = alpha_s[0] * delta_lambda_cgs;
-          bool optically_thin = delta_tau <= delta_tau_max;
-
-          // Accumulate alternative image quantities
-          if (image_time and l == 0)
-            image[adaptive_level](image_offset_time,m) =
-                std::min(image[adaptive_level](image_offset_time,m), t_cgs);
-          if (image_length and l == 0)
-          {
-            double temp_e[4] = {};
-            for (int a = 1; a < 4; a++)
-              for (int mu = 0; mu < 4; mu++)
-                temp_e[a] += (gcon[a][mu] - gcon[0][a] * gcon[0][mu] / gcon[0][0]) * kcov[mu];
-            double dl_dlambda_sq = 0.0;
-            for (int a = 1; a < 4; a++)
-              for (int b = 1; b < 4; b++)
-                dl_dlambda_sq += gcov[a][b] * temp_e[a] * temp_e[b];
-            image[adaptive_level](image_offset_length,m) +=
-                std::sqrt(dl_dlambda_sq) * delta_lambda * x_unit;
-          }
-          if (image_lambda or image_lambda_ave)
-            integrated_lambda += delta_lambda_cgs;
-          if (image_emission or image_emission_ave)
-            integrated_emission += j_s[0] * delta_lambda_cgs;
-          if (image_tau)
-            image[adaptive_level](image_offset_tau+l,m) += delta_tau;
-          if (image_lambda_ave and not std::isnan(cell_values[adaptive_level](0,m,n)))
-            for (int a = 0; a < CellValues::num_cell_values; a++)
-            {
-              int index = image_offset_lambda_ave + l * CellValues::num_cell_values + a;
-              image[adaptive_level](index,m) +=
-                  cell_values[adaptive_level](a,m,n) * delta_lambda_cgs;
-            }
-          if (image_emission_ave and not std::isnan(cell_values[adaptive_level](0,m,n)))
-            for (int a = 0; a < CellValues::num_cell_values; a++)
-            {
-              int index = image_offset_emission_ave + l * CellValues::num_cell_values + a;
-              image[adaptive_level](index,m) +=
-                  cell_values[adaptive_level](a,m,n) * j_s[0] * delta_lambda_cgs;
-            }
-          if (image_tau_int and not std::isnan(cell_values[adaptive_level](0,m,n)))
-          {
-            if (optically_thin)
-            {
-              double exp_neg = std::exp(-delta_tau);
-              double expm1 = std::expm1(delta_tau);
-              for (int a = 0; a < CellValues::num_cell_values; a++)
-              {
-                int index = image_offset_tau_int + l * CellValues::num_cell_values + a;
-                image[adaptive_level](index,m) = exp_neg
-                    * (image[adaptive_level](index,m) + cell_values[adaptive_level](a,m,n) * expm1);
-              }
-            }
-            else
-              for (int a = 0; a < CellValues::num_cell_values; a++)
-              {
-                int index = image_offset_tau_int + l * CellValues::num_cell_values + a;
-                image[adaptive_level](index,m) = cell_values[adaptive_level](a,m,n);
-              }
-          }
-          if (image_crossings and l == 0)
-          {
-            bool plane_sign_new = camera_x[1] * x1 + camera_x[2] * x2 + camera_x[3] * x3 > 0.0;
-            if (plane_sign_new != plane_sign)
-              crossings_count++;
-            plane_sign = plane_sign_new;
-          }
+            nn_tet_cov[a][b] += tetrad[a][mu] * temp_d[b][mu];
+        }
 
-          // Prepare to couple to matter
-          double alpha_sq = alpha_s[1] * alpha_s[1] + alpha_s[3] * alpha_s[3];
-          double alpha_p = std::sqrt(alpha_sq);
-          double rho_sq = rho_s[1] * rho_s[1] + rho_s[3] * rho_s[3];
-          double rho_p = std::sqrt(rho_sq);
-          double ss_end[4] = {};
+      // Calculate orthonormal-frame Stokes quantities before coupling to fluid (I 14)
+      double ss_start[4];
+      ss_start[0] = 0.5 * (nn_tet_cov[1][1] + nn_tet_cov[2][2]).real();
+      ss_start[1] = 0.5 * (nn_tet_cov[1][1] - nn_tet_cov[2][2]).real();
+      ss_start[2] = 0.5 * (nn_tet_cov[1][2] + nn_tet_cov[2][1]).real();
+      ss_start[3] = 0.5 * (nn_tet_cov[2][1] - nn_tet_cov[1][2]).imag();
+
+      // Extract emissivity, absorptivity, and rotativity coefficients
+      double j_s[4] = {};
+      double alpha_s[4] = {};
+      double rho_s[4] = {};
+      if (live)
+      {
+        j_s[0] = j_i[adaptive_level](row,c,l);
+        j_s[1] = j_q[adaptive_level](row,c,l);
+        j_s[3] = j_v[adaptive_level](row,c,l);
+        alpha_s[0] = alpha_i[adaptive_level](row,c,l);
+        alpha_s[1] = alpha_q[adaptive_level](row,c,l);
+        alpha_s[3] = alpha_v[adaptive_level](row,c,l);
+        rho_s[1] = rho_q[adaptive_level](row,c,l);
+        rho_s[3] = rho_v[adaptive_level](row,c,l);
+      }
 
-          // Couple via splitting of rotativity from absorptivity/emissivity
-          if (image_rotation_split)
+      // Calculate optical depth
+      double delta_tau = alpha_s[0] * delta_lambda_cgs;
+      bool optically_thin = delta_tau <= delta_tau_max;
+
+      // Accumulate alternative image quantities
+      if (do_time and l == 0)
+        image[adaptive_level](image_offset_time,m) =
+            std::min(image[adaptive_level](image_offset_time,m), t_cgs);
+      if (do_length and l == 0)
+        image[adaptive_level](image_offset_length,m) += sample_dlen[adaptive_level](m,n) * x_unit;
+      if (do_lambda or do_lambda_ave)
+        integrated_lambda += delta_lambda_cgs;
+      if (do_emission or do_emission_ave)
+        integrated_emission += j_s[0] * delta_lambda_cgs;
+      if (do_tau)
+        image[adaptive_level](image_offset_tau+l,m) += delta_tau;
+      if (do_lambda_ave and live and not std::isnan(cell_values[adaptive_level](0,row,c)))
+        for (int a = 0; a < CellValues::num_cell_values; a++)
+        {
+          int index = image_offset_lambda_ave + l * CellValues::num_cell_values + a;
+          image[adaptive_level](index,m) +=
+              cell_values[adaptive_level](a,row,c) * delta_lambda_cgs;
+        }
+      if (do_emission_ave and live and not std::isnan(cell_values[adaptive_level](0,row,c)))
+        for (int a = 0; a < CellValues::num_cell_values; a++)
+        {
+          int index = image_offset_emission_ave + l * CellValues::num_cell_values + a;
+          image[adaptive_level](index,m) +=
+              cell_values[adaptive_level](a,row,c) * j_s[0] * delta_lambda_cgs;
+        }
+      if (do_tau_int and live and not std::isnan(cell_values[adaptive_level](0,row,c)))
+      {
+        if (optically_thin)
+        {
+          double exp_neg = std::exp(-delta_tau);
+          double expm1 = std::expm1(delta_tau);
+          for (int a = 0; a < CellValues::num_cell_values; a++)
           {
-            // Couple first half with no absorptivity
-            if (alpha_s[0] == 0.0)
-              for (int a = 0; a < 4; a++)
-                ss_end[a] = ss_start[a] + j_s[a] * delta_lambda_cgs / 2.0;
-
-            // Couple first half with no polarized absorptivity but with nonzero absorptivity
-            else if (alpha_p == 0.0)
-            {
-              // Optically thin case
-              if (optically_thin)
-              {
-                double exp_neg = std::exp(-delta_tau / 2.0);
-                double expm1 = std::expm1(delta_tau / 2.0);
-                for (int a = 0; a < 4; a++)
-                  ss_end[a] = exp_neg * (ss_start[a] + j_s[a] / alpha_s[0] * expm1);
-              }
-
-              // Optically thick case
-              else
-                for (int a = 0; a < 4; a++)
-                  ss_end[a] = j_s[a] / alpha_s[0];
-            }
-
-            // Couple first half with nonzero polarized absorptivity
-            else
-            {
-              // Optically thin case (I A14-A17)
-              if (optically_thin)
-              {
-                double exp_neg_i = std::exp(-delta_tau / 2.0);
-                double exp_neg_p = std::exp(-alpha_p * delta_lambda_cgs / 2.0);
-                double sinh_p = std::sinh(alpha_p * delta_lambda_cgs / 2.0);
-                double cosh_p = std::cosh(alpha_p * delta_lambda_cgs / 2.0);
-                double coshm1_p =
-                    0.5 * (std::expm1(alpha_p * delta_lambda_cgs / 2.0) + exp_neg_p - 1.0);
-                double alpha_ss = alpha_s[1] * ss_start[1] + alpha_s[3] * ss_start[3];
-                double alpha_j = alpha_s[1] * j_s[1] + alpha_s[3] * j_s[3];
-                double alpha_i_p_factor = 1.0 / (alpha_s[0] * alpha_s[0] - alpha_sq);
-                ss_end[0] = (ss_start[0] * cosh_p - alpha_ss / alpha_p * sinh_p) * exp_neg_i
-                    + alpha_j * alpha_i_p_factor * (-1.0 + (alpha_s[0] * sinh_p + alpha_p * cosh_p)
-                    / alpha_p * exp_neg_p) + alpha_s[0] * j_s[0] * alpha_i_p_factor * (1.0
-                    - (alpha_s[0] * cosh_p + alpha_p * sinh_p) / alpha_s[0] * exp_neg_p);
-
-                for (int a = 1; a < 4; a++)
-                {
-                  double term_1 = (ss_start[a] + alpha_s[a] * alpha_ss / alpha_sq * coshm1_p
-                      - ss_start[0] * alpha_s[a] / alpha_p * sinh_p) * exp_neg_i;
-                  double term_2 = j_s[a] * (1.0 - exp_neg_i) / alpha_s[0];
-                  double term_3 = alpha_j * alpha_s[a] / alpha_s[0] * alpha_i_p_factor * (1.0 - (1.0
-                      - alpha_s[0] * alpha_s[0] / alpha_sq - alpha_s[0] / alpha_sq * (alpha_s[0]
-                      * cosh_p + alpha_p * sinh_p)) * exp_neg_i);
-                  double term_4 = j_s[0] * alpha_s[a] / alpha_p * alpha_i_p_factor * (-alpha_p +
-                      (alpha_p * cosh_p + alpha_s[0] * sinh_p) * exp_neg_i);
-                  ss_end[a] = term_1 + term_2 + term_3 + term_4;
-                }
-              }
-
-              // Optically thick case
-              else
-              {
-                double alpha_j = alpha_s[1] * j_s[1] + alpha_s[3] * j_s[3];
-                ss_end[0] = (alpha_s[0] * j_s[0] - alpha_j) / (alpha_s[0] * alpha_s[0] - alpha_sq);
-                for (int a = 1; a < 4; a++)
-                  ss_end[a] = (j_s[a] - alpha_s[a] * ss_end[0]) / alpha_s[0];
-              }
-            }
-
-            // Ensure state is physically admissible
-            ss_end[0] = std::max(ss_end[0], 0.0);
-            double ss_pol = ss_end[1] * ss_end[1] + ss_end[2] * ss_end[2] + ss_end[3] * ss_end[3];
-            if (ss_pol > ss_end[0] * ss_end[0])
-            {
-              double factor = std::sqrt(ss_end[0] * ss_end[0] / ss_pol);
-              ss_end[1] *= factor;
-              ss_end[2] *= factor;
-              ss_end[3] *= factor;
-            }
-
-            // Reset starting Stokes parameters
-            for (int a = 0; a < 4; a++)
-              ss_start[a] = ss_end[a];
-
-            // Couple with no absorptivity but nonzero rotativity (I A2-A5)
-            if (rho_p != 0.0)
-            {
-              double cos_rho = std::cos(rho_p * delta_lambda_cgs);
-              double sin_rho = std::sin(rho_p * delta_lambda_cgs);
-              double sin_sq_rho = std::sin(rho_p * delta_lambda_cgs / 2.0);
-              sin_sq_rho = sin_sq_rho * sin_sq_rho;
-              double rho_ss = rho_s[1] * ss_start[1] + rho_s[3] * ss_start[3];
-              ss_end[0] = ss_start[0];
-              ss_end[1] = ss_start[1] * cos_rho + 2.0 * rho_s[1] * rho_ss / rho_sq * sin_sq_rho
-                  - rho_s[3] * ss_start[2] / rho_p * sin_rho;
-              ss_end[2] = ss_start[2] * cos_rho
-                  + (rho_s[3] * ss_start[1] - rho_s[1] * ss_start[3]) / rho_p * sin_rho;
-              ss_end[3] = ss_start[3] * cos_rho + 2.0 * rho_s[3] * rho_ss / rho_sq * sin_sq_rho
-                  + rho_s[1] * ss_start[2] / rho_p * sin_rho;
-            }
-
-            // Ensure state is physically admissible
-            ss_pol = ss_end[1] * ss_end[1] + ss_end[2] * ss_end[2] + ss_end[3] * ss_end[3];
-            if (ss_pol > ss_end[0] * ss_end[0])
-            {
-              double factor = std::sqrt(ss_end[0] * ss_end[0] / ss_pol);
-              ss_end[1] *= factor;
-              ss_end[2] *= factor;
-              ss_end[3] *= factor;
-            }
-
-            // Reset starting Stokes parameters
-            for (int a = 0; a < 4; a++)
-              ss_start[a] = ss_end[a];
-
-            // Couple second half with no absorptivity
-            if (alpha_s[0] == 0.0)
-              for (int a = 0; a < 4; a++)
-                ss_end[a] = ss_start[a] + j_s[a] * delta_lambda_cgs / 2.0;
-
-            // Couple second half with no polarized absorptivity but with nonzero absorptivity
-            else if (alpha_p == 0.0)
-            {
-              // Optically thin case
-              if (optically_thin)
-              {
-                double exp_neg = std::exp(-delta_tau / 2.0);
-                double expm1 = std::expm1(delta_tau / 2.0);
-                for (int a = 0; a < 4; a++)
-                  ss_end[a] = exp_neg * (ss_start[a] + j_s[a] / alpha_s[0] * expm1);
-              }
-
-              // Optically thick case
-              else
-                for (int a = 0; a < 4; a++)
-                  ss_end[a] = j_s[a] / alpha_s[0];
-            }
-
-            // Couple second half with nonzero polarized absorptivity
-            else
-            {
-              // Optically thin case (I A14-A17)
-              if (optically_thin)
-              {
-                double exp_neg_i = std::exp(-delta_tau / 2.0);
-                double exp_neg_p = std::exp(-alpha_p * delta_lambda_cgs / 2.0);
-                double sinh_p = std::sinh(alpha_p * delta_lambda_cgs / 2.0);
-                double cosh_p = std::cosh(alpha_p * delta_lambda_cgs / 2.0);
-                double coshm1_p =
-                    0.5 * (std::expm1(alpha_p * delta_lambda_cgs / 2.0) + exp_neg_p - 1.0);
-                double alpha_ss = alpha_s[1] * ss_start[1] + alpha_s[3] * ss_start[3];
-                double alpha_j = alpha_s[1] * j_s[1] + alpha_s[3] * j_s[3];
-                double alpha_i_p_factor = 1.0 / (alpha_s[0] * alpha_s[0] - alpha_sq);
-                ss_end[0] = (ss_start[0] * cosh_p - alpha_ss / alpha_p * sinh_p) * exp_neg_i
-                    + alpha_j * alpha_i_p_factor * (-1.0 + (alpha_s[0] * sinh_p + alpha_p * cosh_p)
-                    / alpha_p * exp_neg_p) + alpha_s[0] * j_s[0] * alpha_i_p_factor * (1.0
-                    - (alpha_s[0] * cosh_p + alpha_p * sinh_p) / alpha_s[0] * exp_neg_p);
-                for (int a = 1; a < 4; a++)
-                {
-                  double term_1 = (ss_start[a] + alpha_s[a] * alpha_ss / alpha_sq * coshm1_p
-                      - ss_start[0] * alpha_s[a] / alpha_p * sinh_p) * exp_neg_i;
-                  double term_2 = j_s[a] * (1.0 - exp_neg_i) / alpha_s[0];
-                  double term_3 = alpha_j * alpha_s[a] / alpha_s[0] * alpha_i_p_factor * (1.0 - (1.0
-                      - alpha_s[0] * alpha_s[0] / alpha_sq - alpha_s[0] / alpha_sq * (alpha_s[0]
-                      * cosh_p + alpha_p * sinh_p)) * exp_neg_i);
-                  double term_4 = j_s[0] * alpha_s[a] / alpha_p * alpha_i_p_factor * (-alpha_p +
-                      (alpha_p * cosh_p + alpha_s[0] * sinh_p) * exp_neg_i);
-                  ss_end[a] = term_1 + term_2 + term_3 + term_4;
-                }
-              }
-
-              // Optically thick case
-              else
-              {
-                double alpha_j = alpha_s[1] * j_s[1] + alpha_s[3] * j_s[3];
-                ss_end[0] = (alpha_s[0] * j_s[0] - alpha_j) / (alpha_s[0] * alpha_s[0] - alpha_sq);
-                for (int a = 1; a < 4; a++)
-                  ss_end[a] = (j_s[a] - alpha_s[a] * ss_end[0]) / alpha_s[0];
-              }
-            }
+            int index = image_offset_tau_int + l * CellValues::num_cell_values + a;
+            image[adaptive_level](index,m) = exp_neg
+                * (image[adaptive_level](index,m) + cell_values[adaptive_level](a,row,c) * expm1);
           }
-
-          // Couple with no splitting
-          else
+        }
+        else
+          for (int a = 0; a < CellValues::num_cell_values; a++)
           {
-            // Couple with no absorptivity or rotativity
-            if (alpha_s[0] == 0.0 and rho_p == 0.0)
-              for (int a = 0; a < 4; a++)
-                ss_end[a] = ss_start[a] + j_s[a] * delta_lambda_cgs;
-
-            // Couple with no polarized absorptivity or rotativity but with nonzero absorptivity
-            else if (alpha_p == 0.0 and rho_p == 0.0)
-            {
-              // Optically thin case
-              if (optically_thin)
-              {
-                double exp_neg = std::exp(-delta_tau);
-                double expm1 = std::expm1(delta_tau);
-                for (int a = 0; a < 4; a++)
-                  ss_end[a] = exp_neg * (ss_start[a] + j_s[a] / alpha_s[0] * expm1);
-              }
-
-              // Optically thick case
-              else
-                for (int a = 0; a < 4; a++)
-                  ss_end[a] = j_s[a] / alpha_s[0];
-            }
-
-            // Couple with no absorptivity but nonzero rotativity (I A2-A5)
-            else if (alpha_s[0] == 0.0)
-            {
-              double cos_rho = std::cos(rho_p * delta_lambda_cgs);
-              double sin_rho = std::sin(rho_p * delta_lambda_cgs);
-              double sin_sq_rho = std::sin(rho_p * delta_lambda_cgs / 2.0);
-              sin_sq_rho = sin_sq_rho * sin_sq_rho;
-              double rho_ss = rho_s[1] * ss_start[1] + rho_s[3] * ss_start[3];
-              ss_end[0] = ss_start[0];
-              ss_end[1] = ss_start[1] * cos_rho + 2.0 * rho_s[1] * rho_ss / rho_sq * sin_sq_rho
-                  - rho_s[3] * ss_start[2] / rho_p * sin_rho;
-              ss_end[2] = ss_start[2] * cos_rho
-                  + (rho_s[3] * ss_start[1] - rho_s[1] * ss_start[3]) / rho_p * sin_rho;
-              ss_end[3] = ss_start[3] * cos_rho + 2.0 * rho_s[3] * rho_ss / rho_sq * sin_sq_rho
-                  + rho_s[1] * ss_start[2] / rho_p * sin_rho;
-              for (int a = 0; a < 4; a++)
-                ss_end[a] += j_s[a] * delta_lambda_cgs;
-            }
-
-            // Couple with no rotativity but nonzero polarized absorptivity
-            else if (rho_p == 0.0)
-            {
-              // Optically thin case (I A14-A17)
-              if (optically_thin)
-              {
-                double exp_neg_i = std::exp(-delta_tau);
-                double exp_neg_p = std::exp(-alpha_p * delta_lambda_cgs);
-                double sinh_p = std::sinh(alpha_p * delta_lambda_cgs);
-                double cosh_p = std::cosh(alpha_p * delta_lambda_cgs);
-                double coshm1_p = 0.5 * (std::expm1(alpha_p * delta_lambda_cgs) + exp_neg_p - 1.0);
-                double alpha_ss = alpha_s[1] * ss_start[1] + alpha_s[3] * ss_start[3];
-                double alpha_j = alpha_s[1] * j_s[1] + alpha_s[3] * j_s[3];
-                double alpha_i_p_factor = 1.0 / (alpha_s[0] * alpha_s[0] - alpha_sq);
-                ss_end[0] = (ss_start[0] * cosh_p - alpha_ss / alpha_p * sinh_p) * exp_neg_i
-                    + alpha_j * alpha_i_p_factor * (-1.0 + (alpha_s[0] * sinh_p + alpha_p * cosh_p)
-                    / alpha_p * exp_neg_p) + alpha_s[0] * j_s[0] * alpha_i_p_factor * (1.0
-                    - (alpha_s[0] * cosh_p + alpha_p * sinh_p) / alpha_s[0] * exp_neg_p);
-                for (int a = 1; a < 4; a++)
-                {
-                  double term_1 = (ss_start[a] + alpha_s[a] * alpha_ss / alpha_sq * coshm1_p
-                      - ss_start[0] * alpha_s[a] / alpha_p * sinh_p) * exp_neg_i;
-                  double term_2 = j_s[a] * (1.0 - exp_neg_i) / alpha_s[0];
-                  double term_3 = alpha_j * alpha_s[a] / alpha_s[0] * alpha_i_p_factor * (1.0 - (1.0
-                      - alpha_s[0] * alpha_s[0] / alpha_sq - alpha_s[0] / alpha_sq * (alpha_s[0]
-                      * cosh_p + alpha_p * sinh_p)) * exp_neg_i);
-                  double term_4 = j_s[0] * alpha_s[a] / alpha_p * alpha_i_p_factor * (-alpha_p +
-                      (alpha_p * cosh_p + alpha_s[0] * sinh_p) * exp_neg_i);
-                  ss_end[a] = term_1 + term_2 + term_3 + term_4;
-                }
-              }
-
-              // Optically thick case
-              else
-              {
-                double alpha_j = alpha_s[1] * j_s[1] + alpha_s[3] * j_s[3];
-                ss_end[0] = (alpha_s[0] * j_s[0] - alpha_j) / (alpha_s[0] * alpha_s[0] - alpha_sq);
-                for (int a = 1; a < 4; a++)
-                  ss_end[a] = (j_s[a] - alpha_s[a] * ss_end[0]) / alpha_s[0];
-              }
-            }
-
-            // Couple with nonzero absorptivity and rotativity
-            else
-            {
-              // Calculate coefficients needed for coupling matrices
-              double alpha_rho = alpha_s[1] * rho_s[1] + alpha_s[3] * rho_s[3];
-              double alpha_sq_rho_sq = alpha_sq - rho_sq;
-              double lambda_a =
-                  std::sqrt(alpha_sq_rho_sq * alpha_sq_rho_sq / 4.0 + alpha_rho * alpha_rho);
-              double lambda_b = alpha_sq_rho_sq / 2.0;
-              double lambda_1 = std::sqrt(lambda_a + lambda_b);
-              double lambda_2 = std::sqrt(lambda_a - lambda_b);
-              double coefficient_theta = lambda_1 * lambda_1 + lambda_2 * lambda_2;
-              double s = alpha_rho >= 0.0 ? 1.0 : -1.0;
-
-              // Calculate coupling matrix 1
-              double mm_1[4][4] = {};
-              for (int a = 0; a < 4; a++)
-                mm_1[a][a] = 1.0;
-
-              // Calculate coupling matrix 2
-              double mm_2[4][4] = {};
-              mm_2[0][1] = lambda_2 * alpha_s[1] - s * lambda_1 * rho_s[1];
-              mm_2[0][3] = lambda_2 * alpha_s[3] - s * lambda_1 * rho_s[3];
-              mm_2[1][2] = s * lambda_1 * alpha_s[3] + lambda_2 * rho_s[3];
-              mm_2[1][2] = s * lambda_1 * alpha_s[1] + lambda_2 * rho_s[1];
-              mm_2[1][0] = mm_2[0][1];
-              mm_2[2][0] = mm_2[0][2];
-              mm_2[3][0] = mm_2[0][3];
-              mm_2[2][1] = -mm_2[1][2];
-              mm_2[3][1] = -mm_2[1][3];
-              mm_2[3][2] = -mm_2[2][3];
-              for (int a = 0; a < 4; a++)
-                for (int b = 0; b < 4; b++)
-                  mm_2[a][b] *= 1.0 / coefficient_theta;
-
-              // Calculate coupling matrix 3
-              double mm_3[4][4] = {};
-              mm_3[0][1] = lambda_1 * alpha_s[1] + s * lambda_2 * rho_s[1];
-              mm_3[0][3] = lambda_1 * alpha_s[3] + s * lambda_2 * rho_s[3];
-              mm_3[1][2] = -(s * lambda_2 * alpha_s[3] - lambda_1 * rho_s[3]);
-              mm_3[1][2] = -(s * lambda_2 * alpha_s[1] - lambda_1 * rho_s[1]);
-              mm_3[1][0] = mm_3[0][1];
-              mm_3[2][0] = mm_3[0][2];
-              mm_3[3][0] = mm_3[0][3];
-              mm_3[2][1] = -mm_3[1][2];
-              mm_3[3][1] = -mm_3[1][3];
-              mm_3[3][2] = -mm_3[2][3];
-              for (int a = 0; a < 4; a++)
-                for (int b = 0; b < 4; b++)
-                  mm_3[a][b] *= 1.0 / coefficient_theta;
-
-              // Calculate coupling matrix 4
-              double mm_4[4][4] = {};
-              mm_4[0][0] = (alpha_sq + rho_sq) / 2.0;
-              mm_4[1][1] =
-                  alpha_s[1] * alpha_s[1] + rho_s[1] * rho_s[1] - (alpha_sq + rho_sq) / 2.0;
-              mm_4[2][2] = -(alpha_sq + rho_sq) / 2.0;
-              mm_4[3][3] =
-                  alpha_s[3] * alpha_s[3] + rho_s[3] * rho_s[3] - (alpha_sq + rho_sq) / 2.0;
-              mm_4[0][2] = alpha_s[1] * rho_s[3] - alpha_s[3] * rho_s[1];
-              mm_4[1][3] = alpha_s[3] * alpha_s[1] + rho_s[3] * rho_s[1];
-              mm_4[1][0] = -mm_4[0][1];
-              mm_4[2][0] = -mm_4[0][2];
-              mm_4[3][0] = -mm_4[0][3];
-              mm_4[2][1] = mm_4[1][2];
-              mm_4[3][1] = mm_4[1][3];
-              mm_4[3][2] = mm_4[2][3];
-              for (int a = 0; a < 4; a++)
-                for (int b = 0; b < 4; b++)
-                  mm_4[a][b] *= 2.0 / coefficient_theta;
-
-              // Calculate coupling polynomial O (L 10)
-              double exp, sin, cos, sinh, cosh;
-              double oo[4][4] = {};
-              if (optically_thin)
-              {
-                exp = std::exp(-delta_tau);
-                sin = std::sin(lambda_2 * delta_lambda_cgs);
-                cos = std::cos(lambda_2 * delta_lambda_cgs);
-                sinh = std::sinh(lambda_1 * delta_lambda_cgs);
-                cosh = std::cosh(lambda_1 * delta_lambda_cgs);
-                for (int a = 0; a < 4; a++)
-                  for (int b = 0; b < 4; b++)
-                    oo[a][b] = exp * (0.5 * (mm_1[a][b] + mm_4[a][b]) * cosh
-                        + 0.5 * (mm_1[a][b] - mm_4[a][b]) * cos - mm_2[a][b] * sin
-                        - mm_3[a][b] * sinh);
-              }
-
-              // Calculate coupling polynomial integral P (I 24)
-              double pp[4][4] = {};
-              double f_1 = 1.0 / (alpha_s[0] * alpha_s[0] - lambda_1 * lambda_1);
-              double f_2 = 1.0 / (alpha_s[0] * alpha_s[0] + lambda_2 * lambda_2);
-              for (int a = 0; a < 4; a++)
-                for (int b = 0; b < 4; b++)
-                {
-                  double cosh_term = -lambda_1 * f_1 * mm_3[a][b]
-                      + 0.5 * alpha_s[0] * f_1 * (mm_1[a][b] + mm_4[a][b]);
-                  double cos_term = -lambda_2 * f_2 * mm_2[a][b]
-                      + 0.5 * alpha_s[0] * f_2 * (mm_1[a][b] - mm_4[a][b]);
-                  pp[a][b] = cosh_term + cos_term;
-                  if (optically_thin)
-                  {
-                    double sin_term = -alpha_s[0] * f_2 * mm_2[a][b]
-                        - 0.5 * lambda_2 * f_2 * (mm_1[a][b] - mm_4[a][b]);
-                    double sinh_term = -alpha_s[0] * f_1 * mm_3[a][b]
-                        + 0.5 * lambda_1 * f_1 * (mm_1[a][b] + mm_4[a][b]);
-                    pp[a][b] -= exp
-                        * (cosh_term * cosh + cos_term * cos + sin_term * sin + sinh_term * sinh);
-                  }
-                }
-
-
-              // Apply coupling polynomials
-              if (optically_thin)
-                for (int a = 0; a < 4; a++)
-                  for (int b = 0; b < 4; b++)
-                    ss_end[a] += pp[a][b] * j_s[b] + oo[a][b] * ss_start[b];
-              else
-                for (int a = 0; a < 4; a++)
-                  for (int b = 0; b < 4; b++)
-                    ss_end[a] += pp[a][b] * j_s[b];
-            }
+            int index = image_offset_tau_int + l * CellValues::num_cell_values + a;
+            image[adaptive_level](index,m) = cell_values[adaptive_level](a,row,c);
           }
+      }
+      if (do_crossings and l == 0)
+      {
+        bool plane_sign_new = camera_x[1] * x1 + camera_x[2] * x2 + camera_x[3] * x3 > 0.0;
+        if (plane_sign_new != plane_sign)
+          crossings_count++;
+        plane_sign = plane_sign_new;
+      }
 
-          // Ensure state is physically admissible
-          ss_end[0] = std::max(ss_end[0], 0.0);
-          double ss_pol = ss_end[1] * ss_end[1] + ss_end[2] * ss_end[2] + ss_end[3] * ss_end[3];
-          if (ss_pol > ss_end[0] * ss_end[0])
-          {
-            double factor = std::sqrt(ss_end[0] * ss_end[0] / ss_pol);
-            ss_end[1] *= factor;
-            ss_end[2] *= factor;
-            ss_end[3] *= factor;
-          }
+      // Couple to matter
+      double ss_end[4];
+      CoupleStokes(j_s, alpha_s, rho_s, delta_lambda_cgs, ss_start, ss_end);
 
-          // Calculate orthonormal-frame N after coupling to fluid (I 13)
-          for (int mu = 0; mu < 4; mu++)
-            for (int nu = 0; nu < 4; nu++)
-              nn_tet_con[mu][nu] = 0.0;
-          nn_tet_con[1][1] = ss_end[0] + ss_end[1];
-          nn_tet_con[2][2] = ss_end[0] - ss_end[1];
-          nn_tet_con[1][2] = ss_end[2] - Math::i * ss_end[3];
-          nn_tet_con[2][1] = ss_end[2] + Math::i * ss_end[3];
-
-          // Transform N into coordinate frame
-          std::complex<double> temp_f[4][4] = {};
-          for (int nu = 0; nu < 4; nu++)
-            for (int a = 0; a < 4; a++)
-              for (int b = 0; b < 4; b++)
-                temp_f[nu][a] += tetrad[b][nu] * nn_tet_con[a][b];
-          for (int mu = 0; mu < 4; mu++)
-            for (int nu = 0; nu < 4; nu++)
-            {
-              nn_con[mu][nu] = 0.0;
-              for (int a = 0; a < 4; a++)
-                nn_con[mu][nu] += tetrad[a][mu] * temp_f[nu][a];
-            }
-
-          // Parallel-transport N by second half step
-          for (int mu = 0; mu < 4; mu++)
-            for (int nu = 0; nu < 4; nu++)
-              nn_con_temp[mu][nu] = nn_con[mu][nu];
-          double temp_g[4][4] = {};
-          for (int mu = 0; mu < 4; mu++)
-            for (int beta = 0; beta < 4; beta++)
-              for (int alpha = 0; alpha < 4; alpha++)
-                temp_g[mu][beta] += kcon[alpha] * connection[mu][alpha][beta];
-          delta_lambda_local = (delta_lambda + delta_lambda_new) / 4.0;
-          for (int mu = 0; mu < 4; mu++)
-            for (int nu = 0; nu < 4; nu++)
-            {
-              std::complex<double> dnn_dlambda = 0.0;
-              for (int beta = 0; beta < 4; beta++)
-                dnn_dlambda -= temp_g[mu][beta] * nn_con_temp[beta][nu]
-                    + temp_g[nu][beta] * nn_con_temp[mu][beta];
-              nn_con[mu][nu] += dnn_dlambda * delta_lambda_local;
-            }
-
-          // Store values in registers for next step
-          delta_lambda_old = delta_lambda;
-          for (int mu = 0; mu < 4; mu++)
-            kcon_old[mu] = kcon[mu];
-          for (int mu = 0; mu < 4; mu++)
-            for (int alpha = 0; alpha < 4; alpha++)
-              for (int beta = 0; beta < 4; beta++)
-                connection_old[mu][alpha][beta] = connection[mu][alpha][beta];
+      // Calculate orthonormal-frame N after coupling to fluid (I 13)
+      for (int mu = 0; mu < 4; mu++)
+        for (int nu = 0; nu < 4; nu++)
+          nn_tet_con[mu][nu] = 0.0;
+      nn_tet_con[1][1] = ss_end[0] + ss_end[1];
+      nn_tet_con[2][2] = ss_end[0] - ss_end[1];
+      nn_tet_con[1][2] = ss_end[2] - Math::i * ss_end[3];
+      nn_tet_con[2][1] = ss_end[2] + Math::i * ss_end[3];
+
+      // Transform N into coordinate frame
+      std::complex<double> temp_f[4][4] = {};
+      for (int nu = 0; nu < 4; nu++)
+        for (int a = 0; a < 4; a++)
+          for (int b = 0; b < 4; b++)
+            temp_f[nu][a] += tetrad[b][nu] * nn_tet_con[a][b];
+      for (int mu = 0; mu < 4; mu++)
+        for (int nu = 0; nu < 4; nu++)
+        {
+          nn_con[mu][nu] = 0.0;
+          for (int a = 0; a < 4; a++)
+            nn_con[mu][nu] += tetrad[a][mu] * temp_f[nu][a];
         }
 
-        // Store coherency tensor
-        for (int mu = 0; mu < 4; mu++)
-          for (int nu = 0; nu < 4; nu++)
-            nn(l,m,mu,nu) = nn_con[mu][nu];
-
-        // Store integrated quantities
-        if (image_lambda)
-          image[adaptive_level](image_offset_lambda+l,m) = integrated_lambda;
-        if (image_emission)
-          image[adaptive_level](image_offset_emission+l,m) = integrated_emission;
-        if (image_crossings and l == 0)
-          image[adaptive_level](image_offset_crossings,m) = static_cast<double>(crossings_count);
-
-        // Normalize integrated quantities
-        if (image_lambda_ave)
-          for (int a = 0; a < CellValues::num_cell_values; a++)
-          {
-            int index = image_offset_lambda_ave + l * CellValues::num_cell_values + a;
-            image[adaptive_level](index,m) /= integrated_lambda;
-          }
-        if (image_emission_ave)
-          for (int a = 0; a < CellValues::num_cell_values; a++)
-          {
-            int index = image_offset_emission_ave + l * CellValues::num_cell_values + a;
-            image[adaptive_level](index,m) /= integrated_emission;
-          }
+      // Parallel-transport N by second half step
+      for (int mu = 0; mu < 4; mu++)
+        for (int nu = 0; nu < 4; nu++)
+          nn_con_temp[mu][nu] = nn_con[mu][nu];
+      double temp_g[4][4] = {};
+      for (int mu = 0; mu < 4; mu++)
+        for (int beta = 0; beta < 4; beta++)
+          for (int alpha = 0; alpha < 4; alpha++)
+            temp_g[mu][beta] += kcon[alpha] * connection[mu][alpha][beta];
+      delta_lambda_local = (delta_lambda + delta_lambda_new) / 4.0;
+      for (int mu = 0; mu < 4; mu++)
+        for (int nu = 0; nu < 4; nu++)
+        {
+          std::complex<double> dnn_dlambda = 0.0;
+          for (int beta = 0; beta < 4; beta++)
+            dnn_dlambda -= temp_g[mu][beta] * nn_con_temp[beta][nu]
+                + temp_g[nu][beta] * nn_con_temp[mu][beta];
+          nn_con[mu][nu] += dnn_dlambda * delta_lambda_local;
+        }
+
+      // Store values in registers for next step
+      delta_lambda_old = delta_lambda;
+      for (int mu = 0; mu < 4; mu++)
+        kcon_old[mu] = kcon[mu];
+      for (int mu = 0; mu < 4; mu++)
+        for (int alpha = 0; alpha < 4; alpha++)
+          for (int beta = 0; beta < 4; beta++)
+            connection_old[mu][alpha][beta] = connection[mu][alpha][beta];
+    }
+
+    // Transform coherency tensor into camera frame
+    if (l == 0)
+      CameraTetrad(m, gcov_camera, tetrad_camera);
+    TransformPolarizedRay(m, l, gcov_camera, tetrad_camera, nn_con);
+
+    // Store integrated quantities
+    if (do_lambda)
+      image[adaptive_level](image_offset_lambda+l,m) = integrated_lambda;
+    if (do_emission)
+      image[adaptive_level](image_offset_emission+l,m) = integrated_emission;
+    if (do_crossings and l == 0)
+      image[adaptive_level](image_offset_crossings,m) = static_cast<double>(crossings_count);
+
+    // Normalize integrated quantities
+    if (do_lambda_ave)
+      for (int a = 0; a < CellValues::num_cell_values; a++)
+      {
+        int index = image_offset_lambda_ave + l * CellValues::num_cell_values + a;
+        image[adaptive_level](index,m) /= integrated_lambda;
+      }
+    if (do_emission_ave)
+      for (int a = 0; a < CellValues::num_cell_values; a++)
+      {
+        int index = image_offset_emission_ave + l * CellValues::num_cell_values + a;
+        image[adaptive_level](index,m) /= integrated_emission;
+      }
+  }
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for integrating polarized radiative transfer equation along a single ray via Stokes
+//     parameters
+// Inputs:
+//   m: ray index
+//   row: row of per-sample arrays holding ray
+// Outputs: (none)
+// Notes:
+//   Assumes camera_pos[adaptive_level], camera_dir[adaptive_level], sample_num[adaptive_level],
+//       sample_pos[adaptive_level], sample_dir[adaptive_level], sample_len[adaptive_level], and
+//       momentum_factors[adaptive_level] have been set, as has the given row of
+//       sample_uu1[adaptive_level], sample_uu2[adaptive_level], sample_uu3[adaptive_level],
+//       sample_bb1[adaptive_level], sample_bb2[adaptive_level], sample_bb3[adaptive_level],
+//       j_i[adaptive_level], j_q[adaptive_level], j_v[adaptive_level], alpha_i[adaptive_level],
+//       alpha_q[adaptive_level], alpha_v[adaptive_level], rho_q[adaptive_level], and
+//       rho_v[adaptive_level].
+//   Assumes given row of sample_cut[adaptive_level] has been set if
+//       model_type == ModelType::simulation, in which case the per-sample arrays hold values only
+//       for samples outside the cut region, stored contiguously.
+//   Assumes image[adaptive_level] has been allocated and initialized.
+//   Assumes no image quantities other than polarized light are requested.
+//   Rather than parallel-transporting the coherency tensor at each frequency, parallel-transports
+//       a single real polarization basis vector f, shared by all frequencies, and evolves Stokes
+//       parameters measured relative to f and its rotation by 90 degrees about k.
+//   At each sample, rotates Stokes parameters into the fluid tetrad by twice the angle between f
+//       and the tetrad 1-direction, couples to matter with CoupleStokes(), and rotates back.
+//   Transports f with the same half steps used for the coherency tensor in
+//       IntegratePolarizedRay(), so results agree with that function to within truncation error.
+//   Stores Stokes parameters relative to f in image[adaptive_level] while integrating, and
+//       transforms them into the camera frame at the end of the ray.
+void RadiationIntegrator::IntegrateStokesRay(int m, int row)
+{
+  // Calculate units
+  double x_unit = Physics::gg_msun * mass_msun / (Physics::c * Physics::c);
+
+  // Allocate scratch space
+  double delta_lambda_old = 0.0;
+  double kcon_old[4];
+  double gcov[4][4];
+  double gcon[4][4];
+  double connection[4][4][4];
+  double connection_old[4][4][4];
+  double tetrad[4][4];
+  double ff_con[4] = {};
+  double ff_con_temp[4] = {};
+
+  // Check number of steps
+  int num_steps = sample_num[adaptive_level](m);
+  if (num_steps <= 0)
+    return;
+  int n_start = -1;
+  int z_turnings_count = 0;
+  if (image_z_turnings)
+    FindZTurnings(m, num_steps, n_start, z_turnings_count);
+  if (n_start < 0)
+    n_start = 0;
+
+  // Locate stored values for first sample
+  bool compact = model_type == ModelType::simulation;
+  int c_start = 0;
+  for (int n = 0; n < n_start; n++)
+    if (not compact or not sample_cut[adaptive_level](row,n))
+      c_start++;
+
+  // Go through samples
+  int c_next = c_start;
+  for (int n = n_start; n < num_steps; n++)
+  {
+    // Locate stored values, noting samples in cut region have none
+    bool live = not compact or not sample_cut[adaptive_level](row,n);
+    int c = live ? c_next++ : 0;
+
+    // Extract affine step size
+    double delta_lambda = sample_len[adaptive_level](m,n);
+    double delta_lambda_new = delta_lambda;
+    if (n < num_steps - 1)
+      delta_lambda_new = sample_len[adaptive_level](m,n+1);
+
+    // Extract geodesic position and covariant momentum
+    double x1 = sample_pos[adaptive_level](m,n,1);
+    double x2 = sample_pos[adaptive_level](m,n,2);
+    double x3 = sample_pos[adaptive_level](m,n,3);
+    double kcov[4];
+    kcov[0] = sample_dir[adaptive_level](m,n,0);
+    kcov[1] = sample_dir[adaptive_level](m,n,1);
+    kcov[2] = sample_dir[adaptive_level](m,n,2);
+    kcov[3] = sample_dir[adaptive_level](m,n,3);
+
+    // Extract model variables
+    double uu_sim[3] = {};
+    double bb_sim[3] = {};
+    if (live)
+    {
+      uu_sim[0] = sample_uu1[adaptive_level](row,c);
+      uu_sim[1] = sample_uu2[adaptive_level](row,c);
+      uu_sim[2] = sample_uu3[adaptive_level](row,c);
+      bb_sim[0] = sample_bb1[adaptive_level](row,c);
+      bb_sim[1] = sample_bb2[adaptive_level](row,c);
+      bb_sim[2] = sample_bb3[adaptive_level](row,c);
+    }
+
+    // Calculate geodesic metric and connection
+    CovariantGeodesicMetric(x1, x2, x3, gcov);
+    ContravariantGeodesicMetric(x1, x2, x3, gcon);
+    GeodesicConnection(x1, x2, x3, connection);
+    if (n == n_start)
+      for (int mu = 0; mu < 4; mu++)
+        for (int alpha = 0; alpha < 4; alpha++)
+          for (int beta = 0; beta < 4; beta++)
+            connection_old[mu][alpha][beta] = connection[mu][alpha][beta];
+    else
+      for (int mu = 0; mu < 4; mu++)
+        for (int alpha = 0; alpha < 4; alpha++)
+          for (int beta = 0; beta < 4; beta++)
+            connection_old[mu][alpha][beta] =
+                0.5 * (connection_old[mu][alpha][beta] + connection[mu][alpha][beta]);
+
+    // Calculate geodesic contravariant momentum
+    double kcon[4] = {};
+    for (int mu = 0; mu < 4; mu++)
+      for (int nu = 0; nu < 4; nu++)
+        kcon[mu] += gcon[mu][nu] * kcov[nu];
+    if (n == n_start)
+      for (int mu = 0; mu < 4; mu++)
+        kcon_old[mu] = kcon[mu];
+    else
+      for (int mu = 0; mu < 4; mu++)
+        kcon_old[mu] = 0.5 * (kcon_old[mu] + kcon[mu]);
+
+    // Parallel-transport f by first half step
+    if (n > n_start)
+    {
+      double temp_a[4][4] = {};
+      for (int mu = 0; mu < 4; mu++)
+        for (int beta = 0; beta < 4; beta++)
+          for (int alpha = 0; alpha < 4; alpha++)
+            temp_a[mu][beta] += kcon_old[alpha] * connection_old[mu][alpha][beta];
+      double delta_lambda_local = (delta_lambda_old + delta_lambda) / 2.0;
+      for (int mu = 0; mu < 4; mu++)
+      {
+        double dff_dlambda = 0.0;
+        for (int beta = 0; beta < 4; beta++)
+          dff_dlambda -= temp_a[mu][beta] * ff_con[beta];
+        ff_con_temp[mu] += dff_dlambda * delta_lambda_local;
       }
+      for (int mu = 0; mu < 4; mu++)
+        ff_con[mu] = ff_con_temp[mu];
+    }
+
+    // Calculate orthonormal tetrad, initializing f to its 1-direction
+    FluidTetrad(x1, x2, x3, kcon, kcov, gcov, gcon, uu_sim, bb_sim, tetrad);
+    if (n == n_start)
+      for (int mu = 0; mu < 4; mu++)
+        ff_con[mu] = tetrad[1][mu];
+
+    // Calculate rotation from f to tetrad
+    double ff_cov[4] = {};
+    for (int mu = 0; mu < 4; mu++)
+      for (int nu = 0; nu < 4; nu++)
+        ff_cov[mu] += gcov[mu][nu] * ff_con[nu];
+    double ff_1 = 0.0;
+    double ff_2 = 0.0;
+    for (int mu = 0; mu < 4; mu++)
+    {
+      ff_1 += tetrad[1][mu] * ff_cov[mu];
+      ff_2 += tetrad[2][mu] * ff_cov[mu];
     }
+    double ff_sq = ff_1 * ff_1 + ff_2 * ff_2;
+    double cos_2chi = ff_sq > 0.0 ? (ff_1 * ff_1 - ff_2 * ff_2) / ff_sq : 1.0;
+    double sin_2chi = ff_sq > 0.0 ? 2.0 * ff_1 * ff_2 / ff_sq : 0.0;
 
-    // Go through pixels, transforming into camera frame
-    #pragma omp for schedule(static) collapse(2)
+    // Go through frequencies
     for (int l = 0; l < image_num_frequencies; l++)
-      for (int m = 0; m < num_pix; m++)
+    {
+      // Calculate orthonormal-frame Stokes quantities before coupling to fluid
+      double ss_q = image[adaptive_level](l*4+1,m);
+      double ss_u = image[adaptive_level](l*4+2,m);
+      double ss_start[4];
+      ss_start[0] = image[adaptive_level](l*4+0,m);
+      ss_start[1] = ss_q * cos_2chi - ss_u * sin_2chi;
+      ss_start[2] = ss_q * sin_2chi + ss_u * cos_2chi;
+      ss_start[3] = image[adaptive_level](l*4+3,m);
+
+      // Extract emissivity, absorptivity, and rotativity coefficients
+      double j_s[4] = {};
+      double alpha_s[4] = {};
+      double rho_s[4] = {};
+      if (live)
       {
-        // Extract geodesic position and covariant momentum
-        double x = camera_pos[adaptive_level](m,1);
-        double y = camera_pos[adaptive_level](m,2);
-        double z = camera_pos[adaptive_level](m,3);
-        double kcov[4];
-        kcov[0] = camera_dir[adaptive_level](m,0);
-        kcov[1] = camera_dir[adaptive_level](m,1);
-        kcov[2] = camera_dir[adaptive_level](m,2);
-        kcov[3] = camera_dir[adaptive_level](m,3);
-
-        // Calculate metric
-        CovariantGeodesicMetric(x, y, z, gcov);
-        ContravariantGeodesicMetric(x, y, z, gcon);
-
-        // Calculate geodesic contravariant momentum
-        double kcon[4] = {};
-        for (int mu = 0; mu < 4; mu++)
-          for (int nu = 0; nu < 4; nu++)
-            kcon[mu] += gcon[mu][nu] * kcov[nu];
-
-        // Calculate orientation
-        double up_con[4];
-        up_con[0] = camera_u_con[0] * camera_vert_con_c[0] - (camera_u_cov[1] * camera_vert_con_c[1]
-            + camera_u_cov[2] * camera_vert_con_c[2] + camera_u_cov[3] * camera_vert_con_c[3])
-            / camera_u_cov[0];
-        up_con[1] = camera_vert_con_c[1] + camera_u_con[1] * camera_vert_con_c[0];
-        up_con[2] = camera_vert_con_c[2] + camera_u_con[2] * camera_vert_con_c[0];
-        up_con[3] = camera_vert_con_c[3] + camera_u_con[3] * camera_vert_con_c[0];
-
-        // Calculate orthonormal tetrad
-        Tetrad(camera_u_con, camera_u_cov, kcon, kcov, up_con, gcov, gcon, tetrad);
-
-        // Transform N into orthonormal frame
-        std::complex<double> temp_a[4][4] = {};
-        for (int nu = 0; nu < 4; nu++)
-          for (int alpha = 0; alpha < 4; alpha++)
-            for (int beta = 0; beta < 4; beta++)
-              temp_a[nu][alpha] += gcov[nu][beta] * nn(l,m,alpha,beta);
-        std::complex<double> temp_b[4][4] = {};
-        for (int mu = 0; mu < 4; mu++)
-          for (int nu = 0; nu < 4; nu++)
-            for (int alpha = 0; alpha < 4; alpha++)
-              temp_b[mu][nu] += gcov[mu][alpha] * temp_a[nu][alpha];
-        std::complex<double> temp_c[4][4] = {};
+        j_s[0] = j_i[adaptive_level](row,c,l);
+        j_s[1] = j_q[adaptive_level](row,c,l);
+        j_s[3] = j_v[adaptive_level](row,c,l);
+        alpha_s[0] = alpha_i[adaptive_level](row,c,l);
+        alpha_s[1] = alpha_q[adaptive_level](row,c,l);
+        alpha_s[3] = alpha_v[adaptive_level](row,c,l);
+        rho_s[1] = rho_q[adaptive_level](row,c,l);
+        rho_s[3] = rho_v[adaptive_level](row,c,l);
+      }
+
+      // Couple to matter
+      double delta_lambda_cgs =
+          delta_lambda * x_unit / (image_frequencies(l) * momentum_factors[adaptive_level](m));
+      double ss_end[4];
+      CoupleStokes(j_s, alpha_s, rho_s, delta_lambda_cgs, ss_start, ss_end);
+
+      // Store Stokes quantities relative to f after coupling to fluid
+      image[adaptive_level](l*4+0,m) = ss_end[0];
+      image[adaptive_level](l*4+1,m) = ss_end[1] * cos_2chi + ss_end[2] * sin_2chi;
+      image[adaptive_level](l*4+2,m) = -ss_end[1] * sin_2chi + ss_end[2] * cos_2chi;
+      image[adaptive_level](l*4+3,m) = ss_end[3];
+    }
+
+    // Parallel-transport f by second half step
+    for (int mu = 0; mu < 4; mu++)
+      ff_con_temp[mu] = ff_con[mu];
+    double temp_b[4][4] = {};
+    for (int mu = 0; mu < 4; mu++)
+      for (int beta = 0; beta < 4; beta++)
+        for (int alpha = 0; alpha < 4; alpha++)
+          temp_b[mu][beta] += kcon[alpha] * connection[mu][alpha][beta];
+    double delta_lambda_local = (delta_lambda + delta_lambda_new) / 4.0;
+    for (int mu = 0; mu < 4; mu++)
+    {
+      double dff_dlambda = 0.0;
+      for (int beta = 0; beta < 4; beta++)
+        dff_dlambda -= temp_b[mu][beta] * ff_con_temp[beta];
+      ff_con[mu] += dff_dlambda * delta_lambda_local;
+    }
+
+    // Store values in registers for next step
+    delta_lambda_old = delta_lambda;
+    for (int mu = 0; mu < 4; mu++)
+      kcon_old[mu] = kcon[mu];
+    for (int mu = 0; mu < 4; mu++)
+      for (int alpha = 0; alpha < 4; alpha++)
+        for (int beta = 0; beta < 4; beta++)
+          connection_old[mu][alpha][beta] = connection[mu][alpha][beta];
+  }
+
+  // Calculate rotation from f to camera frame
+  CameraTetrad(m, gcov, tetrad);
+  double ff_cov[4] = {};
+  for (int mu = 0; mu < 4; mu++)
+    for (int nu = 0; nu < 4; nu++)
+      ff_cov[mu] += gcov[mu][nu] * ff_con[nu];
+  double ff_1 = 0.0;
+  double ff_2 = 0.0;
+  for (int mu = 0; mu < 4; mu++)
+  {
+    ff_1 += tetrad[1][mu] * ff_cov[mu];
+    ff_2 += tetrad[2][mu] * ff_cov[mu];
+  }
+  double ff_sq = ff_1 * ff_1 + ff_2 * ff_2;
+  double cos_2chi = ff_sq > 0.0 ? (ff_1 * ff_1 - ff_2 * ff_2) / ff_sq : 1.0;
+  double sin_2chi = ff_sq > 0.0 ? 2.0 * ff_1 * ff_2 / ff_sq : 0.0;
+
+  // Transform Stokes quantities into camera frame and from invariant to standard forms
+  for (int l = 0; l < image_num_frequencies; l++)
+  {
+    double nu_cu = image_frequencies(l) * image_frequencies(l) * image_frequencies(l);
+    double ss_q = image[adaptive_level](l*4+1,m);
+    double ss_u = image[adaptive_level](l*4+2,m);
+    image[adaptive_level](l*4+0,m) *= nu_cu;
+    image[adaptive_level](l*4+1,m) = (ss_q * cos_2chi - ss_u * sin_2chi) * nu_cu;
+    image[adaptive_level](l*4+2,m) = (ss_q * sin_2chi + ss_u * cos_2chi) * nu_cu;
+    image[adaptive_level](l*4+3,m) *= nu_cu;
+  }
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for calculating orthonormal tetrad of fluid at a sample
+// Inputs:
+//   x1, x2, x3: geodesic coordinates of sample
+//   kcon: contravariant components of null momentum
+//   kcov: covariant components of null momentum
+//   gcov: covariant geodesic metric components
+//   gcon: contravariant geodesic metric components
+//   uu_sim: simulation velocity components u^1, u^2, u^3 in normal frame
+//   bb_sim: simulation magnetic field components B^1, B^2, B^3
+// Outputs:
+//   tetrad: components set
+// Notes:
+//   Assumes tetrad is allocated to be 4*4.
+//   Constructs tetrad with Tetrad(), using magnetic field as up direction if it is nonzero.
+void RadiationIntegrator::FluidTetrad(double x1, double x2, double x3, const double kcon[4],
+    const double kcov[4], const double gcov[4][4], const double gcon[4][4],
+    const double uu_sim[3], const double bb_sim[3], double tetrad[4][4]) const
+{
+  // Allocate scratch space
+  double gcov_sim[4][4];
+  double gcon_sim[4][4];
+  double jacobian[4][4];
+
+  // Calculate simulation metric
+  CovariantSimulationMetric(x1, x2, x3, gcov_sim);
+  ContravariantSimulationMetric(x1, x2, x3, gcon_sim);
+
+  // Calculate simulation velocity
+  double uu0_sim = std::sqrt(1.0 + gcov_sim[1][1] * uu_sim[0] * uu_sim[0]
+      + 2.0 * gcov_sim[1][2] * uu_sim[0] * uu_sim[1]
+      + 2.0 * gcov_sim[1][3] * uu_sim[0] * uu_sim[2]
+      + gcov_sim[2][2] * uu_sim[1] * uu_sim[1] + 2.0 * gcov_sim[2][3] * uu_sim[1] * uu_sim[2]
+      + gcov_sim[3][3] * uu_sim[2] * uu_sim[2]);
+  double lapse_sim = 1.0 / std::sqrt(-gcon_sim[0][0]);
+  double shift1_sim = -gcon_sim[0][1] / gcon_sim[0][0];
+  double shift2_sim = -gcon_sim[0][2] / gcon_sim[0][0];
+  double shift3_sim = -gcon_sim[0][3] / gcon_sim[0][0];
+  double ucon_sim[4];
+  ucon_sim[0] = uu0_sim / lapse_sim;
+  ucon_sim[1] = uu_sim[0] - shift1_sim * uu0_sim / lapse_sim;
+  ucon_sim[2] = uu_sim[1] - shift2_sim * uu0_sim / lapse_sim;
+  ucon_sim[3] = uu_sim[2] - shift3_sim * uu0_sim / lapse_sim;
+  double ucov_sim[4] = {};
+  for (int mu = 0; mu < 4; mu++)
+    for (int nu = 0; nu < 4; nu++)
+      ucov_sim[mu] += gcov_sim[mu][nu] * ucon_sim[nu];
+
+  // Calculate simulation magnetic field
+  double bcon_sim[4];
+  bcon_sim[0] = ucov_sim[1] * bb_sim[0] + ucov_sim[2] * bb_sim[1] + ucov_sim[3] * bb_sim[2];
+  bcon_sim[1] = (bb_sim[0] + bcon_sim[0] * ucon_sim[1]) / ucon_sim[0];
+  bcon_sim[2] = (bb_sim[1] + bcon_sim[0] * ucon_sim[2]) / ucon_sim[0];
+  bcon_sim[3] = (bb_sim[2] + bcon_sim[0] * ucon_sim[3]) / ucon_sim[0];
+
+  // Calculate Jacobian of transformation from simulation to geodesic coordinates
+  CoordinateJacobian(x1, x2, x3, jacobian);
+
+  // Transform contravariant velocity and magnetic field to geodesic coordinates
+  double ucon[4] = {};
+  for (int mu = 0; mu < 4; mu++)
+    for (int nu = 0; nu < 4; nu++)
+      ucon[mu] += jacobian[mu][nu] * ucon_sim[nu];
+  double bcon[4] = {};
+  for (int mu = 0; mu < 4; mu++)
+    for (int nu = 0; nu < 4; nu++)
+      bcon[mu] += jacobian[mu][nu] * bcon_sim[nu];
+
+  // Calculate covariant velocity
+  double ucov[4] = {};
+  for (int mu = 0; mu < 4; mu++)
+    for (int nu = 0; nu < 4; nu++)
+      ucov[mu] += gcov[mu][nu] * ucon[nu];
+
+  // Calculate orthonormal tetrad
+  double upcon[4] = {};
+  if (bb_sim[0] == 0.0 and bb_sim[1] == 0.0 and bb_sim[2] == 0.0)
+    upcon[3] = 1.0;
+  else
+    for (int mu = 0; mu < 4; mu++)
+      upcon[mu] = bcon[mu];
+  Tetrad(ucon, ucov, kcon, kcov, upcon, gcov, gcon, tetrad);
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for coupling Stokes parameters to matter over a single step
+// Inputs:
+//   j_s: emissivities (j_I, j_Q, j_U, j_V) in orthonormal frame
+//   alpha_s: absorptivities (alpha_I, alpha_Q, alpha_U, alpha_V) in orthonormal frame
+//   rho_s: rotativities (0, rho_Q, rho_U, rho_V) in orthonormal frame
+//   delta_lambda_cgs: path length in CGS units
+//   ss_start: Stokes parameters (I, Q, U, V) at start of step
+// Outputs:
+//   ss_start: overwritten with intermediate values if image_rotation_split == true
+//   ss_end: Stokes parameters (I, Q, U, V) at end of step
+// Notes:
+//   Assumes j_U, alpha_U, and rho_U vanish, as is the case for the tetrad chosen by Tetrad().
+//   Uses the analytic solution for constant coefficients, as in IntegratePolarizedRay().
+//   Optionally, coupling proceeds via Strang splitting of rotativity from emissivity and
+//       absorptivity as in the implementation of (I).
+//   Ensures the result is physically admissible, with I >= 0 and I^2 >= Q^2 + U^2 + V^2.
+//   References ipole paper 2018 MNRAS 475 43 (I).
+//   References 1985 SoPh 97 239 (L)
+void RadiationIntegrator::CoupleStokes(const double j_s[4], const double alpha_s[4],
+    const double rho_s[4], double delta_lambda_cgs, double ss_start[4], double ss_end[4]) const
+{
+  // Calculate optical depth
+  double delta_tau = alpha_s[0] * delta_lambda_cgs;
+  bool optically_thin = delta_tau <= delta_tau_max;
+
+  // Prepare to couple to matter
+  double alpha_sq = alpha_s[1] * alpha_s[1] + alpha_s[3] * alpha_s[3];
+  double alpha_p = std::sqrt(alpha_sq);
+  double rho_sq = rho_s[1] * rho_s[1] + rho_s[3] * rho_s[3];
+  double rho_p = std::sqrt(rho_sq);
+  for (int a = 0; a < 4; a++)
+    ss_end[a] = 0.0;
+
+  // Couple via splitting of rotativity from absorptivity/emissivity
+  if (image_rotation_split)
+  {
+    // Couple first half with no absorptivity
+    if (alpha_s[0] == 0.0)
+      for (int a = 0; a < 4; a++)
+        ss_end[a] = ss_start[a] + j_s[a] * delta_lambda_cgs / 2.0;
+
+    // Couple first half with no polarized absorptivity but with nonzero absorptivity
+    else if (alpha_p == 0.0)
+    {
+      // Optically thin case
+      if (optically_thin)
+      {
+        double exp_neg = std::exp(-delta_tau / 2.0);
+        double expm1 = std::expm1(delta_tau / 2.0);
+        for (int a = 0; a < 4; a++)
+          ss_end[a] = exp_neg * (ss_start[a] + j_s[a] / alpha_s[0] * expm1);
+      }
+
+      // Optically thick case
+      else
+        for (int a = 0; a < 4; a++)
+          ss_end[a] = j_s[a] / alpha_s[0];
+    }
+
+    // Couple first half with nonzero polarized absorptivity
+    else
+    {
+      // Optically thin case (I A14-A17)
+      if (optically_thin)
+      {
+        double exp_neg_i = std::exp(-delta_tau / 2.0);
+        double exp_neg_p = std::exp(-alpha_p * delta_lambda_cgs / 2.0);
+        double sinh_p = std::sinh(alpha_p * delta_lambda_cgs / 2.0);
+        double cosh_p = std::cosh(alpha_p * delta_lambda_cgs / 2.0);
+        double coshm1_p =
+            0.5 * (std::expm1(alpha_p * delta_lambda_cgs / 2.0) + exp_neg_p - 1.0);
+        double alpha_ss = alpha_s[1] * ss_start[1] + alpha_s[3] * ss_start[3];
+        double alpha_j = alpha_s[1] * j_s[1] + alpha_s[3] * j_s[3];
+        double alpha_i_p_factor = 1.0 / (alpha_s[0] * alpha_s[0] - alpha_sq);
+        ss_end[0] = (ss_start[0] * cosh_p - alpha_ss / alpha_p * sinh_p) * exp_neg_i
+            + alpha_j * alpha_i_p_factor * (-1.0 + (alpha_s[0] * sinh_p + alpha_p * cosh_p)
+            / alpha_p * exp_neg_p) + alpha_s[0] * j_s[0] * alpha_i_p_factor * (1.0
+            - (alpha_s[0] * cosh_p + alpha_p * sinh_p) / alpha_s[0] * exp_neg_p);
+
+        for (int a = 1; a < 4; a++)
+        {
+          double term_1 = (ss_start[a] + alpha_s[a] * alpha_ss / alpha_sq * coshm1_p
+              - ss_start[0] * alpha_s[a] / alpha_p * sinh_p) * exp_neg_i;
+          double term_2 = j_s[a] * (1.0 - exp_neg_i) / alpha_s[0];
+          double term_3 = alpha_j * alpha_s[a] / alpha_s[0] * alpha_i_p_factor * (1.0 - (1.0
+              - alpha_s[0] * alpha_s[0] / alpha_sq - alpha_s[0] / alpha_sq * (alpha_s[0]
+              * cosh_p + alpha_p * sinh_p)) * exp_neg_i);
+          double term_4 = j_s[0] * alpha_s[a] / alpha_p * alpha_i_p_factor * (-alpha_p +
+              (alpha_p * cosh_p + alpha_s[0] * sinh_p) * exp_neg_i);
+          ss_end[a] = term_1 + term_2 + term_3 + term_4;
+        }
+      }
+
+      // Optically thick case
+      else
+      {
+        double alpha_j = alpha_s[1] * j_s[1] + alpha_s[3] * j_s[3];
+        ss_end[0] = (alpha_s[0] * j_s[0] - alpha_j) / (alpha_s[0] * alpha_s[0] - alpha_sq);
+        for (int a = 1; a < 4; a++)
+          ss_end[a] = (j_s[a] - alpha_s[a] * ss_end[0]) / alpha_s[0];
+      }
+    }
+
+    // Ensure state is physically admissible
+    ss_end[0] = std::max(ss_end[0], 0.0);
+    double ss_pol = ss_end[1] * ss_end[1] + ss_end[2] * ss_end[2] + ss_end[3] * ss_end[3];
+    if (ss_pol > ss_end[0] * ss_end[0])
+    {
+      double factor = std::sqrt(ss_end[0] * ss_end[0] / ss_pol);
+      ss_end[1] *= factor;
+      ss_end[2] *= factor;
+      ss_end[3] *= factor;
+    }
+
+    // Reset starting Stokes parameters
+    for (int a = 0; a < 4; a++)
+      ss_start[a] = ss_end[a];
+
+    // Couple with no absorptivity but nonzero rotativity (I A2-A5)
+    if (rho_p != 0.0)
+    {
+      double cos_rho = std::cos(rho_p * delta_lambda_cgs);
+      double sin_rho = std::sin(rho_p * delta_lambda_cgs);
+      double sin_sq_rho = std::sin(rho_p * delta_lambda_cgs / 2.0);
+      sin_sq_rho = sin_sq_rho * sin_sq_rho;
+      double rho_ss = rho_s[1] * ss_start[1] + rho_s[3] * ss_start[3];
+      ss_end[0] = ss_start[0];
+      ss_end[1] = ss_start[1] * cos_rho + 2.0 * rho_s[1] * rho_ss / rho_sq * sin_sq_rho
+          - rho_s[3] * ss_start[2] / rho_p * sin_rho;
+      ss_end[2] = ss_start[2] * cos_rho
+          + (rho_s[3] * ss_start[1] - rho_s[1] * ss_start[3]) / rho_p * sin_rho;
+      ss_end[3] = ss_start[3] * cos_rho + 2.0 * rho_s[3] * rho_ss / rho_sq * sin_sq_rho
+          + rho_s[1] * ss_start[2] / rho_p * sin_rho;
+    }
+
+    // Ensure state is physically admissible
+    ss_pol = ss_end[1] * ss_end[1] + ss_end[2] * ss_end[2] + ss_end[3] * ss_end[3];
+    if (ss_pol > ss_end[0] * ss_end[0])
+    {
+      double factor = std::sqrt(ss_end[0] * ss_end[0] / ss_pol);
+      ss_end[1] *= factor;
+      ss_end[2] *= factor;
+      ss_end[3] *= factor;
+    }
+
+    // Reset starting Stokes parameters
+    for (int a = 0; a < 4; a++)
+      ss_start[a] = ss_end[a];
+
+    // Couple second half with no absorptivity
+    if (alpha_s[0] == 0.0)
+      for (int a = 0; a < 4; a++)
+        ss_end[a] = ss_start[a] + j_s[a] * delta_lambda_cgs / 2.0;
+
+    // Couple second half with no polarized absorptivity but with nonzero absorptivity
+    else if (alpha_p == 0.0)
+    {
+      // Optically thin case
+      if (optically_thin)
+      {
+        double exp_neg = std::exp(-delta_tau / 2.0);
+        double expm1 = std::expm1(delta_tau / 2.0);
+        for (int a = 0; a < 4; a++)
+          ss_end[a] = exp_neg * (ss_start[a] + j_s[a] / alpha_s[0] * expm1);
+      }
+
+      // Optically thick case
+      else
+        for (int a = 0; a < 4; a++)
+          ss_end[a] = j_s[a] / alpha_s[0];
+    }
+
+    // Couple second half with nonzero polarized absorptivity
+    else
+    {
+      // Optically thin case (I A14-A17)
+      if (optically_thin)
+      {
+        double exp_neg_i = std::exp(-delta_tau / 2.0);
+        double exp_neg_p = std::exp(-alpha_p * delta_lambda_cgs / 2.0);
+        double sinh_p = std::sinh(alpha_p * delta_lambda_cgs / 2.0);
+        double cosh_p = std::cosh(alpha_p * delta_lambda_cgs / 2.0);
+        double coshm1_p =
+            0.5 * (std::expm1(alpha_p * delta_lambda_cgs / 2.0) + exp_neg_p - 1.0);
+        double alpha_ss = alpha_s[1] * ss_start[1] + alpha_s[3] * ss_start[3];
+        double alpha_j = alpha_s[1] * j_s[1] + alpha_s[3] * j_s[3];
+        double alpha_i_p_factor = 1.0 / (alpha_s[0] * alpha_s[0] - alpha_sq);
+        ss_end[0] = (ss_start[0] * cosh_p - alpha_ss / alpha_p * sinh_p) * exp_neg_i
+            + alpha_j * alpha_i_p_factor * (-1.0 + (alpha_s[0] * sinh_p + alpha_p * cosh_p)
+            / alpha_p * exp_neg_p) + alpha_s[0] * j_s[0] * alpha_i_p_factor * (1.0
+            - (alpha_s[0] * cosh_p + alpha_p * sinh_p) / alpha_s[0] * exp_neg_p);
+        for (int a = 1; a < 4; a++)
+        {
+          double term_1 = (ss_start[a] + alpha_s[a] * alpha_ss / alpha_sq * coshm1_p
+              - ss_start[0] * alpha_s[a] / alpha_p * sinh_p) * exp_neg_i;
+          double term_2 = j_s[a] * (1.0 - exp_neg_i) / alpha_s[0];
+          double term_3 = alpha_j * alpha_s[a] / alpha_s[0] * alpha_i_p_factor * (1.0 - (1.0
+              - alpha_s[0] * alpha_s[0] / alpha_sq - alpha_s[0] / alpha_sq * (alpha_s[0]
+              * cosh_p + alpha_p * sinh_p)) * exp_neg_i);
+          double term_4 = j_s[0] * alpha_s[a] / alpha_p * alpha_i_p_factor * (-alpha_p +
+              (alpha_p * cosh_p + alpha_s[0] * sinh_p) * exp_neg_i);
+          ss_end[a] = term_1 + term_2 + term_3 + term_4;
+        }
+      }
+
+      // Optically thick case
+      else
+      {
+        double alpha_j = alpha_s[1] * j_s[1] + alpha_s[3] * j_s[3];
+        ss_end[0] = (alpha_s[0] * j_s[0] - alpha_j) / (alpha_s[0] * alpha_s[0] - alpha_sq);
+        for (int a = 1; a < 4; a++)
+          ss_end[a] = (j_s[a] - alpha_s[a] * ss_end[0]) / alpha_s[0];
+      }
+    }
+  }
+
+  // Couple with no splitting
+  else
+  {
+    // Couple with no absorptivity or rotativity
+    if (alpha_s[0] == 0.0 and rho_p == 0.0)
+      for (int a = 0; a < 4; a++)
+        ss_end[a] = ss_start[a] + j_s[a] * delta_lambda_cgs;
+
+    // Couple with no polarized absorptivity or rotativity but with nonzero absorptivity
+    else if (alpha_p == 0.0 and rho_p == 0.0)
+    {
+      // Optically thin case
+      if (optically_thin)
+      {
+        double exp_neg = std::exp(-delta_tau);
+        double expm1 = std::expm1(delta_tau);
+        for (int a = 0; a < 4; a++)
+          ss_end[a] = exp_neg * (ss_start[a] + j_s[a] / alpha_s[0] * expm1);
+      }
+
+      // Optically thick case
+      else
+        for (int a = 0; a < 4; a++)
+          ss_end[a] = j_s[a] / alpha_s[0];
+    }
+
+    // Couple with no absorptivity but nonzero rotativity (I A2-A5)
+    else if (alpha_s[0] == 0.0)
+    {
+      double cos_rho = std::cos(rho_p * delta_lambda_cgs);
+      double sin_rho = std::sin(rho_p * delta_lambda_cgs);
+      double sin_sq_rho = std::sin(rho_p * delta_lambda_cgs / 2.0);
+      sin_sq_rho = sin_sq_rho * sin_sq_rho;
+      double rho_ss = rho_s[1] * ss_start[1] + rho_s[3] * ss_start[3];
+      ss_end[0] = ss_start[0];
+      ss_end[1] = ss_start[1] * cos_rho + 2.0 * rho_s[1] * rho_ss / rho_sq * sin_sq_rho
+          - rho_s[3] * ss_start[2] / rho_p * sin_rho;
+      ss_end[2] = ss_start[2] * cos_rho
+          + (rho_s[3] * ss_start[1] - rho_s[1] * ss_start[3]) / rho_p * sin_rho;
+      ss_end[3] = ss_start[3] * cos_rho + 2.0 * rho_s[3] * rho_ss / rho_sq * sin_sq_rho
+          + rho_s[1] * ss_start[2] / rho_p * sin_rho;
+      for (int a = 0; a < 4; a++)
+        ss_end[a] += j_s[a] * delta_lambda_cgs;
+    }
+
+    // Couple with no rotativity but nonzero polarized absorptivity
+    else if (rho_p == 0.0)
+    {
+      // Optically thin case (I A14-A17)
+      if (optically_thin)
+      {
+        double exp_neg_i = std::exp(-delta_tau);
+        double exp_neg_p = std::exp(-alpha_p * delta_lambda_cgs);
+        double sinh_p = std::sinh(alpha_p * delta_lambda_cgs);
+        double cosh_p = std::cosh(alpha_p * delta_lambda_cgs);
+        double coshm1_p = 0.5 * (std::expm1(alpha_p * delta_lambda_cgs) + exp_neg_p - 1.0);
+        double alpha_ss = alpha_s[1] * ss_start[1] + alpha_s[3] * ss_start[3];
+        double alpha_j = alpha_s[1] * j_s[1] + alpha_s[3] * j_s[3];
+        double alpha_i_p_factor = 1.0 / (alpha_s[0] * alpha_s[0] - alpha_sq);
+        ss_end[0] = (ss_start[0] * cosh_p - alpha_ss / alpha_p * sinh_p) * exp_neg_i
+            + alpha_j * alpha_i_p_factor * (-1.0 + (alpha_s[0] * sinh_p + alpha_p * cosh_p)
+            / alpha_p * exp_neg_p) + alpha_s[0] * j_s[0] * alpha_i_p_factor * (1.0
+            - (alpha_s[0] * cosh_p + alpha_p * sinh_p) / alpha_s[0] * exp_neg_p);
+        for (int a = 1; a < 4; a++)
+        {
+          double term_1 = (ss_start[a] + alpha_s[a] * alpha_ss / alpha_sq * coshm1_p
+              - ss_start[0] * alpha_s[a] / alpha_p * sinh_p) * exp_neg_i;
+          double term_2 = j_s[a] * (1.0 - exp_neg_i) / alpha_s[0];
+          double term_3 = alpha_j * alpha_s[a] / alpha_s[0] * alpha_i_p_factor * (1.0 - (1.0
+              - alpha_s[0] * alpha_s[0] / alpha_sq - alpha_s[0] / alpha_sq * (alpha_s[0]
+              * cosh_p + alpha_p * sinh_p)) * exp_neg_i);
+          double term_4 = j_s[0] * alpha_s[a] / alpha_p * alpha_i_p_factor * (-alpha_p +
+              (alpha_p * cosh_p + alpha_s[0] * sinh_p) * exp_neg_i);
+          ss_end[a] = term_1 + term_2 + term_3 + term_4;
+        }
+      }
+
+      // Optically thick case
+      else
+      {
+        double alpha_j = alpha_s[1] * j_s[1] + alpha_s[3] * j_s[3];
+        ss_end[0] = (alpha_s[0] * j_s[0] - alpha_j) / (alpha_s[0] * alpha_s[0] - alpha_sq);
+        for (int a = 1; a < 4; a++)
+          ss_end[a] = (j_s[a] - alpha_s[a] * ss_end[0]) / alpha_s[0];
+      }
+    }
+
+    // Couple with nonzero absorptivity and rotativity
+    else
+    {
+      // Calculate coefficients needed for coupling matrices
+      double alpha_rho = alpha_s[1] * rho_s[1] + alpha_s[3] * rho_s[3];
+      double alpha_sq_rho_sq = alpha_sq - rho_sq;
+      double lambda_a =
+          std::sqrt(alpha_sq_rho_sq * alpha_sq_rho_sq / 4.0 + alpha_rho * alpha_rho);
+      double lambda_b = alpha_sq_rho_sq / 2.0;
+      double lambda_1 = std::sqrt(lambda_a + lambda_b);
+      double lambda_2 = std::sqrt(lambda_a - lambda_b);
+      double coefficient_theta = lambda_1 * lambda_1 + lambda_2 * lambda_2;
+      double s = alpha_rho >= 0.0 ? 1.0 : -1.0;
+
+      // Calculate coupling matrix 1
+      double mm_1[4][4] = {};
+      for (int a = 0; a < 4; a++)
+        mm_1[a][a] = 1.0;
+
+      // Calculate coupling matrix 2
+      double mm_2[4][4] = {};
+      mm_2[0][1] = lambda_2 * alpha_s[1] - s * lambda_1 * rho_s[1];
+      mm_2[0][3] = lambda_2 * alpha_s[3] - s * lambda_1 * rho_s[3];
+      mm_2[1][2] = s * lambda_1 * alpha_s[3] + lambda_2 * rho_s[3];
+      mm_2[1][2] = s * lambda_1 * alpha_s[1] + lambda_2 * rho_s[1];
+      mm_2[1][0] = mm_2[0][1];
+      mm_2[2][0] = mm_2[0][2];
+      mm_2[3][0] = mm_2[0][3];
+      mm_2[2][1] = -mm_2[1][2];
+      mm_2[3][1] = -mm_2[1][3];
+      mm_2[3][2] = -mm_2[2][3];
+      for (int a = 0; a < 4; a++)
         for (int b = 0; b < 4; b++)
-          for (int mu = 0; mu < 4; mu++)
-            for (int nu = 0; nu < 4; nu++)
-              temp_c[b][mu] += tetrad[b][nu] * temp_b[mu][nu];
+          mm_2[a][b] *= 1.0 / coefficient_theta;
+
+      // Calculate coupling matrix 3
+      double mm_3[4][4] = {};
+      mm_3[0][1] = lambda_1 * alpha_s[1] + s * lambda_2 * rho_s[1];
+      mm_3[0][3] = lambda_1 * alpha_s[3] + s * lambda_2 * rho_s[3];
+      mm_3[1][2] = -(s * lambda_2 * alpha_s[3] - lambda_1 * rho_s[3]);
+      mm_3[1][2] = -(s * lambda_2 * alpha_s[1] - lambda_1 * rho_s[1]);
+      mm_3[1][0] = mm_3[0][1];
+      mm_3[2][0] = mm_3[0][2];
+      mm_3[3][0] = mm_3[0][3];
+      mm_3[2][1] = -mm_3[1][2];
+      mm_3[3][1] = -mm_3[1][3];
+      mm_3[3][2] = -mm_3[2][3];
+      for (int a = 0; a < 4; a++)
+        for (int b = 0; b < 4; b++)
+          mm_3[a][b] *= 1.0 / coefficient_theta;
+
+      // Calculate coupling matrix 4
+      double mm_4[4][4] = {};
+      mm_4[0][0] = (alpha_sq + rho_sq) / 2.0;
+      mm_4[1][1] =
+          alpha_s[1] * alpha_s[1] + rho_s[1] * rho_s[1] - (alpha_sq + rho_sq) / 2.0;
+      mm_4[2][2] = -(alpha_sq + rho_sq) / 2.0;
+      mm_4[3][3] =
+          alpha_s[3] * alpha_s[3] + rho_s[3] * rho_s[3] - (alpha_sq + rho_sq) / 2.0;
+      mm_4[0][2] = alpha_s[1] * rho_s[3] - alpha_s[3] * rho_s[1];
+      mm_4[1][3] = alpha_s[3] * alpha_s[1] + rho_s[3] * rho_s[1];
+      mm_4[1][0] = -mm_4[0][1];
+      mm_4[2][0] = -mm_4[0][2];
+      mm_4[3][0] = -mm_4[0][3];
+      mm_4[2][1] = mm_4[1][2];
+      mm_4[3][1] = mm_4[1][3];
+      mm_4[3][2] = mm_4[2][3];
+      for (int a = 0; a < 4; a++)
+        for (int b = 0; b < 4; b++)
+          mm_4[a][b] *= 2.0 / coefficient_theta;
+
+      // Calculate coupling polynomial O (L 10)
+      double exp, sin, cos, sinh, cosh;
+      double oo[4][4] = {};
+      if (optically_thin)
+      {
+        exp = std::exp(-delta_tau);
+        sin = std::sin(lambda_2 * delta_lambda_cgs);
+        cos = std::cos(lambda_2 * delta_lambda_cgs);
+        sinh = std::sinh(lambda_1 * delta_lambda_cgs);
+        cosh = std::cosh(lambda_1 * delta_lambda_cgs);
         for (int a = 0; a < 4; a++)
           for (int b = 0; b < 4; b++)
-          {
-            nn_tet_cov[a][b] = 0.0;
-            for (int mu = 0; mu < 4; mu++)
-              nn_tet_cov[a][b] += tetrad[a][mu] * temp_c[b][mu];
-          }
-
-        // Calculate orthonormal-frame Stokes quantities at camera location (I 14)
-        image[adaptive_level](l*4+0,m) = 0.5 * (nn_tet_cov[1][1] + nn_tet_cov[2][2]).real();
-        image[adaptive_level](l*4+1,m) = 0.5 * (nn_tet_cov[1][1] - nn_tet_cov[2][2]).real();
-        image[adaptive_level](l*4+2,m) = 0.5 * (nn_tet_cov[1][2] + nn_tet_cov[2][1]).real();
-        image[adaptive_level](l*4+3,m) = 0.5 * (nn_tet_cov[2][1] - nn_tet_cov[1][2]).imag();
+            oo[a][b] = exp * (0.5 * (mm_1[a][b] + mm_4[a][b]) * cosh
+                + 0.5 * (mm_1[a][b] - mm_4[a][b]) * cos - mm_2[a][b] * sin
+                - mm_3[a][b] * sinh);
       }
 
-    // Transform invariant Stokes quantities (e.g. I_nu/nu^3) to standard ones (e.g. I_nu)
-    #pragma omp for schedule(static) collapse(3)
-    for (int l = 0; l < image_num_frequencies; l++)
+      // Calculate coupling polynomial integral P (I 24)
+      double pp[4][4] = {};
+      double f_1 = 1.0 / (alpha_s[0] * alpha_s[0] - lambda_1 * lambda_1);
+      double f_2 = 1.0 / (alpha_s[0] * alpha_s[0] + lambda_2 * lambda_2);
       for (int a = 0; a < 4; a++)
-        for (int m = 0; m < num_pix; m++)
+        for (int b = 0; b < 4; b++)
         {
-          double nu_cu = image_frequencies(l) * image_frequencies(l) * image_frequencies(l);
-          image[adaptive_level](l*4+a,m) *= nu_cu;
+          double cosh_term = -lambda_1 * f_1 * mm_3[a][b]
+              + 0.5 * alpha_s[0] * f_1 * (mm_1[a][b] + mm_4[a][b]);
+          double cos_term = -lambda_2 * f_2 * mm_2[a][b]
+              + 0.5 * alpha_s[0] * f_2 * (mm_1[a][b] - mm_4[a][b]);
+          pp[a][b] = cosh_term + cos_term;
+          if (optically_thin)
+          {
+            double sin_term = -alpha_s[0] * f_2 * mm_2[a][b]
+                - 0.5 * lambda_2 * f_2 * (mm_1[a][b] - mm_4[a][b]);
+            double sinh_term = -alpha_s[0] * f_1 * mm_3[a][b]
+                + 0.5 * lambda_1 * f_1 * (mm_1[a][b] + mm_4[a][b]);
+            pp[a][b] -= exp
+                * (cosh_term * cosh + cos_term * cos + sin_term * sin + sinh_term * sinh);
+          }
         }
+
+
+      // Apply coupling polynomials
+      if (optically_thin)
+        for (int a = 0; a < 4; a++)
+          for (int b = 0; b < 4; b++)
+            ss_end[a] += pp[a][b] * j_s[b] + oo[a][b] * ss_start[b];
+      else
+        for (int a = 0; a < 4; a++)
+          for (int b = 0; b < 4; b++)
+            ss_end[a] += pp[a][b] * j_s[b];
+    }
   }
 
-  // Free memory
-  if (adaptive_level > 0)
+  // Ensure state is physically admissible
+  ss_end[0] = std::max(ss_end[0], 0.0);
+  double ss_pol = ss_end[1] * ss_end[1] + ss_end[2] * ss_end[2] + ss_end[3] * ss_end[3];
+  if (ss_pol > ss_end[0] * ss_end[0])
   {
-    sample_uu1[adaptive_level].Deallocate();
-    sample_uu2[adaptive_level].Deallocate();
-    sample_uu3[adaptive_level].Deallocate();
-    sample_bb1[adaptive_level].Deallocate();
-    sample_bb2[adaptive_level].Deallocate();
-    sample_bb3[adaptive_level].Deallocate();
-    j_i[adaptive_level].Deallocate();
-    j_q[adaptive_level].Deallocate();
-    j_v[adaptive_level].Deallocate();
-    alpha_i[adaptive_level].Deallocate();
-    alpha_q[adaptive_level].Deallocate();
-    alpha_v[adaptive_level].Deallocate();
-    rho_q[adaptive_level].Deallocate();
-    rho_v[adaptive_level].Deallocate();
-    if (render_num_images <= 0)
-      cell_values[adaptive_level].Deallocate();
+    double factor = std::sqrt(ss_end[0] * ss_end[0] / ss_pol);
+    ss_end[1] *= factor;
+    ss_end[2] *= factor;
+    ss_end[3] *= factor;
   }
   return;
 }
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for transforming polarized results along a single ray into Stokes parameters in camera
+//     frame
+// Inputs:
+//   m: ray index
+//   l: frequency index
+//   gcov: covariant geodesic metric components at camera pixel
+//   tetrad: camera tetrad components at camera pixel
+//   nn_con: contravariant coherency tensor at end of ray
+// Outputs: (none)
+// Notes:
+//   Assumes gcov and tetrad have been set with CameraTetrad().
+//   Sets polarized light quantities for given ray and frequency in image[adaptive_level].
+//   References ipole paper 2018 MNRAS 475 43 (I).
+void RadiationIntegrator::TransformPolarizedRay(int m, int l, const double gcov[4][4],
+    const double tetrad[4][4], const std::complex<double> nn_con[4][4])
+{
+  // Transform N into orthonormal frame
+  std::complex<double> temp_a[4][4] = {};
+  for (int nu = 0; nu < 4; nu++)
+    for (int alpha = 0; alpha < 4; alpha++)
+      for (int beta = 0; beta < 4; beta++)
+        temp_a[nu][alpha] += gcov[nu][beta] * nn_con[alpha][beta];
+  std::complex<double> temp_b[4][4] = {};
+  for (int mu = 0; mu < 4; mu++)
+    for (int nu = 0; nu < 4; nu++)
+      for (int alpha = 0; alpha < 4; alpha++)
+        temp_b[mu][nu] += gcov[mu][alpha] * temp_a[nu][alpha];
+  std::complex<double> temp_c[4][4] = {};
+  for (int b = 0; b < 4; b++)
+    for (int mu = 0; mu < 4; mu++)
+      for (int nu = 0; nu < 4; nu++)
+        temp_c[b][mu] += tetrad[b][nu] * temp_b[mu][nu];
+  std::complex<double> nn_tet_cov[4][4];
+  for (int a = 0; a < 4; a++)
+    for (int b = 0; b < 4; b++)
+    {
+      nn_tet_cov[a][b] = 0.0;
+      for (int mu = 0; mu < 4; mu++)
+        nn_tet_cov[a][b] += tetrad[a][mu] * temp_c[b][mu];
+    }
+
+  // Calculate orthonormal-frame Stokes quantities at camera location (I 14)
+  image[adaptive_level](l*4+0,m) = 0.5 * (nn_tet_cov[1][1] + nn_tet_cov[2][2]).real();
+  image[adaptive_level](l*4+1,m) = 0.5 * (nn_tet_cov[1][1] - nn_tet_cov[2][2]).real();
+  image[adaptive_level](l*4+2,m) = 0.5 * (nn_tet_cov[1][2] + nn_tet_cov[2][1]).real();
+  image[adaptive_level](l*4+3,m) = 0.5 * (nn_tet_cov[2][1] - nn_tet_cov[1][2]).imag();
+
+  // Transform invariant Stokes quantities (e.g. I_nu/nu^3) to standard ones (e.g. I_nu)
+  double nu_cu = image_frequencies(l) * image_frequencies(l) * image_frequencies(l);
+  for (int a = 0; a < 4; a++)
+    image[adaptive_level](l*4+a,m) *= nu_cu;
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for calculating orthonormal tetrad of camera at the end of a ray
+// Inputs:
+//   m: ray index
+// Outputs:
+//   gcov: covariant geodesic metric components at camera pixel
+//   tetrad: components set
+// Notes:
+//   Assumes camera_pos[adaptive_level] and camera_dir[adaptive_level] have been set.
+//   Assumes gcov and tetrad are allocated to be 4*4.
+//   Orients tetrad with camera vertical direction, so that Stokes parameters are measured in
+//       camera frame.
+void RadiationIntegrator::CameraTetrad(int m, double gcov[4][4], double tetrad[4][4]) const
+{
+  // Allocate scratch space
+  double gcon[4][4];
+
+  // Extract geodesic position and covariant momentum
+  double x = camera_pos[adaptive_level](m,1);
+  double y = camera_pos[adaptive_level](m,2);
+  double z = camera_pos[adaptive_level](m,3);
+  double kcov[4];
+  kcov[0] = camera_dir[adaptive_level](m,0);
+  kcov[1] = camera_dir[adaptive_level](m,1);
+  kcov[2] = camera_dir[adaptive_level](m,2);
+  kcov[3] = camera_dir[adaptive_level](m,3);
+
+  // Calculate metric
+  CovariantGeodesicMetric(x, y, z, gcov);
+  ContravariantGeodesicMetric(x, y, z, gcon);
+
+  // Calculate geodesic contravariant momentum
+  double kcon[4] = {};
+  for (int mu = 0; mu < 4; mu++)
+    for (int nu = 0; nu < 4; nu++)
+      kcon[mu] += gcon[mu][nu] * kcov[nu];
+
+  // Calculate orientation
+  double up_con[4];
+  up_con[0] = camera_u_con[0] * camera_vert_con_c[0] - (camera_u_cov[1] * camera_vert_con_c[1]
+      + camera_u_cov[2] * camera_vert_con_c[2] + camera_u_cov[3] * camera_vert_con_c[3])
+      / camera_u_cov[0];
+  up_con[1] = camera_vert_con_c[1] + camera_u_con[1] * camera_vert_con_c[0];
+  up_con[2] = camera_vert_con_c[2] + camera_u_con[2] * camera_vert_con_c[0];
+  up_con[3] = camera_vert_con_c[3] + camera_u_con[3] * camera_vert_con_c[0];
+
+  // Calculate orthonormal tetrad
+  Tetrad(camera_u_con, camera_u_cov, kcon, kcov, up_con, gcov, gcon, tetrad);
+  return;
+}
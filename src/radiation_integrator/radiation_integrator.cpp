@@ -64,6 +64,26 @@ RadiationIntegrator::RadiationIntegrator(const InputReader *p_input_reader,
       simulation_block_interp = p_input_reader->simulation_block_interp.value();
     else if (p_input_reader->simulation_block_interp.has_value())
       BlacklightWarning("Ignoring simulation_block_interp selection.");
+    simulation_check_halos = false;
+    if ((simulation_format == SimulationFormat::athena
+        or simulation_format == SimulationFormat::athenak) and simulation_interp
+        and simulation_block_interp and p_input_reader->simulation_check_halos.has_value())
+      simulation_check_halos = p_input_reader->simulation_check_halos.value();
+    else if (p_input_reader->simulation_check_halos.has_value()
+        and p_input_reader->simulation_check_halos.value())
+      BlacklightWarning("Ignoring simulation_check_halos selection.");
+    simulation_precision = SimulationPrecision::single;
+    if (p_input_reader->simulation_precision.has_value())
+      simulation_precision = p_input_reader->simulation_precision.value();
+    simulation_interleave = false;
+    if (p_input_reader->simulation_interleave.has_value())
+      simulation_interleave = p_input_reader->simulation_interleave.value();
+    simulation_sort_samples = false;
+    if (p_input_reader->simulation_sort_samples.has_value())
+      simulation_sort_samples = p_input_reader->simulation_sort_samples.value();
+    simulation_batch = false;
+    if (p_input_reader->simulation_batch.has_value())
+      simulation_batch = p_input_reader->simulation_batch.value();
   }
 
   // Copy formula parameters
@@ -133,6 +153,16 @@ RadiationIntegrator::RadiationIntegrator(const InputReader *p_input_reader,
   }
   image_crossings = p_input_reader->image_crossings.value();
   image_z_turnings = p_input_reader->image_z_turnings.value();
+  image_stokes = false;
+  if (p_input_reader->image_stokes.has_value() and p_input_reader->image_stokes.value())
+  {
+    if (image_light and image_polarization and not (image_time or image_length or image_lambda
+        or image_emission or image_tau or image_lambda_ave or image_emission_ave or image_tau_int
+        or image_crossings))
+      image_stokes = true;
+    else
+      BlacklightWarning("Ignoring image_stokes selection.");
+  }
 
   // Copy rendering parameters
   if (model_type == ModelType::simulation)
@@ -197,7 +227,11 @@ RadiationIntegrator::RadiationIntegrator(const InputReader *p_input_reader,
         render_z_vals[n_i][n_f] = p_input_reader->render_z_vals[n_i][n_f].value();
       }
     }
+    BuildRenderTable();
   }
+  render_fused = render_num_images > 0 and not simulation_sort_samples;
+  store_cell_values = image_lambda_ave or image_emission_ave or image_tau_int
+      or (render_num_images > 0 and not render_fused);
   if (not (image_light or image_time or image_length or image_lambda or image_emission or image_tau
       or image_lambda_ave or image_emission_ave or image_tau_int or image_crossings
       or image_z_turnings or render_num_images > 0))
@@ -272,6 +306,42 @@ RadiationIntegrator::RadiationIntegrator(const InputReader *p_input_reader,
     }
   }
 
+  // Copy streaming parameters
+  image_streaming = false;
+  if (p_input_reader->image_streaming.has_value())
+    image_streaming = p_input_reader->image_streaming.value();
+  if (image_streaming and model_type != ModelType::simulation)
+  {
+    BlacklightWarning("Ignoring image_streaming selection.");
+    image_streaming = false;
+  }
+  if (image_streaming)
+  {
+    if (adaptive_max_level > 0)
+      throw BlacklightException("Cannot use image_streaming with adaptive ray tracing.");
+    if (render_num_images > 0)
+      throw BlacklightException("Cannot use image_streaming with rendering.");
+    if (checkpoint_sample_save or checkpoint_sample_load)
+      throw BlacklightException("Cannot use image_streaming with sample checkpoints.");
+    if (simulation_sort_samples)
+    {
+      BlacklightWarning("Ignoring simulation_sort_samples selection.");
+      simulation_sort_samples = false;
+    }
+  }
+
+  // Copy ray termination parameters
+  image_tau_max = -1.0;
+  if (p_input_reader->image_tau_max.has_value())
+    image_tau_max = p_input_reader->image_tau_max.value();
+  if (image_tau_max >= 0.0 and (not image_light or image_polarization or image_time
+      or image_length or image_lambda or image_emission or image_tau or image_lambda_ave
+      or image_emission_ave or image_tau_int or image_crossings or render_num_images > 0))
+  {
+    BlacklightWarning("Ignoring image_tau_max selection.");
+    image_tau_max = -1.0;
+  }
+
   // Copy plasma parameters
   if (model_type == ModelType::simulation)
   {
@@ -312,6 +382,14 @@ RadiationIntegrator::RadiationIntegrator(const InputReader *p_input_reader,
     plasma_thermal_frac = 1.0 - (plasma_power_frac + plasma_kappa_frac);
     if (plasma_thermal_frac < 0.0 or plasma_thermal_frac > 1.0)
       BlacklightWarning("Fraction of thermal electrons outside [0, 1].");
+    plasma_tables = false;
+    if (p_input_reader->plasma_tables.has_value())
+      plasma_tables = p_input_reader->plasma_tables.value();
+    if (plasma_tables and not (image_light and image_polarization and plasma_thermal_frac != 0.0))
+    {
+      BlacklightWarning("Ignoring plasma_tables selection.");
+      plasma_tables = false;
+    }
   }
 
   // Copy cut parameters
@@ -395,6 +473,7 @@ RadiationIntegrator::RadiationIntegrator(const InputReader *p_input_reader,
   sample_pos = p_geodesic_integrator->sample_pos;
   sample_dir = p_geodesic_integrator->sample_dir;
   sample_len = p_geodesic_integrator->sample_len;
+  sample_dlen = p_geodesic_integrator->sample_dlen;
 
   // Allocate space for sample data
   sample_inds = new Array<int>[adaptive_max_level+1];
@@ -402,9 +481,6 @@ RadiationIntegrator::RadiationIntegrator(const InputReader *p_input_reader,
   sample_nan = new Array<bool>[adaptive_max_level+1];
   sample_cut = new Array<bool>[adaptive_max_level+1];
   sample_fallback = new Array<bool>[adaptive_max_level+1];
-  sample_rho = new Array<float>[adaptive_max_level+1];
-  sample_pgas = new Array<float>[adaptive_max_level+1];
-  sample_kappa = new Array<float>[adaptive_max_level+1];
   sample_uu1 = new Array<float>[adaptive_max_level+1];
   sample_uu2 = new Array<float>[adaptive_max_level+1];
   sample_uu3 = new Array<float>[adaptive_max_level+1];
@@ -544,6 +620,18 @@ RadiationIntegrator::RadiationIntegrator(const InputReader *p_input_reader,
   if (image_z_turnings)
     image_num_quantities++;
 
+  // Collect image quantities accumulated along rays for selecting integration kernels
+  image_flags = (image_light ? ImageFlags::light : 0) | (image_time ? ImageFlags::time : 0)
+      | (image_length ? ImageFlags::length : 0) | (image_lambda ? ImageFlags::lambda : 0)
+      | (image_emission ? ImageFlags::emission : 0) | (image_tau ? ImageFlags::tau : 0)
+      | (image_lambda_ave ? ImageFlags::lambda_ave : 0)
+      | (image_emission_ave ? ImageFlags::emission_ave : 0)
+      | (image_tau_int ? ImageFlags::tau_int : 0) | (image_crossings ? ImageFlags::crossings : 0);
+
+  // Allocate space for per-frequency quantities along unpolarized rays
+  if (not (model_type == ModelType::simulation and image_light and image_polarization))
+    ray_spectra.Allocate(num_threads, RaySpectra::num_ray_spectra, image_num_frequencies);
+
   // Allocate space for rendering data
   render = new Array<double>[adaptive_max_level+1];
 
@@ -611,9 +699,6 @@ RadiationIntegrator::~RadiationIntegrator()
     sample_nan[level].Deallocate();
     sample_cut[level].Deallocate();
     sample_fallback[level].Deallocate();
-    sample_rho[level].Deallocate();
-    sample_pgas[level].Deallocate();
-    sample_kappa[level].Deallocate();
     sample_uu1[level].Deallocate();
     sample_uu2[level].Deallocate();
     sample_uu3[level].Deallocate();
@@ -626,9 +711,6 @@ RadiationIntegrator::~RadiationIntegrator()
   delete[] sample_nan;
   delete[] sample_cut;
   delete[] sample_fallback;
-  delete[] sample_rho;
-  delete[] sample_pgas;
-  delete[] sample_kappa;
   delete[] sample_uu1;
   delete[] sample_uu2;
   delete[] sample_uu3;
@@ -711,12 +793,34 @@ bool RadiationIntegrator::Integrate(int snapshot, double *p_time_sample, double
   double time_refine_start = 0.0;
   double time_refine_end = 0.0;
 
+  // Check whether ghost cells are needed for interpolation across blocks
+  bool block_interp = model_type == ModelType::simulation
+      and (simulation_format == SimulationFormat::athena
+      or simulation_format == SimulationFormat::athenak) and simulation_interp
+      and simulation_block_interp;
+
+  // Sample and integrate simulation data one ray at a time
+  if (model_type == ModelType::simulation and image_streaming)
+  {
+    time_sample_start = omp_get_wtime();
+    if (first_time)
+      ObtainGridData();
+    if (block_interp)
+      FillHalos();
+    time_sample_end = omp_get_wtime();
+    time_image_start = time_sample_end;
+    IntegrateStreaming(snapshot);
+    time_image_end = omp_get_wtime();
+  }
+
   // Sample simulation data
-  if (model_type == ModelType::simulation)
+  if (model_type == ModelType::simulation and not image_streaming)
   {
     time_sample_start = omp_get_wtime();
     if (first_time)
       ObtainGridData();
+    if (block_interp and adaptive_level == 0)
+      FillHalos();
     if (adaptive_level > 0)
       CalculateSimulationSampling(snapshot);
     else if (first_time)
@@ -730,12 +834,11 @@ bool RadiationIntegrator::Integrate(int snapshot, double *p_time_sample, double
     }
     else if (slow_light_on)
       CalculateSimulationSampling(snapshot);
-    SampleSimulation();
     time_sample_end = omp_get_wtime();
   }
 
   // Integrate according to simulation data
-  if (model_type == ModelType::simulation)
+  if (model_type == ModelType::simulation and not image_streaming)
   {
     time_image_start = time_sample_end;
     CalculateSimulationCoefficients();
@@ -745,8 +848,10 @@ bool RadiationIntegrator::Integrate(int snapshot, double *p_time_sample, double
         or image_tau or image_lambda_ave or image_emission_ave or image_tau_int or image_crossings
         or image_z_turnings)
       IntegrateUnpolarizedRadiation();
+    else if (adaptive_level > 0 and render_fused)
+      sample_cut[adaptive_level].Deallocate();
     time_image_end = omp_get_wtime();
-    if (render_num_images > 0)
+    if (render_num_images > 0 and not render_fused)
     {
       time_render_start = time_image_end;
       Render();
@@ -3,6 +3,10 @@
 #ifndef RADIATION_INTEGRATOR_H_
 #define RADIATION_INTEGRATOR_H_
 
+// C++ headers
+#include <complex>  // complex
+#include <cstdint>  // uint16_t
+
 // Blacklight headers
 #include "../blacklight.hpp"                               // enums
 #include "../geodesic_integrator/geodesic_integrator.hpp"  // GeodesicIntegrator
@@ -42,6 +46,11 @@ struct RadiationIntegrator
   double simulation_rho_cgs;
   bool simulation_interp;
   bool simulation_block_interp;
+  bool simulation_check_halos;
+  SimulationPrecision simulation_precision;
+  bool simulation_interleave;
+  bool simulation_sort_samples;
+  bool simulation_batch;
 
   // Input data - formula parameters
   double formula_mass;
@@ -68,6 +77,7 @@ struct RadiationIntegrator
   int image_num_frequencies;
   bool image_polarization;
   bool image_rotation_split;
+  bool image_stokes;
   bool image_time;
   bool image_length;
   bool image_lambda;
@@ -78,6 +88,8 @@ struct RadiationIntegrator
   bool image_tau_int;
   bool image_crossings;
   bool image_z_turnings;
+  bool image_streaming;
+  double image_tau_max;
 
   // Input data - rendering parameters
   int render_num_images;
@@ -139,6 +151,7 @@ struct RadiationIntegrator
   double plasma_kappa_frac;
   double plasma_kappa;
   double plasma_w;
+  bool plasma_tables;
 
   // Input data - cut parameters
   double cut_rho_min;
@@ -208,6 +221,7 @@ struct RadiationIntegrator
   Array<double> *sample_pos = nullptr;
   Array<double> *sample_dir = nullptr;
   Array<double> *sample_len = nullptr;
+  Array<double> *sample_dlen = nullptr;
 
   // Grid data
   int n_3_root;
@@ -217,11 +231,36 @@ struct RadiationIntegrator
   Array<int> locations;
   Array<double> x1f, x2f, x3f;
   Array<double> x1v, x2v, x3v;
+  int block_root_level;
+  int block_root_num[3];
+  int block_root_offset[3];
+  int block_hash_mask;
+  Array<double> block_root_faces;
+  Array<int> block_hash_keys;
+  Array<int> block_hash_vals;
+  Array<int> block_node_blocks;
+  Array<double> block_node_bounds;
+  Array<int> block_neighbor_dirs;
+  Array<int> block_neighbor_levels;
+  Array<int> block_neighbors;
+  const double cell_index_tol = 1.0e-6;
+  Array<bool> cell_index_regular;
+  Array<bool> cell_index_log;
+  Array<double> cell_index_coeffs;
   double *time;
+  bool time_uniform;
+  double time_inv_dt;
   Array<float> *grid_prim;
+  Array<std::uint16_t> *grid_prim_packed;
   int ind_rho, ind_pgas, ind_kappa;
   int ind_uu1, ind_uu2, ind_uu3;
   int ind_bb1, ind_bb2, ind_bb3;
+  int grid_num_vars;
+  int grid_inds[9];
+  bool grid_positive[9];
+  long int grid_cell_stride, grid_var_stride;
+  int halo_num_cells;
+  Array<float> grid_halo;
 
   // Interpolation grid data
   double sks_map_r_in, sks_map_r_out, sks_map_dr, sks_map_dtheta;
@@ -234,9 +273,7 @@ struct RadiationIntegrator
   Array<bool> *sample_nan = nullptr;
   Array<bool> *sample_cut = nullptr;
   Array<bool> *sample_fallback = nullptr;
-  Array<float> *sample_rho = nullptr;
-  Array<float> *sample_pgas = nullptr;
-  Array<float> *sample_kappa = nullptr;
+  Array<int> sample_order;
   Array<float> *sample_uu1 = nullptr;
   Array<float> *sample_uu2 = nullptr;
   Array<float> *sample_uu3 = nullptr;
@@ -254,12 +291,21 @@ struct RadiationIntegrator
   Array<double> *alpha_v = nullptr;
   Array<double> *rho_q = nullptr;
   Array<double> *rho_v = nullptr;
+  bool store_cell_values;
   Array<double> *cell_values = nullptr;
+  static constexpr int batch_size = 16;
+  Array<int> batch_num;
+  Array<int> batch_inds;
+  Array<double> batch_vals;
+  Array<double> batch_coefficients;
+  Array<double> ray_tau;
 
   // Image data
   Array<double> *image = nullptr;
   Array<double> image_frequencies;
   Array<double> *momentum_factors = nullptr;
+  int image_flags = 0;
+  Array<double> ray_spectra;
   int image_num_quantities = 0;
   int image_offset_time = 0;
   int image_offset_length = 0;
@@ -273,6 +319,11 @@ struct RadiationIntegrator
   int image_offset_z_turnings = 0;
 
   // Rendering data
+  bool render_fused;
+  bool render_fill_present = false;
+  int render_table_size = 0;
+  Array<int> render_table_inds;
+  Array<double> render_table_vals;
   Array<double> *render = nullptr;
 
   // Adaptive data
@@ -303,6 +354,19 @@ struct RadiationIntegrator
   double kappa_rho_v_low_a, kappa_rho_v_low_b;
   double kappa_rho_v_high_a, kappa_rho_v_high_b;
 
+  // Coefficient table data
+  const double table_tolerance = 1.0e-4;
+  const double table_theta_e_max = 1.0e4;
+  const double table_xx_min = 1.0e-6;
+  const double table_xx_max = 1.0e12;
+  const int table_num_min = 256;
+  const int table_num_max = 1 << 20;
+  int table_theta_e_num, table_xx_num;
+  double table_theta_e_log_min, table_theta_e_inv_dlog;
+  double table_xx_log_min, table_xx_inv_dlog;
+  Array<double> table_theta_e_vals;
+  Array<double> table_xx_vals;
+
   // External function
   bool Integrate(int snapshot, double *p_time_sample, double *p_time_image, double *p_time_render);
 
@@ -313,31 +377,106 @@ struct RadiationIntegrator
   // Internal functions - simulation_sampling.cpp
   void ObtainGridData();
   void CalculateSimulationSampling(int snapshot);
-  void SampleSimulation();
-  void FindNearbyInds(int b, int k, int j, int i, int k_c, int j_c, int i_c, double x3, double x2,
-      double x1, int inds[4]);
-  double InterpolateSimple(const Array<float> &grid_vals, int grid_ind, int b, int k, int j, int i,
-      double f_k, double f_j, double f_i);
-  double InterpolateAdvanced(const Array<float> &grid_vals, int grid_ind, int m, int n);
+  double PrepareSimulationSampling(int snapshot, int num_rows);
+  void PrepareSamplingBlock(int *p_b, double block_bounds[6]);
+  void SampleRay(int m, int row, double snapshot_time, int *p_b, double block_bounds[6],
+      double val_extrap[4]);
+  void ReportExtrapolation(int snapshot, double snapshot_time, int num_pix,
+      const int num_extrap[4], const double val_extrap[4]);
+  void SamplePrimitives(int row, int n, double vals[9]);
+  void PrefetchSample(int row, int n);
+  void PrepareTimeIndex();
+  int FindTimeIndex(double x0, int t_ind_guess);
+  double GridValue(int t, int q, int b, int k, int j, int i);
+  void GridValues(int t, int b, int k, int j, int i, double vals[9]);
+  long int CellIndex(int b, int k, int j, int i);
+  double GridDatum(int t, long int ind, bool positive);
+  void InterpolateSimple(int t, int b, int k, int j, int i, double f_k, double f_j, double f_i,
+      double vals[9]);
+  void InterpolateAdvanced(int t, int b, int k, int j, int i, double f_k, double f_j, double f_i,
+      double vals[9]);
+
+  // Internal functions - block_index.cpp
+  void BuildBlockIndex();
+  unsigned int HashBlockLocation(int level, int location_i, int location_j, int location_k);
+  int FindBlockNode(int level, int location_i, int location_j, int location_k);
+  int FindBlock(int level, int location_i, int location_j, int location_k);
+  int LocateBlock(double x1, double x2, double x3);
+  void BuildCellIndex();
+  int FindCell(int b, int d, double x);
+
+  // Internal functions - block_halos.cpp
+  void BuildNeighborTable();
+  int FindNeighborBlock(int level, const int location[3], const int offsets[3], int level_offset,
+      int child);
+  void FillHalos();
+  int CheckHalos();
+  int GhostIndex(int k, int j, int i);
 
   // Internal functions - simulation_coefficients.cpp
   void CalculateSimulationCoefficients();
+  int CountLiveSamples(int num_pix);
+  void PrepareSimulationCoefficients(int num_rows, int num_cols);
+  void CalculateRayCoefficients(int m, int row);
+  void CalculateTerminatedRayCoefficients(int m, int row);
+  long int SortSamplesByBlock(int num_pix);
+  void InitializeRayCoefficients(int m, int row);
+  void CalculateSampleCoefficients(int m, int row, int n, int c, double *render_values);
   double Hypergeometric(double alpha, double beta, double gamma, double z);
 
+  // Internal functions - batch_coefficients.cpp
+  void CalculateBatchCoefficients(int thread);
+  void BatchThermalCoefficients(int thread, int num);
+  void BatchThermalRotativities(int thread, int num);
+  void BatchPowerCoefficients(int thread, int num);
+  void BatchKappaCoefficients(int thread, int num);
+  void BatchKappaPolarizedCoefficients(int thread, int num);
+  void BatchKappaRotativities(int thread, int num);
+
+  // Internal functions - coefficient_tables.cpp
+  void BuildCoefficientTables();
+  double TabulateThetaE(int num);
+  double TabulateXX(int num);
+  void ThermalRotativityFits(double xx, double *p_f_m, double *p_f_m_scale,
+      double *p_delta_jj_5) const;
+  bool TabulatedThetaEFactors(double theta_e, double *p_g, double *p_h, double *p_kk_2_inv) const;
+  bool TabulatedXXFactors(double xx, double *p_f_m, double *p_delta_jj_5) const;
+
   // Internal functions - formula_coefficients.cpp
   void CalculateFormulaCoefficients();
 
   // Internal functions - unpolarized.cpp
   void IntegrateUnpolarizedRadiation();
+  void IntegrateUnpolarizedRay(int m, int row);
+  template <int flags> void IntegrateUnpolarizedRayKernel(int m, int row);
+  void IntegrateTerminatedRay(int m, int row);
 
   // Internal functions - polarized.cpp
   void IntegratePolarizedRadiation();
+  void IntegratePolarizedRay(int m, int row);
+  template <int flags> void IntegratePolarizedRayKernel(int m, int row);
+  void IntegrateStokesRay(int m, int row);
+  void FluidTetrad(double x1, double x2, double x3, const double kcon[4], const double kcov[4],
+      const double gcov[4][4], const double gcon[4][4], const double uu_sim[3],
+      const double bb_sim[3], double tetrad[4][4]) const;
+  void CoupleStokes(const double j_s[4], const double alpha_s[4], const double rho_s[4],
+      double delta_lambda_cgs, double ss_start[4], double ss_end[4]) const;
+  void TransformPolarizedRay(int m, int l, const double gcov[4][4], const double tetrad[4][4],
+      const std::complex<double> nn_con[4][4]);
+  void CameraTetrad(int m, double gcov[4][4], double tetrad[4][4]) const;
+
+  // Internal functions - streaming.cpp
+  void IntegrateStreaming(int snapshot);
 
   // Internal functions - turnings.cpp
   void FindZTurnings(int m, int num_steps, int &n_start, int &z_turnings_count);
 
   // Internal functions - rendering.cpp
+  void BuildRenderTable();
+  void PrepareRendering(int num_pix);
   void Render();
+  void RenderSample(int m, int n, const double current_values[CellValues::num_cell_values],
+      double previous_values[CellValues::num_cell_values]);
 
   // Internal functions - radiation_adaptive.cpp
   bool CheckAdaptiveRefinement();
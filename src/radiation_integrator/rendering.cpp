@@ -14,166 +14,231 @@
 
 //--------------------------------------------------------------------------------------------------
 
-// Function for rendering false color image
+// Function for collecting rendering features into a single table
 // Inputs: (none)
 // Outputs: (none)
 // Notes:
-//   Assumes sample_num[adaptive_level], sample_pos[adaptive_level], sample_dir[adaptive_level],
-//       sample_len[adaptive_level], and cell_values[adaptive_level] have been set.
+//   Assumes rendering parameters have been read.
+//   Allocates and initializes render_table_inds and render_table_vals, with one row per feature
+//       across all rendered images, ordered first by image and then by feature.
+//   Initializes render_table_size and render_fill_present.
+//   Values not used by a feature's type are set to 0.
+void RadiationIntegrator::BuildRenderTable()
+{
+  // Count features
+  render_table_size = 0;
+  for (int n_i = 0; n_i < render_num_images; n_i++)
+    render_table_size += render_num_features[n_i];
+
+  // Allocate table
+  render_table_inds.Allocate(render_table_size, RenderIndices::num_render_indices);
+  render_table_vals.Allocate(render_table_size, RenderValues::num_render_values);
+  render_table_vals.Zero();
+
+  // Fill table
+  render_fill_present = false;
+  for (int n_i = 0, entry = 0; n_i < render_num_images; n_i++)
+    for (int n_f = 0; n_f < render_num_features[n_i]; n_f++, entry++)
+    {
+      RenderType type = render_types[n_i][n_f];
+      int *inds = &render_table_inds(entry,0);
+      double *vals = &render_table_vals(entry,0);
+      inds[RenderIndices::image] = n_i;
+      inds[RenderIndices::quantity] = render_quantities[n_i][n_f];
+      inds[RenderIndices::type] = static_cast<int>(type);
+      if (type == RenderType::fill)
+      {
+        vals[RenderValues::min] = render_min_vals[n_i][n_f];
+        vals[RenderValues::max] = render_max_vals[n_i][n_f];
+        vals[RenderValues::tau_scale] = render_tau_scales[n_i][n_f];
+        render_fill_present = true;
+      }
+      else
+      {
+        vals[RenderValues::thresh] = render_thresh_vals[n_i][n_f];
+        vals[RenderValues::opacity] = render_opacities[n_i][n_f];
+      }
+      vals[RenderValues::x] = render_x_vals[n_i][n_f];
+      vals[RenderValues::y] = render_y_vals[n_i][n_f];
+      vals[RenderValues::z] = render_z_vals[n_i][n_f];
+    }
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for preparing false color image
+// Inputs:
+//   num_pix: number of rays
+// Outputs: (none)
+// Notes:
 //   Allocates and initializes render[adaptive_level].
-//   Deallocates cell_values[adaptive_level] if adaptive_level > 0.
+void RadiationIntegrator::PrepareRendering(int num_pix)
+{
+  if (first_time or adaptive_level > 0)
+    render[adaptive_level].Allocate(render_num_images, 3, num_pix);
+  render[adaptive_level].Zero();
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for rendering false color image
+// Inputs: (none)
+// Outputs: (none)
+// Notes:
+//   Assumes sample_num[adaptive_level], sample_cut[adaptive_level], and cell_values[adaptive_level]
+//       have been set, with cell_values[adaptive_level] holding values only for samples outside
+//       the cut region.
+//   Assumes sample_dlen[adaptive_level] has been set if any feature is a fill.
+//   Allocates and initializes render[adaptive_level] with PrepareRendering() and works on each
+//       sample with RenderSample().
+//   Deallocates sample_cut[adaptive_level] and cell_values[adaptive_level] if
+//       adaptive_level > 0.
+//   Only used if render_fused == false; otherwise samples are rendered as their coefficients are
+//       calculated, without storing cell values.
 void RadiationIntegrator::Render()
 {
   // Allocate rendering array
   int num_pix = camera_num_pix;
   if (adaptive_level > 0)
     num_pix = block_counts[adaptive_level] * block_num_pix;
-  if (first_time or adaptive_level > 0)
-    render[adaptive_level].Allocate(render_num_images, 3, num_pix);
-  render[adaptive_level].Zero();
+  PrepareRendering(num_pix);
 
-  // Determine if fills are present
-  bool fill_present = false;
-  for (int n_i = 0; n_i < render_num_images; n_i++)
+  // Go through pixels in parallel
+  #pragma omp parallel for schedule(static)
+  for (int m = 0; m < num_pix; m++)
   {
-    int num_features = render_num_features[n_i];
-    for (int n_f = 0; n_f < num_features; n_f++)
-      if (render_types[n_i][n_f] == RenderType::fill)
-        fill_present = true;
-  }
+    // Extract number of steps
+    int num_steps = sample_num[adaptive_level](m);
+
+    // Prepare cell values
+    double previous_values[CellValues::num_cell_values];
+    for (int n_v = 0; n_v < CellValues::num_cell_values; n_v++)
+      previous_values[n_v] = std::numeric_limits<double>::quiet_NaN();
+    double current_values[CellValues::num_cell_values];
+
+    // Go through samples
+    int c_next = 0;
+    for (int n = 0; n < num_steps; n++)
+    {
+      // Locate stored values, noting samples in cut region have none
+      bool live = not sample_cut[adaptive_level](m,n);
+      int c = live ? c_next++ : 0;
 
-  // Calculate unit
-  double x_unit = Physics::gg_msun * mass_msun / (Physics::c * Physics::c);
+      // Extract cell values
+      for (int n_v = 0; n_v < CellValues::num_cell_values; n_v++)
+        current_values[n_v] = live ? cell_values[adaptive_level](n_v,m,c)
+            : std::numeric_limits<double>::quiet_NaN();
+
+      // Render sample
+      RenderSample(m, n, current_values, previous_values);
+    }
+  }
 
-  // Work in parallel
-  #pragma omp parallel
+  // Free memory
+  if (adaptive_level > 0)
   {
-    // Allocate scratch space
-    double gcov[4][4];
-    double gcon[4][4];
+    sample_cut[adaptive_level].Deallocate();
+    cell_values[adaptive_level].Deallocate();
+  }
+  return;
+}
 
-    // Go through pixels
-    #pragma omp for schedule(static)
-    for (int m = 0; m < num_pix; m++)
-    {
-      // Extract number of steps
-      int num_steps = sample_num[adaptive_level](m);
+//--------------------------------------------------------------------------------------------------
 
-      // Prepare cell values
-      double previous_values[CellValues::num_cell_values];
-      for (int n_v = 0; n_v < CellValues::num_cell_values; n_v++)
-        previous_values[n_v] = std::numeric_limits<double>::quiet_NaN();
-      double current_values[CellValues::num_cell_values];
+// Function for adding single sample to false color image
+// Inputs:
+//   m: ray index
+//   n: sample index along ray
+//   current_values: cell values at sample, or NaN if none are available
+//   previous_values: cell values at previous sample along ray, or NaN if none are available
+// Outputs:
+//   previous_values: set to current_values
+// Notes:
+//   Assumes render[adaptive_level] has been allocated and initialized.
+//   Assumes sample_dlen[adaptive_level] has been set if render_fill_present == true.
+//   Samples must be added in order along each ray, starting far from the camera.
+//   Goes through all features of all images with a single pass through the table made by
+//       BuildRenderTable().
+void RadiationIntegrator::RenderSample(int m, int n,
+    const double current_values[CellValues::num_cell_values],
+    double previous_values[CellValues::num_cell_values])
+{
+  // Calculate length
+  double delta_length = 0.0;
+  if (render_fill_present)
+  {
+    double x_unit = Physics::gg_msun * mass_msun / (Physics::c * Physics::c);
+    delta_length = sample_dlen[adaptive_level](m,n) * x_unit;
+  }
 
-      // Go through samples
-      for (int n = 0; n < num_steps; n++)
+  // Go through features
+  for (int entry = 0; entry < render_table_size; entry++)
+  {
+    // Extract relevant quantity
+    const int *inds = &render_table_inds(entry,0);
+    const double *vals = &render_table_vals(entry,0);
+    int n_i = inds[RenderIndices::image];
+    int n_v = inds[RenderIndices::quantity];
+    double previous_value = previous_values[n_v];
+    double current_value = current_values[n_v];
+    double x_val = vals[RenderValues::x];
+    double y_val = vals[RenderValues::y];
+    double z_val = vals[RenderValues::z];
+
+    // Calculate effect of passing through filling region
+    RenderType type = static_cast<RenderType>(inds[RenderIndices::type]);
+    if (type == RenderType::fill)
+    {
+      if (not (current_value >= vals[RenderValues::min]
+          and current_value <= vals[RenderValues::max]))
+        continue;
+      double delta_tau = delta_length / vals[RenderValues::tau_scale];
+      bool optically_thin = delta_tau <= delta_tau_max;
+      if (optically_thin)
+      {
+        double exp_neg = std::exp(-delta_tau);
+        double expm1 = std::expm1(delta_tau);
+        render[adaptive_level](n_i,0,m) =
+            exp_neg * (render[adaptive_level](n_i,0,m) + x_val * expm1);
+        render[adaptive_level](n_i,1,m) =
+            exp_neg * (render[adaptive_level](n_i,1,m) + y_val * expm1);
+        render[adaptive_level](n_i,2,m) =
+            exp_neg * (render[adaptive_level](n_i,2,m) + z_val * expm1);
+      }
+      else
       {
-        // Extract useful values
-        double delta_lambda = sample_len[adaptive_level](m,n);
-        double x1 = sample_pos[adaptive_level](m,n,1);
-        double x2 = sample_pos[adaptive_level](m,n,2);
-        double x3 = sample_pos[adaptive_level](m,n,3);
-        double kcov[4];
-        kcov[0] = sample_dir[adaptive_level](m,n,0);
-        kcov[1] = sample_dir[adaptive_level](m,n,1);
-        kcov[2] = sample_dir[adaptive_level](m,n,2);
-        kcov[3] = sample_dir[adaptive_level](m,n,3);
-        for (int n_v = 0; n_v < CellValues::num_cell_values; n_v++)
-          current_values[n_v] = cell_values[adaptive_level](n_v,m,n);
-
-        // Calculate length
-        double delta_length = 0.0;
-        if (fill_present)
-        {
-          CovariantGeodesicMetric(x1, x2, x3, gcov);
-          ContravariantGeodesicMetric(x1, x2, x3, gcon);
-          double temp_a[4] = {};
-          for (int a = 1; a < 4; a++)
-            for (int mu = 0; mu < 4; mu++)
-              temp_a[a] += (gcon[a][mu] - gcon[0][a] * gcon[0][mu] / gcon[0][0]) * kcov[mu];
-          double dl_dlambda_sq = 0.0;
-          for (int a = 1; a < 4; a++)
-            for (int b = 1; b < 4; b++)
-              dl_dlambda_sq += gcov[a][b] * temp_a[a] * temp_a[b];
-          delta_length = std::sqrt(dl_dlambda_sq) * delta_lambda * x_unit;
-        }
-
-        // Go through rendering images
-        for (int n_i = 0; n_i < render_num_images; n_i++)
-        {
-          // Extract number of features
-          int num_features = render_num_features[n_i];
-
-          // Go through features
-          for (int n_f = 0; n_f < num_features; n_f++)
-          {
-            // Extract relevant quantity
-            int n_v = render_quantities[n_i][n_f];
-            double previous_value = previous_values[n_v];
-            double current_value = current_values[n_v];
-
-            // Calculate effect of passing through filling region
-            if (render_types[n_i][n_f] == RenderType::fill
-                and current_value >= render_min_vals[n_i][n_f]
-                and current_value <= render_max_vals[n_i][n_f])
-            {
-              double delta_tau = delta_length / render_tau_scales[n_i][n_f];
-              bool optically_thin = delta_tau <= delta_tau_max;
-              if (optically_thin)
-              {
-                double exp_neg = std::exp(-delta_tau);
-                double expm1 = std::expm1(delta_tau);
-                render[adaptive_level](n_i,0,m) =
-                    exp_neg * (render[adaptive_level](n_i,0,m) + render_x_vals[n_i][n_f] * expm1);
-                render[adaptive_level](n_i,1,m) =
-                    exp_neg * (render[adaptive_level](n_i,1,m) + render_y_vals[n_i][n_f] * expm1);
-                render[adaptive_level](n_i,2,m) =
-                    exp_neg * (render[adaptive_level](n_i,2,m) + render_z_vals[n_i][n_f] * expm1);
-              }
-              else
-              {
-                render[adaptive_level](n_i,0,m) = render_x_vals[n_i][n_f];
-                render[adaptive_level](n_i,1,m) = render_y_vals[n_i][n_f];
-                render[adaptive_level](n_i,2,m) = render_z_vals[n_i][n_f];
-              }
-            }
-
-            // Determine if threshold has been crossed
-            bool threshold_crossed = false;
-            bool rise_search = render_types[n_i][n_f] == RenderType::thresh
-                or render_types[n_i][n_f] == RenderType::rise;
-            if (rise_search and previous_value < render_thresh_vals[n_i][n_f]
-                and current_value >= render_thresh_vals[n_i][n_f])
-              threshold_crossed = true;
-            bool fall_search = render_types[n_i][n_f] == RenderType::thresh
-                or render_types[n_i][n_f] == RenderType::fall;
-            if (fall_search and previous_value > render_thresh_vals[n_i][n_f]
-                and current_value <= render_thresh_vals[n_i][n_f])
-              threshold_crossed = true;
-
-            // Calculate effect of crossing threshold
-            if (threshold_crossed)
-            {
-              double opacity = render_opacities[n_i][n_f];
-              render[adaptive_level](n_i,0,m) = (1.0 - opacity) * render[adaptive_level](n_i,0,m)
-                  + opacity * render_x_vals[n_i][n_f];
-              render[adaptive_level](n_i,1,m) = (1.0 - opacity) * render[adaptive_level](n_i,1,m)
-                  + opacity * render_y_vals[n_i][n_f];
-              render[adaptive_level](n_i,2,m) = (1.0 - opacity) * render[adaptive_level](n_i,2,m)
-                  + opacity * render_z_vals[n_i][n_f];
-            }
-          }
-        }
-
-        // Store current values
-        for (int n_v = 0; n_v < CellValues::num_cell_values; n_v++)
-          previous_values[n_v] = current_values[n_v];
+        render[adaptive_level](n_i,0,m) = x_val;
+        render[adaptive_level](n_i,1,m) = y_val;
+        render[adaptive_level](n_i,2,m) = z_val;
       }
+      continue;
+    }
+
+    // Determine if threshold has been crossed
+    double thresh = vals[RenderValues::thresh];
+    bool rise_crossed = previous_value < thresh and current_value >= thresh;
+    bool fall_crossed = previous_value > thresh and current_value <= thresh;
+    bool threshold_crossed = (type == RenderType::rise and rise_crossed)
+        or (type == RenderType::fall and fall_crossed)
+        or (type == RenderType::thresh and (rise_crossed or fall_crossed));
+
+    // Calculate effect of crossing threshold
+    if (threshold_crossed)
+    {
+      double opacity = vals[RenderValues::opacity];
+      render[adaptive_level](n_i,0,m) =
+          (1.0 - opacity) * render[adaptive_level](n_i,0,m) + opacity * x_val;
+      render[adaptive_level](n_i,1,m) =
+          (1.0 - opacity) * render[adaptive_level](n_i,1,m) + opacity * y_val;
+      render[adaptive_level](n_i,2,m) =
+          (1.0 - opacity) * render[adaptive_level](n_i,2,m) + opacity * z_val;
     }
   }
 
-  // Free memory
-  if (adaptive_level > 0)
-    cell_values[adaptive_level].Deallocate();
+  // Store current values
+  for (int n_v = 0; n_v < CellValues::num_cell_values; n_v++)
+    previous_values[n_v] = current_values[n_v];
   return;
 }
@@ -17,8 +17,8 @@
 // Outputs: (none)
 // Notes:
 //   Overwrites file specified by checkpoint_sample_file.
-//   Saves certain sample data (sample_inds[0], sample_fracs[0] (if needed), sample_nan[0], and
-//       sample_fallback[0]).
+//   Saves certain sample data (sample_inds[0], sample_fracs[0] (if needed), sample_nan[0],
+//       sample_cut[0], and sample_fallback[0]).
 void RadiationIntegrator::SaveSampling()
 {
   // Open checkpoint file for writing
@@ -32,6 +32,7 @@ void RadiationIntegrator::SaveSampling()
   if (simulation_interp)
     WriteBinary(&checkpoint_stream, sample_fracs[0]);
   WriteBinary(&checkpoint_stream, sample_nan[0]);
+  WriteBinary(&checkpoint_stream, sample_cut[0]);
   WriteBinary(&checkpoint_stream, sample_fallback[0]);
   return;
 }
@@ -43,8 +44,8 @@ void RadiationIntegrator::SaveSampling()
 // Outputs: (none)
 // Notes:
 //   Reads file specified by checkpoint_sample_file.
-//   Saves certain sample data (sample_inds[0], sample_fracs[0] (if needed), sample_nan[0], and
-//       sample_fallback[0]), allocating arrays.
+//   Saves certain sample data (sample_inds[0], sample_fracs[0] (if needed), sample_nan[0],
+//       sample_cut[0], and sample_fallback[0]), allocating arrays.
 void RadiationIntegrator::LoadSampling()
 {
   // Open checkpoint file for readiing
@@ -58,6 +59,7 @@ void RadiationIntegrator::LoadSampling()
   if (simulation_interp)
     ReadBinary(&checkpoint_stream, &sample_fracs[0]);
   ReadBinary(&checkpoint_stream, &sample_nan[0]);
+  ReadBinary(&checkpoint_stream, &sample_cut[0]);
   ReadBinary(&checkpoint_stream, &sample_fallback[0]);
   return;
 }
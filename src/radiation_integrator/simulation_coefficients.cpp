@@ -1,12 +1,12 @@
 // Blacklight radiation integrator - simulation radiative transfer coefficients
 
 // C++ headers
-#include <algorithm>  // min
-#include <cmath>      // cbrt, cos, cyl_bessel_k, exp, expm1, pow, sin, sinh, sqrt, tanh, tgamma
+#include <algorithm>  // max, min
+#include <cmath>      // cbrt, cyl_bessel_k, exp, expm1, pow, sin, sinh, sqrt, tgamma
 #include <limits>     // numeric_limits
 
 // Library headers
-#include <omp.h>  // pragmas
+#include <omp.h>  // omp_get_thread_num, pragmas
 
 // Blacklight headers
 #include "radiation_integrator.hpp"
@@ -20,35 +20,131 @@
 // Outputs: (none)
 // Notes:
 //   Assumes geodesic_num_steps[adaptive_level], sample_num[adaptive_level],
-//       sample_pos[adaptive_level], sample_dir[adaptive_level], sample_cut[adaptive_level],
-//       sample_rho[adaptive_level], sample_pgas[adaptive_level], sample_kappa[adaptive_level] (if
-//       needed), sample_uu1[adaptive_level], sample_uu2[adaptive_level],
-//       sample_uu3[adaptive_level], sample_bb1[adaptive_level], sample_bb2[adaptive_level],
-//       sample_bb3[adaptive_level], and momentum_factors[adaptive_level] have been set.
-//   Allocates and initializes j_i[adaptive_level] if image_light == true or image_emission == true
-//       or image_emission_ave == true.
-//   Allocates and initializes alpha_i[adaptive_level] if image_light == true or image_tau == true
-//       or image_tau_int == true.
-//   Allocates and initializes j_q[adaptive_level], j_v[adaptive_level], alpha_q[adaptive_level],
+//       sample_pos[adaptive_level], sample_dir[adaptive_level], sample_inds[adaptive_level],
+//       sample_nan[adaptive_level], sample_cut[adaptive_level], sample_fallback[adaptive_level],
+//       and momentum_factors[adaptive_level] have been set.
+//   Assumes sample_fracs[adaptive_level] has been set if simulation_interp == true.
+//   Allocates arrays with PrepareSimulationCoefficients(), sized with CountLiveSamples() to hold
+//       only samples outside the cut region, and works on each ray with
+//       CalculateRayCoefficients().
+//   If render_fused == true, also allocates and initializes render[adaptive_level] with
+//       PrepareRendering(), so that rays can be rendered as their coefficients are calculated.
+//   If simulation_sort_samples == true, instead initializes each ray with
+//       InitializeRayCoefficients() and works on samples in the order given by
+//       SortSamplesByBlock(), so that samples reading the same block are processed together.
+//   Deallocates sample_inds[adaptive_level], sample_fracs[adaptive_level],
+//       sample_nan[adaptive_level], and sample_fallback[adaptive_level] if adaptive_level > 0;
+//       sample_cut[adaptive_level] is retained, since integration needs it to locate values.
+void RadiationIntegrator::CalculateSimulationCoefficients()
+{
+  // Prepare constants and allocate arrays
+  int num_pix = camera_num_pix;
+  if (adaptive_level > 0)
+    num_pix = block_counts[adaptive_level] * block_num_pix;
+  int num_live = CountLiveSamples(num_pix);
+  PrepareSimulationCoefficients(num_pix, num_live);
+  if (render_fused)
+    PrepareRendering(num_pix);
+
+  // Go through rays in parallel
+  if (not simulation_sort_samples)
+  {
+    #pragma omp parallel for schedule(static)
+    for (int m = 0; m < num_pix; m++)
+      CalculateRayCoefficients(m, m);
+  }
+
+  // Go through samples in parallel, grouped by block
+  else
+  {
+    #pragma omp parallel for schedule(static)
+    for (int m = 0; m < num_pix; m++)
+      InitializeRayCoefficients(m, m);
+    long int num_sorted = SortSamplesByBlock(num_pix);
+    #pragma omp parallel
+    {
+      #pragma omp for schedule(static) nowait
+      for (long int ind = 0; ind < num_sorted; ind++)
+      {
+        if (ind + 1 < num_sorted)
+          PrefetchSample(sample_order.data[3*ind+3], sample_order.data[3*ind+4]);
+        int m = sample_order.data[3*ind];
+        int n = sample_order.data[3*ind+1];
+        int c = sample_order.data[3*ind+2];
+        CalculateSampleCoefficients(m, m, n, c, nullptr);
+      }
+      if (simulation_batch)
+        CalculateBatchCoefficients(omp_get_thread_num());
+    }
+    sample_order.Deallocate();
+  }
+
+  // Free memory
+  if (adaptive_level > 0)
+  {
+    sample_inds[adaptive_level].Deallocate();
+    sample_fracs[adaptive_level].Deallocate();
+    sample_nan[adaptive_level].Deallocate();
+    sample_fallback[adaptive_level].Deallocate();
+  }
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for counting samples outside cut region
+// Inputs:
+//   num_pix: number of rays
+// Outputs:
+//   returned value: maximum number of samples outside the cut region along any ray
+// Notes:
+//   Assumes sample_num[adaptive_level] and sample_cut[adaptive_level] have been set, with one row
+//       per ray.
+//   Cut regions depend only on geometry, so the result is the same for every snapshot.
+//   Returns at least 1, so that arrays sized with the result are never empty.
+int RadiationIntegrator::CountLiveSamples(int num_pix)
+{
+  int num_live_max = 0;
+  #pragma omp parallel for schedule(static) reduction(max: num_live_max)
+  for (int m = 0; m < num_pix; m++)
+  {
+    int num_steps = sample_num[adaptive_level](m);
+    int num_live = 0;
+    for (int n = 0; n < num_steps; n++)
+      if (not sample_cut[adaptive_level](m,n))
+        num_live++;
+    num_live_max = std::max(num_live_max, num_live);
+  }
+  return std::max(num_live_max, 1);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for preparing to calculate radiative transfer coefficients
+// Inputs:
+//   num_rows: number of rays whose coefficients are held at once
+//   num_cols: maximum number of samples held per ray
+// Outputs: (none)
+// Notes:
+//   Precalculates constants for power-law and kappa distributions the first time it is called.
+//   Tabulates thermal rotativity factors with BuildCoefficientTables() the first time it is called
+//       if plasma_tables == true.
+//   Allocates batch_num, batch_inds, batch_vals, and batch_coefficients with one row per thread the
+//       first time it is called if simulation_batch == true.
+//   Allocates sample_uu1[adaptive_level], sample_uu2[adaptive_level], sample_uu3[adaptive_level],
+//       sample_bb1[adaptive_level], sample_bb2[adaptive_level], and sample_bb3[adaptive_level]
+//       with num_rows rows if image_light == true and image_polarization == true, since these are
+//       needed again for polarized transfer.
+//   Allocates j_i[adaptive_level] if image_light == true or image_emission == true or
+//       image_emission_ave == true.
+//   Allocates alpha_i[adaptive_level] if image_light == true or image_tau == true or
+//       image_tau_int == true.
+//   Allocates j_q[adaptive_level], j_v[adaptive_level], alpha_q[adaptive_level],
 //       alpha_v[adaptive_level], rho_q[adaptive_level], and rho_v[adaptive_level] if
 //       image_light == true and image_polarization == true.
-//   Allocates and initializes cell_values[adaptive_level] if image_lambda_ave == true
-//       or image_emission_ave == true or image_tau_int == true or render_num_images > 0.
-//   References beta-dependent temperature ratio electron model from 2016 AA 586 A38 (E1).
-//   References entropy-based electron model from 2017 MNRAS 466 705 (E2).
+//   Allocates cell_values[adaptive_level] if store_cell_values == true.
 //   References 2021 ApJ 921 17 (M) for transfer coefficients.
-//   Transfer coefficients are calculated in their invariant forms, disagreeing with their
-//       definitions in (M) but agreeing with their usages in 2018 MNRAS 475 43.
-//   Faraday coefficients have additional trap for when Theta_e ~ 0, where rho_Q ~ 0 and rho_V is
-//       given by cold-plasma rotation measure considerations, but numerically one might get NaN,
-//       and the rho_V formula has the wrong asymptotic behavior.
-//   Tetrad is chosen such that j_U, alpha_U, rho_U = 0.
-//   Deallocates sample_cut[adaptive_level], sample_rho[adaptive_level],
-//       sample_pgas[adaptive_level], and sample_kappa[adaptive_level] if adaptive_level > 0.
-//   Dealllocates sample_uu1[adaptive_level], sample_uu2[adaptive_level],
-//       sample_uu3[adaptive_level], sample_bb1[adaptive_level], sample_bb2[adaptive_level], and
-//       sample_bb3[adaptive_level] if image_polarization == false and adaptive_level > 0.
-void RadiationIntegrator::CalculateSimulationCoefficients()
+void RadiationIntegrator::PrepareSimulationCoefficients(int num_rows, int num_cols)
 {
   // Precalculate power-law values (M 38-42)
   if (first_time and plasma_power_frac != 0.0)
@@ -79,6 +175,10 @@ void RadiationIntegrator::CalculateSimulationCoefficients()
     }
   }
 
+  // Tabulate thermal rotativity factors
+  if (first_time and plasma_tables)
+    BuildCoefficientTables();
+
   // Precalculate kappa-distribution values (M 43,44,46-48,50-54)
   if (first_time and plasma_kappa_frac != 0.0)
   {
@@ -192,530 +292,891 @@ void RadiationIntegrator::CalculateSimulationCoefficients()
     }
   }
 
+  // Allocate batch storage
+  if (first_time and simulation_batch)
+  {
+    batch_num.Allocate(num_threads);
+    batch_num.Zero();
+    batch_inds.Allocate(num_threads, 2, batch_size);
+    batch_vals.Allocate(num_threads, BatchValues::num_batch_values, batch_size);
+    batch_coefficients.Allocate(num_threads, BatchCoefficients::num_batch_coefficients,
+        batch_size);
+  }
+
+  // Allocate optical depth storage
+  if (first_time and image_tau_max >= 0.0)
+    ray_tau.Allocate(num_threads, image_num_frequencies);
+
   // Allocate arrays
-  int num_pix = camera_num_pix;
-  if (adaptive_level > 0)
-    num_pix = block_counts[adaptive_level] * block_num_pix;
+  bool store_samples = image_light and image_polarization;
   if (first_time or adaptive_level > 0)
   {
+    if (store_samples)
+    {
+      sample_uu1[adaptive_level].Allocate(num_rows, num_cols);
+      sample_uu2[adaptive_level].Allocate(num_rows, num_cols);
+      sample_uu3[adaptive_level].Allocate(num_rows, num_cols);
+      sample_bb1[adaptive_level].Allocate(num_rows, num_cols);
+      sample_bb2[adaptive_level].Allocate(num_rows, num_cols);
+      sample_bb3[adaptive_level].Allocate(num_rows, num_cols);
+    }
     if (image_light or image_emission or image_emission_ave)
-      j_i[adaptive_level].Allocate(image_num_frequencies, num_pix,
-          geodesic_num_steps[adaptive_level]);
+      j_i[adaptive_level].Allocate(num_rows, num_cols, image_num_frequencies);
     if (image_light or image_tau or image_tau_int)
-      alpha_i[adaptive_level].Allocate(image_num_frequencies, num_pix,
-          geodesic_num_steps[adaptive_level]);
+      alpha_i[adaptive_level].Allocate(num_rows, num_cols, image_num_frequencies);
     if (image_light and image_polarization)
     {
-      j_q[adaptive_level].Allocate(image_num_frequencies, num_pix,
-          geodesic_num_steps[adaptive_level]);
-      j_v[adaptive_level].Allocate(image_num_frequencies, num_pix,
-          geodesic_num_steps[adaptive_level]);
-      alpha_q[adaptive_level].Allocate(image_num_frequencies, num_pix,
-          geodesic_num_steps[adaptive_level]);
-      alpha_v[adaptive_level].Allocate(image_num_frequencies, num_pix,
-          geodesic_num_steps[adaptive_level]);
-      rho_q[adaptive_level].Allocate(image_num_frequencies, num_pix,
-          geodesic_num_steps[adaptive_level]);
-      rho_v[adaptive_level].Allocate(image_num_frequencies, num_pix,
-          geodesic_num_steps[adaptive_level]);
+      j_q[adaptive_level].Allocate(num_rows, num_cols, image_num_frequencies);
+      j_v[adaptive_level].Allocate(num_rows, num_cols, image_num_frequencies);
+      alpha_q[adaptive_level].Allocate(num_rows, num_cols, image_num_frequencies);
+      alpha_v[adaptive_level].Allocate(num_rows, num_cols, image_num_frequencies);
+      rho_q[adaptive_level].Allocate(num_rows, num_cols, image_num_frequencies);
+      rho_v[adaptive_level].Allocate(num_rows, num_cols, image_num_frequencies);
+    }
+    if (store_cell_values)
+      cell_values[adaptive_level].Allocate(CellValues::num_cell_values, num_rows,
+          num_cols);
+  }
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for calculating radiative transfer coefficients along a single ray
+// Inputs:
+//   m: ray index
+//   row: row of per-sample arrays holding ray
+// Outputs: (none)
+// Notes:
+//   Assumes arrays have been allocated with PrepareSimulationCoefficients().
+//   Works on each sample outside the cut region with CalculateSampleCoefficients() after
+//       initializing values with InitializeRayCoefficients().
+//   Requests grid data for each sample with PrefetchSample() while working on the previous one.
+//   If simulation_batch == true, finishes any partial batch with CalculateBatchCoefficients(), so
+//       that all values along the ray are set on return.
+//   If render_fused == true, adds every sample to the rendering with RenderSample() as soon as its
+//       cell values are known, so that they need not be stored.
+//   If image_tau_max >= 0.0, instead works with CalculateTerminatedRayCoefficients().
+void RadiationIntegrator::CalculateRayCoefficients(int m, int row)
+{
+  InitializeRayCoefficients(m, row);
+  if (image_tau_max >= 0.0)
+  {
+    CalculateTerminatedRayCoefficients(m, row);
+    return;
+  }
+  double current_values[CellValues::num_cell_values];
+  double previous_values[CellValues::num_cell_values];
+  double *render_values = render_fused ? current_values : nullptr;
+  for (int n_v = 0; n_v < CellValues::num_cell_values; n_v++)
+    previous_values[n_v] = std::numeric_limits<double>::quiet_NaN();
+  int num_steps = sample_num[adaptive_level](m);
+  int c = 0;
+  for (int n = 0; n < num_steps; n++)
+  {
+    if (render_fused)
+      for (int n_v = 0; n_v < CellValues::num_cell_values; n_v++)
+        current_values[n_v] = std::numeric_limits<double>::quiet_NaN();
+    if (not sample_cut[adaptive_level](row,n))
+    {
+      if (n + 1 < num_steps)
+        PrefetchSample(row, n + 1);
+      CalculateSampleCoefficients(m, row, n, c++, render_values);
     }
-    if (image_lambda_ave or image_emission_ave or image_tau_int or render_num_images > 0)
-      cell_values[adaptive_level].Allocate(CellValues::num_cell_values, num_pix,
-          geodesic_num_steps[adaptive_level]);
+    if (render_fused)
+      RenderSample(m, n, current_values, previous_values);
   }
-  j_i[adaptive_level].Zero();
-  j_q[adaptive_level].Zero();
-  j_v[adaptive_level].Zero();
-  alpha_i[adaptive_level].Zero();
-  alpha_q[adaptive_level].Zero();
-  alpha_v[adaptive_level].Zero();
-  rho_q[adaptive_level].Zero();
-  rho_v[adaptive_level].Zero();
-  cell_values[adaptive_level].SetNaN();
+  if (simulation_batch)
+    CalculateBatchCoefficients(omp_get_thread_num());
+  return;
+}
 
+//--------------------------------------------------------------------------------------------------
+
+// Function for calculating radiative transfer coefficients along a single ray until it is opaque
+// Inputs:
+//   m: ray index
+//   row: row of per-sample arrays holding ray
+// Outputs: (none)
+// Notes:
+//   Assumes values have been initialized with InitializeRayCoefficients().
+//   Works on samples outside the cut region starting at the camera, accumulating the optical depth
+//       at each frequency in ray_tau, and stops once it exceeds image_tau_max at all frequencies.
+//   Remaining samples farther from the camera retain their initial values, which is appropriate
+//       for IntegrateUnpolarizedRay(), since it stops at the same optical depth.
+//   If simulation_batch == true, coefficients are only complete after the batch is finished, so
+//       the optical depth is only checked at those points.
+void RadiationIntegrator::CalculateTerminatedRayCoefficients(int m, int row)
+{
   // Calculate units
-  double d_unit = simulation_rho_cgs;
-  double e_unit = d_unit * Physics::c * Physics::c;
-  double b_unit = std::sqrt(4.0 * Math::pi * e_unit);
+  double x_unit = Physics::gg_msun * mass_msun / (Physics::c * Physics::c);
+
+  // Count samples outside cut region
+  int num_steps = sample_num[adaptive_level](m);
+  int num_live = 0;
+  for (int n = 0; n < num_steps; n++)
+    if (not sample_cut[adaptive_level](row,n))
+      num_live++;
+
+  // Prepare optical depths
+  int thread = omp_get_thread_num();
+  for (int l = 0; l < image_num_frequencies; l++)
+    ray_tau(thread,l) = 0.0;
+  int n_checked = num_steps;
+  int c_checked = num_live;
+
+  // Go through samples from camera
+  int c = num_live;
+  for (int n = num_steps - 1; n >= 0; n--)
+    if (not sample_cut[adaptive_level](row,n))
+    {
+      if (n > 0)
+        PrefetchSample(row, n - 1);
+      CalculateSampleCoefficients(m, row, n, --c, nullptr);
+      if (simulation_batch and batch_num(thread) > 0)
+        continue;
+
+      // Add optical depths of completed samples
+      bool opaque = true;
+      for (int l = 0; l < image_num_frequencies; l++)
+      {
+        double delta_lambda_factor =
+            x_unit / (image_frequencies(l) * momentum_factors[adaptive_level](m));
+        int c_tau = c_checked;
+        for (int n_tau = n_checked - 1; n_tau >= n; n_tau--)
+          if (not sample_cut[adaptive_level](row,n_tau))
+            ray_tau(thread,l) += alpha_i[adaptive_level](row,--c_tau,l)
+                * sample_len[adaptive_level](m,n_tau) * delta_lambda_factor;
+        opaque = opaque and ray_tau(thread,l) > image_tau_max;
+      }
+      n_checked = n;
+      c_checked = c;
+      if (opaque)
+        break;
+    }
+  if (simulation_batch)
+    CalculateBatchCoefficients(thread);
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for ordering samples by the simulation block they read
+// Inputs:
+//   num_pix: number of rays
+// Outputs:
+//   returned value: number of samples placed in sample_order
+// Notes:
+//   Assumes sample_num[adaptive_level], sample_inds[adaptive_level], sample_nan[adaptive_level],
+//       and sample_cut[adaptive_level] have been set, with one row per ray.
+//   Allocates sample_order and fills it with (ray, sample, stored sample) index triples for all
+//       samples not in the cut region, sorted by block index with a stable counting sort.
+//   Samples with no valid cell data are placed after all blocks.
+//   Within each block, samples retain their ray order, and each sample is still written to its
+//       own place in the per-sample arrays, so results are independent of the ordering.
+long int RadiationIntegrator::SortSamplesByBlock(int num_pix)
+{
+  // Allocate arrays
+  int n_b = x1f.n2;
+  if (sample_order.allocated)
+    sample_order.Deallocate();
+  sample_order.Allocate(num_pix, geodesic_num_steps[adaptive_level], 3);
+  Array<long int> block_counts_thread(num_threads, n_b + 2);
+  block_counts_thread.Zero();
 
-  // Work in parallel
+  // Sort samples in parallel
   #pragma omp parallel
   {
-    // Allocate scratch space
-    double gcov_sim[4][4];
-    double gcon_sim[4][4];
-    double gcov[4][4];
-    double gcon[4][4];
-    double jacobian[4][4];
-    double tetrad[4][4];
-
-    // Go through rays and samples
+    // Count samples in each block
+    int thread = omp_get_thread_num();
     #pragma omp for schedule(static)
     for (int m = 0; m < num_pix; m++)
     {
       int num_steps = sample_num[adaptive_level](m);
       for (int n = 0; n < num_steps; n++)
       {
-        // Skip coupling if in cut region
         if (sample_cut[adaptive_level](m,n))
           continue;
+        int b = sample_nan[adaptive_level](m,n) ? n_b : sample_inds[adaptive_level](m,n,0);
+        block_counts_thread(thread,b+1)++;
+      }
+    }
 
-        // Extract geodesic position and covariant momentum
-        double x1 = sample_pos[adaptive_level](m,n,1);
-        double x2 = sample_pos[adaptive_level](m,n,2);
-        double x3 = sample_pos[adaptive_level](m,n,3);
-        double kcov[4];
-        kcov[0] = sample_dir[adaptive_level](m,n,0);
-        kcov[1] = sample_dir[adaptive_level](m,n,1);
-        kcov[2] = sample_dir[adaptive_level](m,n,2);
-        kcov[3] = sample_dir[adaptive_level](m,n,3);
-
-        // Extract model variables
-        double rho = sample_rho[adaptive_level](m,n);
-        double pgas = sample_pgas[adaptive_level](m,n);
-        double kappa = 0.0;
-        if (plasma_model == PlasmaModel::code_kappa)
-          kappa = sample_kappa[adaptive_level](m,n);
-        double uu1_sim = sample_uu1[adaptive_level](m,n);
-        double uu2_sim = sample_uu2[adaptive_level](m,n);
-        double uu3_sim = sample_uu3[adaptive_level](m,n);
-        double bb1_sim = sample_bb1[adaptive_level](m,n);
-        double bb2_sim = sample_bb2[adaptive_level](m,n);
-        double bb3_sim = sample_bb3[adaptive_level](m,n);
-
-        // Calculate densities and pressures
-        double rho_cgs = rho * d_unit;
-        double pgas_cgs = pgas * e_unit;
-        double n_cgs = rho_cgs / (plasma_mu * Physics::m_p);
-        double n_e_cgs = n_cgs / (1.0 + 1.0 / plasma_ne_ni);
-
-        // Calculate simulation metric
-        CovariantSimulationMetric(x1, x2, x3, gcov_sim);
-        ContravariantSimulationMetric(x1, x2, x3, gcon_sim);
-
-        // Calculate simulation velocity
-        double uu0_sim = std::sqrt(1.0 + gcov_sim[1][1] * uu1_sim * uu1_sim
-            + 2.0 * gcov_sim[1][2] * uu1_sim * uu2_sim + 2.0 * gcov_sim[1][3] * uu1_sim * uu3_sim
-            + gcov_sim[2][2] * uu2_sim * uu2_sim + 2.0 * gcov_sim[2][3] * uu2_sim * uu3_sim
-            + gcov_sim[3][3] * uu3_sim * uu3_sim);
-        double lapse_sim = 1.0 / std::sqrt(-gcon_sim[0][0]);
-        double shift1_sim = -gcon_sim[0][1] / gcon_sim[0][0];
-        double shift2_sim = -gcon_sim[0][2] / gcon_sim[0][0];
-        double shift3_sim = -gcon_sim[0][3] / gcon_sim[0][0];
-        double ucon_sim[4];
-        ucon_sim[0] = uu0_sim / lapse_sim;
-        ucon_sim[1] = uu1_sim - shift1_sim * uu0_sim / lapse_sim;
-        ucon_sim[2] = uu2_sim - shift2_sim * uu0_sim / lapse_sim;
-        ucon_sim[3] = uu3_sim - shift3_sim * uu0_sim / lapse_sim;
-        double ucov_sim[4] = {};
-        for (int mu = 0; mu < 4; mu++)
-          for (int nu = 0; nu < 4; nu++)
-            ucov_sim[mu] += gcov_sim[mu][nu] * ucon_sim[nu];
-
-        // Calculate simulation magnetic field
-        double bcon_sim[4];
-        bcon_sim[0] = ucov_sim[1] * bb1_sim + ucov_sim[2] * bb2_sim + ucov_sim[3] * bb3_sim;
-        bcon_sim[1] = (bb1_sim + bcon_sim[0] * ucon_sim[1]) / ucon_sim[0];
-        bcon_sim[2] = (bb2_sim + bcon_sim[0] * ucon_sim[2]) / ucon_sim[0];
-        bcon_sim[3] = (bb3_sim + bcon_sim[0] * ucon_sim[3]) / ucon_sim[0];
-        double bcov_sim[4] = {};
-        for (int mu = 0; mu < 4; mu++)
-          for (int nu = 0; nu < 4; nu++)
-            bcov_sim[mu] += gcov_sim[mu][nu] * bcon_sim[nu];
-        double b_sq = 0.0;
-        for (int mu = 0; mu < 4; mu++)
-          b_sq += bcov_sim[mu] * bcon_sim[mu];
-        double bb_cgs = std::sqrt(b_sq) * b_unit;
-        double sigma = b_sq / rho;
-        double beta_inv = b_sq / (2.0 * pgas);
-
-        // Calculate electron temperature for model with T_i/T_e a function of beta (E1 1)
-        double kb_tt_e_cgs = std::numeric_limits<double>::quiet_NaN();
-        double theta_e = std::numeric_limits<double>::quiet_NaN();
-        if (plasma_thermal_frac != 0.0 and plasma_model == PlasmaModel::ti_te_beta)
-        {
-          double tti_tte = (plasma_rat_high + plasma_rat_low * beta_inv * beta_inv)
-              / (1.0 + beta_inv * beta_inv);
-          double kb_tt_tot_cgs = plasma_mu * Physics::m_p * pgas_cgs / rho_cgs;
-          if (plasma_use_p)
-            kb_tt_e_cgs = (1.0 + plasma_ne_ni) / (tti_tte + plasma_ne_ni) * kb_tt_tot_cgs;
-          else
-          {
-            kb_tt_e_cgs = (1.0 + plasma_ne_ni) * kb_tt_tot_cgs / (plasma_gamma - 1.0);
-            kb_tt_e_cgs /= tti_tte / (plasma_gamma_i - 1.0) + plasma_ne_ni / (plasma_gamma_e - 1.0);
-          }
-          theta_e = kb_tt_e_cgs / (Physics::m_e * Physics::c * Physics::c);
-        }
-
-        // Calculate electron temperature for given electron entropy (E2 13)
-        if (plasma_thermal_frac != 0.0 and plasma_model == PlasmaModel::code_kappa)
+    // Calculate offsets for each thread and block
+    #pragma omp single
+    {
+      long int offset = 0;
+      for (int b = 0; b <= n_b; b++)
+        for (int thread_other = 0; thread_other < num_threads; thread_other++)
         {
-          double mu_e = plasma_mu * (1.0 + 1.0 / plasma_ne_ni);
-          double rho_e = rho * Physics::m_e / (mu_e * Physics::m_p);
-          double rho_kappa_e_cbrt = std::cbrt(rho_e * kappa);
-          theta_e = 1.0 / 5.0 * (std::sqrt(1.0 + 25.0 * rho_kappa_e_cbrt * rho_kappa_e_cbrt) - 1.0);
-          kb_tt_e_cgs = theta_e * Physics::m_e * Physics::c * Physics::c;
+          long int count = block_counts_thread(thread_other,b+1);
+          block_counts_thread(thread_other,b+1) = offset;
+          offset += count;
         }
+      block_counts_thread(0,0) = offset;
+    }
 
-        // Skip coupling based on cell values
-        if ((cut_rho_min >= 0.0 and rho_cgs < cut_rho_min)
-            or (cut_rho_max >= 0.0 and rho_cgs > cut_rho_max)
-            or (cut_n_e_min >= 0.0 and n_e_cgs < cut_n_e_min)
-            or (cut_n_e_max >= 0.0 and n_e_cgs > cut_n_e_max)
-            or (cut_p_gas_min >= 0.0 and pgas_cgs < cut_p_gas_min)
-            or (cut_p_gas_max >= 0.0 and pgas_cgs > cut_p_gas_max)
-            or (cut_theta_e_min >= 0.0 and theta_e < cut_theta_e_min)
-            or (cut_theta_e_max >= 0.0 and theta_e > cut_theta_e_max)
-            or (cut_b_min >= 0.0 and bb_cgs < cut_b_min)
-            or (cut_b_max >= 0.0 and bb_cgs > cut_b_max)
-            or (cut_sigma_min >= 0.0 and sigma < cut_sigma_min)
-            or (cut_sigma_max >= 0.0 and sigma > cut_sigma_max)
-            or (cut_beta_inverse_min >= 0.0 and beta_inv < cut_beta_inverse_min)
-            or (cut_beta_inverse_max >= 0.0 and beta_inv > cut_beta_inverse_max))
+    // Place samples
+    #pragma omp for schedule(static)
+    for (int m = 0; m < num_pix; m++)
+    {
+      int num_steps = sample_num[adaptive_level](m);
+      int c = 0;
+      for (int n = 0; n < num_steps; n++)
+      {
+        if (sample_cut[adaptive_level](m,n))
           continue;
+        int b = sample_nan[adaptive_level](m,n) ? n_b : sample_inds[adaptive_level](m,n,0);
+        long int ind = block_counts_thread(thread,b+1)++;
+        sample_order.data[3*ind] = m;
+        sample_order.data[3*ind+1] = n;
+        sample_order.data[3*ind+2] = c++;
+      }
+    }
+  }
+  return block_counts_thread(0,0);
+}
 
-        // Record cell values
-        if (image_lambda_ave or image_emission_ave or image_tau_int or render_num_images > 0)
-        {
-          cell_values[adaptive_level](static_cast<int>(CellValues::rho),m,n) = rho_cgs;
-          cell_values[adaptive_level](static_cast<int>(CellValues::n_e),m,n) = n_e_cgs;
-          cell_values[adaptive_level](static_cast<int>(CellValues::p_gas),m,n) = pgas_cgs;
-          cell_values[adaptive_level](static_cast<int>(CellValues::theta_e),m,n) = theta_e;
-          cell_values[adaptive_level](static_cast<int>(CellValues::bb),m,n) = bb_cgs;
-          cell_values[adaptive_level](static_cast<int>(CellValues::sigma),m,n) = sigma;
-          cell_values[adaptive_level](static_cast<int>(CellValues::beta_inv),m,n) = beta_inv;
-        }
+//--------------------------------------------------------------------------------------------------
 
-        // Skip remaining calculations if possible
-        if (not (image_light or image_emission or image_tau or image_emission_ave or image_tau_int))
-          continue;
+// Function for initializing radiative transfer coefficients along a single ray
+// Inputs:
+//   m: ray index
+//   row: row of per-sample arrays holding ray
+// Outputs: (none)
+// Notes:
+//   Assumes sample_num[adaptive_level] and the given row of sample_cut[adaptive_level] have been
+//       set.
+//   Assumes arrays have been allocated with PrepareSimulationCoefficients().
+//   Initializes given row of allocated coefficient arrays, cell_values[adaptive_level], and
+//       stored samples for the samples along the ray outside the cut region.
+void RadiationIntegrator::InitializeRayCoefficients(int m, int row)
+{
+  // Count samples outside cut region
+  int num_steps = sample_num[adaptive_level](m);
+  int num_live = 0;
+  for (int n = 0; n < num_steps; n++)
+    if (not sample_cut[adaptive_level](row,n))
+      num_live++;
 
-        // Skip coupling if magnetic field vanishes
-        if (bb1_sim == 0.0 and bb2_sim == 0.0 and bb3_sim == 0.0)
-          continue;
+  // Initialize values along ray
+  bool store_samples = image_light and image_polarization;
+  for (int c = 0; c < num_live; c++)
+    for (int l = 0; l < image_num_frequencies; l++)
+    {
+      if (image_light or image_emission or image_emission_ave)
+        j_i[adaptive_level](row,c,l) = 0.0;
+      if (image_light or image_tau or image_tau_int)
+        alpha_i[adaptive_level](row,c,l) = 0.0;
+      if (image_light and image_polarization)
+      {
+        j_q[adaptive_level](row,c,l) = 0.0;
+        j_v[adaptive_level](row,c,l) = 0.0;
+        alpha_q[adaptive_level](row,c,l) = 0.0;
+        alpha_v[adaptive_level](row,c,l) = 0.0;
+        rho_q[adaptive_level](row,c,l) = 0.0;
+        rho_v[adaptive_level](row,c,l) = 0.0;
+      }
+    }
+  if (store_cell_values)
+    for (int a = 0; a < CellValues::num_cell_values; a++)
+      for (int c = 0; c < num_live; c++)
+        cell_values[adaptive_level](a,row,c) = std::numeric_limits<double>::quiet_NaN();
+  if (store_samples)
+    for (int c = 0; c < num_live; c++)
+    {
+      sample_uu1[adaptive_level](row,c) = 0.0f;
+      sample_uu2[adaptive_level](row,c) = 0.0f;
+      sample_uu3[adaptive_level](row,c) = 0.0f;
+      sample_bb1[adaptive_level](row,c) = 0.0f;
+      sample_bb2[adaptive_level](row,c) = 0.0f;
+      sample_bb3[adaptive_level](row,c) = 0.0f;
+    }
+  return;
+}
 
-        // Calculate Jacobian of transformation from simulation to geodesic coordinates
-        CoordinateJacobian(x1, x2, x3, jacobian);
-
-        // Transform contravariant velocity and magnetic field to geodesic coordinates
-        double ucon[4] = {};
-        for (int mu = 0; mu < 4; mu++)
-          for (int nu = 0; nu < 4; nu++)
-            ucon[mu] += jacobian[mu][nu] * ucon_sim[nu];
-        double bcon[4] = {};
-        for (int mu = 0; mu < 4; mu++)
-          for (int nu = 0; nu < 4; nu++)
-            bcon[mu] += jacobian[mu][nu] * bcon_sim[nu];
-
-        // Calculate geodesic metric
-        CovariantGeodesicMetric(x1, x2, x3, gcov);
-        ContravariantGeodesicMetric(x1, x2, x3, gcon);
-
-        // Calculate geodesic contravariant momentum
-        double kcon[4] = {};
-        for (int mu = 0; mu < 4; mu++)
-          for (int nu = 0; nu < 4; nu++)
-            kcon[mu] += gcon[mu][nu] * kcov[nu];
-
-        // Calculate covariant velocity and magnetic field
-        double ucov[4] = {};
-        for (int mu = 0; mu < 4; mu++)
-          for (int nu = 0; nu < 4; nu++)
-            ucov[mu] += gcov[mu][nu] * ucon[nu];
-        double bcov[4] = {};
-        for (int mu = 0; mu < 4; mu++)
-          for (int nu = 0; nu < 4; nu++)
-            bcov[mu] += gcov[mu][nu] * bcon[nu];
-
-        // Calculate orthonormal tetrad
-        Tetrad(ucon, ucov, kcon, kcov, bcon, gcov, gcon, tetrad);
-
-        // Calculate orthonormal-frame angle between wavevector and magnetic field
-        double k_tet_1 = 0.0;
-        double k_tet_2 = 0.0;
-        double k_tet_3 = 0.0;
-        double b_tet_1 = 0.0;
-        double b_tet_2 = 0.0;
-        double b_tet_3 = 0.0;
-        for (int mu = 0; mu < 4; mu++)
-        {
-          k_tet_1 += tetrad[1][mu] * kcov[mu];
-          k_tet_2 += tetrad[2][mu] * kcov[mu];
-          k_tet_3 += tetrad[3][mu] * kcov[mu];
-          b_tet_1 += tetrad[1][mu] * bcov[mu];
-          b_tet_2 += tetrad[2][mu] * bcov[mu];
-          b_tet_3 += tetrad[3][mu] * bcov[mu];
-        }
-        double k_sq_tet = k_tet_1 * k_tet_1 + k_tet_2 * k_tet_2 + k_tet_3 * k_tet_3;
-        double b_sq_tet = b_tet_1 * b_tet_1 + b_tet_2 * b_tet_2 + b_tet_3 * b_tet_3;
-        double k_b_tet = k_tet_1 * b_tet_1 + k_tet_2 * b_tet_2 + k_tet_3 * b_tet_3;
-        double cos2_theta_b = std::min(k_b_tet * k_b_tet / (k_sq_tet * b_sq_tet), 1.0);
-        double sin2_theta_b = 1.0 - cos2_theta_b;
-        double sin_theta_b = std::sqrt(sin2_theta_b);
-        double cos_theta_b = std::sqrt(cos2_theta_b) * (k_b_tet >= 0.0 ? 1.0 : -1.0);
-
-        // Go through frequencies
-        for (int l = 0; l < image_num_frequencies; l++)
-        {
-          // Calculate orthonormal-frame frequencies
-          double nu_cgs = 0.0;
-          for (int mu = 0; mu < 4; mu++)
-            nu_cgs -= kcov[mu] * ucon[mu];
-          nu_cgs *= image_frequencies(l) * momentum_factors[adaptive_level](m);
-          double nu_2_cgs = nu_cgs * nu_cgs;
-          double nu_c_cgs = Physics::e * bb_cgs / (2.0 * Math::pi * Physics::m_e * Physics::c);
-          double nu_s_cgs = 2.0 / 9.0 * nu_c_cgs * theta_e * theta_e * sin_theta_b;
-
-          // Calculate thermal synchrotron emissivities (M 28,30)
-          double j_i_val;
-          if (plasma_thermal_frac != 0.0)
-          {
-            double xx = nu_cgs / nu_s_cgs;
-            double xx_1_2 = std::sqrt(xx);
-            double xx_1_3 = std::cbrt(xx);
-            double xx_1_6 = std::sqrt(xx_1_3);
-            double coefficient = plasma_thermal_frac * n_e_cgs * Physics::e * Physics::e * nu_c_cgs
-                / (Physics::c * nu_2_cgs) * std::exp(-xx_1_3);
-            double var_a = Math::sqrt2 * Math::pi / 27.0 * sin_theta_b;
-            double var_b = std::pow(2.0, 11.0 / 12.0);
-            double var_c = xx_1_2 + var_b * xx_1_6;
-            j_i_val = coefficient * var_a * var_c * var_c;
-            if (image_light or image_emission or image_emission_ave)
-              j_i[adaptive_level](l,m,n) = j_i_val;
-            if (image_light and image_polarization)
-            {
-              double var_d = (7.0 * std::pow(theta_e, 0.96) + 35.0)
-                  / (10.0 * std::pow(theta_e, 0.96) + 75.0) * var_b;
-              double var_e = xx_1_2 + var_d * xx_1_6;
-              double var_f = cos_theta_b / theta_e;
-              double var_g = Math::pi / 3.0 + Math::pi / 3.0 * xx_1_3 + 2.0 / 300.0 * xx_1_2
-                  + 2.0 / 19.0 * Math::pi * xx_1_3 * xx_1_3;
-              j_q[adaptive_level](l,m,n) = -coefficient * var_a * var_e * var_e;
-              j_v[adaptive_level](l,m,n) = coefficient * var_f * var_g;
-            }
-          }
-
-          // Calculate thermal synchrotron absorptivities from Kirchoff's law (M 31)
-          if (plasma_thermal_frac != 0.0)
-          {
-            // Calculate absorptivities
-            double b_nu_nu_3_cgs = 2.0 * Physics::h / (Physics::c * Physics::c)
-                / std::expm1(Physics::h * nu_cgs / kb_tt_e_cgs);
-            if (image_light or image_tau or image_tau_int)
-              alpha_i[adaptive_level](l,m,n) = j_i_val / b_nu_nu_3_cgs;
-            if (image_light and image_polarization)
-            {
-              alpha_q[adaptive_level](l,m,n) = j_q[adaptive_level](l,m,n) / b_nu_nu_3_cgs;
-              alpha_v[adaptive_level](l,m,n) = j_v[adaptive_level](l,m,n) / b_nu_nu_3_cgs;
-            }
-
-            // Account for numerical issues later arising from absorptivities being too small
-            if ((image_light or image_tau or image_tau_int)
-                and 1.0 / (alpha_i[adaptive_level](l,m,n) * alpha_i[adaptive_level](l,m,n))
-                == std::numeric_limits<double>::infinity())
-            {
-              alpha_i[adaptive_level](l,m,n) = 0.0;
-              if (image_light and image_polarization)
-              {
-                alpha_q[adaptive_level](l,m,n) = 0.0;
-                alpha_v[adaptive_level](l,m,n) = 0.0;
-              }
-            }
-          }
-
-          // Calculate thermal synchrotron rotativities (M 33-37)
-          if (plasma_thermal_frac != 0.0 and image_light and image_polarization)
-          {
-            double coefficient_q = -plasma_thermal_frac * n_e_cgs * Physics::e * Physics::e
-                * nu_c_cgs * nu_c_cgs * sin2_theta_b / (Physics::m_e * Physics::c * nu_2_cgs);
-            double coefficient_v = plasma_thermal_frac * 2.0 * n_e_cgs * Physics::e * Physics::e
-                * nu_c_cgs * cos_theta_b / (Physics::m_e * Physics::c * nu_cgs);
-            double factor_q = 0.0;
-            double factor_v = 1.0;
-            if (theta_e >= theta_e_zero)
-            {
-              double kk_0 = std::cyl_bessel_k(0.0, 1.0 / theta_e);
-              double kk_1 = std::cyl_bessel_k(1.0, 1.0 / theta_e);
-              double kk_2 = std::cyl_bessel_k(2.0, 1.0 / theta_e);
-              double xx = nu_cgs / nu_s_cgs;
-              double xx_neg_1_2 = 1.0 / std::sqrt(xx);
-              double var_a = 2.011 * std::exp(-19.78 * std::pow(xx, -0.5175));
-              double var_b = std::cos(39.89 * xx_neg_1_2) * std::exp(-70.16 * std::pow(xx, -0.6));
-              double var_c = 0.011 * std::exp(-1.69 * xx_neg_1_2);
-              double var_d = 0.003135 * std::pow(xx, 4.0 / 3.0);
-              double var_e = 0.5 * (1.0 + std::tanh(10.0 * std::log(0.6648 * xx_neg_1_2)));
-              double f_0 = var_a - var_b - var_c;
-              double f_m = f_0 + (var_c - var_d) * var_e;
-              double delta_jj_5 = 0.4379 * std::log(1.0 + 1.3414 * std::pow(xx, -0.7515));
-              factor_q = f_m * (kk_1 / kk_2 + 6.0 * theta_e);
-              factor_v = (kk_0 - delta_jj_5) / kk_2;
-              factor_v = factor_v < 0.0 or factor_v > 1.0 ? 1.0 : factor_v;
-            }
-            rho_q[adaptive_level](l,m,n) = coefficient_q * factor_q;
-            rho_v[adaptive_level](l,m,n) = coefficient_v * factor_v;
-          }
-
-          // Calculate power-law synchrotron emissivities (M 28,38)
-          if (plasma_power_frac != 0.0 and (image_light or image_emission or image_emission_ave))
-          {
-            double var_a = std::pow(nu_cgs / (nu_c_cgs * sin_theta_b), -(plasma_p - 1.0) / 2.0);
-            double coefficient = plasma_power_frac * n_e_cgs * Physics::e * Physics::e * nu_c_cgs
-                / (Physics::c * nu_2_cgs) * power_jj * sin_theta_b * var_a;
-            j_i[adaptive_level](l,m,n) += coefficient;
-            if (image_light and image_polarization)
-            {
-              double var_b = cos_theta_b / sin_theta_b;
-              double var_c = 1.0 / std::sqrt(nu_cgs / (3.0 * nu_c_cgs * sin_theta_b));
-              j_q[adaptive_level](l,m,n) += coefficient * power_jj_q;
-              j_v[adaptive_level](l,m,n) += coefficient * power_jj_v * var_b * var_c;
-            }
-          }
-
-          // Calculate power-law synchrotron absorptivities (M 29,39)
-          if (plasma_power_frac != 0.0 and (image_light or image_tau or image_tau_int))
-          {
-            double var_a = std::pow(nu_cgs / (nu_c_cgs * sin_theta_b), -(plasma_p + 2.0) / 2.0);
-            double coefficient = plasma_power_frac * n_e_cgs * Physics::e * Physics::e
-                / (Physics::m_e * Physics::c) * power_aa * var_a;
-            alpha_i[adaptive_level](l,m,n) += coefficient;
-            if (image_light and image_polarization)
-            {
-              double var_b = std::pow(3.1 * std::pow(sin_theta_b, -1.92) - 3.1, 0.512);
-              double var_c = 1.0 / std::sqrt(nu_cgs / (nu_c_cgs * sin_theta_b));
-              double var_d = cos_theta_b >= 0.0 ? 1.0 : -1.0;
-              alpha_q[adaptive_level](l,m,n) += coefficient * power_aa_q;
-              alpha_v[adaptive_level](l,m,n) += coefficient * power_aa_v * var_b * var_c * var_d;
-            }
-          }
-
-          // Calculate power-law synchrotron rotativities (M 40-42)
-          if (plasma_power_frac != 0.0 and image_light and image_polarization)
-          {
-            double var_a = n_e_cgs * Physics::e * Physics::e * nu_cgs
-                / (Physics::m_e * Physics::c * nu_c_cgs * sin_theta_b);
-            double var_b = nu_c_cgs * sin_theta_b / nu_cgs;
-            double var_c = var_b * var_b;
-            double var_d = var_c * var_b;
-            double var_e = 1.0 - std::pow(2.0 * nu_c_cgs * plasma_gamma_min * plasma_gamma_min
-                * sin_theta_b / (3.0 * nu_cgs), plasma_p / 2.0 - 1.0);
-            double var_f = cos_theta_b / sin_theta_b;
-            double coefficient = plasma_power_frac * power_rho * var_a;
-            rho_q[adaptive_level](l,m,n) += coefficient * power_rho_q * var_d * var_e;
-            rho_v[adaptive_level](l,m,n) += coefficient * power_rho_v * var_c * var_f;
-          }
-
-          // Calculate kappa-distribution synchrotron emissivities (M 28,43-46)
-          if (plasma_kappa_frac != 0.0 and (image_light or image_emission or image_emission_ave))
-          {
-            double nu_kappa_cgs =
-                nu_c_cgs * plasma_w * plasma_w * plasma_kappa * plasma_kappa * sin_theta_b;
-            double xx = nu_cgs / nu_kappa_cgs;
-            double var_a = plasma_kappa_frac * n_e_cgs * Physics::e * Physics::e * nu_c_cgs
-                / (Physics::c * nu_2_cgs);
-            double var_b = std::cbrt(xx) * sin_theta_b;
-            double var_c = std::pow(xx, -(plasma_kappa - 2.0) / 2.0) * sin_theta_b;
-            double coefficient_low = kappa_jj_low * var_a * var_b;
-            double coefficient_high = kappa_jj_high * var_a * var_c;
-            j_i[adaptive_level](l,m,n) += std::pow(std::pow(coefficient_low, -kappa_jj_x_i)
-                + std::pow(coefficient_high, -kappa_jj_x_i), -1.0 / kappa_jj_x_i);
-            if (image_light and image_polarization)
-            {
-              double var_d = std::pow(std::pow(sin_theta_b, -2.4) - 1.0, 0.48);
-              double var_e = std::pow(xx, -0.35);
-              double var_f = std::pow(std::pow(sin_theta_b, -2.5) - 1.0, 0.44);
-              double var_g = 1.0 / std::sqrt(xx);
-              double var_h = cos_theta_b >= 0.0 ? 1.0 : -1.0;
-              double jj_q_low = coefficient_low * kappa_jj_low_q;
-              double jj_v_low = coefficient_low * kappa_jj_low_v * var_d * var_e;
-              double jj_q_high = coefficient_high * kappa_jj_high_q;
-              double jj_v_high = coefficient_high * kappa_jj_high_v * var_f * var_g;
-              j_q[adaptive_level](l,m,n) -= std::pow(std::pow(jj_q_low, -kappa_jj_x_q)
-                  + std::pow(jj_q_high, -kappa_jj_x_q), -1.0 / kappa_jj_x_q);
-              j_v[adaptive_level](l,m,n) += std::pow(std::pow(jj_v_low, -kappa_jj_x_v)
-                  + std::pow(jj_v_high, -kappa_jj_x_v), -1.0 / kappa_jj_x_v) * var_h;
-            }
-          }
-
-          // Calculate kappa-distribution synchrotron absoptivities (M 29,47-50)
-          if (plasma_kappa_frac != 0.0 and (image_light or image_tau or image_tau_int))
-          {
-            double nu_kappa_cgs =
-                nu_c_cgs * plasma_w * plasma_w * plasma_kappa * plasma_kappa * sin_theta_b;
-            double xx = nu_cgs / nu_kappa_cgs;
-            double var_a =
-                plasma_kappa_frac * n_e_cgs * Physics::e * Physics::e / (Physics::m_e * Physics::c);
-            double var_b = std::pow(xx, -2.0 / 3.0);
-            double var_c = std::pow(xx, -(1.0 + plasma_kappa) / 2.0);
-            double coefficient_low = kappa_aa_low * var_a * var_b;
-            double coefficient_high = kappa_aa_high * var_a * var_c;
-            double aa_i_low = coefficient_low;
-            double aa_i_high = coefficient_high * kappa_aa_high_i;
-            alpha_i[adaptive_level](l,m,n) += std::pow(std::pow(aa_i_low, -kappa_aa_x_i)
-                + std::pow(aa_i_high, -kappa_aa_x_i), -1.0 / kappa_aa_x_i);
-            if (image_light and image_polarization)
-            {
-              double var_d = std::pow(std::pow(sin_theta_b, -2.28) - 1.0, 0.446);
-              double var_e = std::pow(xx, -0.35);
-              double var_f = std::sqrt(std::pow(sin_theta_b, -2.05) - 1.0);
-              double var_g = 1.0 / std::sqrt(xx);
-              double var_h = cos_theta_b >= 0.0 ? 1.0 : -1.0;
-              double aa_q_low = coefficient_low * kappa_aa_low_q;
-              double aa_v_low = coefficient_low * kappa_aa_low_v * var_d * var_e;
-              double aa_q_high = coefficient_high * kappa_aa_high_q;
-              double aa_v_high = coefficient_high * kappa_aa_high_v * var_f * var_g;
-              alpha_q[adaptive_level](l,m,n) -= std::pow(std::pow(aa_q_low, -kappa_aa_x_q)
-                  + std::pow(aa_q_high, -kappa_aa_x_q), -1.0 / kappa_aa_x_q);
-              alpha_v[adaptive_level](l,m,n) += std::pow(std::pow(aa_v_low, -kappa_aa_x_v)
-                  + std::pow(aa_v_high, -kappa_aa_x_v), -1.0 / kappa_aa_x_v) * var_h;
-            }
-          }
-
-          // Calculate kappa-distribution synchrotron rotativities (M 51-54)
-          if (plasma_kappa_frac != 0.0 and image_light and image_polarization)
-          {
-            double nu_kappa_cgs =
-                nu_c_cgs * plasma_w * plasma_w * plasma_kappa * plasma_kappa * sin_theta_b;
-            double xx = nu_cgs / nu_kappa_cgs;
-            double var_a = -plasma_kappa_frac * n_e_cgs * Physics::e * Physics::e * nu_c_cgs
-                * nu_c_cgs * sin2_theta_b / (Physics::m_e * Physics::c * nu_2_cgs);
-            double var_b = plasma_kappa_frac * 2.0 * n_e_cgs * Physics::e * Physics::e * nu_c_cgs
-                * cos_theta_b / (Physics::m_e * Physics::c * nu_cgs);
-            double var_c = 1.0 / std::sqrt(xx);
-            double rho_q_low = var_a * kappa_rho_q_low_a * (1.0 - std::exp(kappa_rho_q_low_b
-                * std::pow(xx, 0.84)) - std::sin(kappa_rho_q_low_c * xx)
-                * std::exp(kappa_rho_q_low_d * std::pow(xx, kappa_rho_q_low_e)));
-            double rho_q_high = var_a * kappa_rho_q_high_a * (1.0 - std::exp(kappa_rho_q_high_b
-                * std::pow(xx, 0.84)) - std::sin(kappa_rho_q_high_c * xx)
-                * std::exp(kappa_rho_q_high_d * std::pow(xx, kappa_rho_q_high_e)));
-            double rho_v_low = kappa_rho_v * var_b * kappa_rho_v_low_a
-                * (1.0 - 0.17 * std::log(1.0 + kappa_rho_v_low_b * var_c));
-            double rho_v_high = kappa_rho_v * var_b * kappa_rho_v_high_a
-                * (1.0 - 0.17 * std::log(1.0 + kappa_rho_v_high_b * var_c));
-            rho_q[adaptive_level](l,m,n) +=
-                (1.0 - kappa_rho_frac) * rho_q_low + kappa_rho_frac * rho_q_high;
-            rho_v[adaptive_level](l,m,n) +=
-                (1.0 - kappa_rho_frac) * rho_v_low + kappa_rho_frac * rho_v_high;
-          }
-        }
+//--------------------------------------------------------------------------------------------------
+
+// Function for calculating radiative transfer coefficients at a single sample
+// Inputs:
+//   m: ray index
+//   row: row of per-sample arrays holding ray
+//   n: sample index along ray
+//   c: index of sample among those along ray outside the cut region
+//   render_values: nullptr, or array to hold cell values for rendering
+// Outputs:
+//   render_values: cell values set unless sample is excluded by cuts, if not nullptr
+// Notes:
+//   Assumes geodesic_num_steps[adaptive_level], sample_pos[adaptive_level],
+//       sample_dir[adaptive_level], and momentum_factors[adaptive_level] have been set, as has the
+//       given row of sample_inds[adaptive_level], sample_nan[adaptive_level],
+//       sample_fallback[adaptive_level], and (if simulation_interp == true)
+//       sample_fracs[adaptive_level].
+//   Assumes sample is not in the cut region.
+//   Assumes values have been initialized with InitializeRayCoefficients().
+//   Sets entry c of given row of allocated coefficient arrays, cell_values[adaptive_level], and
+//       stored samples, which hold only samples outside the cut region.
+//   Resamples simulation data with SamplePrimitives(), rather than storing primitives for all
+//       samples first.
+//   Evaluates all frequency-independent factors, including the Bessel functions of 1/Theta_e and
+//       angular factors, once per sample before looping over frequencies.
+//   If simulation_batch == true, instead stores the frequency-independent factors in the calling
+//       thread's batch, leaving frequency-dependent values to CalculateBatchCoefficients().
+//   References beta-dependent temperature ratio electron model from 2016 AA 586 A38 (E1).
+//   References entropy-based electron model from 2017 MNRAS 466 705 (E2).
+//   References 2021 ApJ 921 17 (M) for transfer coefficients.
+//   Transfer coefficients are calculated in their invariant forms, disagreeing with their
+//       definitions in (M) but agreeing with their usages in 2018 MNRAS 475 43.
+//   Faraday coefficients have additional trap for when Theta_e ~ 0, where rho_Q ~ 0 and rho_V is
+//       given by cold-plasma rotation measure considerations, but numerically one might get NaN,
+//       and the rho_V formula has the wrong asymptotic behavior.
+//   Tetrad is chosen such that j_U, alpha_U, rho_U = 0.
+void RadiationIntegrator::CalculateSampleCoefficients(int m, int row, int n, int c,
+    double *render_values)
+{
+  // Calculate units
+  double d_unit = simulation_rho_cgs;
+  double e_unit = d_unit * Physics::c * Physics::c;
+  double b_unit = std::sqrt(4.0 * Math::pi * e_unit);
+
+  // Allocate scratch space
+  double gcov_sim[4][4];
+  double gcon_sim[4][4];
+  double gcov[4][4];
+  double gcon[4][4];
+  double jacobian[4][4];
+  double tetrad[4][4];
+
+  // Extract geodesic position and covariant momentum
+  double x1 = sample_pos[adaptive_level](m,n,1);
+  double x2 = sample_pos[adaptive_level](m,n,2);
+  double x3 = sample_pos[adaptive_level](m,n,3);
+  double kcov[4];
+  kcov[0] = sample_dir[adaptive_level](m,n,0);
+  kcov[1] = sample_dir[adaptive_level](m,n,1);
+  kcov[2] = sample_dir[adaptive_level](m,n,2);
+  kcov[3] = sample_dir[adaptive_level](m,n,3);
+
+  // Resample model variables
+  double vals[9];
+  SamplePrimitives(row, n, vals);
+  double rho = vals[0];
+  double pgas = vals[1];
+  double kappa = 0.0;
+  if (plasma_model == PlasmaModel::code_kappa)
+    kappa = vals[8];
+  double uu1_sim = vals[2];
+  double uu2_sim = vals[3];
+  double uu3_sim = vals[4];
+  double bb1_sim = vals[5];
+  double bb2_sim = vals[6];
+  double bb3_sim = vals[7];
+
+  // Retain velocity and magnetic field for polarized transfer
+  if (image_light and image_polarization)
+  {
+    sample_uu1[adaptive_level](row,c) = static_cast<float>(uu1_sim);
+    sample_uu2[adaptive_level](row,c) = static_cast<float>(uu2_sim);
+    sample_uu3[adaptive_level](row,c) = static_cast<float>(uu3_sim);
+    sample_bb1[adaptive_level](row,c) = static_cast<float>(bb1_sim);
+    sample_bb2[adaptive_level](row,c) = static_cast<float>(bb2_sim);
+    sample_bb3[adaptive_level](row,c) = static_cast<float>(bb3_sim);
+  }
+
+  // Calculate densities and pressures
+  double rho_cgs = rho * d_unit;
+  double pgas_cgs = pgas * e_unit;
+  double n_cgs = rho_cgs / (plasma_mu * Physics::m_p);
+  double n_e_cgs = n_cgs / (1.0 + 1.0 / plasma_ne_ni);
+
+  // Calculate simulation metric
+  CovariantSimulationMetric(x1, x2, x3, gcov_sim);
+  ContravariantSimulationMetric(x1, x2, x3, gcon_sim);
+
+  // Calculate simulation velocity
+  double uu0_sim = std::sqrt(1.0 + gcov_sim[1][1] * uu1_sim * uu1_sim
+      + 2.0 * gcov_sim[1][2] * uu1_sim * uu2_sim + 2.0 * gcov_sim[1][3] * uu1_sim * uu3_sim
+      + gcov_sim[2][2] * uu2_sim * uu2_sim + 2.0 * gcov_sim[2][3] * uu2_sim * uu3_sim
+      + gcov_sim[3][3] * uu3_sim * uu3_sim);
+  double lapse_sim = 1.0 / std::sqrt(-gcon_sim[0][0]);
+  double shift1_sim = -gcon_sim[0][1] / gcon_sim[0][0];
+  double shift2_sim = -gcon_sim[0][2] / gcon_sim[0][0];
+  double shift3_sim = -gcon_sim[0][3] / gcon_sim[0][0];
+  double ucon_sim[4];
+  ucon_sim[0] = uu0_sim / lapse_sim;
+  ucon_sim[1] = uu1_sim - shift1_sim * uu0_sim / lapse_sim;
+  ucon_sim[2] = uu2_sim - shift2_sim * uu0_sim / lapse_sim;
+  ucon_sim[3] = uu3_sim - shift3_sim * uu0_sim / lapse_sim;
+  double ucov_sim[4] = {};
+  for (int mu = 0; mu < 4; mu++)
+    for (int nu = 0; nu < 4; nu++)
+      ucov_sim[mu] += gcov_sim[mu][nu] * ucon_sim[nu];
+
+  // Calculate simulation magnetic field
+  double bcon_sim[4];
+  bcon_sim[0] = ucov_sim[1] * bb1_sim + ucov_sim[2] * bb2_sim + ucov_sim[3] * bb3_sim;
+  bcon_sim[1] = (bb1_sim + bcon_sim[0] * ucon_sim[1]) / ucon_sim[0];
+  bcon_sim[2] = (bb2_sim + bcon_sim[0] * ucon_sim[2]) / ucon_sim[0];
+  bcon_sim[3] = (bb3_sim + bcon_sim[0] * ucon_sim[3]) / ucon_sim[0];
+  double bcov_sim[4] = {};
+  for (int mu = 0; mu < 4; mu++)
+    for (int nu = 0; nu < 4; nu++)
+      bcov_sim[mu] += gcov_sim[mu][nu] * bcon_sim[nu];
+  double b_sq = 0.0;
+  for (int mu = 0; mu < 4; mu++)
+    b_sq += bcov_sim[mu] * bcon_sim[mu];
+  double bb_cgs = std::sqrt(b_sq) * b_unit;
+  double sigma = b_sq / rho;
+  double beta_inv = b_sq / (2.0 * pgas);
+
+  // Calculate electron temperature for model with T_i/T_e a function of beta (E1 1)
+  double kb_tt_e_cgs = std::numeric_limits<double>::quiet_NaN();
+  double theta_e = std::numeric_limits<double>::quiet_NaN();
+  if (plasma_thermal_frac != 0.0 and plasma_model == PlasmaModel::ti_te_beta)
+  {
+    double tti_tte = (plasma_rat_high + plasma_rat_low * beta_inv * beta_inv)
+        / (1.0 + beta_inv * beta_inv);
+    double kb_tt_tot_cgs = plasma_mu * Physics::m_p * pgas_cgs / rho_cgs;
+    if (plasma_use_p)
+      kb_tt_e_cgs = (1.0 + plasma_ne_ni) / (tti_tte + plasma_ne_ni) * kb_tt_tot_cgs;
+    else
+    {
+      kb_tt_e_cgs = (1.0 + plasma_ne_ni) * kb_tt_tot_cgs / (plasma_gamma - 1.0);
+      kb_tt_e_cgs /= tti_tte / (plasma_gamma_i - 1.0) + plasma_ne_ni / (plasma_gamma_e - 1.0);
+    }
+    theta_e = kb_tt_e_cgs / (Physics::m_e * Physics::c * Physics::c);
+  }
+
+  // Calculate electron temperature for given electron entropy (E2 13)
+  if (plasma_thermal_frac != 0.0 and plasma_model == PlasmaModel::code_kappa)
+  {
+    double mu_e = plasma_mu * (1.0 + 1.0 / plasma_ne_ni);
+    double rho_e = rho * Physics::m_e / (mu_e * Physics::m_p);
+    double rho_kappa_e_cbrt = std::cbrt(rho_e * kappa);
+    theta_e = 1.0 / 5.0 * (std::sqrt(1.0 + 25.0 * rho_kappa_e_cbrt * rho_kappa_e_cbrt) - 1.0);
+    kb_tt_e_cgs = theta_e * Physics::m_e * Physics::c * Physics::c;
+  }
+
+  // Skip coupling based on cell values
+  if ((cut_rho_min >= 0.0 and rho_cgs < cut_rho_min)
+      or (cut_rho_max >= 0.0 and rho_cgs > cut_rho_max)
+      or (cut_n_e_min >= 0.0 and n_e_cgs < cut_n_e_min)
+      or (cut_n_e_max >= 0.0 and n_e_cgs > cut_n_e_max)
+      or (cut_p_gas_min >= 0.0 and pgas_cgs < cut_p_gas_min)
+      or (cut_p_gas_max >= 0.0 and pgas_cgs > cut_p_gas_max)
+      or (cut_theta_e_min >= 0.0 and theta_e < cut_theta_e_min)
+      or (cut_theta_e_max >= 0.0 and theta_e > cut_theta_e_max)
+      or (cut_b_min >= 0.0 and bb_cgs < cut_b_min)
+      or (cut_b_max >= 0.0 and bb_cgs > cut_b_max)
+      or (cut_sigma_min >= 0.0 and sigma < cut_sigma_min)
+      or (cut_sigma_max >= 0.0 and sigma > cut_sigma_max)
+      or (cut_beta_inverse_min >= 0.0 and beta_inv < cut_beta_inverse_min)
+      or (cut_beta_inverse_max >= 0.0 and beta_inv > cut_beta_inverse_max))
+    return;
+
+  // Record cell values
+  if (store_cell_values or render_values != nullptr)
+  {
+    double values[CellValues::num_cell_values];
+    values[CellValues::rho] = rho_cgs;
+    values[CellValues::n_e] = n_e_cgs;
+    values[CellValues::p_gas] = pgas_cgs;
+    values[CellValues::theta_e] = theta_e;
+    values[CellValues::bb] = bb_cgs;
+    values[CellValues::sigma] = sigma;
+    values[CellValues::beta_inv] = beta_inv;
+    for (int a = 0; a < CellValues::num_cell_values; a++)
+    {
+      if (store_cell_values)
+        cell_values[adaptive_level](a,row,c) = values[a];
+      if (render_values != nullptr)
+        render_values[a] = values[a];
+    }
+  }
+
+  // Skip remaining calculations if possible
+  if (not (image_light or image_emission or image_tau or image_emission_ave or image_tau_int))
+    return;
+
+  // Skip coupling if magnetic field vanishes
+  if (bb1_sim == 0.0 and bb2_sim == 0.0 and bb3_sim == 0.0)
+    return;
+
+  // Calculate Jacobian of transformation from simulation to geodesic coordinates
+  CoordinateJacobian(x1, x2, x3, jacobian);
+
+  // Transform contravariant velocity and magnetic field to geodesic coordinates
+  double ucon[4] = {};
+  for (int mu = 0; mu < 4; mu++)
+    for (int nu = 0; nu < 4; nu++)
+      ucon[mu] += jacobian[mu][nu] * ucon_sim[nu];
+  double bcon[4] = {};
+  for (int mu = 0; mu < 4; mu++)
+    for (int nu = 0; nu < 4; nu++)
+      bcon[mu] += jacobian[mu][nu] * bcon_sim[nu];
+
+  // Calculate geodesic metric
+  CovariantGeodesicMetric(x1, x2, x3, gcov);
+  ContravariantGeodesicMetric(x1, x2, x3, gcon);
+
+  // Calculate geodesic contravariant momentum
+  double kcon[4] = {};
+  for (int mu = 0; mu < 4; mu++)
+    for (int nu = 0; nu < 4; nu++)
+      kcon[mu] += gcon[mu][nu] * kcov[nu];
+
+  // Calculate covariant velocity and magnetic field
+  double ucov[4] = {};
+  for (int mu = 0; mu < 4; mu++)
+    for (int nu = 0; nu < 4; nu++)
+      ucov[mu] += gcov[mu][nu] * ucon[nu];
+  double bcov[4] = {};
+  for (int mu = 0; mu < 4; mu++)
+    for (int nu = 0; nu < 4; nu++)
+      bcov[mu] += gcov[mu][nu] * bcon[nu];
+
+  // Calculate orthonormal tetrad
+  Tetrad(ucon, ucov, kcon, kcov, bcon, gcov, gcon, tetrad);
+
+  // Calculate orthonormal-frame angle between wavevector and magnetic field
+  double k_tet_1 = 0.0;
+  double k_tet_2 = 0.0;
+  double k_tet_3 = 0.0;
+  double b_tet_1 = 0.0;
+  double b_tet_2 = 0.0;
+  double b_tet_3 = 0.0;
+  for (int mu = 0; mu < 4; mu++)
+  {
+    k_tet_1 += tetrad[1][mu] * kcov[mu];
+    k_tet_2 += tetrad[2][mu] * kcov[mu];
+    k_tet_3 += tetrad[3][mu] * kcov[mu];
+    b_tet_1 += tetrad[1][mu] * bcov[mu];
+    b_tet_2 += tetrad[2][mu] * bcov[mu];
+    b_tet_3 += tetrad[3][mu] * bcov[mu];
+  }
+  double k_sq_tet = k_tet_1 * k_tet_1 + k_tet_2 * k_tet_2 + k_tet_3 * k_tet_3;
+  double b_sq_tet = b_tet_1 * b_tet_1 + b_tet_2 * b_tet_2 + b_tet_3 * b_tet_3;
+  double k_b_tet = k_tet_1 * b_tet_1 + k_tet_2 * b_tet_2 + k_tet_3 * b_tet_3;
+  double cos2_theta_b = std::min(k_b_tet * k_b_tet / (k_sq_tet * b_sq_tet), 1.0);
+  double sin2_theta_b = 1.0 - cos2_theta_b;
+  double sin_theta_b = std::sqrt(sin2_theta_b);
+  double cos_theta_b = std::sqrt(cos2_theta_b) * (k_b_tet >= 0.0 ? 1.0 : -1.0);
+
+  // Calculate frequency-independent parts of orthonormal-frame frequencies
+  double nu_fluid = 0.0;
+  for (int mu = 0; mu < 4; mu++)
+    nu_fluid -= kcov[mu] * ucon[mu];
+  double momentum_factor = momentum_factors[adaptive_level](m);
+  double nu_c_cgs = Physics::e * bb_cgs / (2.0 * Math::pi * Physics::m_e * Physics::c);
+  double nu_s_cgs = 2.0 / 9.0 * nu_c_cgs * theta_e * theta_e * sin_theta_b;
+
+  // Calculate frequency-independent thermal factors (M 30,35-37)
+  double thermal_var_jj_a = Math::sqrt2 * Math::pi / 27.0 * sin_theta_b;
+  double thermal_var_jj_b = std::pow(2.0, 11.0 / 12.0);
+  double thermal_var_jj_d = 0.0;
+  double thermal_var_jj_f = 0.0;
+  bool thermal_rho_tabulated = false;
+  double thermal_rho_g = 0.0;
+  double thermal_rho_h = 0.0;
+  double thermal_rho_kk_0 = 0.0;
+  double thermal_rho_kk_2 = 0.0;
+  double thermal_rho_kk_2_inv = 0.0;
+  if (plasma_thermal_frac != 0.0 and image_light and image_polarization)
+  {
+    thermal_var_jj_d = (7.0 * std::pow(theta_e, 0.96) + 35.0)
+        / (10.0 * std::pow(theta_e, 0.96) + 75.0) * thermal_var_jj_b;
+    thermal_var_jj_f = cos_theta_b / theta_e;
+    if (theta_e >= theta_e_zero)
+    {
+      thermal_rho_tabulated = plasma_tables and TabulatedThetaEFactors(theta_e, &thermal_rho_g,
+          &thermal_rho_h, &thermal_rho_kk_2_inv);
+      if (not thermal_rho_tabulated)
+      {
+        thermal_rho_kk_0 = std::cyl_bessel_k(0.0, 1.0 / theta_e);
+        double kk_1 = std::cyl_bessel_k(1.0, 1.0 / theta_e);
+        thermal_rho_kk_2 = std::cyl_bessel_k(2.0, 1.0 / theta_e);
+        thermal_rho_g = kk_1 / thermal_rho_kk_2 + 6.0 * theta_e;
       }
     }
   }
 
-  // Free memory
-  if (adaptive_level > 0)
+  // Calculate frequency-independent power-law factors (M 38,39,42)
+  double power_cot_theta_b = 0.0;
+  double power_var_aa_b = 0.0;
+  if (plasma_power_frac != 0.0 and image_light and image_polarization)
+  {
+    power_cot_theta_b = cos_theta_b / sin_theta_b;
+    power_var_aa_b = std::pow(3.1 * std::pow(sin_theta_b, -1.92) - 3.1, 0.512);
+  }
+
+  // Calculate frequency-independent kappa-distribution factors (M 43-50)
+  double nu_kappa_cgs = nu_c_cgs * plasma_w * plasma_w * plasma_kappa * plasma_kappa * sin_theta_b;
+  double kappa_var_aa_a =
+      plasma_kappa_frac * n_e_cgs * Physics::e * Physics::e / (Physics::m_e * Physics::c);
+  double kappa_var_jj_d = 0.0;
+  double kappa_var_jj_f = 0.0;
+  double kappa_var_aa_d = 0.0;
+  double kappa_var_aa_f = 0.0;
+  if (plasma_kappa_frac != 0.0 and image_light and image_polarization)
+  {
+    kappa_var_jj_d = std::pow(std::pow(sin_theta_b, -2.4) - 1.0, 0.48);
+    kappa_var_jj_f = std::pow(std::pow(sin_theta_b, -2.5) - 1.0, 0.44);
+    kappa_var_aa_d = std::pow(std::pow(sin_theta_b, -2.28) - 1.0, 0.446);
+    kappa_var_aa_f = std::sqrt(std::pow(sin_theta_b, -2.05) - 1.0);
+  }
+
+  // Defer frequency-dependent calculations to batch of samples
+  if (simulation_batch)
+  {
+    int thread = omp_get_thread_num();
+    int k = batch_num(thread);
+    batch_inds(thread,0,k) = row;
+    batch_inds(thread,1,k) = c;
+    batch_vals(thread,static_cast<int>(BatchValues::n_e),k) = n_e_cgs;
+    batch_vals(thread,static_cast<int>(BatchValues::kb_tt_e),k) = kb_tt_e_cgs;
+    batch_vals(thread,static_cast<int>(BatchValues::theta_e),k) = theta_e;
+    batch_vals(thread,static_cast<int>(BatchValues::nu_fluid),k) = nu_fluid;
+    batch_vals(thread,static_cast<int>(BatchValues::momentum_factor),k) = momentum_factor;
+    batch_vals(thread,static_cast<int>(BatchValues::nu_c),k) = nu_c_cgs;
+    batch_vals(thread,static_cast<int>(BatchValues::nu_s),k) = nu_s_cgs;
+    batch_vals(thread,static_cast<int>(BatchValues::sin_theta_b),k) = sin_theta_b;
+    batch_vals(thread,static_cast<int>(BatchValues::sin2_theta_b),k) = sin2_theta_b;
+    batch_vals(thread,static_cast<int>(BatchValues::cos_theta_b),k) = cos_theta_b;
+    batch_vals(thread,static_cast<int>(BatchValues::thermal_jj_a),k) = thermal_var_jj_a;
+    batch_vals(thread,static_cast<int>(BatchValues::thermal_jj_d),k) = thermal_var_jj_d;
+    batch_vals(thread,static_cast<int>(BatchValues::thermal_jj_f),k) = thermal_var_jj_f;
+    batch_vals(thread,static_cast<int>(BatchValues::thermal_rho_tabulated),k) =
+        thermal_rho_tabulated ? 1.0 : 0.0;
+    batch_vals(thread,static_cast<int>(BatchValues::thermal_rho_g),k) = thermal_rho_g;
+    batch_vals(thread,static_cast<int>(BatchValues::thermal_rho_h),k) = thermal_rho_h;
+    batch_vals(thread,static_cast<int>(BatchValues::thermal_rho_kk_0),k) = thermal_rho_kk_0;
+    batch_vals(thread,static_cast<int>(BatchValues::thermal_rho_kk_2),k) = thermal_rho_kk_2;
+    batch_vals(thread,static_cast<int>(BatchValues::thermal_rho_kk_2_inv),k) = thermal_rho_kk_2_inv;
+    batch_vals(thread,static_cast<int>(BatchValues::power_cot_theta_b),k) = power_cot_theta_b;
+    batch_vals(thread,static_cast<int>(BatchValues::power_aa_b),k) = power_var_aa_b;
+    batch_vals(thread,static_cast<int>(BatchValues::nu_kappa),k) = nu_kappa_cgs;
+    batch_vals(thread,static_cast<int>(BatchValues::kappa_aa_a),k) = kappa_var_aa_a;
+    batch_vals(thread,static_cast<int>(BatchValues::kappa_jj_d),k) = kappa_var_jj_d;
+    batch_vals(thread,static_cast<int>(BatchValues::kappa_jj_f),k) = kappa_var_jj_f;
+    batch_vals(thread,static_cast<int>(BatchValues::kappa_aa_d),k) = kappa_var_aa_d;
+    batch_vals(thread,static_cast<int>(BatchValues::kappa_aa_f),k) = kappa_var_aa_f;
+    batch_num(thread)++;
+    if (batch_num(thread) == batch_size)
+      CalculateBatchCoefficients(thread);
+    return;
+  }
+
+  // Go through frequencies
+  for (int l = 0; l < image_num_frequencies; l++)
   {
-    sample_cut[adaptive_level].Deallocate();
-    sample_rho[adaptive_level].Deallocate();
-    sample_pgas[adaptive_level].Deallocate();
-    sample_kappa[adaptive_level].Deallocate();
-    if (image_light and not image_polarization)
+    // Calculate orthonormal-frame frequencies
+    double nu_cgs = nu_fluid * (image_frequencies(l) * momentum_factor);
+    double nu_2_cgs = nu_cgs * nu_cgs;
+
+    // Calculate thermal synchrotron emissivities (M 28,30)
+    double j_i_val;
+    if (plasma_thermal_frac != 0.0)
+    {
+      double xx = nu_cgs / nu_s_cgs;
+      double xx_1_2 = std::sqrt(xx);
+      double xx_1_3 = std::cbrt(xx);
+      double xx_1_6 = std::sqrt(xx_1_3);
+      double coefficient = plasma_thermal_frac * n_e_cgs * Physics::e * Physics::e * nu_c_cgs
+          / (Physics::c * nu_2_cgs) * std::exp(-xx_1_3);
+      double var_c = xx_1_2 + thermal_var_jj_b * xx_1_6;
+      j_i_val = coefficient * thermal_var_jj_a * var_c * var_c;
+      if (image_light or image_emission or image_emission_ave)
+        j_i[adaptive_level](row,c,l) = j_i_val;
+      if (image_light and image_polarization)
+      {
+        double var_e = xx_1_2 + thermal_var_jj_d * xx_1_6;
+        double var_g = Math::pi / 3.0 + Math::pi / 3.0 * xx_1_3 + 2.0 / 300.0 * xx_1_2
+            + 2.0 / 19.0 * Math::pi * xx_1_3 * xx_1_3;
+        j_q[adaptive_level](row,c,l) = -coefficient * thermal_var_jj_a * var_e * var_e;
+        j_v[adaptive_level](row,c,l) = coefficient * thermal_var_jj_f * var_g;
+      }
+    }
+
+    // Calculate thermal synchrotron absorptivities from Kirchoff's law (M 31)
+    if (plasma_thermal_frac != 0.0)
+    {
+      // Calculate absorptivities
+      double b_nu_nu_3_cgs = 2.0 * Physics::h / (Physics::c * Physics::c)
+          / std::expm1(Physics::h * nu_cgs / kb_tt_e_cgs);
+      if (image_light or image_tau or image_tau_int)
+        alpha_i[adaptive_level](row,c,l) = j_i_val / b_nu_nu_3_cgs;
+      if (image_light and image_polarization)
+      {
+        alpha_q[adaptive_level](row,c,l) = j_q[adaptive_level](row,c,l) / b_nu_nu_3_cgs;
+        alpha_v[adaptive_level](row,c,l) = j_v[adaptive_level](row,c,l) / b_nu_nu_3_cgs;
+      }
+
+      // Account for numerical issues later arising from absorptivities being too small
+      if ((image_light or image_tau or image_tau_int)
+          and 1.0 / (alpha_i[adaptive_level](row,c,l) * alpha_i[adaptive_level](row,c,l))
+          == std::numeric_limits<double>::infinity())
+      {
+        alpha_i[adaptive_level](row,c,l) = 0.0;
+        if (image_light and image_polarization)
+        {
+          alpha_q[adaptive_level](row,c,l) = 0.0;
+          alpha_v[adaptive_level](row,c,l) = 0.0;
+        }
+      }
+    }
+
+    // Calculate thermal synchrotron rotativities (M 33-37)
+    if (plasma_thermal_frac != 0.0 and image_light and image_polarization)
+    {
+      double coefficient_q = -plasma_thermal_frac * n_e_cgs * Physics::e * Physics::e
+          * nu_c_cgs * nu_c_cgs * sin2_theta_b / (Physics::m_e * Physics::c * nu_2_cgs);
+      double coefficient_v = plasma_thermal_frac * 2.0 * n_e_cgs * Physics::e * Physics::e
+          * nu_c_cgs * cos_theta_b / (Physics::m_e * Physics::c * nu_cgs);
+      double factor_q = 0.0;
+      double factor_v = 1.0;
+      if (theta_e >= theta_e_zero)
+      {
+        double xx = nu_cgs / nu_s_cgs;
+        double f_m, f_m_scale, delta_jj_5;
+        if (not (thermal_rho_tabulated and TabulatedXXFactors(xx, &f_m, &delta_jj_5)))
+          ThermalRotativityFits(xx, &f_m, &f_m_scale, &delta_jj_5);
+        factor_q = f_m * thermal_rho_g;
+        if (thermal_rho_tabulated)
+          factor_v = thermal_rho_h - delta_jj_5 * thermal_rho_kk_2_inv;
+        else
+          factor_v = (thermal_rho_kk_0 - delta_jj_5) / thermal_rho_kk_2;
+        factor_v = factor_v < 0.0 or factor_v > 1.0 ? 1.0 : factor_v;
+      }
+      rho_q[adaptive_level](row,c,l) = coefficient_q * factor_q;
+      rho_v[adaptive_level](row,c,l) = coefficient_v * factor_v;
+    }
+
+    // Calculate power-law synchrotron emissivities (M 28,38)
+    if (plasma_power_frac != 0.0 and (image_light or image_emission or image_emission_ave))
+    {
+      double var_a = std::pow(nu_cgs / (nu_c_cgs * sin_theta_b), -(plasma_p - 1.0) / 2.0);
+      double coefficient = plasma_power_frac * n_e_cgs * Physics::e * Physics::e * nu_c_cgs
+          / (Physics::c * nu_2_cgs) * power_jj * sin_theta_b * var_a;
+      j_i[adaptive_level](row,c,l) += coefficient;
+      if (image_light and image_polarization)
+      {
+        double var_c = 1.0 / std::sqrt(nu_cgs / (3.0 * nu_c_cgs * sin_theta_b));
+        j_q[adaptive_level](row,c,l) += coefficient * power_jj_q;
+        j_v[adaptive_level](row,c,l) += coefficient * power_jj_v * power_cot_theta_b * var_c;
+      }
+    }
+
+    // Calculate power-law synchrotron absorptivities (M 29,39)
+    if (plasma_power_frac != 0.0 and (image_light or image_tau or image_tau_int))
+    {
+      double var_a = std::pow(nu_cgs / (nu_c_cgs * sin_theta_b), -(plasma_p + 2.0) / 2.0);
+      double coefficient = plasma_power_frac * n_e_cgs * Physics::e * Physics::e
+          / (Physics::m_e * Physics::c) * power_aa * var_a;
+      alpha_i[adaptive_level](row,c,l) += coefficient;
+      if (image_light and image_polarization)
+      {
+        double var_c = 1.0 / std::sqrt(nu_cgs / (nu_c_cgs * sin_theta_b));
+        double var_d = cos_theta_b >= 0.0 ? 1.0 : -1.0;
+        alpha_q[adaptive_level](row,c,l) += coefficient * power_aa_q;
+        alpha_v[adaptive_level](row,c,l) +=
+            coefficient * power_aa_v * power_var_aa_b * var_c * var_d;
+      }
+    }
+
+    // Calculate power-law synchrotron rotativities (M 40-42)
+    if (plasma_power_frac != 0.0 and image_light and image_polarization)
+    {
+      double var_a = n_e_cgs * Physics::e * Physics::e * nu_cgs
+          / (Physics::m_e * Physics::c * nu_c_cgs * sin_theta_b);
+      double var_b = nu_c_cgs * sin_theta_b / nu_cgs;
+      double var_c = var_b * var_b;
+      double var_d = var_c * var_b;
+      double var_e = 1.0 - std::pow(2.0 * nu_c_cgs * plasma_gamma_min * plasma_gamma_min
+          * sin_theta_b / (3.0 * nu_cgs), plasma_p / 2.0 - 1.0);
+      double coefficient = plasma_power_frac * power_rho * var_a;
+      rho_q[adaptive_level](row,c,l) += coefficient * power_rho_q * var_d * var_e;
+      rho_v[adaptive_level](row,c,l) += coefficient * power_rho_v * var_c * power_cot_theta_b;
+    }
+
+    // Calculate kappa-distribution synchrotron emissivities (M 28,43-46)
+    if (plasma_kappa_frac != 0.0 and (image_light or image_emission or image_emission_ave))
+    {
+      double xx = nu_cgs / nu_kappa_cgs;
+      double var_a = plasma_kappa_frac * n_e_cgs * Physics::e * Physics::e * nu_c_cgs
+          / (Physics::c * nu_2_cgs);
+      double var_b = std::cbrt(xx) * sin_theta_b;
+      double var_c = std::pow(xx, -(plasma_kappa - 2.0) / 2.0) * sin_theta_b;
+      double coefficient_low = kappa_jj_low * var_a * var_b;
+      double coefficient_high = kappa_jj_high * var_a * var_c;
+      j_i[adaptive_level](row,c,l) += std::pow(std::pow(coefficient_low, -kappa_jj_x_i)
+          + std::pow(coefficient_high, -kappa_jj_x_i), -1.0 / kappa_jj_x_i);
+      if (image_light and image_polarization)
+      {
+        double var_e = std::pow(xx, -0.35);
+        double var_g = 1.0 / std::sqrt(xx);
+        double var_h = cos_theta_b >= 0.0 ? 1.0 : -1.0;
+        double jj_q_low = coefficient_low * kappa_jj_low_q;
+        double jj_v_low = coefficient_low * kappa_jj_low_v * kappa_var_jj_d * var_e;
+        double jj_q_high = coefficient_high * kappa_jj_high_q;
+        double jj_v_high = coefficient_high * kappa_jj_high_v * kappa_var_jj_f * var_g;
+        j_q[adaptive_level](row,c,l) -= std::pow(std::pow(jj_q_low, -kappa_jj_x_q)
+            + std::pow(jj_q_high, -kappa_jj_x_q), -1.0 / kappa_jj_x_q);
+        j_v[adaptive_level](row,c,l) += std::pow(std::pow(jj_v_low, -kappa_jj_x_v)
+            + std::pow(jj_v_high, -kappa_jj_x_v), -1.0 / kappa_jj_x_v) * var_h;
+      }
+    }
+
+    // Calculate kappa-distribution synchrotron absoptivities (M 29,47-50)
+    if (plasma_kappa_frac != 0.0 and (image_light or image_tau or image_tau_int))
+    {
+      double xx = nu_cgs / nu_kappa_cgs;
+      double var_b = std::pow(xx, -2.0 / 3.0);
+      double var_c = std::pow(xx, -(1.0 + plasma_kappa) / 2.0);
+      double coefficient_low = kappa_aa_low * kappa_var_aa_a * var_b;
+      double coefficient_high = kappa_aa_high * kappa_var_aa_a * var_c;
+      double aa_i_low = coefficient_low;
+      double aa_i_high = coefficient_high * kappa_aa_high_i;
+      alpha_i[adaptive_level](row,c,l) += std::pow(std::pow(aa_i_low, -kappa_aa_x_i)
+          + std::pow(aa_i_high, -kappa_aa_x_i), -1.0 / kappa_aa_x_i);
+      if (image_light and image_polarization)
+      {
+        double var_e = std::pow(xx, -0.35);
+        double var_g = 1.0 / std::sqrt(xx);
+        double var_h = cos_theta_b >= 0.0 ? 1.0 : -1.0;
+        double aa_q_low = coefficient_low * kappa_aa_low_q;
+        double aa_v_low = coefficient_low * kappa_aa_low_v * kappa_var_aa_d * var_e;
+        double aa_q_high = coefficient_high * kappa_aa_high_q;
+        double aa_v_high = coefficient_high * kappa_aa_high_v * kappa_var_aa_f * var_g;
+        alpha_q[adaptive_level](row,c,l) -= std::pow(std::pow(aa_q_low, -kappa_aa_x_q)
+            + std::pow(aa_q_high, -kappa_aa_x_q), -1.0 / kappa_aa_x_q);
+        alpha_v[adaptive_level](row,c,l) += std::pow(std::pow(aa_v_low, -kappa_aa_x_v)
+            + std::pow(aa_v_high, -kappa_aa_x_v), -1.0 / kappa_aa_x_v) * var_h;
+      }
+    }
+
+    // Calculate kappa-distribution synchrotron rotativities (M 51-54)
+    if (plasma_kappa_frac != 0.0 and image_light and image_polarization)
     {
-      sample_uu1[adaptive_level].Deallocate();
-      sample_uu2[adaptive_level].Deallocate();
-      sample_uu3[adaptive_level].Deallocate();
-      sample_bb1[adaptive_level].Deallocate();
-      sample_bb2[adaptive_level].Deallocate();
-      sample_bb3[adaptive_level].Deallocate();
+      double xx = nu_cgs / nu_kappa_cgs;
+      double var_a = -plasma_kappa_frac * n_e_cgs * Physics::e * Physics::e * nu_c_cgs
+          * nu_c_cgs * sin2_theta_b / (Physics::m_e * Physics::c * nu_2_cgs);
+      double var_b = plasma_kappa_frac * 2.0 * n_e_cgs * Physics::e * Physics::e * nu_c_cgs
+          * cos_theta_b / (Physics::m_e * Physics::c * nu_cgs);
+      double var_c = 1.0 / std::sqrt(xx);
+      double rho_q_low = var_a * kappa_rho_q_low_a * (1.0 - std::exp(kappa_rho_q_low_b
+          * std::pow(xx, 0.84)) - std::sin(kappa_rho_q_low_c * xx)
+          * std::exp(kappa_rho_q_low_d * std::pow(xx, kappa_rho_q_low_e)));
+      double rho_q_high = var_a * kappa_rho_q_high_a * (1.0 - std::exp(kappa_rho_q_high_b
+          * std::pow(xx, 0.84)) - std::sin(kappa_rho_q_high_c * xx)
+          * std::exp(kappa_rho_q_high_d * std::pow(xx, kappa_rho_q_high_e)));
+      double rho_v_low = kappa_rho_v * var_b * kappa_rho_v_low_a
+          * (1.0 - 0.17 * std::log(1.0 + kappa_rho_v_low_b * var_c));
+      double rho_v_high = kappa_rho_v * var_b * kappa_rho_v_high_a
+          * (1.0 - 0.17 * std::log(1.0 + kappa_rho_v_high_b * var_c));
+      rho_q[adaptive_level](row,c,l) +=
+          (1.0 - kappa_rho_frac) * rho_q_low + kappa_rho_frac * rho_q_high;
+      rho_v[adaptive_level](row,c,l) +=
+          (1.0 - kappa_rho_frac) * rho_v_low + kappa_rho_frac * rho_v_high;
     }
   }
   return;
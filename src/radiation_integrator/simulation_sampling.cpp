@@ -2,7 +2,7 @@
 
 // C++ headers
 #include <algorithm>  // max, min
-#include <cmath>      // abs, acos, modf
+#include <cmath>      // abs, acos, ceil, modf
 #include <limits>     // numeric_limits
 #include <sstream>    // ostringstream
 
@@ -15,6 +15,7 @@
 #include "../simulation_reader/simulation_reader.hpp"  // SimulationReader
 #include "../utils/array.hpp"                          // Array
 #include "../utils/exceptions.hpp"                     // BlacklightException, BlacklightWarning
+#include "../utils/reduced_precision.hpp"              // DecodeReduced
 
 //--------------------------------------------------------------------------------------------------
 
@@ -31,13 +32,8 @@ void RadiationIntegrator::ObtainGridData()
     n_3_root = p_simulation_reader->n_3_root;
 
   // Copy grid layout
-  if ((simulation_format == SimulationFormat::athena
-      or simulation_format == SimulationFormat::athenak) and simulation_interp
-      and simulation_block_interp)
-  {
-    levels = p_simulation_reader->levels;
-    locations = p_simulation_reader->locations;
-  }
+  levels = p_simulation_reader->levels;
+  locations = p_simulation_reader->locations;
 
   // Copy coordinates
   x1f = p_simulation_reader->x1f;
@@ -52,6 +48,8 @@ void RadiationIntegrator::ObtainGridData()
 
   // Copy cell values
   grid_prim = p_simulation_reader->prim;
+  if (simulation_precision != SimulationPrecision::single)
+    grid_prim_packed = p_simulation_reader->prim_packed;
 
   // Copy indices
   ind_rho = p_simulation_reader->ind_rho;
@@ -64,6 +62,34 @@ void RadiationIntegrator::ObtainGridData()
   ind_bb2 = p_simulation_reader->ind_bb2;
   ind_bb3 = p_simulation_reader->ind_bb3;
 
+  // Prepare to gather sampled quantities (rho, pgas, uu1, uu2, uu3, bb1, bb2, bb3, kappa)
+  grid_num_vars = plasma_model == PlasmaModel::code_kappa ? 9 : 8;
+  grid_inds[0] = ind_rho;
+  grid_inds[1] = ind_pgas;
+  grid_inds[2] = ind_uu1;
+  grid_inds[3] = ind_uu2;
+  grid_inds[4] = ind_uu3;
+  grid_inds[5] = ind_bb1;
+  grid_inds[6] = ind_bb2;
+  grid_inds[7] = ind_bb3;
+  grid_inds[8] = ind_kappa;
+  for (int q = 0; q < 9; q++)
+    grid_positive[q] = q == 0 or q == 1 or q == 8;
+
+  // Calculate strides in stored cell data
+  const int *prim_dims = p_simulation_reader->prim_dims;
+  if (simulation_interleave)
+  {
+    grid_cell_stride = p_simulation_reader->prim_stride;
+    grid_var_stride = 1;
+  }
+  else
+  {
+    grid_cell_stride = 1;
+    grid_var_stride =
+        static_cast<long int>(prim_dims[1]) * prim_dims[2] * prim_dims[3] * prim_dims[4];
+  }
+
   // Copy coordinate interpolation map
   sks_map_r_in = p_simulation_reader->sks_map_r_in;
   sks_map_r_out = p_simulation_reader->sks_map_r_out;
@@ -91,6 +117,16 @@ void RadiationIntegrator::ObtainGridData()
     for (int level = 1; level <= max_level; level++)
       n_3_level(level) = n_3_level(level-1) * 2;
   }
+
+  // Index blocks for lookup by location and cells for lookup by coordinate
+  BuildBlockIndex();
+  BuildCellIndex();
+
+  // Find neighbors of blocks for interpolating across block boundaries
+  if ((simulation_format == SimulationFormat::athena
+      or simulation_format == SimulationFormat::athenak) and simulation_interp
+      and simulation_block_interp)
+    BuildNeighborTable();
   return;
 }
 
@@ -104,30 +140,75 @@ void RadiationIntegrator::ObtainGridData()
 //   Assumes geodesic_num_steps[adaptive_level], sample_flags[adaptive_level],
 //       sample_num[adaptive_level], and sample_pos[adaptive_level] have been set.
 //   Allocates and initializes sample_inds[adaptive_level], sample_nan[adaptive_level],
-//       sample_cut[adaptive_level], and sample_fallback[adaptive_level].
+//       sample_cut[adaptive_level], and sample_fallback[adaptive_level], with one row per ray.
 //   Allocates and initializes sample_fracs[adaptive_level] if simulation_interp == true or if
 //       slow_light_on == true and slow_interp == true.
-//   If simulation_interp == false, locates cell containing geodesic sample point.
-//   If simulation_interp == true and simulation_block_interp == false, prepares trilinear
-//       interpolation to geodesic sample point from cell centers, using only data within the same
-//       block of cells (i.e. sometimes using extrapolation near block edges).
-//   If simulation_interp == true and simulation_block_interp == true, prepares trilinear
-//       interpolation after obtaining anchor points possibly from neighboring blocks, even at
-//       different refinement levels, or across the periodic boundary in spherical coordinates.
-//   If slow_light_on == true, chooses from multiple available time slices for each point.
-//   If slow_light_on == true and slow_interp == true, prepares interpolation between adjacent (or
-//       sometimes identical) time slices.
-//   When the simulation uses Coordinates::fmks, indices and fractions are found via simple scaling
-//       for uniform grids with no bounds checking.
+//   Works on each ray with SampleRay().
 void RadiationIntegrator::CalculateSimulationSampling(int snapshot)
+{
+  // Prepare time slices and allocate arrays
+  int num_pix = camera_num_pix;
+  if (adaptive_level > 0)
+    num_pix = block_counts[adaptive_level] * block_num_pix;
+  double snapshot_time = PrepareSimulationSampling(snapshot, num_pix);
+
+  // Prepare bookkeeping for warnings and errors
+  int num_extrap[4] = {};
+  double val_extrap[4] = {};
+
+  // Work in parallel
+  #pragma omp parallel
+  {
+    // Prepare bookkeeping
+    int b;
+    double block_bounds[6];
+    PrepareSamplingBlock(&b, block_bounds);
+
+    // Resample cell data onto geodesics
+    #pragma omp for schedule(static) reduction(+: num_extrap[:4]) reduction(max: val_extrap[:4])
+    for (int m = 0; m < num_pix; m++)
+    {
+      double val_extrap_ray[4];
+      SampleRay(m, m, snapshot_time, &b, block_bounds, val_extrap_ray);
+      for (int q = 0; q < 4; q++)
+        if (val_extrap_ray[q] > 0.0)
+        {
+          num_extrap[q]++;
+          val_extrap[q] = std::max(val_extrap[q], val_extrap_ray[q]);
+        }
+    }
+  }
+
+  // Report extrapolation in time
+  ReportExtrapolation(snapshot, snapshot_time, num_pix, num_extrap, val_extrap);
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for preparing to determine how to sample cell data onto rays
+// Inputs:
+//   snapshot: index (starting at 0) of which snapshot is about to be processed
+//   num_rows: number of rays whose sample data is held at once
+// Outputs:
+//   returned value: simulation time of snapshot (0 unless slow_light_on == true)
+// Notes:
+//   Allocates sample_inds[adaptive_level], sample_nan[adaptive_level], sample_cut[adaptive_level],
+//       and sample_fallback[adaptive_level] with num_rows rows.
+//   Allocates sample_fracs[adaptive_level] if simulation_interp == true or if slow_light_on == true
+//       and slow_interp == true.
+//   Prepares lookup of time slices if slow_light_on == true.
+double RadiationIntegrator::PrepareSimulationSampling(int snapshot, int num_rows)
 {
   // Calculate time of snapshot
   double snapshot_time = 0.0;
   if (slow_light_on)
+  {
     snapshot_time = slow_t_start + slow_dt * snapshot;
+    PrepareTimeIndex();
+  }
 
   // Allocate arrays
-  int num_pix = camera_num_pix;
   int num_interp_inds = 4;
   if (slow_light_on)
     num_interp_inds++;
@@ -136,481 +217,466 @@ void RadiationIntegrator::CalculateSimulationSampling(int snapshot)
     num_interp_fracs += 3;
   if (slow_light_on and slow_interp)
     num_interp_fracs++;
-  if (adaptive_level > 0)
-    num_pix = block_counts[adaptive_level] * block_num_pix;
   if (first_time or adaptive_level > 0)
   {
-    if ((simulation_format == SimulationFormat::athena
-        or simulation_format == SimulationFormat::athenak) and simulation_interp
-        and simulation_block_interp)
-      sample_inds[adaptive_level].Allocate(num_pix, geodesic_num_steps[adaptive_level], 8,
-          num_interp_inds);
-    else
-      sample_inds[adaptive_level].Allocate(num_pix, geodesic_num_steps[adaptive_level],
-          num_interp_inds);
+    sample_inds[adaptive_level].Allocate(num_rows, geodesic_num_steps[adaptive_level],
+        num_interp_inds);
     if (num_interp_fracs > 0)
-      sample_fracs[adaptive_level].Allocate(num_pix, geodesic_num_steps[adaptive_level],
+      sample_fracs[adaptive_level].Allocate(num_rows, geodesic_num_steps[adaptive_level],
           num_interp_fracs);
-    sample_nan[adaptive_level].Allocate(num_pix, geodesic_num_steps[adaptive_level]);
-    sample_cut[adaptive_level].Allocate(num_pix, geodesic_num_steps[adaptive_level]);
-    sample_fallback[adaptive_level].Allocate(num_pix, geodesic_num_steps[adaptive_level]);
+    sample_nan[adaptive_level].Allocate(num_rows, geodesic_num_steps[adaptive_level]);
+    sample_cut[adaptive_level].Allocate(num_rows, geodesic_num_steps[adaptive_level]);
+    sample_fallback[adaptive_level].Allocate(num_rows, geodesic_num_steps[adaptive_level]);
   }
-  sample_nan[adaptive_level].Zero();
-  sample_cut[adaptive_level].Zero();
-  sample_fallback[adaptive_level].Zero();
+  return snapshot_time;
+}
 
-  // Prepare bookkeeping for warnings and errors
-  int num_extrap_camera_small = 0;
-  int num_extrap_camera_large = 0;
-  int num_extrap_source_small = 0;
-  int num_extrap_source_large = 0;
-  double val_extrap_camera_small = 0.0;
-  double val_extrap_camera_large = 0.0;
-  double val_extrap_source_small = 0.0;
-  double val_extrap_source_large = 0.0;
+//--------------------------------------------------------------------------------------------------
 
-  // Work in parallel
-  #pragma omp parallel
+// Function for initializing block tracked from one sample to the next
+// Inputs: (none)
+// Outputs:
+//   *p_b: index of first block to check
+//   block_bounds: x^1, x^2, and x^3 limits of region in which block is known to apply
+// Notes:
+//   Each thread should track its own block, passing it to SampleRay() for consecutive rays.
+void RadiationIntegrator::PrepareSamplingBlock(int *p_b, double block_bounds[6])
+{
+  int b = 0;
+  *p_b = b;
+  if (simulation_coord == Coordinates::fmks)
+    for (int p = 0; p < 6; p++)
+      block_bounds[p] = simulation_bounds(p);
+  else
   {
-    // Prepare bookkeeping
-    int n_b = x1f.n2;
-    int n_i = x1v.n1;
-    int n_j = x2v.n1;
-    int n_k = x3v.n1;
-    int b = 0;
-    int i = 0;
-    int j = 0;
-    int k = 0;
-    double x1_min_block = x1f(b,0);
-    double x1_max_block = x1f(b,n_i);
-    double x2_min_block = x2f(b,0);
-    double x2_max_block = x2f(b,n_j);
-    double x3_min_block = x3f(b,0);
-    double x3_max_block = x3f(b,n_k);
-    if (simulation_coord == Coordinates::fmks)
+    block_bounds[0] = x1f(b,0);
+    block_bounds[1] = x1f(b,x1v.n1);
+    block_bounds[2] = x2f(b,0);
+    block_bounds[3] = x2f(b,x2v.n1);
+    block_bounds[4] = x3f(b,0);
+    block_bounds[5] = x3f(b,x3v.n1);
+  }
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for determining how to sample cell data onto a single ray
+// Inputs:
+//   m: ray index
+//   row: row of per-sample arrays in which to store results
+//   snapshot_time: simulation time of snapshot
+//   *p_b: index of block containing previous sample
+//   block_bounds: x^1, x^2, and x^3 limits of region in which block is known to apply
+// Outputs:
+//   *p_b: index of block containing last sample on grid
+//   block_bounds: updated to match *p_b
+//   val_extrap: largest extrapolation in time needed beyond data (0 if none), in order forward by
+//       small amount, forward by large amount, backward by small amount, and backward by large
+//       amount
+// Notes:
+//   Assumes geodesic_num_steps[adaptive_level], sample_flags[adaptive_level],
+//       sample_num[adaptive_level], and sample_pos[adaptive_level] have been set.
+//   Assumes arrays have been allocated with PrepareSimulationSampling().
+//   Sets row of sample_inds[adaptive_level], sample_nan[adaptive_level],
+//       sample_cut[adaptive_level], sample_fallback[adaptive_level], and (if allocated)
+//       sample_fracs[adaptive_level].
+//   If simulation_interp == false, locates cell containing geodesic sample point.
+//   If simulation_interp == true and simulation_block_interp == false, prepares trilinear
+//       interpolation to geodesic sample point from cell centers, using only data within the same
+//       block of cells (i.e. sometimes using extrapolation near block edges).
+//   If simulation_interp == true and simulation_block_interp == true, prepares trilinear
+//       interpolation with anchor points possibly in the ghost cells around the block, which
+//       FillHalos() fills from neighboring blocks, even at different refinement levels, or across
+//       the periodic boundary in spherical coordinates.
+//   If slow_light_on == true, chooses from multiple available time slices for each point.
+//   If slow_light_on == true and slow_interp == true, prepares interpolation between adjacent (or
+//       sometimes identical) time slices.
+//   When the simulation uses Coordinates::fmks, indices and fractions are found via simple scaling
+//       for uniform grids with no bounds checking.
+void RadiationIntegrator::SampleRay(int m, int row, double snapshot_time, int *p_b,
+    double block_bounds[6], double val_extrap[4])
+{
+  // Prepare bookkeeping
+  for (int q = 0; q < 4; q++)
+    val_extrap[q] = 0.0;
+  for (int n = 0; n < geodesic_num_steps[adaptive_level]; n++)
+  {
+    sample_nan[adaptive_level](row,n) = false;
+    sample_cut[adaptive_level](row,n) = false;
+    sample_fallback[adaptive_level](row,n) = false;
+  }
+  int n_i = x1v.n1;
+  int n_j = x2v.n1;
+  int n_k = x3v.n1;
+  int b = *p_b;
+  int i = 0;
+  int j = 0;
+  int k = 0;
+  double x1_min_block = block_bounds[0];
+  double x1_max_block = block_bounds[1];
+  double x2_min_block = block_bounds[2];
+  double x2_max_block = block_bounds[3];
+  double x3_min_block = block_bounds[4];
+  double x3_max_block = block_bounds[5];
+
+  // Extract number of steps along this geodesic
+  int num_steps = sample_num[adaptive_level](m);
+
+  // Set NaN fallback values if geodesic poorly terminated
+  if (fallback_nan and sample_flags[adaptive_level](m))
+  {
+    for (int n = 0; n < num_steps; n++)
+      sample_nan[adaptive_level](row,n) = true;
+    return;
+  }
+
+  // Go along geodesic
+  int t_ind_prev = 0;
+  for (int n = 0; n < num_steps; n++)
+  {
+    // Extract coordinates
+    double x0 = sample_pos[adaptive_level](m,n,0) + snapshot_time;
+    double x1 = sample_pos[adaptive_level](m,n,1);
+    double x2 = sample_pos[adaptive_level](m,n,2);
+    double x3 = sample_pos[adaptive_level](m,n,3);
+
+    // Cut outside camera radius
+    double r = RadialGeodesicCoordinate(x1, x2, x3);
+    if (r > camera_r)
     {
-      x1_min_block = simulation_bounds(0);
-      x1_max_block = simulation_bounds(1);
-      x2_min_block = simulation_bounds(2);
-      x2_max_block = simulation_bounds(3);
-      x3_min_block = simulation_bounds(4);
-      x3_max_block = simulation_bounds(5);
+      sample_cut[adaptive_level](row,n) = true;
+      continue;
     }
 
-    // Resample cell data onto geodesics
-    #pragma omp for schedule(static) reduction(+: num_extrap_camera_small, \
-        num_extrap_camera_large, num_extrap_source_small, num_extrap_source_large) reduction(max: \
-        val_extrap_camera_small, val_extrap_camera_large, val_extrap_source_small, \
-        val_extrap_source_large)
-    for (int m = 0; m < num_pix; m++)
+    // Cut camera plane
+    if (cut_omit_near or cut_omit_far)
     {
-      // Extract number of steps along this geodesic
-      int num_steps = sample_num[adaptive_level](m);
+      double dot_product = x1 * camera_x[1] + x2 * camera_x[2] + x3 * camera_x[3];
+      if ((cut_omit_near and dot_product > 0.0) or (cut_omit_far and dot_product < 0.0))
+      {
+        sample_cut[adaptive_level](row,n) = true;
+        continue;
+      }
+    }
 
-      // Set NaN fallback values if geodesic poorly terminated
-      if (fallback_nan and sample_flags[adaptive_level](m))
+    // Cut spheres
+    if ((cut_omit_in >= 0.0 and r < cut_omit_in) or (cut_omit_out >= 0.0 and r > cut_omit_out))
+    {
+      sample_cut[adaptive_level](row,n) = true;
+      continue;
+    }
+
+    // Cut with respect to midplane
+    if (cut_midplane_theta > 0.0 or cut_midplane_theta < 0.0)
+    {
+      double th = std::acos(x3 / r);
+      if ((cut_midplane_theta > 0.0 and std::abs(th - Math::pi / 2.0) > cut_midplane_theta)
+          or (cut_midplane_theta < 0.0 and std::abs(th - Math::pi / 2.0) < -cut_midplane_theta))
       {
-        for (int n = 0; n < num_steps; n++)
-          sample_nan[adaptive_level](m,n) = true;
+        sample_cut[adaptive_level](row,n) = true;
         continue;
       }
+    }
+    if ((cut_midplane_z > 0.0 and std::abs(x3) > cut_midplane_z)
+        or (cut_midplane_z < 0.0 and std::abs(x3) < -cut_midplane_z))
+    {
+      sample_cut[adaptive_level](row,n) = true;
+      continue;
+    }
 
-      // Prepare bookkeeping for extrapolation
-      bool extrap_camera_small = false;
-      bool extrap_camera_large = false;
-      bool extrap_source_small = false;
-      bool extrap_source_large = false;
-      double val_extrap_camera_small_local = 0.0;
-      double val_extrap_camera_large_local = 0.0;
-      double val_extrap_source_small_local = 0.0;
-      double val_extrap_source_large_local = 0.0;
-
-      // Go along geodesic
-      for (int n = 0; n < num_steps; n++)
+    // Cut arbitrary plane
+    if (cut_plane)
+    {
+      double dot_product = (x1 - cut_plane_origin_x) * cut_plane_normal_x
+          + (x2 - cut_plane_origin_y) * cut_plane_normal_y
+          + (x3 - cut_plane_origin_z) * cut_plane_normal_z;
+      if (dot_product < 0.0)
       {
-        // Extract coordinates
-        double x0 = sample_pos[adaptive_level](m,n,0) + snapshot_time;
-        double x1 = sample_pos[adaptive_level](m,n,1);
-        double x2 = sample_pos[adaptive_level](m,n,2);
-        double x3 = sample_pos[adaptive_level](m,n,3);
-
-        // Cut outside camera radius
-        double r = RadialGeodesicCoordinate(x1, x2, x3);
-        if (r > camera_r)
-        {
-          sample_cut[adaptive_level](m,n) = true;
-          continue;
-        }
+        sample_cut[adaptive_level](row,n) = true;
+        continue;
+      }
+    }
 
-        // Cut camera plane
-        if (cut_omit_near or cut_omit_far)
-        {
-          double dot_product = x1 * camera_x[1] + x2 * camera_x[2] + x3 * camera_x[3];
-          if ((cut_omit_near and dot_product > 0.0) or (cut_omit_far and dot_product < 0.0))
-          {
-            sample_cut[adaptive_level](m,n) = true;
-            continue;
-          }
-        }
+    // Convert coordinates
+    ConvertFromCKS(&x1, &x2, &x3);
 
-        // Cut spheres
-        if ((cut_omit_in >= 0.0 and r < cut_omit_in) or (cut_omit_out >= 0.0 and r > cut_omit_out))
+    // Calculate time interpolation
+    int t_ind = 0;
+    double t_frac = 0.0;
+    if (slow_light_on)
+    {
+      if (x0 >= time[0])
+      {
+        if (x0 > time[0] + extrapolation_tolerance)
         {
-          sample_cut[adaptive_level](m,n) = true;
-          continue;
+          val_extrap[1] = std::max(val_extrap[1], x0 - time[0]);
         }
-
-        // Cut with respect to midplane
-        if (cut_midplane_theta > 0.0 or cut_midplane_theta < 0.0)
+        else if (x0 > time[0])
         {
-          double th = std::acos(x3 / r);
-          if ((cut_midplane_theta > 0.0 and std::abs(th - Math::pi / 2.0) > cut_midplane_theta)
-              or (cut_midplane_theta < 0.0 and std::abs(th - Math::pi / 2.0) < -cut_midplane_theta))
-          {
-            sample_cut[adaptive_level](m,n) = true;
-            continue;
-          }
+          val_extrap[0] = std::max(val_extrap[0], x0 - time[0]);
         }
-        if ((cut_midplane_z > 0.0 and std::abs(x3) > cut_midplane_z)
-            or (cut_midplane_z < 0.0 and std::abs(x3) < -cut_midplane_z))
+      }
+      else if (x0 <= time[slow_chunk_size-1])
+      {
+        if (x0 < time[slow_chunk_size-1] - extrapolation_tolerance)
         {
-          sample_cut[adaptive_level](m,n) = true;
-          continue;
+          val_extrap[3] = std::max(val_extrap[3], time[slow_chunk_size-1] - x0);
         }
-
-        // Cut arbitrary plane
-        if (cut_plane)
+        else if (x0 < time[slow_chunk_size-1])
         {
-          double dot_product = (x1 - cut_plane_origin_x) * cut_plane_normal_x
-              + (x2 - cut_plane_origin_y) * cut_plane_normal_y
-              + (x3 - cut_plane_origin_z) * cut_plane_normal_z;
-          if (dot_product < 0.0)
-          {
-            sample_cut[adaptive_level](m,n) = true;
-            continue;
-          }
+          val_extrap[2] = std::max(val_extrap[2], time[slow_chunk_size-1] - x0);
         }
-
-        // Convert coordinates
-        ConvertFromCKS(&x1, &x2, &x3);
-
-        // Calculate time interpolation
-        int t_ind = 0;
-        double t_frac = 0.0;
-        if (slow_light_on)
+        if (slow_interp)
         {
-          if (x0 >= time[0])
-          {
-            if (x0 > time[0] + extrapolation_tolerance)
-            {
-              extrap_camera_large = true;
-              val_extrap_camera_large_local = std::max(val_extrap_camera_large_local, x0 - time[0]);
-            }
-            else if (x0 > time[0])
-            {
-              extrap_camera_small = true;
-              val_extrap_camera_small_local = std::max(val_extrap_camera_small_local, x0 - time[0]);
-            }
-          }
-          else if (x0 <= time[slow_chunk_size-1])
-          {
-            if (x0 < time[slow_chunk_size-1] - extrapolation_tolerance)
-            {
-              extrap_source_large = true;
-              val_extrap_source_large_local =
-                  std::max(val_extrap_source_large_local, time[slow_chunk_size-1] - x0);
-            }
-            else if (x0 < time[slow_chunk_size-1])
-            {
-              extrap_source_small = true;
-              val_extrap_source_small_local =
-                  std::max(val_extrap_source_small_local, time[slow_chunk_size-1] - x0);
-            }
-            if (slow_interp)
-            {
-              t_ind = slow_chunk_size - 2;
-              t_frac = 1.0;
-            }
-            else
-              t_ind = slow_chunk_size - 1;
-          }
-          else
-          {
-            while (time[t_ind++] > x0);
-            t_ind--;
-            if (slow_interp)
-            {
-              t_ind--;
-              t_frac = (x0 - time[t_ind]) / (time[t_ind+1] - time[t_ind]);
-            }
-            else if (time[t_ind-1] - x0 <= x0 - time[t_ind])
-              t_ind--;
-          }
+          t_ind = slow_chunk_size - 2;
+          t_frac = 1.0;
         }
-
-        // Determine block
-        if (x1 < x1_min_block or x1 > x1_max_block or x2 < x2_min_block or x2 > x2_max_block
-            or x3 < x3_min_block or x3 > x3_max_block)
+        else
+          t_ind = slow_chunk_size - 1;
+      }
+      else
+      {
+        t_ind = FindTimeIndex(x0, t_ind_prev);
+        t_ind_prev = t_ind;
+        if (slow_interp)
         {
-          // Check if block contains position
-          int b_new;
-          double x1_min_temp = x1_min_block;
-          double x1_max_temp = x1_max_block;
-          double x2_min_temp = x2_min_block;
-          double x2_max_temp = x2_max_block;
-          double x3_min_temp = x3_min_block;
-          double x3_max_temp = x3_max_block;
-          for (b_new = 0; b_new < n_b; b_new++)
-          {
-            x1_min_temp = x1f(b_new,0);
-            x1_max_temp = x1f(b_new,n_i);
-            x2_min_temp = x2f(b_new,0);
-            x2_max_temp = x2f(b_new,n_j);
-            x3_min_temp = x3f(b_new,0);
-            x3_max_temp = x3f(b_new,n_k);
-            if (x1 >= x1_min_temp and x1 <= x1_max_temp and x2 >= x2_min_temp and x2 <= x2_max_temp
-                and x3 >= x3_min_temp and x3 <= x3_max_temp)
-              break;
-          }
-
-          // Set fallback values if off grid
-          if (b_new == n_b)
-          {
-            if (fallback_nan)
-              sample_nan[adaptive_level](m,n) = true;
-            else
-              sample_fallback[adaptive_level](m,n) = true;
-            continue;
-          }
-
-          // Set newly found block as one to search
-          b = b_new;
-          x1_min_block = x1_min_temp;
-          x1_max_block = x1_max_temp;
-          x2_min_block = x2_min_temp;
-          x2_max_block = x2_max_temp;
-          x3_min_block = x3_min_temp;
-          x3_max_block = x3_max_temp;
+          t_ind--;
+          t_frac = (x0 - time[t_ind]) / (time[t_ind+1] - time[t_ind]);
         }
+        else if (time[t_ind-1] - x0 <= x0 - time[t_ind])
+          t_ind--;
+      }
+    }
 
-        // Prepare to sample values in FMKS case
-        if (simulation_coord == Coordinates::fmks)
-        {
-          // Calculate location of coordinate point in SKS map with fractional offset
-          double i_ind, j_ind;
-          double f_i = std::modf((x1 - sks_map_r_in) / sks_map_dr, &i_ind);
-          double f_j = std::modf(x2 / sks_map_dtheta, &j_ind);
-          i = static_cast<int>(i_ind);
-          j = static_cast<int>(j_ind);
-          double fmks_x1 = (1.0 - f_i) * sks_map(0,j,i) + f_i * sks_map(0,j,i+1);
-          double fmks_x2 = (1.0 - f_j) * sks_map(1,j+1,i) + f_j * sks_map(1,j+1,i);
-
-          // Calculate fractional zone within fluid file
-          double x1_0 = x1f(b,0);
-          double dx1 = x1f(b,1) - x1f(b,0);
-          double dx2 = x2f(b,1) - x2f(b,0);
-          f_i = std::modf((fmks_x1 - x1_0) / dx1, &i_ind);
-          f_j = std::modf(fmks_x2 / dx2, &j_ind);
-          int i_m = static_cast<int>(i_ind);
-          int j_m = static_cast<int>(j_ind);
-
-          // Calculate phi coordinate as usual
-          for (k = 0; k < n_k; k++)
-            if (x3f(b,k+1) >= x3)
-              break;
-          int k_m = k == 0 or (k != n_k - 1 and x3 >= x3v(b,k)) ? k : k - 1;
-          double f_k = (x3 - x3v(b,k_m)) / (x3v(b,k_m+1) - x3v(b,k_m));
-
-          // Prepare to sample values without interpolation
-          if (not simulation_interp)
-          {
-            sample_inds[adaptive_level](m,n,0) = b;
-            sample_inds[adaptive_level](m,n,1) = k;
-            sample_inds[adaptive_level](m,n,2) = f_j >= 0.5 ? j_m + 1 : j_m;
-            sample_inds[adaptive_level](m,n,3) = f_i >= 0.5 ? i_m + 1 : i_m;
-            if (slow_light_on)
-              sample_inds[adaptive_level](m,n,4) = t_ind;
-            if (slow_light_on and slow_interp)
-              sample_fracs[adaptive_level](m,n,0) = t_frac;
-          }
-
-          // Prepare to sample values with interpolation
-          else
-          {
-            sample_inds[adaptive_level](m,n,0) = b;
-            sample_inds[adaptive_level](m,n,1) = k_m;
-            sample_inds[adaptive_level](m,n,2) = j_m;
-            sample_inds[adaptive_level](m,n,3) = i_m;
-            if (slow_light_on)
-              sample_inds[adaptive_level](m,n,4) = t_ind;
-            sample_fracs[adaptive_level](m,n,0) = f_k;
-            sample_fracs[adaptive_level](m,n,1) = f_j;
-            sample_fracs[adaptive_level](m,n,2) = f_i;
-            if (slow_light_on and slow_interp)
-              sample_fracs[adaptive_level](m,n,3) = t_frac;
-          }
-        }
+    // Determine block
+    if (x1 < x1_min_block or x1 > x1_max_block or x2 < x2_min_block or x2 > x2_max_block
+        or x3 < x3_min_block or x3 > x3_max_block)
+    {
+      // Find block containing position
+      int b_new = LocateBlock(x1, x2, x3);
 
-        // Prepare to sample values in all other cases
+      // Set fallback values if off grid
+      if (b_new < 0)
+      {
+        if (fallback_nan)
+          sample_nan[adaptive_level](row,n) = true;
         else
-        {
-          // Determine cell
-          for (i = 0; i < n_i; i++)
-            if (x1f(b,i+1) >= x1)
-              break;
-          for (j = 0; j < n_j; j++)
-            if (x2f(b,j+1) >= x2)
-              break;
-          for (k = 0; k < n_k; k++)
-            if (x3f(b,k+1) >= x3)
-              break;
-
-          // Prepare to sample values without interpolation
-          if (not simulation_interp)
-          {
-            sample_inds[adaptive_level](m,n,0) = b;
-            sample_inds[adaptive_level](m,n,1) = k;
-            sample_inds[adaptive_level](m,n,2) = j;
-            sample_inds[adaptive_level](m,n,3) = i;
-            if (slow_light_on)
-              sample_inds[adaptive_level](m,n,4) = t_ind;
-            if (slow_light_on and slow_interp)
-              sample_fracs[adaptive_level](m,n,0) = t_frac;
-          }
-
-          // Prepare to sample values with intrablock interpolation
-          else if (not ((simulation_format == SimulationFormat::athena
-              or simulation_format == SimulationFormat::athenak) and simulation_block_interp))
-          {
-            int i_m = i == 0 or (i != n_i - 1 and x1 >= x1v(b,i)) ? i : i - 1;
-            int j_m = j == 0 or (j != n_j - 1 and x2 >= x2v(b,j)) ? j : j - 1;
-            int k_m = k == 0 or (k != n_k - 1 and x3 >= x3v(b,k)) ? k : k - 1;
-            double f_i = (x1 - x1v(b,i_m)) / (x1v(b,i_m+1) - x1v(b,i_m));
-            double f_j = (x2 - x2v(b,j_m)) / (x2v(b,j_m+1) - x2v(b,j_m));
-            double f_k = (x3 - x3v(b,k_m)) / (x3v(b,k_m+1) - x3v(b,k_m));
-            sample_inds[adaptive_level](m,n,0) = b;
-            sample_inds[adaptive_level](m,n,1) = k_m;
-            sample_inds[adaptive_level](m,n,2) = j_m;
-            sample_inds[adaptive_level](m,n,3) = i_m;
-            if (slow_light_on)
-              sample_inds[adaptive_level](m,n,4) = t_ind;
-            sample_fracs[adaptive_level](m,n,0) = f_k;
-            sample_fracs[adaptive_level](m,n,1) = f_j;
-            sample_fracs[adaptive_level](m,n,2) = f_i;
-            if (slow_light_on and slow_interp)
-              sample_fracs[adaptive_level](m,n,3) = t_frac;
-          }
-
-          // Prepare to sample values with interblock interpolation
-          else
-          {
-            // Determine indices to use for interpolation
-            int i_m = x1 >= x1v(b,i) ? i : i - 1;
-            int j_m = x2 >= x2v(b,j) ? j : j - 1;
-            int k_m = x3 >= x3v(b,k) ? k : k - 1;
-            int i_p = i_m + 1;
-            int j_p = j_m + 1;
-            int k_p = k_m + 1;
-
-            // Calculate fractions to use in interpolation
-            double x1_m = i_m == -1 ? 2.0 * x1f(b,i) - x1v(b,i) : x1v(b,i_m);
-            double x2_m = j_m == -1 ? 2.0 * x2f(b,j) - x2v(b,j) : x2v(b,j_m);
-            double x3_m = k_m == -1 ? 2.0 * x3f(b,k) - x3v(b,k) : x3v(b,k_m);
-            double x1_p = i_p == n_i ? 2.0 * x1v(b,i+1) - x1v(b,i) : x1v(b,i_p);
-            double x2_p = j_p == n_j ? 2.0 * x2v(b,j+1) - x2v(b,j) : x2v(b,j_p);
-            double x3_p = k_p == n_k ? 2.0 * x3v(b,k+1) - x3v(b,k) : x3v(b,k_p);
-            double f_i = (x1 - x1_m) / (x1_p - x1_m);
-            double f_j = (x2 - x2_m) / (x2_p - x2_m);
-            double f_k = (x3 - x3_m) / (x3_p - x3_m);
-
-            // Find interpolation anchors
-            int inds[8][4];
-            FindNearbyInds(b, k_m, j_m, i_m, k, j, i, x3, x2, x1, inds[0]);
-            FindNearbyInds(b, k_m, j_m, i_p, k, j, i, x3, x2, x1, inds[1]);
-            FindNearbyInds(b, k_m, j_p, i_m, k, j, i, x3, x2, x1, inds[2]);
-            FindNearbyInds(b, k_m, j_p, i_p, k, j, i, x3, x2, x1, inds[3]);
-            FindNearbyInds(b, k_p, j_m, i_m, k, j, i, x3, x2, x1, inds[4]);
-            FindNearbyInds(b, k_p, j_m, i_p, k, j, i, x3, x2, x1, inds[5]);
-            FindNearbyInds(b, k_p, j_p, i_m, k, j, i, x3, x2, x1, inds[6]);
-            FindNearbyInds(b, k_p, j_p, i_p, k, j, i, x3, x2, x1, inds[7]);
-
-            // Store results
-            for (int p = 0; p < 8; p++)
-            {
-              for (int q = 0; q < 4; q++)
-                sample_inds[adaptive_level](m,n,p,q) = inds[p][q];
-              if (slow_light_on)
-                sample_inds[adaptive_level](m,n,p,4) = t_ind;
-            }
-            sample_fracs[adaptive_level](m,n,0) = f_k;
-            sample_fracs[adaptive_level](m,n,1) = f_j;
-            sample_fracs[adaptive_level](m,n,2) = f_i;
-            if (slow_light_on and slow_interp)
-              sample_fracs[adaptive_level](m,n,3) = t_frac;
-          }
-        }
+          sample_fallback[adaptive_level](row,n) = true;
+        continue;
       }
 
-      // Add to accounting of warnings and errors
-      if (extrap_camera_small)
+      // Set newly found block as one to search
+      b = b_new;
+      x1_min_block = x1f(b,0);
+      x1_max_block = x1f(b,n_i);
+      x2_min_block = x2f(b,0);
+      x2_max_block = x2f(b,n_j);
+      x3_min_block = x3f(b,0);
+      x3_max_block = x3f(b,n_k);
+    }
+
+    // Prepare to sample values in FMKS case
+    if (simulation_coord == Coordinates::fmks)
+    {
+      // Calculate location of coordinate point in SKS map with fractional offset
+      double i_ind, j_ind;
+      double f_i = std::modf((x1 - sks_map_r_in) / sks_map_dr, &i_ind);
+      double f_j = std::modf(x2 / sks_map_dtheta, &j_ind);
+      i = static_cast<int>(i_ind);
+      j = static_cast<int>(j_ind);
+      double fmks_x1 = (1.0 - f_i) * sks_map(0,j,i) + f_i * sks_map(0,j,i+1);
+      double fmks_x2 = (1.0 - f_j) * sks_map(1,j+1,i) + f_j * sks_map(1,j+1,i);
+
+      // Calculate fractional zone within fluid file
+      double x1_0 = x1f(b,0);
+      double dx1 = x1f(b,1) - x1f(b,0);
+      double dx2 = x2f(b,1) - x2f(b,0);
+      f_i = std::modf((fmks_x1 - x1_0) / dx1, &i_ind);
+      f_j = std::modf(fmks_x2 / dx2, &j_ind);
+      int i_m = static_cast<int>(i_ind);
+      int j_m = static_cast<int>(j_ind);
+
+      // Calculate phi coordinate as usual
+      k = FindCell(b, 2, x3);
+      int k_m = k == 0 or (k != n_k - 1 and x3 >= x3v(b,k)) ? k : k - 1;
+      double f_k = (x3 - x3v(b,k_m)) / (x3v(b,k_m+1) - x3v(b,k_m));
+
+      // Prepare to sample values without interpolation
+      if (not simulation_interp)
       {
-        num_extrap_camera_small++;
-        val_extrap_camera_small = std::max(val_extrap_camera_small, val_extrap_camera_small_local);
+        sample_inds[adaptive_level](row,n,0) = b;
+        sample_inds[adaptive_level](row,n,1) = k;
+        sample_inds[adaptive_level](row,n,2) = f_j >= 0.5 ? j_m + 1 : j_m;
+        sample_inds[adaptive_level](row,n,3) = f_i >= 0.5 ? i_m + 1 : i_m;
+        if (slow_light_on)
+          sample_inds[adaptive_level](row,n,4) = t_ind;
+        if (slow_light_on and slow_interp)
+          sample_fracs[adaptive_level](row,n,0) = t_frac;
       }
-      if (extrap_camera_large)
+
+      // Prepare to sample values with interpolation
+      else
       {
-        num_extrap_camera_large++;
-        val_extrap_camera_large = std::max(val_extrap_camera_large, val_extrap_camera_large_local);
+        sample_inds[adaptive_level](row,n,0) = b;
+        sample_inds[adaptive_level](row,n,1) = k_m;
+        sample_inds[adaptive_level](row,n,2) = j_m;
+        sample_inds[adaptive_level](row,n,3) = i_m;
+        if (slow_light_on)
+          sample_inds[adaptive_level](row,n,4) = t_ind;
+        sample_fracs[adaptive_level](row,n,0) = f_k;
+        sample_fracs[adaptive_level](row,n,1) = f_j;
+        sample_fracs[adaptive_level](row,n,2) = f_i;
+        if (slow_light_on and slow_interp)
+          sample_fracs[adaptive_level](row,n,3) = t_frac;
       }
-      if (extrap_source_small)
+    }
+
+    // Prepare to sample values in all other cases
+    else
+    {
+      // Determine cell
+      i = FindCell(b, 0, x1);
+      j = FindCell(b, 1, x2);
+      k = FindCell(b, 2, x3);
+
+      // Prepare to sample values without interpolation
+      if (not simulation_interp)
       {
-        num_extrap_source_small++;
-        val_extrap_source_small = std::max(val_extrap_source_small, val_extrap_source_small_local);
+        sample_inds[adaptive_level](row,n,0) = b;
+        sample_inds[adaptive_level](row,n,1) = k;
+        sample_inds[adaptive_level](row,n,2) = j;
+        sample_inds[adaptive_level](row,n,3) = i;
+        if (slow_light_on)
+          sample_inds[adaptive_level](row,n,4) = t_ind;
+        if (slow_light_on and slow_interp)
+          sample_fracs[adaptive_level](row,n,0) = t_frac;
       }
-      if (extrap_source_large)
+
+      // Prepare to sample values with intrablock interpolation
+      else if (not ((simulation_format == SimulationFormat::athena
+          or simulation_format == SimulationFormat::athenak) and simulation_block_interp))
       {
-        num_extrap_source_large++;
-        val_extrap_source_large = std::max(val_extrap_source_large, val_extrap_source_large_local);
+        int i_m = i == 0 or (i != n_i - 1 and x1 >= x1v(b,i)) ? i : i - 1;
+        int j_m = j == 0 or (j != n_j - 1 and x2 >= x2v(b,j)) ? j : j - 1;
+        int k_m = k == 0 or (k != n_k - 1 and x3 >= x3v(b,k)) ? k : k - 1;
+        double f_i = (x1 - x1v(b,i_m)) / (x1v(b,i_m+1) - x1v(b,i_m));
+        double f_j = (x2 - x2v(b,j_m)) / (x2v(b,j_m+1) - x2v(b,j_m));
+        double f_k = (x3 - x3v(b,k_m)) / (x3v(b,k_m+1) - x3v(b,k_m));
+        sample_inds[adaptive_level](row,n,0) = b;
+        sample_inds[adaptive_level](row,n,1) = k_m;
+        sample_inds[adaptive_level](row,n,2) = j_m;
+        sample_inds[adaptive_level](row,n,3) = i_m;
+        if (slow_light_on)
+          sample_inds[adaptive_level](row,n,4) = t_ind;
+        sample_fracs[adaptive_level](row,n,0) = f_k;
+        sample_fracs[adaptive_level](row,n,1) = f_j;
+        sample_fracs[adaptive_level](row,n,2) = f_i;
+        if (slow_light_on and slow_interp)
+          sample_fracs[adaptive_level](row,n,3) = t_frac;
+      }
+
+      // Prepare to sample values with interblock interpolation
+      else
+      {
+        // Determine indices to use for interpolation
+        int i_m = x1 >= x1v(b,i) ? i : i - 1;
+        int j_m = x2 >= x2v(b,j) ? j : j - 1;
+        int k_m = x3 >= x3v(b,k) ? k : k - 1;
+        int i_p = i_m + 1;
+        int j_p = j_m + 1;
+        int k_p = k_m + 1;
+
+        // Calculate fractions to use in interpolation
+        double x1_m = i_m == -1 ? 2.0 * x1f(b,i) - x1v(b,i) : x1v(b,i_m);
+        double x2_m = j_m == -1 ? 2.0 * x2f(b,j) - x2v(b,j) : x2v(b,j_m);
+        double x3_m = k_m == -1 ? 2.0 * x3f(b,k) - x3v(b,k) : x3v(b,k_m);
+        double x1_p = i_p == n_i ? 2.0 * x1v(b,i+1) - x1v(b,i) : x1v(b,i_p);
+        double x2_p = j_p == n_j ? 2.0 * x2v(b,j+1) - x2v(b,j) : x2v(b,j_p);
+        double x3_p = k_p == n_k ? 2.0 * x3v(b,k+1) - x3v(b,k) : x3v(b,k_p);
+        double f_i = (x1 - x1_m) / (x1_p - x1_m);
+        double f_j = (x2 - x2_m) / (x2_p - x2_m);
+        double f_k = (x3 - x3_m) / (x3_p - x3_m);
+
+        // Store results, with anchors possibly in ghost cells
+        sample_inds[adaptive_level](row,n,0) = b;
+        sample_inds[adaptive_level](row,n,1) = k_m;
+        sample_inds[adaptive_level](row,n,2) = j_m;
+        sample_inds[adaptive_level](row,n,3) = i_m;
+        if (slow_light_on)
+          sample_inds[adaptive_level](row,n,4) = t_ind;
+        sample_fracs[adaptive_level](row,n,0) = f_k;
+        sample_fracs[adaptive_level](row,n,1) = f_j;
+        sample_fracs[adaptive_level](row,n,2) = f_i;
+        if (slow_light_on and slow_interp)
+          sample_fracs[adaptive_level](row,n,3) = t_frac;
       }
     }
   }
 
+  // Record block for next ray
+  *p_b = b;
+  block_bounds[0] = x1_min_block;
+  block_bounds[1] = x1_max_block;
+  block_bounds[2] = x2_min_block;
+  block_bounds[3] = x2_max_block;
+  block_bounds[4] = x3_min_block;
+  block_bounds[5] = x3_max_block;
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for reporting extrapolation in time needed for sampling
+// Inputs:
+//   snapshot: index (starting at 0) of snapshot
+//   snapshot_time: simulation time of snapshot
+//   num_pix: number of rays sampled
+//   num_extrap: numbers of rays needing each kind of extrapolation, ordered as in SampleRay()
+//   val_extrap: largest extrapolation of each kind
+// Outputs: (none)
+// Notes:
+//   Throws error if any large extrapolation is needed.
+//   Issues warning if any small extrapolation is needed.
+void RadiationIntegrator::ReportExtrapolation(int snapshot, double snapshot_time, int num_pix,
+    const int num_extrap[4], const double val_extrap[4])
+{
   // Throw error if large extrapolation needed
-  if (num_extrap_camera_large > 0)
+  if (num_extrap[1] > 0)
   {
     std::ostringstream message;
     message << "Snapshot " << snapshot << " at time " << snapshot_time;
-    message << " requires significant extrapolation forward in time (" << num_extrap_camera_large;
-    message << "/" << num_pix << " pixels, by up to " << val_extrap_camera_large;
+    message << " requires significant extrapolation forward in time (" << num_extrap[1];
+    message << "/" << num_pix << " pixels, by up to " << val_extrap[1];
     message << " gravitational times).";
     throw BlacklightException(message.str().c_str());
   }
-  if (num_extrap_source_large > 0)
+  if (num_extrap[3] > 0)
   {
     std::ostringstream message;
     message << "Snapshot " << snapshot << " at time " << snapshot_time;
-    message << " requires significant extrapolation backward in time (" << num_extrap_source_large;
-    message << "/" << num_pix << " pixels, by up to " << val_extrap_source_large;
+    message << " requires significant extrapolation backward in time (" << num_extrap[3];
+    message << "/" << num_pix << " pixels, by up to " << val_extrap[3];
     message << " gravitational times).";
     throw BlacklightException(message.str().c_str());
   }
 
   // Warn if small extrapolation needed
-  if (num_extrap_camera_small > 0)
+  if (num_extrap[0] > 0)
   {
     std::ostringstream message;
     message << "Snapshot " << snapshot << " at time " << snapshot_time;
-    message << " requires moderate extrapolation forward in time (" << num_extrap_camera_small;
-    message << "/" << num_pix << " pixels, by up to " << val_extrap_camera_small;
+    message << " requires moderate extrapolation forward in time (" << num_extrap[0];
+    message << "/" << num_pix << " pixels, by up to " << val_extrap[0];
     message << " gravitational times).";
     BlacklightWarning(message.str().c_str());
   }
-  if (num_extrap_source_small > 0)
+  if (num_extrap[2] > 0)
   {
     std::ostringstream message;
     message << "Snapshot " << snapshot << " at time " << snapshot_time;
-    message << " requires moderate extrapolation backward in time (" << num_extrap_source_small;
-    message << "/" << num_pix << " pixels, by up to " << val_extrap_source_small;
+    message << " requires moderate extrapolation backward in time (" << num_extrap[2];
+    message << "/" << num_pix << " pixels, by up to " << val_extrap[2];
     message << " gravitational times).";
     BlacklightWarning(message.str().c_str());
   }
@@ -619,768 +685,361 @@ void RadiationIntegrator::CalculateSimulationSampling(int snapshot)
 
 //--------------------------------------------------------------------------------------------------
 
-// Function for resampling simulation cell data onto rays.
-// Inputs: (none)
-// Outputs: (none)
+// Function for resampling simulation cell data onto a single point along a ray
+// Inputs:
+//   row: row of per-sample arrays holding ray
+//   n: sample index along ray
+// Outputs:
+//   vals: rho, pgas, uu1, uu2, uu3, bb1, bb2, bb3, and kappa (if needed) set, ordered as in
+//       grid_inds
 // Notes:
-//   Assumes geodesic_num_steps[adaptive_level], sample_num[adaptive_level],
-//       sample_inds[adaptive_level], sample_nan[adaptive_level], sample_cut[adaptive_level],
-//       and sample_fallback[adaptive_level] have been set.
+//   Assumes sample_inds[adaptive_level], sample_nan[adaptive_level], and
+//       sample_fallback[adaptive_level] have been set.
 //   Assumes sample_fracs[adaptive_level] has been set if simulation_interp == true.
-//   Allocates and initializes sample_rho[adaptive_level], sample_pgas[adaptive_level],
-//       sample_kappa[adaptive_level] (if needed), sample_uu1[adaptive_level],
-//       sample_uu2[adaptive_level], sample_uu3[adaptive_level], sample_bb1[adaptive_level],
-//       sample_bb2[adaptive_level], and sample_bb3[adaptive_level].
-//   Deallocates sample_inds[adaptive_level], sample_fracs[adaptive_level],
-//       sample_nan[adaptive_level], and sample_fallback[adaptive_level] if adaptive_level > 0.
-void RadiationIntegrator::SampleSimulation()
+//   Does not check sample_cut[adaptive_level]; cut samples should not be passed in.
+//   Values are rounded to single precision, matching the precision of the simulation data.
+//   Called by CalculateSimulationCoefficients() while it works on each sample, so that primitives
+//       are never stored for entire rays unless polarized transfer needs them.
+void RadiationIntegrator::SamplePrimitives(int row, int n, double vals[9])
 {
-  // Allocate arrays
-  int num_pix = camera_num_pix;
-  if (adaptive_level > 0)
-    num_pix = block_counts[adaptive_level] * block_num_pix;
-  if (first_time or adaptive_level > 0)
+  // Set NaN values
+  if (sample_nan[adaptive_level](row,n))
   {
-    sample_rho[adaptive_level].Allocate(num_pix, geodesic_num_steps[adaptive_level]);
-    sample_pgas[adaptive_level].Allocate(num_pix, geodesic_num_steps[adaptive_level]);
-    if (plasma_model == PlasmaModel::code_kappa)
-      sample_kappa[adaptive_level].Allocate(num_pix, geodesic_num_steps[adaptive_level]);
-    sample_uu1[adaptive_level].Allocate(num_pix, geodesic_num_steps[adaptive_level]);
-    sample_uu2[adaptive_level].Allocate(num_pix, geodesic_num_steps[adaptive_level]);
-    sample_uu3[adaptive_level].Allocate(num_pix, geodesic_num_steps[adaptive_level]);
-    sample_bb1[adaptive_level].Allocate(num_pix, geodesic_num_steps[adaptive_level]);
-    sample_bb2[adaptive_level].Allocate(num_pix, geodesic_num_steps[adaptive_level]);
-    sample_bb3[adaptive_level].Allocate(num_pix, geodesic_num_steps[adaptive_level]);
+    for (int q = 0; q < grid_num_vars; q++)
+      vals[q] = std::numeric_limits<double>::quiet_NaN();
+    return;
   }
-  sample_rho[adaptive_level].Zero();
-  sample_pgas[adaptive_level].Zero();
-  sample_kappa[adaptive_level].Zero();
-  sample_uu1[adaptive_level].Zero();
-  sample_uu2[adaptive_level].Zero();
-  sample_uu3[adaptive_level].Zero();
-  sample_bb1[adaptive_level].Zero();
-  sample_bb2[adaptive_level].Zero();
-  sample_bb3[adaptive_level].Zero();
-
-  // Resample cell data onto geodesics in parallel
-  #pragma omp parallel for schedule(static)
-  for (int m = 0; m < num_pix; m++)
-  {
-    // Extract number of steps along this geodesic
-    int num_steps = sample_num[adaptive_level](m);
 
-    // Go along geodesic
-    for (int n = 0; n < num_steps; n++)
-    {
-      // Set NaN values
-      if (sample_nan[adaptive_level](m,n))
-      {
-        sample_rho[adaptive_level](m,n) = std::numeric_limits<float>::quiet_NaN();
-        sample_pgas[adaptive_level](m,n) = std::numeric_limits<float>::quiet_NaN();
-        if (plasma_model == PlasmaModel::code_kappa)
-          sample_kappa[adaptive_level](m,n) = std::numeric_limits<float>::quiet_NaN();
-        sample_uu1[adaptive_level](m,n) = std::numeric_limits<float>::quiet_NaN();
-        sample_uu2[adaptive_level](m,n) = std::numeric_limits<float>::quiet_NaN();
-        sample_uu3[adaptive_level](m,n) = std::numeric_limits<float>::quiet_NaN();
-        sample_bb1[adaptive_level](m,n) = std::numeric_limits<float>::quiet_NaN();
-        sample_bb2[adaptive_level](m,n) = std::numeric_limits<float>::quiet_NaN();
-        sample_bb3[adaptive_level](m,n) = std::numeric_limits<float>::quiet_NaN();
-      }
+  // Set fallback values
+  if (sample_fallback[adaptive_level](row,n))
+  {
+    float fallback_vals[9] = {fallback_rho, fallback_pgas, fallback_uu1, fallback_uu2,
+        fallback_uu3, fallback_bb1, fallback_bb2, fallback_bb3, fallback_kappa};
+    for (int q = 0; q < grid_num_vars; q++)
+      vals[q] = fallback_vals[q];
+    return;
+  }
 
-      // Skip cut regions
-      else if (sample_cut[adaptive_level](m,n))
-        continue;
+  // Extract indices
+  bool block_interp = (simulation_format == SimulationFormat::athena
+      or simulation_format == SimulationFormat::athenak) and simulation_interp
+      and simulation_block_interp;
+  int b = sample_inds[adaptive_level](row,n,0);
+  int k = sample_inds[adaptive_level](row,n,1);
+  int j = sample_inds[adaptive_level](row,n,2);
+  int i = sample_inds[adaptive_level](row,n,3);
+  int t = 0;
+  if (slow_light_on)
+    t = sample_inds[adaptive_level](row,n,4);
 
-      // Set fallback values
-      else if (sample_fallback[adaptive_level](m,n))
-      {
-        sample_rho[adaptive_level](m,n) = fallback_rho;
-        sample_pgas[adaptive_level](m,n) = fallback_pgas;
-        if (plasma_model == PlasmaModel::code_kappa)
-          sample_kappa[adaptive_level](m,n) = fallback_kappa;
-        sample_uu1[adaptive_level](m,n) = fallback_uu1;
-        sample_uu2[adaptive_level](m,n) = fallback_uu2;
-        sample_uu3[adaptive_level](m,n) = fallback_uu3;
-        sample_bb1[adaptive_level](m,n) = fallback_bb1;
-        sample_bb2[adaptive_level](m,n) = fallback_bb2;
-        sample_bb3[adaptive_level](m,n) = fallback_bb3;
-      }
+  // Calculate values on one or two time slices
+  bool time_interp = slow_light_on and slow_interp;
+  double vals_t[2][9];
+  for (int t_offset = 0; t_offset <= (time_interp ? 1 : 0); t_offset++)
+  {
+    // Set nearest values
+    if (not simulation_interp)
+      GridValues(t + t_offset, b, k, j, i, vals_t[t_offset]);
 
-      // Set nearest values
-      else if (not simulation_interp)
-      {
-        // Extract indices
-        int b = sample_inds[adaptive_level](m,n,0);
-        int k = sample_inds[adaptive_level](m,n,1);
-        int j = sample_inds[adaptive_level](m,n,2);
-        int i = sample_inds[adaptive_level](m,n,3);
-        int t = 0;
-        if (slow_light_on)
-          t = sample_inds[adaptive_level](m,n,4);
+    // Set interpolated values, accounting for possible invalid values
+    else
+    {
+      double f_k = sample_fracs[adaptive_level](row,n,0);
+      double f_j = sample_fracs[adaptive_level](row,n,1);
+      double f_i = sample_fracs[adaptive_level](row,n,2);
+      if (block_interp)
+        InterpolateAdvanced(t + t_offset, b, k, j, i, f_k, f_j, f_i, vals_t[t_offset]);
+      else
+        InterpolateSimple(t + t_offset, b, k, j, i, f_k, f_j, f_i, vals_t[t_offset]);
+      for (int q = 0; q < grid_num_vars; q++)
+        if (grid_positive[q] and vals_t[t_offset][q] <= 0.0)
+          vals_t[t_offset][q] = GridValue(t + t_offset, q, b, k, j, i);
+    }
+  }
 
-        // Calculate values without temporal interpolation
-        if (not (slow_light_on and slow_interp))
-        {
-          sample_rho[adaptive_level](m,n) = grid_prim[t](ind_rho,b,k,j,i);
-          sample_pgas[adaptive_level](m,n) = grid_prim[t](ind_pgas,b,k,j,i);
-          if (plasma_model == PlasmaModel::code_kappa)
-            sample_kappa[adaptive_level](m,n) = grid_prim[t](ind_kappa,b,k,j,i);
-          sample_uu1[adaptive_level](m,n) = grid_prim[t](ind_uu1,b,k,j,i);
-          sample_uu2[adaptive_level](m,n) = grid_prim[t](ind_uu2,b,k,j,i);
-          sample_uu3[adaptive_level](m,n) = grid_prim[t](ind_uu3,b,k,j,i);
-          sample_bb1[adaptive_level](m,n) = grid_prim[t](ind_bb1,b,k,j,i);
-          sample_bb2[adaptive_level](m,n) = grid_prim[t](ind_bb2,b,k,j,i);
-          sample_bb3[adaptive_level](m,n) = grid_prim[t](ind_bb3,b,k,j,i);
-        }
+  // Assign values without temporal interpolation
+  if (not time_interp)
+    for (int q = 0; q < grid_num_vars; q++)
+      vals[q] = static_cast<float>(vals_t[0][q]);
 
-        // Calculate values with temporal interpolation
-        else
-        {
-          // Perform spatial interpolation on first slice
-          double rho_1 = static_cast<double>(grid_prim[t](ind_rho,b,k,j,i));
-          double pgas_1 = static_cast<double>(grid_prim[t](ind_pgas,b,k,j,i));
-          double kappa_1 = 0.0;
-          if (plasma_model == PlasmaModel::code_kappa)
-            kappa_1 = static_cast<double>(grid_prim[t](ind_kappa,b,k,j,i));
-          double uu1_1 = static_cast<double>(grid_prim[t](ind_uu1,b,k,j,i));
-          double uu2_1 = static_cast<double>(grid_prim[t](ind_uu2,b,k,j,i));
-          double uu3_1 = static_cast<double>(grid_prim[t](ind_uu3,b,k,j,i));
-          double bb1_1 = static_cast<double>(grid_prim[t](ind_bb1,b,k,j,i));
-          double bb2_1 = static_cast<double>(grid_prim[t](ind_bb2,b,k,j,i));
-          double bb3_1 = static_cast<double>(grid_prim[t](ind_bb3,b,k,j,i));
-
-          // Perform spatial interpolation on second slice
-          double rho_2 = static_cast<double>(grid_prim[t+1](ind_rho,b,k,j,i));
-          double pgas_2 = static_cast<double>(grid_prim[t+1](ind_pgas,b,k,j,i));
-          double kappa_2 = 0.0;
-          if (plasma_model == PlasmaModel::code_kappa)
-            kappa_2 = static_cast<double>(grid_prim[t+1](ind_kappa,b,k,j,i));
-          double uu1_2 = static_cast<double>(grid_prim[t+1](ind_uu1,b,k,j,i));
-          double uu2_2 = static_cast<double>(grid_prim[t+1](ind_uu2,b,k,j,i));
-          double uu3_2 = static_cast<double>(grid_prim[t+1](ind_uu3,b,k,j,i));
-          double bb1_2 = static_cast<double>(grid_prim[t+1](ind_bb1,b,k,j,i));
-          double bb2_2 = static_cast<double>(grid_prim[t+1](ind_bb2,b,k,j,i));
-          double bb3_2 = static_cast<double>(grid_prim[t+1](ind_bb3,b,k,j,i));
-
-          // Assign interpolated values
-          double t_frac = sample_fracs[adaptive_level](m,n,0);
-          sample_rho[adaptive_level](m,n) =
-              static_cast<float>((1.0 - t_frac) * rho_1 + t_frac * rho_2);
-          sample_pgas[adaptive_level](m,n) =
-              static_cast<float>((1.0 - t_frac) * pgas_1 + t_frac * pgas_2);
-          if (plasma_model == PlasmaModel::code_kappa)
-            sample_kappa[adaptive_level](m,n) =
-                static_cast<float>((1.0 - t_frac) * kappa_1 + t_frac * kappa_2);
-          sample_uu1[adaptive_level](m,n) =
-              static_cast<float>((1.0 - t_frac) * uu1_1 + t_frac * uu1_2);
-          sample_uu2[adaptive_level](m,n) =
-              static_cast<float>((1.0 - t_frac) * uu2_1 + t_frac * uu2_2);
-          sample_uu3[adaptive_level](m,n) =
-              static_cast<float>((1.0 - t_frac) * uu3_1 + t_frac * uu3_2);
-          sample_bb1[adaptive_level](m,n) =
-              static_cast<float>((1.0 - t_frac) * bb1_1 + t_frac * bb1_2);
-          sample_bb2[adaptive_level](m,n) =
-              static_cast<float>((1.0 - t_frac) * bb2_1 + t_frac * bb2_2);
-          sample_bb3[adaptive_level](m,n) =
-              static_cast<float>((1.0 - t_frac) * bb3_1 + t_frac * bb3_2);
-        }
-      }
+  // Assign values with temporal interpolation
+  else
+  {
+    double t_frac = sample_fracs[adaptive_level](row,n,simulation_interp ? 3 : 0);
+    for (int q = 0; q < grid_num_vars; q++)
+      vals[q] = static_cast<float>((1.0 - t_frac) * vals_t[0][q] + t_frac * vals_t[1][q]);
+  }
+  return;
+}
 
-      // Set intrablock interpolated values
-      else if (not ((simulation_format == SimulationFormat::athena
-          or simulation_format == SimulationFormat::athenak) and simulation_block_interp))
-      {
-        // Extract indices and coefficients
-        int b = sample_inds[adaptive_level](m,n,0);
-        int k = sample_inds[adaptive_level](m,n,1);
-        int j = sample_inds[adaptive_level](m,n,2);
-        int i = sample_inds[adaptive_level](m,n,3);
-        int t = 0;
-        if (slow_light_on)
-          t = sample_inds[adaptive_level](m,n,4);
-        double f_k = sample_fracs[adaptive_level](m,n,0);
-        double f_j = sample_fracs[adaptive_level](m,n,1);
-        double f_i = sample_fracs[adaptive_level](m,n,2);
+//--------------------------------------------------------------------------------------------------
 
-        // Calculate values without temporal interpolation
-        if (not (slow_light_on and slow_interp))
-        {
-          // Perform spatial interpolation
-          double rho = InterpolateSimple(grid_prim[t], ind_rho, b, k, j, i, f_k, f_j, f_i);
-          double pgas = InterpolateSimple(grid_prim[t], ind_pgas, b, k, j, i, f_k, f_j, f_i);
-          double kappa = 0.0;
-          if (plasma_model == PlasmaModel::code_kappa)
-            kappa = InterpolateSimple(grid_prim[t], ind_kappa, b, k, j, i, f_k, f_j, f_i);
-          double uu1 = InterpolateSimple(grid_prim[t], ind_uu1, b, k, j, i, f_k, f_j, f_i);
-          double uu2 = InterpolateSimple(grid_prim[t], ind_uu2, b, k, j, i, f_k, f_j, f_i);
-          double uu3 = InterpolateSimple(grid_prim[t], ind_uu3, b, k, j, i, f_k, f_j, f_i);
-          double bb1 = InterpolateSimple(grid_prim[t], ind_bb1, b, k, j, i, f_k, f_j, f_i);
-          double bb2 = InterpolateSimple(grid_prim[t], ind_bb2, b, k, j, i, f_k, f_j, f_i);
-          double bb3 = InterpolateSimple(grid_prim[t], ind_bb3, b, k, j, i, f_k, f_j, f_i);
-
-          // Account for possible invalid values
-          if (rho <= 0.0)
-            rho = static_cast<double>(grid_prim[t](ind_rho,b,k,j,i));
-          if (pgas <= 0.0)
-            pgas = static_cast<double>(grid_prim[t](ind_pgas,b,k,j,i));
-          if (plasma_model == PlasmaModel::code_kappa and kappa <= 0.0)
-            kappa = static_cast<double>(grid_prim[t](ind_kappa,b,k,j,i));
-
-          // Assign values
-          sample_rho[adaptive_level](m,n) = static_cast<float>(rho);
-          sample_pgas[adaptive_level](m,n) = static_cast<float>(pgas);
-          if (plasma_model == PlasmaModel::code_kappa)
-            sample_kappa[adaptive_level](m,n) = static_cast<float>(kappa);
-          sample_uu1[adaptive_level](m,n) = static_cast<float>(uu1);
-          sample_uu2[adaptive_level](m,n) = static_cast<float>(uu2);
-          sample_uu3[adaptive_level](m,n) = static_cast<float>(uu3);
-          sample_bb1[adaptive_level](m,n) = static_cast<float>(bb1);
-          sample_bb2[adaptive_level](m,n) = static_cast<float>(bb2);
-          sample_bb3[adaptive_level](m,n) = static_cast<float>(bb3);
-        }
+// Function for requesting grid data needed by a sample ahead of time
+// Inputs:
+//   row: row of per-sample arrays holding ray
+//   n: sample index along ray
+// Outputs: (none)
+// Notes:
+//   Assumes sample_inds[adaptive_level], sample_nan[adaptive_level], sample_cut[adaptive_level],
+//       and sample_fallback[adaptive_level] have been set.
+//   Only issues hints to the memory system, so results are unaffected.
+//   Covers the same cells and time slices as SamplePrimitives(), except that stencils reaching
+//       into grid_halo are skipped.
+//   With interleaved storage, a single hint is issued per cell; otherwise every variable is
+//       hinted separately.
+void RadiationIntegrator::PrefetchSample(int row, int n)
+{
+  // Check for samples without grid data
+  if (sample_cut[adaptive_level](row,n) or sample_nan[adaptive_level](row,n)
+      or sample_fallback[adaptive_level](row,n))
+    return;
 
-        // Calculate values with temporal interpolation
-        else
-        {
-          // Perform spatial interpolation on first slice
-          double rho_1 = InterpolateSimple(grid_prim[t], ind_rho, b, k, j, i, f_k, f_j, f_i);
-          double pgas_1 = InterpolateSimple(grid_prim[t], ind_pgas, b, k, j, i, f_k, f_j, f_i);
-          double kappa_1 = 0.0;
-          if (plasma_model == PlasmaModel::code_kappa)
-            kappa_1 = InterpolateSimple(grid_prim[t], ind_kappa, b, k, j, i, f_k, f_j, f_i);
-          double uu1_1 = InterpolateSimple(grid_prim[t], ind_uu1, b, k, j, i, f_k, f_j, f_i);
-          double uu2_1 = InterpolateSimple(grid_prim[t], ind_uu2, b, k, j, i, f_k, f_j, f_i);
-          double uu3_1 = InterpolateSimple(grid_prim[t], ind_uu3, b, k, j, i, f_k, f_j, f_i);
-          double bb1_1 = InterpolateSimple(grid_prim[t], ind_bb1, b, k, j, i, f_k, f_j, f_i);
-          double bb2_1 = InterpolateSimple(grid_prim[t], ind_bb2, b, k, j, i, f_k, f_j, f_i);
-          double bb3_1 = InterpolateSimple(grid_prim[t], ind_bb3, b, k, j, i, f_k, f_j, f_i);
-
-          // Account for possible invalid values
-          if (rho_1 <= 0.0)
-            rho_1 = static_cast<double>(grid_prim[t](ind_rho,b,k,j,i));
-          if (pgas_1 <= 0.0)
-            pgas_1 = static_cast<double>(grid_prim[t](ind_pgas,b,k,j,i));
-          if (plasma_model == PlasmaModel::code_kappa and kappa_1 <= 0.0)
-            kappa_1 = static_cast<double>(grid_prim[t](ind_kappa,b,k,j,i));
-
-          // Perform spatial interpolation on second slice
-          double rho_2 = InterpolateSimple(grid_prim[t+1], ind_rho, b, k, j, i, f_k, f_j, f_i);
-          double pgas_2 = InterpolateSimple(grid_prim[t+1], ind_pgas, b, k, j, i, f_k, f_j, f_i);
-          double kappa_2 = 0.0;
-          if (plasma_model == PlasmaModel::code_kappa)
-            kappa_2 = InterpolateSimple(grid_prim[t+1], ind_kappa, b, k, j, i, f_k, f_j, f_i);
-          double uu1_2 = InterpolateSimple(grid_prim[t+1], ind_uu1, b, k, j, i, f_k, f_j, f_i);
-          double uu2_2 = InterpolateSimple(grid_prim[t+1], ind_uu2, b, k, j, i, f_k, f_j, f_i);
-          double uu3_2 = InterpolateSimple(grid_prim[t+1], ind_uu3, b, k, j, i, f_k, f_j, f_i);
-          double bb1_2 = InterpolateSimple(grid_prim[t+1], ind_bb1, b, k, j, i, f_k, f_j, f_i);
-          double bb2_2 = InterpolateSimple(grid_prim[t+1], ind_bb2, b, k, j, i, f_k, f_j, f_i);
-          double bb3_2 = InterpolateSimple(grid_prim[t+1], ind_bb3, b, k, j, i, f_k, f_j, f_i);
-
-          // Account for possible invalid values
-          if (rho_2 <= 0.0)
-            rho_2 = static_cast<double>(grid_prim[t+1](ind_rho,b,k,j,i));
-          if (pgas_2 <= 0.0)
-            pgas_2 = static_cast<double>(grid_prim[t+1](ind_pgas,b,k,j,i));
-          if (plasma_model == PlasmaModel::code_kappa and kappa_2 <= 0.0)
-            kappa_2 = static_cast<double>(grid_prim[t+1](ind_kappa,b,k,j,i));
-
-          // Assign interpolated values
-          double t_frac = sample_fracs[adaptive_level](m,n,3);
-          sample_rho[adaptive_level](m,n) =
-              static_cast<float>((1.0 - t_frac) * rho_1 + t_frac * rho_2);
-          sample_pgas[adaptive_level](m,n) =
-              static_cast<float>((1.0 - t_frac) * pgas_1 + t_frac * pgas_2);
-          if (plasma_model == PlasmaModel::code_kappa)
-            sample_kappa[adaptive_level](m,n) =
-                static_cast<float>((1.0 - t_frac) * kappa_1 + t_frac * kappa_2);
-          sample_uu1[adaptive_level](m,n) =
-              static_cast<float>((1.0 - t_frac) * uu1_1 + t_frac * uu1_2);
-          sample_uu2[adaptive_level](m,n) =
-              static_cast<float>((1.0 - t_frac) * uu2_1 + t_frac * uu2_2);
-          sample_uu3[adaptive_level](m,n) =
-              static_cast<float>((1.0 - t_frac) * uu3_1 + t_frac * uu3_2);
-          sample_bb1[adaptive_level](m,n) =
-              static_cast<float>((1.0 - t_frac) * bb1_1 + t_frac * bb1_2);
-          sample_bb2[adaptive_level](m,n) =
-              static_cast<float>((1.0 - t_frac) * bb2_1 + t_frac * bb2_2);
-          sample_bb3[adaptive_level](m,n) =
-              static_cast<float>((1.0 - t_frac) * bb3_1 + t_frac * bb3_2);
-        }
-      }
+  // Extract indices
+  int b = sample_inds[adaptive_level](row,n,0);
+  int k = sample_inds[adaptive_level](row,n,1);
+  int j = sample_inds[adaptive_level](row,n,2);
+  int i = sample_inds[adaptive_level](row,n,3);
+  int t = 0;
+  if (slow_light_on)
+    t = sample_inds[adaptive_level](row,n,4);
+  int num_cells = simulation_interp ? 8 : 1;
+  if (simulation_interp
+      and not (k >= 0 and k < x3v.n1 - 1 and j >= 0 and j < x2v.n1 - 1 and i >= 0
+      and i < x1v.n1 - 1))
+    return;
 
-      // Set interblock interpolated values
-      else
+  // Request values
+  int num_times = slow_light_on and slow_interp ? 2 : 1;
+  int num_vars = grid_var_stride == 1 ? 1 : grid_num_vars;
+  for (int t_offset = 0; t_offset < num_times; t_offset++)
+    for (int p = 0; p < num_cells; p++)
+    {
+      long int ind = CellIndex(b, k + p / 4, j + p / 2 % 2, i + p % 2);
+      for (int q = 0; q < num_vars; q++)
       {
-        // Extract index
-        int t = 0;
-        if (slow_light_on)
-          t = sample_inds[adaptive_level](m,n,4);
-
-        // Calculate values without temporal interpolation
-        if (not (slow_light_on and slow_interp))
-        {
-          // Perform spatial interpolation
-          double rho = InterpolateAdvanced(grid_prim[t], ind_rho, m, n);
-          double pgas = InterpolateAdvanced(grid_prim[t], ind_pgas, m, n);
-          double kappa = 0.0;
-          if (plasma_model == PlasmaModel::code_kappa)
-            kappa = InterpolateAdvanced(grid_prim[t], ind_kappa, m, n);
-          double uu1 = InterpolateAdvanced(grid_prim[t], ind_uu1, m, n);
-          double uu2 = InterpolateAdvanced(grid_prim[t], ind_uu2, m, n);
-          double uu3 = InterpolateAdvanced(grid_prim[t], ind_uu3, m, n);
-          double bb1 = InterpolateAdvanced(grid_prim[t], ind_bb1, m, n);
-          double bb2 = InterpolateAdvanced(grid_prim[t], ind_bb2, m, n);
-          double bb3 = InterpolateAdvanced(grid_prim[t], ind_bb3, m, n);
-
-          // Account for possible invalid values
-          int b = sample_inds[adaptive_level](m,n,0,0);
-          int k = sample_inds[adaptive_level](m,n,0,1);
-          int j = sample_inds[adaptive_level](m,n,0,2);
-          int i = sample_inds[adaptive_level](m,n,0,3);
-          if (rho <= 0.0)
-            rho = static_cast<double>(grid_prim[t](ind_rho,b,k,j,i));
-          if (pgas <= 0.0)
-            pgas = static_cast<double>(grid_prim[t](ind_pgas,b,k,j,i));
-          if (plasma_model == PlasmaModel::code_kappa and kappa <= 0.0)
-            kappa = static_cast<double>(grid_prim[t](ind_kappa,b,k,j,i));
-
-          // Assign values
-          sample_rho[adaptive_level](m,n) = static_cast<float>(rho);
-          sample_pgas[adaptive_level](m,n) = static_cast<float>(pgas);
-          if (plasma_model == PlasmaModel::code_kappa)
-            sample_kappa[adaptive_level](m,n) = static_cast<float>(kappa);
-          sample_uu1[adaptive_level](m,n) = static_cast<float>(uu1);
-          sample_uu2[adaptive_level](m,n) = static_cast<float>(uu2);
-          sample_uu3[adaptive_level](m,n) = static_cast<float>(uu3);
-          sample_bb1[adaptive_level](m,n) = static_cast<float>(bb1);
-          sample_bb2[adaptive_level](m,n) = static_cast<float>(bb2);
-          sample_bb3[adaptive_level](m,n) = static_cast<float>(bb3);
-        }
-
-        // Calculate values with temporal interpolation
+        long int ind_q = ind + grid_inds[q] * grid_var_stride;
+        if (simulation_precision == SimulationPrecision::single)
+          __builtin_prefetch(grid_prim[t+t_offset].data + ind_q);
         else
-        {
-          // Perform spatial interpolation on first slice
-          double rho_1 = InterpolateAdvanced(grid_prim[t], ind_rho, m, n);
-          double pgas_1 = InterpolateAdvanced(grid_prim[t], ind_pgas, m, n);
-          double kappa_1 = 0.0;
-          if (plasma_model == PlasmaModel::code_kappa)
-            kappa_1 = InterpolateAdvanced(grid_prim[t], ind_kappa, m, n);
-          double uu1_1 = InterpolateAdvanced(grid_prim[t], ind_uu1, m, n);
-          double uu2_1 = InterpolateAdvanced(grid_prim[t], ind_uu2, m, n);
-          double uu3_1 = InterpolateAdvanced(grid_prim[t], ind_uu3, m, n);
-          double bb1_1 = InterpolateAdvanced(grid_prim[t], ind_bb1, m, n);
-          double bb2_1 = InterpolateAdvanced(grid_prim[t], ind_bb2, m, n);
-          double bb3_1 = InterpolateAdvanced(grid_prim[t], ind_bb3, m, n);
-
-          // Account for possible invalid values
-          int b = sample_inds[adaptive_level](m,n,0,0);
-          int k = sample_inds[adaptive_level](m,n,0,1);
-          int j = sample_inds[adaptive_level](m,n,0,2);
-          int i = sample_inds[adaptive_level](m,n,0,3);
-          if (rho_1 <= 0.0)
-            rho_1 = static_cast<double>(grid_prim[t](ind_rho,b,k,j,i));
-          if (pgas_1 <= 0.0)
-            pgas_1 = static_cast<double>(grid_prim[t](ind_pgas,b,k,j,i));
-          if (plasma_model == PlasmaModel::code_kappa and kappa_1 <= 0.0)
-            kappa_1 = static_cast<double>(grid_prim[t](ind_kappa,b,k,j,i));
-
-          // Perform spatial interpolation on second slice
-          double rho_2 = InterpolateAdvanced(grid_prim[t+1], ind_rho, m, n);
-          double pgas_2 = InterpolateAdvanced(grid_prim[t+1], ind_pgas, m, n);
-          double kappa_2 = 0.0;
-          if (plasma_model == PlasmaModel::code_kappa)
-            kappa_2 = InterpolateAdvanced(grid_prim[t+1], ind_kappa, m, n);
-          double uu1_2 = InterpolateAdvanced(grid_prim[t+1], ind_uu1, m, n);
-          double uu2_2 = InterpolateAdvanced(grid_prim[t+1], ind_uu2, m, n);
-          double uu3_2 = InterpolateAdvanced(grid_prim[t+1], ind_uu3, m, n);
-          double bb1_2 = InterpolateAdvanced(grid_prim[t+1], ind_bb1, m, n);
-          double bb2_2 = InterpolateAdvanced(grid_prim[t+1], ind_bb2, m, n);
-          double bb3_2 = InterpolateAdvanced(grid_prim[t+1], ind_bb3, m, n);
-
-          // Account for possible invalid values
-          if (rho_2 <= 0.0)
-            rho_2 = static_cast<double>(grid_prim[t+1](ind_rho,b,k,j,i));
-          if (pgas_2 <= 0.0)
-            pgas_2 = static_cast<double>(grid_prim[t+1](ind_pgas,b,k,j,i));
-          if (plasma_model == PlasmaModel::code_kappa and kappa_2 <= 0.0)
-            kappa_2 = static_cast<double>(grid_prim[t+1](ind_kappa,b,k,j,i));
-
-          // Assign interpolated values
-          double t_frac = sample_fracs[adaptive_level](m,n,3);
-          sample_rho[adaptive_level](m,n) =
-              static_cast<float>((1.0 - t_frac) * rho_1 + t_frac * rho_2);
-          sample_pgas[adaptive_level](m,n) =
-              static_cast<float>((1.0 - t_frac) * pgas_1 + t_frac * pgas_2);
-          if (plasma_model == PlasmaModel::code_kappa)
-            sample_kappa[adaptive_level](m,n) =
-                static_cast<float>((1.0 - t_frac) * kappa_1 + t_frac * kappa_2);
-          sample_uu1[adaptive_level](m,n) =
-              static_cast<float>((1.0 - t_frac) * uu1_1 + t_frac * uu1_2);
-          sample_uu2[adaptive_level](m,n) =
-              static_cast<float>((1.0 - t_frac) * uu2_1 + t_frac * uu2_2);
-          sample_uu3[adaptive_level](m,n) =
-              static_cast<float>((1.0 - t_frac) * uu3_1 + t_frac * uu3_2);
-          sample_bb1[adaptive_level](m,n) =
-              static_cast<float>((1.0 - t_frac) * bb1_1 + t_frac * bb1_2);
-          sample_bb2[adaptive_level](m,n) =
-              static_cast<float>((1.0 - t_frac) * bb2_1 + t_frac * bb2_2);
-          sample_bb3[adaptive_level](m,n) =
-              static_cast<float>((1.0 - t_frac) * bb3_1 + t_frac * bb3_2);
-        }
+          __builtin_prefetch(grid_prim_packed[t+t_offset].data + ind_q);
       }
     }
-  }
+  return;
+}
 
-  // Free memory
-  if (adaptive_level > 0)
-  {
-    sample_inds[adaptive_level].Deallocate();
-    sample_fracs[adaptive_level].Deallocate();
-    sample_nan[adaptive_level].Deallocate();
-    sample_fallback[adaptive_level].Deallocate();
-  }
+//--------------------------------------------------------------------------------------------------
+
+// Function for checking cadence of loaded time slices
+// Inputs: (none)
+// Outputs: (none)
+// Notes:
+//   Assumes time has been set for current chunk of slow_chunk_size slices, in decreasing order.
+//   Sets time_uniform and time_inv_dt for use by FindTimeIndex().
+//   Tolerance only affects speed of FindTimeIndex(), not its result.
+void RadiationIntegrator::PrepareTimeIndex()
+{
+  double dt = (time[0] - time[slow_chunk_size-1]) / (slow_chunk_size - 1);
+  time_uniform = dt > 0.0;
+  for (int t = 1; t < slow_chunk_size - 1 and time_uniform; t++)
+    time_uniform = std::abs(time[t] - (time[0] - t * dt)) <= 1.0e-6 * dt;
+  time_inv_dt = time_uniform ? 1.0 / dt : 0.0;
   return;
 }
 
 //--------------------------------------------------------------------------------------------------
 
-// Function for finding cell indices in a given or nearby block
+// Function for finding first time slice not after given time
 // Inputs:
-//   b: block index
-//   k, j, i: cell indices for x^3, x^2, and x^1, possibly 1 beyond valid range
-//   k_c, j_c, i_c: cell indices for closest cell to sample point in question
-//   x3, x2, x1: coordinates of sample point in question
+//   x0: time, assumed to lie strictly between latest and earliest loaded slices
+//   t_ind_guess: nearby index, or 0 if none is known
 // Outputs:
-//   inds: block, x^3, x^2, and x^1 indices set
+//   returned value: smallest index t_ind with time[t_ind] <= x0
 // Notes:
-//   If requested cell is within block, that cell is used.
-//   If requested cell is in an adjacent block, the appropriate cell there is used:
-//     If adjacent block is at the same refinement level, the appropriate ghost cell is used.
-//     If adjacent block is coarser, the coarse cell containing the appropriate ghost cell is used.
-//     If adjacent block is finer, the fine cell closest to the given coordinates is used.
-//   If the requested cell is not on the grid, values are copied from the unique cell on the grid
-//       closest to the appropriate ghost cell, effectively resulting in constant (rather than
-//       linear) extrapolation near the edges of the grid.
-//   In the case of simulation_coord being Coordinates::sks or Coordinates::fmks, neighboring blocks
-//       are understood to cross the periodic boundary in x^3 (phi), but the domain is not stitched
-//       together at the poles.
-void RadiationIntegrator::FindNearbyInds(int b, int k, int j, int i, int k_c, int j_c, int i_c,
-    double x3, double x2, double x1, int inds[4])
+//   Assumes PrepareTimeIndex() has been called.
+//   For uniform cadence, computes index in closed form; otherwise starts from given guess, or
+//       bisects if no guess is given.
+//   Corrects initial index by stepping through slices, which takes amortized constant time when
+//       consecutive calls along a geodesic use the previous result as their guess.
+int RadiationIntegrator::FindTimeIndex(double x0, int t_ind_guess)
 {
-  // Extract location data
-  int n_b = x1f.n2;
-  int n_i = x1v.n1;
-  int n_j = x2v.n1;
-  int n_k = x3v.n1;
-  int level = levels(b);
-  int location_i = locations(b,0);
-  int location_j = locations(b,1);
-  int location_k = locations(b,2);
-  bool upper_i = i > n_i / 2;
-  bool upper_j = j > n_j / 2;
-  bool upper_k = k > n_k / 2;
-  int i_safe = std::max(std::min(i, n_i - 1), 0);
-  int j_safe = std::max(std::min(j, n_j - 1), 0);
-  int k_safe = std::max(std::min(k, n_k - 1), 0);
-
-  // Handle simple case on given block
-  if (i == i_safe and j == j_safe and k == k_safe)
+  // Make initial guess
+  int t_ind = t_ind_guess;
+  if (time_uniform)
   {
-    inds[0] = b;
-    inds[1] = k;
-    inds[2] = j;
-    inds[3] = i;
-    return;
+    double t_val = std::ceil((time[0] - x0) * time_inv_dt);
+    t_ind = 1;
+    if (t_val >= slow_chunk_size - 1)
+      t_ind = slow_chunk_size - 1;
+    else if (t_val > 1.0)
+      t_ind = static_cast<int>(t_val);
   }
-
-  // Check for grid existing in various directions
-  bool x1_off_grid = true;
-  bool x2_off_grid = true;
-  bool x3_off_grid = true;
-  for (int b_alt = 0; b_alt < n_b; b_alt++)
+  else if (t_ind <= 0)
   {
-    // Extract data for block
-    int level_alt = levels(b_alt);
-    int location_i_alt = locations(b_alt,0);
-    int location_j_alt = locations(b_alt,1);
-    int location_k_alt = locations(b_alt,2);
-
-    // Check x^1-direction
-    if (x1_off_grid and i != i_safe)
+    int t_ind_lower = 1;
+    int t_ind_upper = slow_chunk_size - 1;
+    while (t_ind_upper > t_ind_lower)
     {
-      bool same_level_exists = level_alt == level;
-      same_level_exists =
-          same_level_exists and location_i_alt == (i == -1 ? location_i - 1 : location_i + 1);
-      same_level_exists = same_level_exists and location_j_alt == location_j;
-      same_level_exists = same_level_exists and location_k_alt == location_k;
-      bool coarser_level_exists = level_alt == level - 1;
-      coarser_level_exists = coarser_level_exists
-          and location_i_alt == (i == -1 ? (location_i - 1) / 2 : (location_i + 1) / 2);
-      coarser_level_exists = coarser_level_exists and location_j_alt == location_j / 2;
-      coarser_level_exists = coarser_level_exists and location_k_alt == location_k / 2;
-      bool finer_level_exists = level_alt == level + 1;
-      finer_level_exists = finer_level_exists
-          and location_i_alt == (i == -1 ? location_i * 2 - 1 : location_i * 2 + 2);
-      finer_level_exists =
-          finer_level_exists and location_j_alt == (upper_j ? location_j * 2 + 1 : location_j * 2);
-      finer_level_exists =
-          finer_level_exists and location_k_alt == (upper_k ? location_k * 2 + 1 : location_k * 2);
-      if (same_level_exists or coarser_level_exists or finer_level_exists)
-        x1_off_grid = false;
+      int t_ind_mid = (t_ind_lower + t_ind_upper) / 2;
+      if (time[t_ind_mid] <= x0)
+        t_ind_upper = t_ind_mid;
+      else
+        t_ind_lower = t_ind_mid + 1;
     }
+    t_ind = t_ind_lower;
+  }
 
-    // Check x^2-direction
-    if (x2_off_grid and j != j_safe)
-    {
-      bool same_level_exists = level_alt == level;
-      same_level_exists = same_level_exists and location_i_alt == location_i;
-      same_level_exists =
-          same_level_exists and location_j_alt == (j == -1 ? location_j - 1 : location_j + 1);
-      same_level_exists = same_level_exists and location_k_alt == location_k;
-      bool coarser_level_exists = level_alt == level - 1;
-      coarser_level_exists = coarser_level_exists and location_i_alt == location_i / 2;
-      coarser_level_exists = coarser_level_exists
-          and location_j_alt == (j == -1 ? (location_j - 1) / 2 : (location_j + 1) / 2);
-      coarser_level_exists = coarser_level_exists and location_k_alt == location_k / 2;
-      bool finer_level_exists = level_alt == level + 1;
-      finer_level_exists =
-          finer_level_exists and location_i_alt == (upper_i ? location_i * 2 + 1 : location_i * 2);
-      finer_level_exists = finer_level_exists
-          and location_j_alt == (j == -1 ? location_j * 2 - 1 : location_j * 2 + 2);
-      finer_level_exists =
-          finer_level_exists and location_k_alt == (upper_k ? location_k * 2 + 1 : location_k * 2);
-      if (same_level_exists or coarser_level_exists or finer_level_exists)
-        x2_off_grid = false;
-    }
+  // Correct guess
+  while (t_ind > 1 and time[t_ind-1] <= x0)
+    t_ind--;
+  while (t_ind < slow_chunk_size - 1 and time[t_ind] > x0)
+    t_ind++;
+  return t_ind;
+}
 
-    // Check x^3-direction
-    if (x3_off_grid and k != k_safe)
-    {
-      bool same_level_exists = level_alt == level;
-      same_level_exists = same_level_exists and location_i_alt == location_i;
-      same_level_exists = same_level_exists and location_j_alt == location_j;
-      same_level_exists =
-          same_level_exists and location_k_alt == (k == -1 ? location_k - 1 : location_k + 1);
-      bool coarser_level_exists = level_alt == level - 1;
-      coarser_level_exists = coarser_level_exists and location_i_alt == location_i / 2;
-      coarser_level_exists = coarser_level_exists and location_j_alt == location_j / 2;
-      coarser_level_exists = coarser_level_exists
-          and location_k_alt == (k == -1 ? (location_k - 1) / 2 : (location_k + 1) / 2);
-      bool finer_level_exists = level_alt == level + 1;
-      finer_level_exists =
-          finer_level_exists and location_i_alt == (upper_i ? location_i * 2 + 1 : location_i * 2);
-      finer_level_exists =
-          finer_level_exists and location_j_alt == (upper_j ? location_j * 2 + 1 : location_j * 2);
-      finer_level_exists = finer_level_exists
-          and location_k_alt == (k == -1 ? location_k * 2 - 1 : location_k * 2 + 2);
-      if (same_level_exists or coarser_level_exists or finer_level_exists)
-        x3_off_grid = false;
-    }
+//--------------------------------------------------------------------------------------------------
 
-    // Check x^3-direction across periodic boundary
-    if (x3_off_grid and simulation_coord == Coordinates::sks and k == -1 and location_k == 0)
-    {
-      bool same_level_exists = level_alt == level;
-      same_level_exists = same_level_exists and location_i_alt == location_i;
-      same_level_exists = same_level_exists and location_j_alt == location_j;
-      same_level_exists = same_level_exists and location_k_alt == n_3_level(level_alt) - 1;
-      bool coarser_level_exists = level_alt == level - 1;
-      coarser_level_exists = coarser_level_exists and location_i_alt == location_i / 2;
-      coarser_level_exists = coarser_level_exists and location_j_alt == location_j / 2;
-      coarser_level_exists = coarser_level_exists and location_k_alt == n_3_level(level_alt) - 1;
-      bool finer_level_exists = level_alt == level + 1;
-      finer_level_exists =
-          finer_level_exists and location_i_alt == (upper_i ? location_i * 2 + 1 : location_i * 2);
-      finer_level_exists =
-          finer_level_exists and location_j_alt == (upper_j ? location_j * 2 + 1 : location_j * 2);
-      finer_level_exists = finer_level_exists and location_k_alt == n_3_level(level_alt) - 1;
-      if (same_level_exists or coarser_level_exists or finer_level_exists)
-        x3_off_grid = false;
-    }
-    if (x3_off_grid and simulation_coord == Coordinates::sks and k == n_k
-        and location_k == n_3_level(level) - 1)
-    {
-      bool same_level_exists = level_alt == level;
-      same_level_exists = same_level_exists and location_i_alt == location_i;
-      same_level_exists = same_level_exists and location_j_alt == location_j;
-      same_level_exists = same_level_exists and location_k_alt == 0;
-      bool coarser_level_exists = level_alt == level - 1;
-      coarser_level_exists = coarser_level_exists and location_i_alt == location_i / 2;
-      coarser_level_exists = coarser_level_exists and location_j_alt == location_j / 2;
-      coarser_level_exists = coarser_level_exists and location_k_alt == 0;
-      bool finer_level_exists = level_alt == level + 1;
-      finer_level_exists =
-          finer_level_exists and location_i_alt == (upper_i ? location_i * 2 + 1 : location_i * 2);
-      finer_level_exists =
-          finer_level_exists and location_j_alt == (upper_j ? location_j * 2 + 1 : location_j * 2);
-      finer_level_exists = finer_level_exists and location_k_alt == 0;
-      if (same_level_exists or coarser_level_exists or finer_level_exists)
-        x3_off_grid = false;
-    }
-  }
+// Function for extracting single sampled quantity from grid
+// Inputs:
+//   t: time index
+//   q: index of quantity to be extracted, ordered as in grid_inds
+//   b: block index
+//   k, j, i: cell indices, possibly 1 beyond valid range
+// Outputs:
+//   returned value: value from grid
+// Notes:
+//   Accounts for storage precision and layout.
+//   Takes values outside block from grid_halo, which must have been filled by FillHalos().
+double RadiationIntegrator::GridValue(int t, int q, int b, int k, int j, int i)
+{
+  if (k < 0 or k >= x3v.n1 or j < 0 or j >= x2v.n1 or i < 0 or i >= x1v.n1)
+    return grid_halo(t,b,GhostIndex(k, j, i),q);
+  return GridDatum(t, CellIndex(b, k, j, i) + grid_inds[q] * grid_var_stride, grid_positive[q]);
+}
 
-  // Account for grid existing in simple cases
-  if (i == i_safe)
-    x1_off_grid = false;
-  if (j == j_safe)
-    x2_off_grid = false;
-  if (k == k_safe)
-    x3_off_grid = false;
-
-  // Adjust sought location to be on grid
-  if (x1_off_grid)
-    i = i_safe;
-  if (x2_off_grid)
-    j = j_safe;
-  if (x3_off_grid)
-    k = k_safe;
-
-  // Find cell at same level
-  int level_sought = level;
-  int location_i_sought = i == i_safe ? location_i : i == -1 ? location_i - 1 : location_i + 1;
-  int location_j_sought = j == j_safe ? location_j : j == -1 ? location_j - 1 : location_j + 1;
-  int location_k_sought = k == k_safe ? location_k : k == -1 ? location_k - 1 : location_k + 1;
-  if (simulation_coord == Coordinates::sks and k == -1 and location_k == 0)
-    location_k_sought = n_3_level(level_sought) - 1;
-  if (simulation_coord == Coordinates::sks and k == n_k and location_k == n_3_level(level) - 1)
-    location_k_sought = 0;
-  int i_sought = i == i_safe ? i : i == -1 ? n_i - 1 : 0;
-  int j_sought = j == j_safe ? j : j == -1 ? n_j - 1 : 0;
-  int k_sought = k == k_safe ? k : k == -1 ? n_k - 1 : 0;
-  for (int b_alt = 0; b_alt < n_b; b_alt++)
-    if (levels(b_alt) == level_sought and locations(b_alt,0) == location_i_sought
-        and locations(b_alt,1) == location_j_sought and locations(b_alt,2) == location_k_sought)
-    {
-      inds[0] = b_alt;
-      inds[1] = k_sought;
-      inds[2] = j_sought;
-      inds[3] = i_sought;
-      return;
-    }
+//--------------------------------------------------------------------------------------------------
 
-  // Find cell at coarser level
-  level_sought = level - 1;
-  if (level_sought >= 0)
-  {
-    location_i_sought =
-        i == i_safe ? location_i / 2 : i == -1 ? (location_i - 1) / 2 : (location_i + 1) / 2;
-    location_j_sought =
-        j == j_safe ? location_j / 2 : j == -1 ? (location_j - 1) / 2 : (location_j + 1) / 2;
-    location_k_sought =
-        k == k_safe ? location_k / 2 : k == -1 ? (location_k - 1) / 2 : (location_k + 1) / 2;
-    if (simulation_coord == Coordinates::sks and k == -1 and location_k == 0)
-      location_k_sought = n_3_level(level_sought) - 1;
-    if (simulation_coord == Coordinates::sks and k == n_k and location_k == n_3_level(level) - 1)
-      location_k_sought = 0;
-    i_sought = i == i_safe ? (location_i % 2 * n_i + i) / 2 : i == -1 ? n_i - 1 : 0;
-    j_sought = j == j_safe ? (location_j % 2 * n_j + j) / 2 : j == -1 ? n_j - 1 : 0;
-    k_sought = k == k_safe ? (location_k % 2 * n_k + k) / 2 : k == -1 ? n_k - 1 : 0;
-    for (int b_alt = 0; b_alt < n_b; b_alt++)
-      if (levels(b_alt) == level_sought and locations(b_alt,0) == location_i_sought
-          and locations(b_alt,1) == location_j_sought and locations(b_alt,2) == location_k_sought)
-      {
-        inds[0] = b_alt;
-        inds[1] = k_sought;
-        inds[2] = j_sought;
-        inds[3] = i_sought;
-        return;
-      }
-  }
+// Function for extracting all sampled quantities in a cell from grid
+// Inputs:
+//   t: time index
+//   b: block index
+//   k, j, i: cell indices
+// Outputs:
+//   vals: first grid_num_vars values set, ordered as in grid_inds
+void RadiationIntegrator::GridValues(int t, int b, int k, int j, int i, double vals[9])
+{
+  long int ind = CellIndex(b, k, j, i);
+  for (int q = 0; q < grid_num_vars; q++)
+    vals[q] = GridDatum(t, ind + grid_inds[q] * grid_var_stride, grid_positive[q]);
+  return;
+}
 
-  // Find cell at finer level
-  level_sought = level + 1;
-  location_i_sought = location_i * 2 + (i == i_safe ? 0 : i == -1 ? -1 : 1) + (upper_i ? 1 : 0);
-  location_j_sought = location_j * 2 + (j == j_safe ? 0 : j == -1 ? -1 : 1) + (upper_j ? 1 : 0);
-  location_k_sought = location_k * 2 + (k == k_safe ? 0 : k == -1 ? -1 : 1) + (upper_k ? 1 : 0);
-  if (simulation_coord == Coordinates::sks and k == -1 and location_k == 0
-      and level_sought <= max_level)
-    location_k_sought = n_3_level(level_sought) - 1;
-  if (simulation_coord == Coordinates::sks and k == n_k and location_k == n_3_level(level) - 1)
-    location_k_sought = 0;
-  i_sought = i == i_safe ? (upper_i ? (i - n_i / 2) * 2 : i * 2) : i == -1 ? n_i - 2 : 0;
-  j_sought = j == j_safe ? (upper_j ? (j - n_j / 2) * 2 : j * 2) : j == -1 ? n_j - 2 : 0;
-  k_sought = k == k_safe ? (upper_k ? (k - n_k / 2) * 2 : k * 2) : k == -1 ? n_k - 2 : 0;
-  for (int b_alt = 0; b_alt < n_b; b_alt++)
-    if (levels(b_alt) == level_sought and locations(b_alt,0) == location_i_sought
-        and locations(b_alt,1) == location_j_sought and locations(b_alt,2) == location_k_sought)
-    {
-      inds[0] = b_alt;
-      inds[1] = k_sought;
-      inds[2] = j_sought;
-      inds[3] = i_sought;
-      inds[1] += k < k_c or (k == k_c and x3 > x3v(b,k_c)) ? 1 : 0;
-      inds[2] += j < j_c or (j == j_c and x2 > x2v(b,j_c)) ? 1 : 0;
-      inds[3] += i < i_c or (i == i_c and x1 > x1v(b,i_c)) ? 1 : 0;
-      return;
-    }
+//--------------------------------------------------------------------------------------------------
 
-  // Report grid inconsistency
-  throw BlacklightException("Grid interpolation failed.");
-  return;
+// Function for locating cell in stored cell data
+// Inputs:
+//   b: block index
+//   k, j, i: cell indices
+// Outputs:
+//   returned value: offset of first variable in cell
+long int RadiationIntegrator::CellIndex(int b, int k, int j, int i)
+{
+  long int ind = ((static_cast<long int>(b) * x3v.n1 + k) * x2v.n1 + j) * x1v.n1 + i;
+  return ind * grid_cell_stride;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for extracting value at given offset in stored cell data
+// Inputs:
+//   t: time index
+//   ind: offset of value
+//   positive: flag indicating quantity is physically positive (e.g. density or pressure)
+// Outputs:
+//   returned value: value from grid
+double RadiationIntegrator::GridDatum(int t, long int ind, bool positive)
+{
+  if (simulation_precision == SimulationPrecision::single)
+    return static_cast<double>(grid_prim[t].data[ind]);
+  return static_cast<double>(DecodeReduced(grid_prim_packed[t].data[ind], simulation_precision,
+      positive));
 }
 
 //--------------------------------------------------------------------------------------------------
 
 // Function for performing simple interpolation near a given cell
 // Inputs:
-//   grid_vals: full array of values on grid
-//   grid_ind: index of quantity to be interpolated
+//   t: time index
 //   b: block index
 //   k, j, i: cell indices
 //   f_k, f_j, f_i: interpolation fractions
 // Outputs:
-//   returned value: interpolated value from grid
-double RadiationIntegrator::InterpolateSimple(const Array<float> &grid_vals, int grid_ind, int b,
-    int k, int j, int i, double f_k, double f_j, double f_i)
+//   vals: first grid_num_vars interpolated values set, ordered as in grid_inds
+// Notes:
+//   Gathers all quantities from each of the 8 cells in turn, which touches a single cache line
+//       per cell with interleaved storage.
+void RadiationIntegrator::InterpolateSimple(int t, int b, int k, int j, int i, double f_k,
+    double f_j, double f_i, double vals[9])
 {
-  double val_mmm = static_cast<double>(grid_vals(grid_ind,b,k,j,i));
-  double val_mmp = static_cast<double>(grid_vals(grid_ind,b,k,j,i+1));
-  double val_mpm = static_cast<double>(grid_vals(grid_ind,b,k,j+1,i));
-  double val_mpp = static_cast<double>(grid_vals(grid_ind,b,k,j+1,i+1));
-  double val_pmm = static_cast<double>(grid_vals(grid_ind,b,k+1,j,i));
-  double val_pmp = static_cast<double>(grid_vals(grid_ind,b,k+1,j,i+1));
-  double val_ppm = static_cast<double>(grid_vals(grid_ind,b,k+1,j+1,i));
-  double val_ppp = static_cast<double>(grid_vals(grid_ind,b,k+1,j+1,i+1));
-  double val = (1.0 - f_k) * (1.0 - f_j) * (1.0 - f_i) * val_mmm
-      + (1.0 - f_k) * (1.0 - f_j) * f_i * val_mmp + (1.0 - f_k) * f_j * (1.0 - f_i) * val_mpm
-      + (1.0 - f_k) * f_j * f_i * val_mpp + f_k * (1.0 - f_j) * (1.0 - f_i) * val_pmm
-      + f_k * (1.0 - f_j) * f_i * val_pmp + f_k * f_j * (1.0 - f_i) * val_ppm
-      + f_k * f_j * f_i * val_ppp;
-  return val;
+  double weights[8];
+  weights[0] = (1.0 - f_k) * (1.0 - f_j) * (1.0 - f_i);
+  weights[1] = (1.0 - f_k) * (1.0 - f_j) * f_i;
+  weights[2] = (1.0 - f_k) * f_j * (1.0 - f_i);
+  weights[3] = (1.0 - f_k) * f_j * f_i;
+  weights[4] = f_k * (1.0 - f_j) * (1.0 - f_i);
+  weights[5] = f_k * (1.0 - f_j) * f_i;
+  weights[6] = f_k * f_j * (1.0 - f_i);
+  weights[7] = f_k * f_j * f_i;
+  for (int p = 0; p < 8; p++)
+  {
+    long int ind = CellIndex(b, k + p / 4, j + p / 2 % 2, i + p % 2);
+    for (int q = 0; q < grid_num_vars; q++)
+    {
+      double val = weights[p] * GridDatum(t, ind + grid_inds[q] * grid_var_stride,
+          grid_positive[q]);
+      vals[q] = p == 0 ? val : vals[q] + val;
+    }
+  }
+  return;
 }
 
 //--------------------------------------------------------------------------------------------------
 
-// Function for performing advanced interpolation among 8 cells
+// Function for performing interpolation near a given cell, possibly using ghost cells
 // Inputs:
-//   grid_vals: full array of values on grid
-//   grid_ind: index of quantity to be interpolated
-//   m: ray index
-//   n: index along ray
+//   t: time index
+//   b: block index
+//   k, j, i: cell indices, possibly -1
+//   f_k, f_j, f_i: interpolation fractions
 // Outputs:
-//   returned value: interpolated value from grid
+//   vals: first grid_num_vars interpolated values set, ordered as in grid_inds
 // Notes:
-//   Assumes sample_inds[adaptive_level] and sample_fracs[adaptive_level] have been set.
-double RadiationIntegrator::InterpolateAdvanced(const Array<float> &grid_vals, int grid_ind, int m,
-    int n)
+//   Takes values outside block from grid_halo, which must have been filled by FillHalos().
+//   Uses InterpolateSimple() when all 8 cells are within the block.
+void RadiationIntegrator::InterpolateAdvanced(int t, int b, int k, int j, int i, double f_k,
+    double f_j, double f_i, double vals[9])
 {
-  double vals[8] = {};
-  for (int p = 0; p < 8; p++)
+  // Interpolate within block
+  if (k >= 0 and k < x3v.n1 - 1 and j >= 0 and j < x2v.n1 - 1 and i >= 0 and i < x1v.n1 - 1)
   {
-    int b = sample_inds[adaptive_level](m,n,p,0);
-    int k = sample_inds[adaptive_level](m,n,p,1);
-    int j = sample_inds[adaptive_level](m,n,p,2);
-    int i = sample_inds[adaptive_level](m,n,p,3);
-    vals[p] = static_cast<double>(grid_vals(grid_ind,b,k,j,i));
+    InterpolateSimple(t, b, k, j, i, f_k, f_j, f_i, vals);
+    return;
   }
-  double f_k = sample_fracs[adaptive_level](m,n,0);
-  double f_j = sample_fracs[adaptive_level](m,n,1);
-  double f_i = sample_fracs[adaptive_level](m,n,2);
-  double val = (1.0 - f_k) * (1.0 - f_j) * (1.0 - f_i) * vals[0]
-      + (1.0 - f_k) * (1.0 - f_j) * f_i * vals[1] + (1.0 - f_k) * f_j * (1.0 - f_i) * vals[2]
-      + (1.0 - f_k) * f_j * f_i * vals[3] + f_k * (1.0 - f_j) * (1.0 - f_i) * vals[4]
-      + f_k * (1.0 - f_j) * f_i * vals[5] + f_k * f_j * (1.0 - f_i) * vals[6]
-      + f_k * f_j * f_i * vals[7];
-  return val;
+
+  // Interpolate using ghost cells
+  double weights[8];
+  weights[0] = (1.0 - f_k) * (1.0 - f_j) * (1.0 - f_i);
+  weights[1] = (1.0 - f_k) * (1.0 - f_j) * f_i;
+  weights[2] = (1.0 - f_k) * f_j * (1.0 - f_i);
+  weights[3] = (1.0 - f_k) * f_j * f_i;
+  weights[4] = f_k * (1.0 - f_j) * (1.0 - f_i);
+  weights[5] = f_k * (1.0 - f_j) * f_i;
+  weights[6] = f_k * f_j * (1.0 - f_i);
+  weights[7] = f_k * f_j * f_i;
+  for (int p = 0; p < 8; p++)
+    for (int q = 0; q < grid_num_vars; q++)
+    {
+      double val = weights[p] * GridValue(t, q, b, k + p / 4, j + p / 2 % 2, i + p % 2);
+      vals[q] = p == 0 ? val : vals[q] + val;
+    }
+  return;
 }
@@ -0,0 +1,84 @@
+// Blacklight radiation integrator - streaming sampling and integration
+
+// C++ headers
+#include <algorithm>  // max
+
+// Library headers
+#include <omp.h>  // omp_get_thread_num
+
+// Blacklight headers
+#include "radiation_integrator.hpp"
+#include "../utils/array.hpp"        // Array
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for sampling simulation data and integrating radiation one ray at a time
+// Inputs:
+//   snapshot: index (starting at 0) of which snapshot is about to be processed
+// Outputs: (none)
+// Notes:
+//   Assumes geodesic_num_steps[0], sample_flags[0], sample_num[0], sample_pos[0], sample_dir[0],
+//       sample_len[0], camera_pos[0], camera_dir[0], and momentum_factors[0] have been set.
+//   Assumes adaptive_level == 0.
+//   Allocates per-sample arrays with one row per thread rather than one row per ray, so that their
+//       size is independent of the number of pixels.
+//   Each thread samples a ray with SampleRay(), calculates its coefficients with
+//       CalculateRayCoefficients(), and integrates it with IntegrateUnpolarizedRay(),
+//       IntegratePolarizedRay(), or IntegrateStokesRay() before moving on to the next ray.
+//   Allocates and initializes image[0].
+//   Sampling is recalculated for every snapshot, since it is not retained between rays.
+void RadiationIntegrator::IntegrateStreaming(int snapshot)
+{
+  // Prepare time slices, constants, and arrays
+  int num_pix = camera_num_pix;
+  double snapshot_time = PrepareSimulationSampling(snapshot, num_threads);
+  PrepareSimulationCoefficients(num_threads, geodesic_num_steps[0]);
+
+  // Allocate image array
+  if (first_time)
+    image[0].Allocate(image_num_quantities, num_pix);
+  image[0].Zero();
+  bool polarized = image_light and image_polarization;
+
+  // Prepare bookkeeping for warnings and errors
+  int num_extrap[4] = {};
+  double val_extrap[4] = {};
+
+  // Work in parallel
+  #pragma omp parallel
+  {
+    // Prepare bookkeeping
+    int row = omp_get_thread_num();
+    int b;
+    double block_bounds[6];
+    PrepareSamplingBlock(&b, block_bounds);
+
+    // Go through rays, processing each one completely before the next
+    #pragma omp for schedule(dynamic) reduction(+: num_extrap[:4]) reduction(max: val_extrap[:4])
+    for (int m = 0; m < num_pix; m++)
+    {
+      // Sample simulation data
+      double val_extrap_ray[4];
+      SampleRay(m, row, snapshot_time, &b, block_bounds, val_extrap_ray);
+      for (int q = 0; q < 4; q++)
+        if (val_extrap_ray[q] > 0.0)
+        {
+          num_extrap[q]++;
+          val_extrap[q] = std::max(val_extrap[q], val_extrap_ray[q]);
+        }
+
+      // Calculate coefficients and integrate
+      CalculateRayCoefficients(m, row);
+      if (polarized and image_stokes)
+        IntegrateStokesRay(m, row);
+      else if (polarized)
+        IntegratePolarizedRay(m, row);
+      else
+        IntegrateUnpolarizedRay(m, row);
+    }
+  }
+
+  // Report extrapolation in time
+  ReportExtrapolation(snapshot, snapshot_time, num_pix, num_extrap, val_extrap);
+  return;
+}
@@ -2,11 +2,11 @@
 
 // C++ headers
 #include <algorithm>  // min
-#include <cmath>      // exp, expm1
+#include <cmath>      // exp, expm1, isnan
 #include <limits>     // numeric_limits
 
 // Library headers
-#include <omp.h>  // pragmas
+#include <omp.h>  // omp_get_thread_num, pragmas
 
 // Blacklight headers
 #include "radiation_integrator.hpp"
@@ -22,12 +22,14 @@
 //   Assumes sample_num[adaptive_level], sample_len[adaptive_level], j_i[adaptive_level],
 //       alpha_i[adaptive_level], and momentum_factors[adaptive_level] have been set.
 //   Assumes sample_pos[adaptive_level] has been set if image_time == true or image_length == true.
-//   Assumes sample_dir[adaptive_level] has been set if image_length == true.
+//   Assumes sample_dlen[adaptive_level] has been set if image_length == true.
 //   Assumes cell_values[adaptive_level] has been set if image_lambda_ave == true or
 //       image_emission_ave == true or image_tau_int == true.
-//   Allocates and initializes image[adaptive_level].
+//   Allocates and initializes image[adaptive_level] and works on each ray with
+//       IntegrateUnpolarizedRay().
 //   Deallocates j_i[adaptive_level] and alpha_i[adaptive_level] if adaptive_level > 0.
-//   Deallocates cell_values[adaptive_level] if render_num_images <= 0 and adaptive_level > 0.
+//   Deallocates sample_cut[adaptive_level] and cell_values[adaptive_level] if adaptive_level > 0,
+//       unless Render() still needs them.
 void RadiationIntegrator::IntegrateUnpolarizedRadiation()
 {
   // Allocate image array
@@ -38,187 +40,409 @@ void RadiationIntegrator::IntegrateUnpolarizedRadiation()
     image[adaptive_level].Allocate(image_num_quantities, num_pix);
   image[adaptive_level].Zero();
 
+  // Go through pixels in parallel
+  #pragma omp parallel for schedule(static)
+  for (int m = 0; m < num_pix; m++)
+    IntegrateUnpolarizedRay(m, m);
+
+  // Free memory
+  if (adaptive_level > 0)
+  {
+    j_i[adaptive_level].Deallocate();
+    alpha_i[adaptive_level].Deallocate();
+    if (render_num_images <= 0 or render_fused)
+    {
+      sample_cut[adaptive_level].Deallocate();
+      cell_values[adaptive_level].Deallocate();
+    }
+  }
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for integrating unpolarized radiative transfer equation along a single ray
+// Inputs:
+//   m: ray index
+//   row: row of per-sample arrays holding ray
+// Outputs: (none)
+// Notes:
+//   Assumes sample_num[adaptive_level], sample_len[adaptive_level], and
+//       momentum_factors[adaptive_level] have been set, as has the given row of
+//       j_i[adaptive_level] and alpha_i[adaptive_level].
+//   Assumes sample_pos[adaptive_level] has been set if image_time == true or image_length == true.
+//   Assumes sample_dlen[adaptive_level] has been set if image_length == true.
+//   Assumes given row of cell_values[adaptive_level] has been set if image_lambda_ave == true or
+//       image_emission_ave == true or image_tau_int == true.
+//   Assumes given row of sample_cut[adaptive_level] has been set if
+//       model_type == ModelType::simulation, in which case the per-sample arrays hold values only
+//       for samples outside the cut region, stored contiguously.
+//   Assumes image[adaptive_level] has been allocated and initialized.
+//   If image_tau_max >= 0.0, instead works with IntegrateTerminatedRay().
+//   Otherwise works with IntegrateUnpolarizedRayKernel(), specialized to image_flags if the
+//       combination of image quantities is a common one.
+void RadiationIntegrator::IntegrateUnpolarizedRay(int m, int row)
+{
+  // Integrate from camera if ray can be terminated
+  if (image_tau_max >= 0.0)
+  {
+    IntegrateTerminatedRay(m, row);
+    return;
+  }
+
+  // Integrate with kernel specialized to requested image quantities
+  if (image_flags == ImageFlags::light)
+    IntegrateUnpolarizedRayKernel<ImageFlags::light>(m, row);
+  else if (image_flags == (ImageFlags::light | ImageFlags::tau))
+    IntegrateUnpolarizedRayKernel<ImageFlags::light | ImageFlags::tau>(m, row);
+  else if (image_flags == (ImageFlags::light | ImageFlags::lambda | ImageFlags::emission
+      | ImageFlags::tau))
+    IntegrateUnpolarizedRayKernel<ImageFlags::light | ImageFlags::lambda | ImageFlags::emission
+        | ImageFlags::tau>(m, row);
+  else if (image_flags == (ImageFlags::light | ImageFlags::lambda_ave | ImageFlags::emission_ave
+      | ImageFlags::tau_int))
+    IntegrateUnpolarizedRayKernel<ImageFlags::light | ImageFlags::lambda_ave
+        | ImageFlags::emission_ave | ImageFlags::tau_int>(m, row);
+  else
+    IntegrateUnpolarizedRayKernel<ImageFlags::runtime>(m, row);
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for integrating unpolarized radiative transfer equation along a single ray, with image
+//     quantities fixed at compile time
+// Inputs:
+//   flags: bitwise combination of ImageFlags values for image quantities to produce, or
+//       ImageFlags::runtime to use the image_light, image_time, etc. flags
+//   m: ray index
+//   row: row of per-sample arrays holding ray
+// Outputs: (none)
+// Notes:
+//   Makes the same assumptions as IntegrateUnpolarizedRay().
+//   Assumes image_tau_max < 0.0.
+//   Assumes flags agrees with image_flags unless it is ImageFlags::runtime.
+//   Tests for image quantities not requested in flags are eliminated at compile time.
+//   Goes through samples once, updating all frequencies at each sample, and accumulates
+//       per-frequency quantities in the calling thread's row of ray_spectra before storing them in
+//       the image.
+template <int flags>
+void RadiationIntegrator::IntegrateUnpolarizedRayKernel(int m, int row)
+{
+  // Select image quantities, fixed at compile time unless runtime selection is requested
+  constexpr bool runtime = (flags & ImageFlags::runtime) != 0;
+  const bool do_light = runtime ? image_light : (flags & ImageFlags::light) != 0;
+  const bool do_time = runtime ? image_time : (flags & ImageFlags::time) != 0;
+  const bool do_length = runtime ? image_length : (flags & ImageFlags::length) != 0;
+  const bool do_lambda = runtime ? image_lambda : (flags & ImageFlags::lambda) != 0;
+  const bool do_emission = runtime ? image_emission : (flags & ImageFlags::emission) != 0;
+  const bool do_tau = runtime ? image_tau : (flags & ImageFlags::tau) != 0;
+  const bool do_lambda_ave = runtime ? image_lambda_ave : (flags & ImageFlags::lambda_ave) != 0;
+  const bool do_emission_ave =
+      runtime ? image_emission_ave : (flags & ImageFlags::emission_ave) != 0;
+  const bool do_tau_int = runtime ? image_tau_int : (flags & ImageFlags::tau_int) != 0;
+  const bool do_crossings = runtime ? image_crossings : (flags & ImageFlags::crossings) != 0;
+  const bool do_cell_values = do_lambda_ave or do_emission_ave or do_tau_int;
+
   // Calculate units
   double x_unit = Physics::gg_msun * mass_msun / (Physics::c * Physics::c);
   double t_unit = x_unit / Physics::c;
 
-  // Work in parallel
-  #pragma omp parallel
+  // Extract number of steps
+  int num_steps = sample_num[adaptive_level](m);
+  int n_start = -1;
+  int z_turnings_count = 0;
+  if (image_z_turnings)
+    FindZTurnings(m, num_steps, n_start, z_turnings_count);
+  if (n_start < 0)
+    n_start = 0;
+
+  // Locate stored values for first sample
+  bool compact = model_type == ModelType::simulation;
+  int c_start = 0;
+  for (int n = 0; n < n_start; n++)
+    if (not compact or not sample_cut[adaptive_level](row,n))
+      c_start++;
+
+  // Prepare integrated quantities
+  int num_freq = image_num_frequencies;
+  double *spectra = &ray_spectra(omp_get_thread_num(),0,0);
+  double *frequency_scales = spectra + RaySpectra::frequency_scale * num_freq;
+  double *intensities = spectra + RaySpectra::intensity * num_freq;
+  double *integrated_lambdas = spectra + RaySpectra::lambda * num_freq;
+  double *integrated_emissions = spectra + RaySpectra::emission * num_freq;
+  double *integrated_taus = spectra + RaySpectra::tau * num_freq;
+  for (int l = 0; l < num_freq; l++)
+  {
+    frequency_scales[l] = image_frequencies(l) * momentum_factors[adaptive_level](m);
+    intensities[l] = 0.0;
+    integrated_lambdas[l] = 0.0;
+    integrated_emissions[l] = 0.0;
+    integrated_taus[l] = 0.0;
+  }
+  double x1_init = sample_pos[adaptive_level](m,0,1);
+  double x2_init = sample_pos[adaptive_level](m,0,2);
+  double x3_init = sample_pos[adaptive_level](m,0,3);
+  bool plane_sign = camera_x[1] * x1_init + camera_x[2] * x2_init + camera_x[3] * x3_init > 0.0;
+  int crossings_count = 0;
+
+  // Go through samples
+  int c_next = c_start;
+  for (int n = n_start; n < num_steps; n++)
   {
-    // Allocate scratch space
-    double gcov[4][4];
-    double gcon[4][4];
+    // Locate stored values, noting samples in cut region have none
+    bool live = not compact or not sample_cut[adaptive_level](row,n);
+    int c = live ? c_next++ : 0;
+
+    // Integrate frequency-independent quantities
+    double delta_lambda_x = sample_len[adaptive_level](m,n) * x_unit;
+    if (do_time)
+    {
+      double t_cgs = sample_pos[adaptive_level](m,n,0) * t_unit;
+      image[adaptive_level](image_offset_time,m) =
+          std::min(image[adaptive_level](image_offset_time,m), t_cgs);
+    }
+    if (do_length)
+      image[adaptive_level](image_offset_length,m) += sample_dlen[adaptive_level](m,n) * x_unit;
+    if (do_crossings)
+    {
+      double x1 = sample_pos[adaptive_level](m,n,1);
+      double x2 = sample_pos[adaptive_level](m,n,2);
+      double x3 = sample_pos[adaptive_level](m,n,3);
+      bool plane_sign_new = camera_x[1] * x1 + camera_x[2] * x2 + camera_x[3] * x3 > 0.0;
+      if (plane_sign_new != plane_sign)
+        crossings_count++;
+      plane_sign = plane_sign_new;
+    }
 
-    // Go through frequencies and pixels
-    #pragma omp for schedule(static)
-    for (int m = 0; m < num_pix; m++)
+    // Accumulate affine lengths in cut region, where there is no emission or absorption
+    if (not live)
     {
-      // Extract number of steps
-      int num_steps = sample_num[adaptive_level](m);
-      int n_start = -1;
-      int z_turnings_count = 0;
-      if (image_z_turnings)
-        FindZTurnings(m, num_steps, n_start, z_turnings_count);
-      if (n_start < 0)
-        n_start = 0;
-
-      for (int l = 0; l < image_num_frequencies; l++)
+      if (do_lambda or do_lambda_ave)
+        for (int l = 0; l < num_freq; l++)
+          integrated_lambdas[l] += delta_lambda_x / frequency_scales[l];
+      continue;
+    }
+
+    // Integrate all frequencies
+    const double *j_vals = do_light or do_emission or do_emission_ave
+        ? &j_i[adaptive_level](row,c,0) : nullptr;
+    const double *alpha_vals = do_light or do_tau or do_tau_int
+        ? &alpha_i[adaptive_level](row,c,0) : nullptr;
+    for (int l = 0; l < num_freq; l++)
+    {
+      double delta_lambda_cgs = delta_lambda_x / frequency_scales[l];
+      double j = j_vals != nullptr ? j_vals[l] : 0.0;
+      double alpha = alpha_vals != nullptr ? alpha_vals[l] : 0.0;
+      double delta_tau = alpha * delta_lambda_cgs;
+      if (do_light)
       {
-        // Prepare integrated quantities
-        double integrated_lambda = 0.0;
-        double integrated_emission = 0.0;
-        double x1_init = sample_pos[adaptive_level](m,0,1);
-        double x2_init = sample_pos[adaptive_level](m,0,2);
-        double x3_init = sample_pos[adaptive_level](m,0,3);
-        bool plane_sign =
-            camera_x[1] * x1_init + camera_x[2] * x2_init + camera_x[3] * x3_init > 0.0;
-        int crossings_count = 0;
-
-        // Go through samples
-        for (int n = n_start; n < num_steps; n++)
-        {
-          // Extract and calculate useful values
-          double delta_lambda = sample_len[adaptive_level](m,n);
-          double delta_lambda_cgs =
-              delta_lambda * x_unit / (image_frequencies(l) * momentum_factors[adaptive_level](m));
-          double t_cgs = sample_pos[adaptive_level](m,n,0) * t_unit;
-          double x1 = sample_pos[adaptive_level](m,n,1);
-          double x2 = sample_pos[adaptive_level](m,n,2);
-          double x3 = sample_pos[adaptive_level](m,n,3);
-          double kcov[4];
-          kcov[0] = sample_dir[adaptive_level](m,n,0);
-          kcov[1] = sample_dir[adaptive_level](m,n,1);
-          kcov[2] = sample_dir[adaptive_level](m,n,2);
-          kcov[3] = sample_dir[adaptive_level](m,n,3);
-          double j = std::numeric_limits<double>::quiet_NaN();
-          if (image_light or image_emission or image_emission_ave)
-            j = j_i[adaptive_level](l,m,n);
-          double alpha = std::numeric_limits<double>::quiet_NaN();
-          if (image_light or image_tau or image_tau_int)
-            alpha = alpha_i[adaptive_level](l,m,n);
-          double ss = j / alpha;
-          double delta_tau = alpha * delta_lambda_cgs;
-          double exp_neg = std::exp(-delta_tau);
-          double expm1 = std::expm1(delta_tau);
-          bool optically_thin = delta_tau <= delta_tau_max;
-
-          // Integrate light
-          if (image_light)
+        double ss = j / alpha;
+        double intensity_thin =
+            std::exp(-delta_tau) * (intensities[l] + ss * std::expm1(delta_tau));
+        double intensity_absorbing = delta_tau <= delta_tau_max ? intensity_thin : ss;
+        intensities[l] = alpha > 0.0 ? intensity_absorbing : intensities[l] + j * delta_lambda_cgs;
+      }
+      if (do_lambda or do_lambda_ave)
+        integrated_lambdas[l] += delta_lambda_cgs;
+      if (do_emission or do_emission_ave)
+        integrated_emissions[l] += j * delta_lambda_cgs;
+      if (do_tau)
+        integrated_taus[l] += delta_tau;
+    }
+
+    // Integrate cell values at all frequencies
+    if (do_cell_values and not std::isnan(cell_values[adaptive_level](0,row,c)))
+      for (int l = 0; l < num_freq; l++)
+      {
+        double delta_lambda_cgs = delta_lambda_x / frequency_scales[l];
+        if (do_lambda_ave)
+          for (int a = 0; a < CellValues::num_cell_values; a++)
           {
-            if (alpha > 0.0)
-            {
-              if (optically_thin)
-                image[adaptive_level](l,m) = exp_neg * (image[adaptive_level](l,m) + ss * expm1);
-              else
-                image[adaptive_level](l,m) = ss;
-            }
-            else
-              image[adaptive_level](l,m) += j * delta_lambda_cgs;
+            int index = image_offset_lambda_ave + l * CellValues::num_cell_values + a;
+            image[adaptive_level](index,m) +=
+                cell_values[adaptive_level](a,row,c) * delta_lambda_cgs;
           }
-
-          // Integrate alternative image quantities
-          if (image_time and l == 0)
-            image[adaptive_level](image_offset_time,m) =
-                std::min(image[adaptive_level](image_offset_time,m), t_cgs);
-          if (image_length and l == 0)
+        if (do_emission_ave)
+        {
+          double j = j_vals[l];
+          for (int a = 0; a < CellValues::num_cell_values; a++)
           {
-            CovariantGeodesicMetric(x1, x2, x3, gcov);
-            ContravariantGeodesicMetric(x1, x2, x3, gcon);
-            double temp_a[4] = {};
-            for (int a = 1; a < 4; a++)
-              for (int mu = 0; mu < 4; mu++)
-                temp_a[a] += (gcon[a][mu] - gcon[0][a] * gcon[0][mu] / gcon[0][0]) * kcov[mu];
-            double dl_dlambda_sq = 0.0;
-            for (int a = 1; a < 4; a++)
-              for (int b = 1; b < 4; b++)
-                dl_dlambda_sq += gcov[a][b] * temp_a[a] * temp_a[b];
-            image[adaptive_level](image_offset_length,m) +=
-                std::sqrt(dl_dlambda_sq) * delta_lambda * x_unit;
+            int index = image_offset_emission_ave + l * CellValues::num_cell_values + a;
+            image[adaptive_level](index,m) +=
+                cell_values[adaptive_level](a,row,c) * j * delta_lambda_cgs;
           }
-          if (image_lambda or image_lambda_ave)
-            integrated_lambda += delta_lambda_cgs;
-          if (image_emission or image_emission_ave)
-            integrated_emission += j * delta_lambda_cgs;
-          if (image_tau)
-            image[adaptive_level](image_offset_tau+l,m) += delta_tau;
-          if (image_lambda_ave and not std::isnan(cell_values[adaptive_level](0,m,n)))
+        }
+        if (do_tau_int)
+        {
+          double delta_tau = alpha_vals[l] * delta_lambda_cgs;
+          if (delta_tau <= delta_tau_max)
+          {
+            double exp_neg = std::exp(-delta_tau);
+            double expm1 = std::expm1(delta_tau);
             for (int a = 0; a < CellValues::num_cell_values; a++)
             {
-              int index = image_offset_lambda_ave + l * CellValues::num_cell_values + a;
-              image[adaptive_level](index,m) +=
-                  cell_values[adaptive_level](a,m,n) * delta_lambda_cgs;
+              int index = image_offset_tau_int + l * CellValues::num_cell_values + a;
+              image[adaptive_level](index,m) = exp_neg
+                  * (image[adaptive_level](index,m) + cell_values[adaptive_level](a,row,c) * expm1);
             }
-          if (image_emission_ave and not std::isnan(cell_values[adaptive_level](0,m,n)))
+          }
+          else
             for (int a = 0; a < CellValues::num_cell_values; a++)
             {
-              int index = image_offset_emission_ave + l * CellValues::num_cell_values + a;
-              image[adaptive_level](index,m) +=
-                  cell_values[adaptive_level](a,m,n) * j * delta_lambda_cgs;
+              int index = image_offset_tau_int + l * CellValues::num_cell_values + a;
+              image[adaptive_level](index,m) = cell_values[adaptive_level](a,row,c);
             }
-          if (image_tau_int and not std::isnan(cell_values[adaptive_level](0,m,n)))
-          {
-            if (optically_thin)
-              for (int a = 0; a < CellValues::num_cell_values; a++)
-              {
-                int index = image_offset_tau_int + l * CellValues::num_cell_values + a;
-                image[adaptive_level](index,m) = exp_neg
-                    * (image[adaptive_level](index,m) + cell_values[adaptive_level](a,m,n) * expm1);
-              }
-            else
-              for (int a = 0; a < CellValues::num_cell_values; a++)
-              {
-                int index = image_offset_tau_int + l * CellValues::num_cell_values + a;
-                image[adaptive_level](index,m) = cell_values[adaptive_level](a,m,n);
-              }
-          }
-          if (image_crossings and l == 0)
-          {
-            bool plane_sign_new = camera_x[1] * x1 + camera_x[2] * x2 + camera_x[3] * x3 > 0.0;
-            if (plane_sign_new != plane_sign)
-              crossings_count++;
-            plane_sign = plane_sign_new;
-          }
         }
+      }
+  }
 
-        // Store integrated quantities
-        if (image_lambda)
-          image[adaptive_level](image_offset_lambda+l,m) = integrated_lambda;
-        if (image_emission)
-          image[adaptive_level](image_offset_emission+l,m) = integrated_emission;
-        if (image_crossings and l == 0)
-          image[adaptive_level](image_offset_crossings,m) = static_cast<double>(crossings_count);
+  // Store integrated quantities
+  for (int l = 0; l < num_freq; l++)
+  {
+    if (do_light)
+    {
+      double nu_cu = image_frequencies(l) * image_frequencies(l) * image_frequencies(l);
+      image[adaptive_level](l,m) = intensities[l] * nu_cu;
+    }
+    if (do_lambda)
+      image[adaptive_level](image_offset_lambda+l,m) = integrated_lambdas[l];
+    if (do_emission)
+      image[adaptive_level](image_offset_emission+l,m) = integrated_emissions[l];
+    if (do_tau)
+      image[adaptive_level](image_offset_tau+l,m) = integrated_taus[l];
+  }
+  if (do_crossings)
+    image[adaptive_level](image_offset_crossings,m) = static_cast<double>(crossings_count);
 
-        // Normalize integrated quantities
-        if (image_lambda_ave)
-          for (int a = 0; a < CellValues::num_cell_values; a++)
-          {
-            int index = image_offset_lambda_ave + l * CellValues::num_cell_values + a;
-            image[adaptive_level](index,m) /= integrated_lambda;
-          }
-        if (image_emission_ave)
-          for (int a = 0; a < CellValues::num_cell_values; a++)
-          {
-            int index = image_offset_emission_ave + l * CellValues::num_cell_values + a;
-            image[adaptive_level](index,m) /= integrated_emission;
-          }
+  // Normalize integrated quantities
+  for (int l = 0; l < num_freq; l++)
+  {
+    if (do_lambda_ave)
+      for (int a = 0; a < CellValues::num_cell_values; a++)
+      {
+        int index = image_offset_lambda_ave + l * CellValues::num_cell_values + a;
+        image[adaptive_level](index,m) /= integrated_lambdas[l];
+      }
+    if (do_emission_ave)
+      for (int a = 0; a < CellValues::num_cell_values; a++)
+      {
+        int index = image_offset_emission_ave + l * CellValues::num_cell_values + a;
+        image[adaptive_level](index,m) /= integrated_emissions[l];
+      }
+  }
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for integrating unpolarized radiative transfer equation along a single ray from camera
+// Inputs:
+//   m: ray index
+//   row: row of per-sample arrays holding ray
+// Outputs: (none)
+// Notes:
+//   Assumes sample_num[adaptive_level], sample_len[adaptive_level], and
+//       momentum_factors[adaptive_level] have been set, as has the given row of
+//       j_i[adaptive_level] and alpha_i[adaptive_level].
+//   Assumes given row of sample_cut[adaptive_level] has been set if
+//       model_type == ModelType::simulation, in which case the per-sample arrays hold values only
+//       for samples outside the cut region, stored contiguously.
+//   Assumes image[adaptive_level] has been allocated and initialized.
+//   Assumes image_light == true and no other image quantities are requested.
+//   Accumulates intensity weighted by the transmittance between each sample and the camera, which
+//       agrees with IntegrateUnpolarizedRay() up to roundoff.
+//   Goes through samples once, updating all frequencies at each sample, and accumulates
+//       per-frequency quantities in the calling thread's row of ray_spectra.
+//   Stops at each frequency once the optical depth from the camera exceeds image_tau_max, ignoring
+//       contributions suppressed by at least a factor of e^(-image_tau_max), and stops going
+//       through samples once this happens at all frequencies.
+void RadiationIntegrator::IntegrateTerminatedRay(int m, int row)
+{
+  // Calculate units
+  double x_unit = Physics::gg_msun * mass_msun / (Physics::c * Physics::c);
+
+  // Extract number of steps
+  int num_steps = sample_num[adaptive_level](m);
+  int n_start = -1;
+  int z_turnings_count = 0;
+  if (image_z_turnings)
+    FindZTurnings(m, num_steps, n_start, z_turnings_count);
+  if (n_start < 0)
+    n_start = 0;
+
+  // Locate stored values for last sample
+  bool compact = model_type == ModelType::simulation;
+  int c_end = 0;
+  for (int n = 0; n < num_steps; n++)
+    if (not compact or not sample_cut[adaptive_level](row,n))
+      c_end++;
 
-        // Transform I_nu/nu^3 to I_nu
-        if (image_light)
+  // Prepare integrated quantities
+  int num_freq = image_num_frequencies;
+  double *spectra = &ray_spectra(omp_get_thread_num(),0,0);
+  double *delta_lambda_factors = spectra + RaySpectra::lambda_factor * num_freq;
+  double *intensities = spectra + RaySpectra::intensity * num_freq;
+  double *transmittances = spectra + RaySpectra::transmittance * num_freq;
+  double *taus = spectra + RaySpectra::tau * num_freq;
+  for (int l = 0; l < num_freq; l++)
+  {
+    delta_lambda_factors[l] =
+        x_unit / (image_frequencies(l) * momentum_factors[adaptive_level](m));
+    intensities[l] = 0.0;
+    transmittances[l] = 1.0;
+    taus[l] = 0.0;
+  }
+
+  // Go through samples from camera until ray is opaque at all frequencies
+  int c = c_end;
+  bool transparent = true;
+  for (int n = num_steps - 1; n >= n_start and transparent; n--)
+  {
+    // Locate stored values, noting samples in cut region have none
+    if (compact and sample_cut[adaptive_level](row,n))
+      continue;
+    c--;
+
+    // Integrate light at frequencies where ray is not yet opaque
+    double delta_lambda = sample_len[adaptive_level](m,n);
+    const double *j_vals = &j_i[adaptive_level](row,c,0);
+    const double *alpha_vals = &alpha_i[adaptive_level](row,c,0);
+    transparent = false;
+    for (int l = 0; l < num_freq; l++)
+    {
+      if (not (taus[l] <= image_tau_max))
+        continue;
+      double delta_lambda_cgs = delta_lambda * delta_lambda_factors[l];
+      double j = j_vals[l];
+      double alpha = alpha_vals[l];
+      double delta_tau = alpha * delta_lambda_cgs;
+      if (alpha > 0.0)
+      {
+        if (delta_tau <= delta_tau_max)
         {
-          double nu_cu = image_frequencies(l) * image_frequencies(l) * image_frequencies(l);
-          image[adaptive_level](l,m) *= nu_cu;
+          double absorbed = -std::expm1(-delta_tau);
+          intensities[l] += transmittances[l] * j / alpha * absorbed;
+          transmittances[l] *= 1.0 - absorbed;
+        }
+        else
+        {
+          intensities[l] += transmittances[l] * j / alpha;
+          transmittances[l] = 0.0;
         }
       }
+      else
+        intensities[l] += transmittances[l] * j * delta_lambda_cgs;
+      taus[l] += delta_tau;
+      transparent = transparent or taus[l] <= image_tau_max;
     }
   }
 
-  // Free memory
-  if (adaptive_level > 0)
+  // Transform I_nu/nu^3 to I_nu
+  for (int l = 0; l < num_freq; l++)
   {
-    j_i[adaptive_level].Deallocate();
-    alpha_i[adaptive_level].Deallocate();
-    if (render_num_images <= 0)
-      cell_values[adaptive_level].Deallocate();
+    double nu_cu = image_frequencies(l) * image_frequencies(l) * image_frequencies(l);
+    image[adaptive_level](l,m) = intensities[l] * nu_cu;
   }
   return;
 }
@@ -1,8 +1,9 @@
 // Blacklight simulation reader - HDF5 interface for reading arrays
 
 // C++ headers
-#include <cstring>  // memcpy
-#include <string>   // string
+#include <algorithm>  // min
+#include <cstring>    // memcpy
+#include <string>     // string
 
 // Library headers
 #include <omp.h>  // pragmas
@@ -99,6 +100,143 @@ void SimulationReader::ReadHDF5FloatArray(const char *name, Array<float> &float_
 
 //--------------------------------------------------------------------------------------------------
 
+// Function to read selected variables of 5D float array dataset from HDF5 file by name
+// Inputs:
+//   name: name of dataset
+//   num_slices: number of variables to read
+//   file_inds: indices of variables (along slowest-varying dimension) within dataset
+//   array_inds: indices of variables (along n5) within float_array to be set
+// Outputs:
+//   float_array: array set at given variable indices
+// Notes:
+//   Changes stream pointer.
+//   Assumes float_array is allocated with n4, n3, n2, and n1 matching dataset.
+//   Reads only needed hyperslabs from file rather than entire dataset.
+void SimulationReader::ReadHDF5FloatArraySlices(const char *name, int num_slices,
+    const int *file_inds, const int *array_inds, Array<float> &float_array)
+{
+  // Locate header
+  unsigned long int header_address =
+      ReadHDF5DatasetHeaderAddress(name, root_btree_address, root_data_segment_address);
+
+  // Read header
+  unsigned char *datatype_raw, *dataspace_raw;
+  unsigned long int data_address, data_size;
+  ReadHDF5DataObjectHeader(header_address, &datatype_raw, &dataspace_raw, &data_address,
+      &data_size);
+
+  // Check dimensions
+  unsigned long int *dims;
+  int num_dims;
+  ReadHDF5DataspaceDims(dataspace_raw, &dims, &num_dims);
+  if (num_dims != 5)
+    throw BlacklightException("Unexpected HDF5 floating-point array size.");
+  unsigned long int num_file_slices = dims[0];
+  delete[] dims;
+  unsigned long int slice_size = data_size / num_file_slices;
+
+  // Modify dataspace to describe single slice
+  const unsigned long int one = 1;
+  std::memcpy(dataspace_raw + 8, &one, 8);
+
+  // Read and set each slice
+  unsigned char *slice_raw = new unsigned char[slice_size];
+  for (int n = 0; n < num_slices; n++)
+  {
+    if (file_inds[n] < 0 or static_cast<unsigned long int>(file_inds[n]) >= num_file_slices)
+      throw BlacklightException("Invalid HDF5 slice requested.");
+    data_stream.seekg(static_cast<std::streamoff>(data_address
+        + static_cast<unsigned long int>(file_inds[n]) * slice_size));
+    data_stream.read(reinterpret_cast<char *>(slice_raw), static_cast<std::streamoff>(slice_size));
+    Array<float> slice(float_array);
+    slice.Slice(5, array_inds[n], array_inds[n]);
+    SetHDF5FloatArray(datatype_raw, dataspace_raw, slice_raw, slice);
+  }
+  delete[] datatype_raw;
+  delete[] dataspace_raw;
+  delete[] slice_raw;
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function to read 4D float array dataset from HDF5 file by name into transposed 5D array
+// Inputs:
+//   name: name of dataset
+//   i_start: index of first x^1-plane of dataset to read
+//   num_vars: number of variables to read
+//   file_inds: indices of variables (along fastest-varying dimension) within dataset
+//   array_inds: indices of variables (along n5) within float_array to be set
+// Outputs:
+//   float_array: array set at given variable indices
+// Notes:
+//   Changes stream pointer.
+//   Assumes dataset has indices (i,j,k,variable) and float_array is allocated with n4 = 1, n3 and
+//       n2 matching dataset, and n1 not extending beyond dataset when offset by i_start.
+//   Reads dataset in slabs of x^1-planes, transposing each slab before reading the next, so the
+//       full dataset is never held in memory.
+void SimulationReader::ReadHDF5FloatArrayTransposed(const char *name, int i_start, int num_vars,
+    const int *file_inds, const int *array_inds, Array<float> &float_array)
+{
+  // Locate header
+  unsigned long int header_address =
+      ReadHDF5DatasetHeaderAddress(name, root_btree_address, root_data_segment_address);
+
+  // Read header
+  unsigned char *datatype_raw, *dataspace_raw;
+  unsigned long int data_address, data_size;
+  ReadHDF5DataObjectHeader(header_address, &datatype_raw, &dataspace_raw, &data_address,
+      &data_size);
+
+  // Check dimensions
+  unsigned long int *dims;
+  int num_dims;
+  ReadHDF5DataspaceDims(dataspace_raw, &dims, &num_dims);
+  if (num_dims != 4)
+    throw BlacklightException("Unexpected HDF5 floating-point array size.");
+  int n1_file = static_cast<int>(dims[0]);
+  int n2 = static_cast<int>(dims[1]);
+  int n3 = static_cast<int>(dims[2]);
+  int num_file_vars = static_cast<int>(dims[3]);
+  delete[] dims;
+  int n1 = float_array.n1;
+  if (float_array.n4 != 1 or float_array.n3 != n3 or float_array.n2 != n2 or i_start < 0
+      or i_start + n1 > n1_file)
+    throw BlacklightException("Array dimension mismatch.");
+  for (int n = 0; n < num_vars; n++)
+    if (file_inds[n] < 0 or file_inds[n] >= num_file_vars)
+      throw BlacklightException("Invalid HDF5 slice requested.");
+
+  // Prepare buffers
+  unsigned long int plane_size = data_size / static_cast<unsigned long int>(n1_file);
+  int num_planes = SlabPlanes(static_cast<long int>(n2) * n3 * num_file_vars);
+  unsigned char *slab_raw =
+      new unsigned char[plane_size * static_cast<unsigned long int>(num_planes)];
+  Array<float> slab(num_planes, n2, n3, num_file_vars);
+
+  // Read and transpose each slab
+  data_stream.seekg(static_cast<std::streamoff>(data_address
+      + static_cast<unsigned long int>(i_start) * plane_size));
+  for (int i_slab = 0; i_slab < n1; i_slab += num_planes)
+  {
+    int num_planes_read = std::min(num_planes, n1 - i_slab);
+    data_stream.read(reinterpret_cast<char *>(slab_raw),
+        static_cast<std::streamoff>(plane_size * static_cast<unsigned long int>(num_planes_read)));
+    unsigned long int num_planes_dim = static_cast<unsigned long int>(num_planes_read);
+    std::memcpy(dataspace_raw + 8, &num_planes_dim, 8);
+    Array<float> slab_read(slab);
+    slab_read.Slice(4, 0, num_planes_read - 1);
+    SetHDF5FloatArray(datatype_raw, dataspace_raw, slab_raw, slab_read);
+    TransposePrimitives(slab_read, i_slab, num_vars, file_inds, array_inds, float_array);
+  }
+  delete[] datatype_raw;
+  delete[] dataspace_raw;
+  delete[] slab_raw;
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
 // Function to read float array dataset into double Array from HDF5 file by name
 // Inputs:
 //   name: name of dataset
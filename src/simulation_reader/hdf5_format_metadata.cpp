@@ -157,7 +157,7 @@ unsigned long int SimulationReader::ReadHDF5DatasetHeaderAddress(const char *nam
 
 //--------------------------------------------------------------------------------------------------
 
-// Function to read HDF5 data object header
+// Function to read HDF5 data object header and raw data
 // Inputs:
 //   data_object_header_address: offset where header is located
 // Outputs:
@@ -166,13 +166,42 @@ unsigned long int SimulationReader::ReadHDF5DatasetHeaderAddress(const char *nam
 //   *p_data_raw: raw data
 // Notes:
 //   Changes stream pointer.
+//   See ReadHDF5DataObjectHeader() overload below for restrictions.
+void SimulationReader::ReadHDF5DataObjectHeader(unsigned long int data_object_header_address,
+    unsigned char **p_datatype_raw, unsigned char **p_dataspace_raw, unsigned char **p_data_raw)
+{
+  // Read header
+  unsigned long int data_address, data_size;
+  ReadHDF5DataObjectHeader(data_object_header_address, p_datatype_raw, p_dataspace_raw,
+      &data_address, &data_size);
+
+  // Read raw data
+  *p_data_raw = new unsigned char[data_size];
+  data_stream.seekg(static_cast<std::streamoff>(data_address));
+  data_stream.read(reinterpret_cast<char *>(*p_data_raw), static_cast<std::streamoff>(data_size));
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function to read HDF5 data object header without reading raw data
+// Inputs:
+//   data_object_header_address: offset where header is located
+// Outputs:
+//   *p_datatype_raw: raw datatype description
+//   *p_dataspace_raw: raw dataspace description
+//   *p_data_address: offset where contiguous raw data is located
+//   *p_data_size: size of raw data in bytes
+// Notes:
+//   Changes stream pointer.
 //   Must have object header version 1.
 //   Must not have shared header messages.
 //   Must have data layout message version 3.
 //   Must have size of offsets 8.
 //   Must be run on little-endian machine.
 void SimulationReader::ReadHDF5DataObjectHeader(unsigned long int data_object_header_address,
-    unsigned char **p_datatype_raw, unsigned char **p_dataspace_raw, unsigned char **p_data_raw)
+    unsigned char **p_datatype_raw, unsigned char **p_dataspace_raw,
+    unsigned long int *p_data_address, unsigned long int *p_data_size)
 {
   // Check object header version
   data_stream.seekg(static_cast<std::streamoff>(data_object_header_address));
@@ -280,10 +309,9 @@ void SimulationReader::ReadHDF5DataObjectHeader(unsigned long int data_object_he
   if (not (datatype_found and dataspace_found and data_layout_found))
     throw BlacklightException("Could not find needed dataset properties.");
 
-  // Read raw data
-  *p_data_raw = new unsigned char[data_size];
-  data_stream.seekg(static_cast<std::streamoff>(data_address));
-  data_stream.read(reinterpret_cast<char *>(*p_data_raw), static_cast<std::streamoff>(data_size));
+  // Record location of raw data
+  *p_data_address = data_address;
+  *p_data_size = data_size;
   return;
 }
 
@@ -1,8 +1,10 @@
 // Blacklight simulation reader - conversion functions for different coordinate systems
 
 // C++ headers
-#include <algorithm>  // min
+#include <algorithm>  // max, min
 #include <cmath>      // abs, cos, exp, log, pow, sin, sqrt
+#include <fstream>    // ifstream, ofstream
+#include <ios>        // ios_base
 
 // Library headers
 #include <omp.h>  // pragmas
@@ -11,7 +13,58 @@
 #include "simulation_reader.hpp"
 #include "../blacklight.hpp"        // Math
 #include "../utils/array.hpp"       // Array
-#include "../utils/exceptions.hpp"  // BlacklightException
+#include "../utils/exceptions.hpp"  // BlacklightException, BlacklightWarning
+#include "../utils/file_io.hpp"     // ReadBinary, WriteBinary
+
+//--------------------------------------------------------------------------------------------------
+
+// Function to restrict radial extent of grid to what can be sampled
+// Inputs: (none)
+// Outputs: (none)
+// Notes:
+//   Assumes single block with x1f and x1v set in native coordinates, with x^1 = log(r).
+//   Keeps cells covering [radial_r_min, radial_r_max], together with radial_margin cells on
+//       either side so that interpolation at any sampled radius is unaffected.
+//   Sets radial_i_start to first cell kept and shrinks x1f and x1v accordingly.
+//   Records full radial extent of grid in grid_r_in and grid_r_out beforehand, so that the FMKS
+//       map, and thus the image and simulation_sks_map_file, do not depend on the range kept.
+//   Operates in serial, given arrays are 1D.
+void SimulationReader::PruneRadialRange()
+{
+  // Record full radial extent
+  int n1 = x1v.n1;
+  grid_r_in = std::exp(x1f(0,0));
+  grid_r_out = std::exp(x1f(0,n1));
+
+  // Find cells containing radial limits
+  double x1_min = std::log(radial_r_min);
+  double x1_max = std::log(radial_r_max);
+  int i_start = 0;
+  while (i_start < n1 - 1 and x1f(0,i_start+1) <= x1_min)
+    i_start++;
+  int i_end = n1 - 1;
+  while (i_end > i_start and x1f(0,i_end) >= x1_max)
+    i_end--;
+
+  // Add margins
+  i_start = std::max(i_start - radial_margin, 0);
+  i_end = std::min(i_end + radial_margin, n1 - 1);
+  radial_i_start = i_start;
+  if (i_start == 0 and i_end == n1 - 1)
+    return;
+
+  // Shrink coordinate arrays
+  int n1_new = i_end - i_start + 1;
+  Array<double> x1f_new(1, n1_new + 1);
+  Array<double> x1v_new(1, n1_new);
+  for (int i = 0; i <= n1_new; i++)
+    x1f_new(0,i) = x1f(0,i_start+i);
+  for (int i = 0; i < n1_new; i++)
+    x1v_new(0,i) = x1v(0,i_start+i);
+  x1f.Swap(x1f_new);
+  x1v.Swap(x1v_new);
+  return;
+}
 
 //--------------------------------------------------------------------------------------------------
 
@@ -36,12 +89,8 @@ void SimulationReader::ConvertCoordinates()
   // Handle FMKS case
   if (simulation_coord == Coordinates::fmks)
   {
-    // Calculate radial limits
-    double r_in = std::exp(x1f(0,0));
-    double r_out = std::exp(x1f(0,n1));
-
-    // Calculate map between x1/x2 and r/theta
-    GenerateSKSMap(r_in, r_out);
+    // Calculate map between x1/x2 and r/theta over full grid
+    GenerateSKSMap(grid_r_in, grid_r_out);
 
     // Calculate grid bounds
     simulation_bounds.Allocate(6);
@@ -326,12 +375,11 @@ void SimulationReader::ConvertPrimitives4(Array<float> &primitives)
 // Notes:
 //   Assumes all metric parameters have been loaded.
 //   Allocates and sets sks_map to save mapping.
-//   Operates in serial since it only needs to run once and is 2D.
+//   Loads map from simulation_sks_map_file if given and matching, otherwise calculates map and
+//       saves it there.
+//   Works in parallel over radial rows, with each theta point seeded by its neighbor.
 void SimulationReader::GenerateSKSMap(double r_in, double r_out)
 {
-  // Allocate map
-  sks_map.Allocate(2, sks_map_n2, sks_map_n1);
-
   // Calculate spacing in SKS coordinates
   double dr = (r_out - r_in) / (sks_map_n1 - 1);
   double dtheta = Math::pi / (sks_map_n2 - 1);
@@ -342,7 +390,15 @@ void SimulationReader::GenerateSKSMap(double r_in, double r_out)
   sks_map_dr = dr;
   sks_map_dtheta = dtheta;
 
+  // Load map if possible
+  if (not simulation_sks_map_file.empty() and LoadSKSMap())
+    return;
+
+  // Allocate map
+  sks_map.Allocate(2, sks_map_n2, sks_map_n1);
+
   // Go through sample points in r
+  #pragma omp parallel for schedule(static)
   for (int i = 0; i < sks_map_n1; ++i)
   {
     // Calculate radial coordinates
@@ -350,45 +406,16 @@ void SimulationReader::GenerateSKSMap(double r_in, double r_out)
     double x1 = log(r);
 
     // Go through sample points in theta
+    double x2_guess = 0.0;
     for (int j = 0; j < sks_map_n2; ++j)
     {
       // Calculate polar coordinates
       double theta = std::min(j * dtheta, Math::pi);
       double x2 = 0.5;
 
-      // Iterate via bisection to find x^2
+      // Solve for x^2 away from poles
       if (theta > sks_map_tol and std::abs(Math::pi - theta) > sks_map_tol)
-      {
-        // Prepare initial bounds
-        double x2_a = 0.0;
-        double x2_b = 1.0;
-        x2 = (x2_b + x2_a) / 2.0;
-        double temp_r, temp_phi;
-        double theta_a = 0.0;
-        double theta_b = Math::pi;
-        double theta_c = Math::pi / 2.0;
-        GetSKSCoordinates(x1, x2_a, 0.0, &temp_r, &theta_a, &temp_phi);
-        GetSKSCoordinates(x1, x2_b, 0.0, &temp_r, &theta_b, &temp_phi);
-
-        // Perform iteration
-        for (int n = 0; n < sks_map_max_iter; n++)
-        {
-          GetSKSCoordinates(x1, x2, 0.0, &temp_r, &theta_c, &temp_phi);
-          if ((theta_c - theta) * (theta_b - theta) < 0.0)
-          {
-            theta_a = theta_c;
-            x2_a = x2;
-          }
-          else
-          {
-            theta_b = theta_c;
-            x2_b = x2;
-          }
-          x2 = (x2_a + x2_b) / 2.0;
-          if (std::abs(theta - theta_c) < sks_map_tol)
-            break;
-        }
-      }
+        x2 = InvertSKSTheta(x1, theta, x2_guess);
 
       // Assign x^2 when at or beyond north pole
       else if (theta < sks_map_tol)
@@ -401,8 +428,128 @@ void SimulationReader::GenerateSKSMap(double r_in, double r_out)
       // Store mapping
       sks_map(0,j,i) = x1;
       sks_map(1,j,i) = x2;
+      x2_guess = x2;
     }
   }
+
+  // Save map
+  if (not simulation_sks_map_file.empty())
+    SaveSKSMap();
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function to find FMKS x^2 corresponding to SKS theta
+// Inputs:
+//   x1: FMKS radial coordinate
+//   theta: SKS polar coordinate
+//   x2_guess: initial guess for x^2
+// Outputs:
+//   returned value: x^2 such that theta(x1, x^2) agrees with given theta to within sks_map_tol
+// Notes:
+//   Uses Newton iteration with analytic derivative, safeguarded by a bracket [0, 1] that shrinks
+//       with each step; falls back to bisection whenever Newton step would leave the bracket.
+//   Assumes theta increases monotonically with x^2.
+double SimulationReader::InvertSKSTheta(double x1, double theta, double x2_guess)
+{
+  // Prepare bracket
+  double x2_a = 0.0;
+  double x2_b = 1.0;
+  double x2 = std::min(std::max(x2_guess, x2_a), x2_b);
+
+  // Perform iteration
+  for (int n = 0; n < sks_map_max_iter; n++)
+  {
+    double r_val = 0.0;
+    double theta_val = 0.0;
+    double phi_val = 0.0;
+    GetSKSCoordinates(x1, x2, 0.0, &r_val, &theta_val, &phi_val);
+    double residual = theta_val - theta;
+    if (std::abs(residual) < sks_map_tol)
+      break;
+    if (residual < 0.0)
+      x2_a = x2;
+    else
+      x2_b = x2;
+    double dr_dx1, dth_dx1, dth_dx2;
+    SetJacobianFactors(x1, x2, &dr_dx1, &dth_dx1, &dth_dx2);
+    double x2_new = x2 - residual / dth_dx2;
+    if (not (x2_new > x2_a and x2_new < x2_b))
+      x2_new = 0.5 * (x2_a + x2_b);
+    x2 = x2_new;
+  }
+  return x2;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function to load map between SKS and FMKS from file
+// Inputs: (none)
+// Outputs:
+//   returned value: flag indicating map was loaded
+// Notes:
+//   Reads file specified by simulation_sks_map_file.
+//   Only accepts file whose map size, radial range, tolerance, and metric parameters all match
+//       current values exactly.
+//   Allocates and sets sks_map if successful.
+bool SimulationReader::LoadSKSMap()
+{
+  // Open map file for reading
+  std::ifstream map_stream(simulation_sks_map_file, std::ios_base::in | std::ios_base::binary);
+  if (not map_stream.is_open())
+    return false;
+
+  // Check parameters
+  double params[9] = {sks_map_r_in, sks_map_r_out, sks_map_tol, metric_h, metric_r_in,
+      metric_poly_xt, metric_poly_alpha, metric_mks_smooth, metric_derived_poly_norm};
+  int n1, n2;
+  double params_file[9];
+  ReadBinary(&map_stream, &n1);
+  ReadBinary(&map_stream, &n2);
+  ReadBinary(&map_stream, params_file, 9);
+  bool match = map_stream.good() and n1 == sks_map_n1 and n2 == sks_map_n2;
+  for (int n = 0; n < 9; n++)
+    match = match and params_file[n] == params[n];
+  if (not match)
+  {
+    BlacklightWarning("Ignoring simulation_sks_map_file with mismatched parameters.");
+    return false;
+  }
+
+  // Read map
+  ReadBinary(&map_stream, &sks_map);
+  if (not map_stream.good() or sks_map.n3 != 2 or sks_map.n2 != sks_map_n2
+      or sks_map.n1 != sks_map_n1)
+    throw BlacklightException("Could not read simulation_sks_map_file.");
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function to save map between SKS and FMKS to file
+// Inputs: (none)
+// Outputs: (none)
+// Notes:
+//   Overwrites file specified by simulation_sks_map_file.
+//   Saves map size, radial range, tolerance, and metric parameters before map itself.
+void SimulationReader::SaveSKSMap()
+{
+  // Open map file for writing
+  std::ofstream map_stream(simulation_sks_map_file, std::ios_base::out | std::ios_base::binary);
+  if (not map_stream.is_open())
+  {
+    BlacklightWarning("Could not open simulation_sks_map_file for writing.");
+    return;
+  }
+
+  // Write parameters and map
+  double params[9] = {sks_map_r_in, sks_map_r_out, sks_map_tol, metric_h, metric_r_in,
+      metric_poly_xt, metric_poly_alpha, metric_mks_smooth, metric_derived_poly_norm};
+  WriteBinary(&map_stream, sks_map_n1);
+  WriteBinary(&map_stream, sks_map_n2);
+  WriteBinary(&map_stream, params, 9);
+  WriteBinary(&map_stream, sks_map);
   return;
 }
 
@@ -1,18 +1,19 @@
 // Blacklight simulation reader
 
 // C++ headers
-#include <algorithm>  // remove
+#include <algorithm>  // max, min, remove
 #include <cctype>     // tolower
-#include <cmath>      // abs, pow
-#include <cstdint>    // int32_t
+#include <cmath>      // abs, acos, cos, isfinite, pow, sqrt
+#include <cstdint>    // int32_t, uint16_t
 #include <cstdio>     // snprintf
 #include <cstring>    // strncmp, strtok
 #include <fstream>    // ifstream
 #include <ios>        // ios_base, streamoff
 #include <iosfwd>     // streampos
+#include <iostream>   // cout, endl
 #include <optional>   // optional
 #include <sstream>    // ostringstream
-#include <string>     // getline, stod, stoi, string
+#include <string>     // getline, stod, stoi, string, to_string
 
 // Library headers
 #include <omp.h>  // pragmas, omp_get_wtime
@@ -24,6 +25,7 @@
 #include "../utils/array.hpp"                // Array
 #include "../utils/exceptions.hpp"           // BlacklightException, BlacklightWarning
 #include "../utils/file_io.hpp"              // ReadBinary
+#include "../utils/reduced_precision.hpp"    // DecodeReduced, EncodeReduced
 
 //--------------------------------------------------------------------------------------------------
 
@@ -59,6 +61,35 @@ SimulationReader::SimulationReader(const InputReader *p_input_reader_)
     simulation_a = p_input_reader->simulation_a.value();
     simulation_m_msun = p_input_reader->simulation_m_msun.value();
     simulation_rho_cgs = p_input_reader->simulation_rho_cgs.value();
+    simulation_precision = SimulationPrecision::single;
+    if (p_input_reader->simulation_precision.has_value())
+      simulation_precision = p_input_reader->simulation_precision.value();
+    simulation_interleave = false;
+    if (p_input_reader->simulation_interleave.has_value())
+      simulation_interleave = p_input_reader->simulation_interleave.value();
+    if (p_input_reader->simulation_sks_map_file.has_value())
+      simulation_sks_map_file = p_input_reader->simulation_sks_map_file.value();
+  }
+
+  // Calculate radial range that can be sampled
+  if (model_type == ModelType::simulation)
+  {
+    double bh_a = simulation_a;
+    double r_horizon = 1.0 + std::sqrt(1.0 - bh_a * bh_a);
+    double r_terminate = 0.0;
+    RayTerminate ray_terminate = p_input_reader->ray_terminate.value();
+    if (ray_terminate == RayTerminate::photon)
+      r_terminate = 2.0 * (1.0 + std::cos(2.0 / 3.0 * std::acos(-std::abs(bh_a))));
+    else if (ray_terminate == RayTerminate::multiplicative)
+      r_terminate = r_horizon * p_input_reader->ray_factor.value();
+    else if (ray_terminate == RayTerminate::additive)
+      r_terminate = r_horizon + p_input_reader->ray_factor.value();
+    double cut_omit_in = p_input_reader->cut_omit_in.value();
+    double cut_omit_out = p_input_reader->cut_omit_out.value();
+    radial_r_min = std::max(r_terminate, cut_omit_in);
+    radial_r_max = p_input_reader->camera_r.value();
+    if (cut_omit_out >= 0.0)
+      radial_r_max = std::min(radial_r_max, cut_omit_out);
   }
 
   // Copy slow-light parameters
@@ -159,6 +190,8 @@ SimulationReader::SimulationReader(const InputReader *p_input_reader_)
   // Allocate arrays of Arrays of cell variables
   if (num_arrays > 0)
     prim = new Array<float>[num_arrays];
+  if (num_arrays > 0 and simulation_precision != SimulationPrecision::single)
+    prim_packed = new Array<std::uint16_t>[num_arrays];
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -179,6 +212,12 @@ SimulationReader::~SimulationReader()
       prim[n].Deallocate();
     delete[] time;
     delete[] prim;
+    if (simulation_precision != SimulationPrecision::single)
+    {
+      for (int n = 0; n < num_arrays; n++)
+        prim_packed[n].Deallocate();
+      delete[] prim_packed;
+    }
   }
 }
 
@@ -292,7 +331,10 @@ double SimulationReader::Read(int snapshot)
       num_read = latest_file_number - latest_file_number_old;
       for (int n = slow_chunk_size - 1; n >= num_read; n--)
       {
-        prim[n].Swap(prim[n-num_read]);
+        if (simulation_precision == SimulationPrecision::single)
+          prim[n].Swap(prim[n-num_read]);
+        else
+          prim_packed[n].Swap(prim_packed[n-num_read]);
         time[n] = time[n-num_read];
       }
     }
@@ -324,6 +366,15 @@ double SimulationReader::Read(int snapshot)
     if (not data_stream.is_open())
       throw BlacklightException("Could not open file for reading.");
 
+    // Prepare single-precision buffer for reduced-precision or interleaved storage, releasing any
+    // interleaved array left from the previous file
+    if ((simulation_precision != SimulationPrecision::single or simulation_interleave)
+        and not first_time)
+    {
+      prim[n].Deallocate();
+      prim[n].Allocate(prim_dims[0], prim_dims[1], prim_dims[2], prim_dims[3], prim_dims[4]);
+    }
+
     // Read basic data about file
     if (simulation_format == SimulationFormat::athena
         or simulation_format == SimulationFormat::iharm3d)
@@ -465,10 +516,8 @@ double SimulationReader::Read(int snapshot)
         x1v.Allocate(athenak_num_blocks, athenak_block_nx);
         x2v.Allocate(athenak_num_blocks, athenak_block_ny);
         x3v.Allocate(athenak_num_blocks, athenak_block_nz);
-        int n5 = plasma_model == PlasmaModel::code_kappa ? 9 : 8;
-        for (int nn = 0; nn < num_read; nn++)
-          prim[nn].Allocate(n5, athenak_num_blocks, athenak_block_nz, athenak_block_ny,
-              athenak_block_nx);
+        AllocatePrimitives(num_prim_read, athenak_num_blocks, athenak_block_nz, athenak_block_ny,
+            athenak_block_nx);
       }
 
       // Go through blocks
@@ -534,8 +583,8 @@ double SimulationReader::Read(int snapshot)
         if (first_time and athenak_variable_size == 8)
           athenak_cell_data_double = new double[athenak_cells_per_block];
         std::streampos cell_data_begin = data_stream.tellg();
-        int athenak_inds[8] = {athenak_ind_rho, athenak_ind_uu1, athenak_ind_uu2, athenak_ind_uu3,
-            athenak_ind_pgas, athenak_ind_bb1, athenak_ind_bb2, athenak_ind_bb3};
+        int athenak_inds[8] = {file_ind_rho, file_ind_uu1, file_ind_uu2, file_ind_uu3,
+            file_ind_pgas, file_ind_bb1, file_ind_bb2, file_ind_bb3};
         int prim_inds[8] =
             {ind_rho, ind_uu1, ind_uu2, ind_uu3, ind_pgas, ind_bb1, ind_bb2, ind_bb3};
         for (int ind_ind = 0; ind_ind < 8; ind_ind++)
@@ -560,7 +609,7 @@ double SimulationReader::Read(int snapshot)
         if (plasma_model == PlasmaModel::code_kappa)
         {
           data_stream.seekg(cell_data_begin);
-          offset = athenak_ind_kappa * athenak_cells_per_block * athenak_variable_size;
+          offset = file_ind_kappa * athenak_cells_per_block * athenak_variable_size;
           data_stream.seekg(offset, std::ios_base::cur);
           if (athenak_variable_size == 4)
             data_stream.read(reinterpret_cast<char *>(&prim[n](ind_kappa,block,0,0,0)),
@@ -656,6 +705,7 @@ double SimulationReader::Read(int snapshot)
           x3f(0,k+1) = x_start(0) + (k + 1) * dx(0);
           x3v(0,k) = 0.5 * (x3f(0,k) + x3f(0,k+1));
         }
+        PruneRadialRange();
         ConvertCoordinates();
       }
       else if (simulation_format == SimulationFormat::harm3d)
@@ -714,6 +764,7 @@ double SimulationReader::Read(int snapshot)
         data_stream >> temp_val;
         data_stream.seekg(1, std::ios_base::cur);
         cell_data_address = data_stream.tellg();
+        PruneRadialRange();
         ConvertCoordinates();
       }
     }
@@ -764,45 +815,39 @@ double SimulationReader::Read(int snapshot)
       if (first_time)
       {
         VerifyVariablesAthena();
-        int n5 = num_variables(ind_hydro) + num_variables(ind_bb);
         int n4 = levels.n1;
         int n3 = x3v.n1;
         int n2 = x2v.n1;
         int n1 = x1v.n1;
-        for (int nn = 0; nn < num_read; nn++)
-          prim[nn].Allocate(n5, n4, n3, n2, n1);
+        AllocatePrimitives(num_prim_read, n4, n3, n2, n1);
       }
-      Array<float> hydro(prim[n]);
-      hydro.Slice(5, 0, num_variables(ind_hydro) - 1);
-      ReadHDF5FloatArray("prim", hydro);
-      Array<float> bb(prim[n]);
-      bb.Slice(5, num_variables(ind_hydro), num_variables(ind_hydro) + num_variables(ind_bb) - 1);
-      ReadHDF5FloatArray("B", bb);
+      int num_hydro_read = num_prim_read - 3;
+      int hydro_file_inds[6] = {file_ind_rho, file_ind_uu1, file_ind_uu2, file_ind_uu3,
+          file_ind_pgas, plasma_model == PlasmaModel::code_kappa ? file_ind_kappa : -1};
+      int hydro_prim_inds[6] = {ind_rho, ind_uu1, ind_uu2, ind_uu3, ind_pgas, ind_kappa};
+      ReadHDF5FloatArraySlices("prim", num_hydro_read, hydro_file_inds, hydro_prim_inds, prim[n]);
+      int bb_file_inds[3] = {file_ind_bb1, file_ind_bb2, file_ind_bb3};
+      int bb_prim_inds[3] = {ind_bb1, ind_bb2, ind_bb3};
+      ReadHDF5FloatArraySlices("B", 3, bb_file_inds, bb_prim_inds, prim[n]);
     }
     else if (simulation_format == SimulationFormat::iharm3d)
     {
       if (first_time)
       {
         VerifyVariablesHarm();
-        int n5 = num_variables(0);
         int n4 = levels.n1;
         int n3 = x3v.n1;
         int n2 = x2v.n1;
         int n1 = x1v.n1;
-        for (int nn = 0; nn < num_read; nn++)
-          prim[nn].Allocate(n5, n4, n3, n2, n1);
-        prim_transpose.Allocate(n1, n2, n3, n5);
+        AllocatePrimitives(num_prim_read, n4, n3, n2, n1);
       }
-      ReadHDF5FloatArray("prims", prim_transpose);
-      for (int n_variable = 0; n_variable < num_variables(0); n_variable++)
-        for (int k = 0; k < x3v.n1; k++)
-          for (int j = 0; j < x2v.n1; j++)
-            for (int i = 0; i < x1v.n1; i++)
-              prim[n](n_variable,0,k,j,i) = prim_transpose(i,j,k,n_variable);
-      for (int k = 0; k < x3v.n1; k++)
-        for (int j = 0; j < x2v.n1; j++)
-          for (int i = 0; i < x1v.n1; i++)
-            prim[n](ind_pgas,0,k,j,i) *= static_cast<float>(plasma_gamma - 1.0);
+      int file_inds[9] = {file_ind_rho, file_ind_uu1, file_ind_uu2, file_ind_uu3, file_ind_pgas,
+          file_ind_bb1, file_ind_bb2, file_ind_bb3,
+          plasma_model == PlasmaModel::code_kappa ? file_ind_kappa : -1};
+      int prim_inds[9] = {ind_rho, ind_uu1, ind_uu2, ind_uu3, ind_pgas, ind_bb1, ind_bb2, ind_bb3,
+          ind_kappa};
+      ReadHDF5FloatArrayTransposed("prims", radial_i_start, num_prim_read, file_inds, prim_inds,
+          prim[n]);
       ConvertPrimitives3(prim[n]);
     }
     else if (simulation_format == SimulationFormat::harm3d)
@@ -814,9 +859,7 @@ double SimulationReader::Read(int snapshot)
         int n3 = x3v.n1;
         int n2 = x2v.n1;
         int n1 = x1v.n1;
-        for (int nn = 0; nn < num_read; nn++)
-          prim[nn].Allocate(n5, n4, n3, n2, n1);
-        prim_transpose.Allocate(n1, n2, n3, n5 + 6);
+        AllocatePrimitives(n5, n4, n3, n2, n1);
         ind_rho = 0;
         ind_pgas = 1;
         ind_kappa = 10;
@@ -833,20 +876,26 @@ double SimulationReader::Read(int snapshot)
         data_stream.seekg(cell_data_address);
       std::cout << "Reading raw data begins." << std::endl;
       double time_harm3d = omp_get_wtime();
-      ReadBinary(&data_stream, prim_transpose.data, prim_transpose.n_tot);
-      #pragma omp parallel
+      int num_vars = prim[n].n5;
+      int num_file_vars = num_vars + 6;
+      int file_inds[11], prim_inds[11];
+      for (int n_variable = 0; n_variable < num_vars; n_variable++)
+      {
+        file_inds[n_variable] = n_variable + 6;
+        prim_inds[n_variable] = n_variable;
+      }
+      long int plane_size = static_cast<long int>(x3v.n1) * x2v.n1 * num_file_vars;
+      data_stream.seekg(radial_i_start * plane_size * static_cast<long int>(sizeof(float)),
+          std::ios_base::cur);
+      int num_planes = SlabPlanes(plane_size);
+      Array<float> slab(num_planes, x2v.n1, x3v.n1, num_file_vars);
+      for (int i_start = 0; i_start < x1v.n1; i_start += num_planes)
       {
-        #pragma omp for schedule(static) collapse(3)
-        for (int n_variable = 0; n_variable < prim[n].n5; n_variable++)
-          for (int k = 0; k < x3v.n1; k++)
-            for (int j = 0; j < x2v.n1; j++)
-              for (int i = 0; i < x1v.n1; i++)
-                prim[n](n_variable,0,k,j,i) = prim_transpose(i,j,k,n_variable+6);
-        #pragma omp for schedule(static) collapse(2)
-        for (int k = 0; k < x3v.n1; k++)
-          for (int j = 0; j < x2v.n1; j++)
-            for (int i = 0; i < x1v.n1; i++)
-              prim[n](ind_pgas,0,k,j,i) *= static_cast<float>(plasma_gamma - 1.0);
+        int num_planes_read = std::min(num_planes, x1v.n1 - i_start);
+        ReadBinary(&data_stream, slab.data, num_planes_read * plane_size);
+        Array<float> slab_read(slab);
+        slab_read.Slice(4, 0, num_planes_read - 1);
+        TransposePrimitives(slab_read, i_start, num_vars, file_inds, prim_inds, prim[n]);
       }
       std::cout << "Reading raw data ends. Elapsed time:\t" << omp_get_wtime() - time_harm3d;
       std::cout << " s" << std::endl;
@@ -857,6 +906,14 @@ double SimulationReader::Read(int snapshot)
       // std::cout << " s" << std::endl;
     }
 
+    // Convert to interleaved layout
+    if (simulation_interleave)
+      InterleavePrimitives(n);
+
+    // Convert to reduced precision
+    if (simulation_precision != SimulationPrecision::single)
+      PackPrimitives(n);
+
     // Close input file
     data_stream.close();
 
@@ -1144,7 +1201,8 @@ void SimulationReader::ReadAthenaKInputs()
 // Inputs: (none)
 // Outputs: (none)
 // Notes:
-//   Sets indices locating specific variables among primitives.
+//   Sets indices locating specific variables within "prim" and "B" datasets.
+//   Sets indices locating specific variables among compact primitives.
 //   Assumes metadata set.
 void SimulationReader::VerifyVariablesAthena()
 {
@@ -1157,41 +1215,43 @@ void SimulationReader::VerifyVariablesAthena()
       prim_offset += num_variables(ind_hydro);
   if (ind_hydro == num_dataset_names)
     throw BlacklightException("Unable to locate array \"prim\" in data file.");
+  const std::string *prim_names = variable_names + prim_offset;
+  int num_prim_names = num_variables(ind_hydro);
 
   // Check that all necessary primitives are present
-  for (ind_rho = prim_offset; ind_rho < prim_offset + num_variables(ind_hydro); ind_rho++)
-    if (variable_names[ind_rho] == "rho")
+  for (file_ind_rho = 0; file_ind_rho < num_prim_names; file_ind_rho++)
+    if (prim_names[file_ind_rho] == "rho")
       break;
-  if (ind_rho == num_variables(ind_hydro))
+  if (file_ind_rho == num_prim_names)
     throw BlacklightException("Unable to locate \"rho\" slice of \"prim\" in data file.");
-  for (ind_pgas = prim_offset; ind_pgas < prim_offset + num_variables(ind_hydro); ind_pgas++)
-    if (variable_names[ind_pgas] == "press")
+  for (file_ind_pgas = 0; file_ind_pgas < num_prim_names; file_ind_pgas++)
+    if (prim_names[file_ind_pgas] == "press")
       break;
-  if (ind_pgas == num_variables(ind_hydro))
+  if (file_ind_pgas == num_prim_names)
     throw BlacklightException("Unable to locate \"press\" slice of \"prim\" in data file.");
   if (plasma_model == PlasmaModel::code_kappa)
   {
-    for (ind_kappa = prim_offset; ind_kappa < prim_offset + num_variables(ind_hydro); ind_kappa++)
-      if (variable_names[ind_kappa] == simulation_kappa_name)
+    for (file_ind_kappa = 0; file_ind_kappa < num_prim_names; file_ind_kappa++)
+      if (prim_names[file_ind_kappa] == simulation_kappa_name)
         break;
-    if (ind_kappa == num_variables(ind_hydro))
+    if (file_ind_kappa == num_prim_names)
       throw
           BlacklightException("Unable to locate electron entropy slice of \"prim\" in data file.");
   }
-  for (ind_uu1 = prim_offset; ind_uu1 < prim_offset + num_variables(ind_hydro); ind_uu1++)
-    if (variable_names[ind_uu1] == "vel1")
+  for (file_ind_uu1 = 0; file_ind_uu1 < num_prim_names; file_ind_uu1++)
+    if (prim_names[file_ind_uu1] == "vel1")
       break;
-  if (ind_uu1 == num_variables(ind_hydro))
+  if (file_ind_uu1 == num_prim_names)
     throw BlacklightException("Unable to locate \"vel1\" slice of \"prim\" in data file.");
-  for (ind_uu2 = prim_offset; ind_uu2 < prim_offset + num_variables(ind_hydro); ind_uu2++)
-    if (variable_names[ind_uu2] == "vel2")
+  for (file_ind_uu2 = 0; file_ind_uu2 < num_prim_names; file_ind_uu2++)
+    if (prim_names[file_ind_uu2] == "vel2")
       break;
-  if (ind_uu2 == num_variables(ind_hydro))
+  if (file_ind_uu2 == num_prim_names)
     throw BlacklightException("Unable to locate \"vel2\" slice of \"prim\" in data file.");
-  for (ind_uu3 = prim_offset; ind_uu3 < prim_offset + num_variables(ind_hydro); ind_uu3++)
-    if (variable_names[ind_uu3] == "vel3")
+  for (file_ind_uu3 = 0; file_ind_uu3 < num_prim_names; file_ind_uu3++)
+    if (prim_names[file_ind_uu3] == "vel3")
       break;
-  if (ind_uu3 == num_variables(ind_hydro))
+  if (file_ind_uu3 == num_prim_names)
     throw BlacklightException("Unable to locate \"vel3\" slice of \"prim\" in data file.");
 
   // Check that array of all magnetic field components is present
@@ -1203,23 +1263,28 @@ void SimulationReader::VerifyVariablesAthena()
       bb_offset += num_variables(ind_bb);
   if (ind_bb == num_dataset_names)
     throw BlacklightException("Unable to locate array \"B\" in data file.");
+  const std::string *bb_names = variable_names + bb_offset;
+  int num_bb_names = num_variables(ind_bb);
 
   // Check that all necessary magnetic field components are present
-  for (ind_bb1 = bb_offset; ind_bb1 < bb_offset + num_variables(ind_bb); ind_bb1++)
-    if (variable_names[ind_bb1] == "Bcc1")
+  for (file_ind_bb1 = 0; file_ind_bb1 < num_bb_names; file_ind_bb1++)
+    if (bb_names[file_ind_bb1] == "Bcc1")
       break;
-  if (ind_bb1 == bb_offset + num_variables(ind_bb))
-    throw BlacklightException("Unable to locate \"Bcc1\" slice of \"prim\" in data file.");
-  for (ind_bb2 = bb_offset; ind_bb2 < bb_offset + num_variables(ind_bb); ind_bb2++)
-    if (variable_names[ind_bb2] == "Bcc2")
+  if (file_ind_bb1 == num_bb_names)
+    throw BlacklightException("Unable to locate \"Bcc1\" slice of \"B\" in data file.");
+  for (file_ind_bb2 = 0; file_ind_bb2 < num_bb_names; file_ind_bb2++)
+    if (bb_names[file_ind_bb2] == "Bcc2")
       break;
-  if (ind_bb2 == bb_offset + num_variables(ind_bb))
-    throw BlacklightException("Unable to locate \"Bcc2\" slice of \"prim\" in data file.");
-  for (ind_bb3 = bb_offset; ind_bb3 < bb_offset + num_variables(ind_bb); ind_bb3++)
-    if (variable_names[ind_bb3] == "Bcc3")
+  if (file_ind_bb2 == num_bb_names)
+    throw BlacklightException("Unable to locate \"Bcc2\" slice of \"B\" in data file.");
+  for (file_ind_bb3 = 0; file_ind_bb3 < num_bb_names; file_ind_bb3++)
+    if (bb_names[file_ind_bb3] == "Bcc3")
       break;
-  if (ind_bb3 == bb_offset + num_variables(ind_bb))
-    throw BlacklightException("Unable to locate \"Bcc3\" slice of \"prim\" in data file.");
+  if (file_ind_bb3 == num_bb_names)
+    throw BlacklightException("Unable to locate \"Bcc3\" slice of \"B\" in data file.");
+
+  // Set indices for internal arrays
+  SetCompactIndices();
   return;
 }
 
@@ -1230,71 +1295,64 @@ void SimulationReader::VerifyVariablesAthena()
 // Outputs: (none)
 // Notes:
 //   Sets indices locating specific variables in file.
+//   Sets indices locating specific variables among compact primitives.
 //   Assumes metadata set.
 void SimulationReader::VerifyVariablesAthenaK()
 {
   // Check that all necessary hydrodynamical values are present
-  for (athenak_ind_rho = 0; athenak_ind_rho < num_variable_names; athenak_ind_rho++)
-    if (variable_names[athenak_ind_rho] == "dens")
+  for (file_ind_rho = 0; file_ind_rho < num_variable_names; file_ind_rho++)
+    if (variable_names[file_ind_rho] == "dens")
       break;
-  if (athenak_ind_rho == num_variable_names)
+  if (file_ind_rho == num_variable_names)
     throw BlacklightException("Unable to locate \"dens\" values in data file.");
-  for (athenak_ind_pgas = 0; athenak_ind_pgas < num_variable_names; athenak_ind_pgas++)
-    if (variable_names[athenak_ind_pgas] == "eint")
+  for (file_ind_pgas = 0; file_ind_pgas < num_variable_names; file_ind_pgas++)
+    if (variable_names[file_ind_pgas] == "eint")
       break;
-  if (athenak_ind_pgas == num_variable_names)
+  if (file_ind_pgas == num_variable_names)
     throw BlacklightException("Unable to locate \"eint\" values in data file.");
   if (plasma_model == PlasmaModel::code_kappa)
   {
-    for (athenak_ind_kappa = 0; athenak_ind_kappa < num_variable_names; athenak_ind_kappa++)
-      if (variable_names[athenak_ind_kappa] == simulation_kappa_name)
+    for (file_ind_kappa = 0; file_ind_kappa < num_variable_names; file_ind_kappa++)
+      if (variable_names[file_ind_kappa] == simulation_kappa_name)
         break;
-    if (athenak_ind_kappa == num_variable_names)
+    if (file_ind_kappa == num_variable_names)
       throw BlacklightException("Unable to locate electron entropy values in data file.");
   }
-  for (athenak_ind_uu1 = 0; athenak_ind_uu1 < num_variable_names; athenak_ind_uu1++)
-    if (variable_names[athenak_ind_uu1] == "velx")
+  for (file_ind_uu1 = 0; file_ind_uu1 < num_variable_names; file_ind_uu1++)
+    if (variable_names[file_ind_uu1] == "velx")
       break;
-  if (athenak_ind_uu1 == num_variable_names)
+  if (file_ind_uu1 == num_variable_names)
     throw BlacklightException("Unable to locate \"velx\" values in data file.");
-  for (athenak_ind_uu2 = 0; athenak_ind_uu2 < num_variable_names; athenak_ind_uu2++)
-    if (variable_names[athenak_ind_uu2] == "vely")
+  for (file_ind_uu2 = 0; file_ind_uu2 < num_variable_names; file_ind_uu2++)
+    if (variable_names[file_ind_uu2] == "vely")
       break;
-  if (athenak_ind_uu2 == num_variable_names)
+  if (file_ind_uu2 == num_variable_names)
     throw BlacklightException("Unable to locate \"vely\" values in data file.");
-  for (athenak_ind_uu3 = 0; athenak_ind_uu3 < num_variable_names; athenak_ind_uu3++)
-    if (variable_names[athenak_ind_uu3] == "velz")
+  for (file_ind_uu3 = 0; file_ind_uu3 < num_variable_names; file_ind_uu3++)
+    if (variable_names[file_ind_uu3] == "velz")
       break;
-  if (athenak_ind_uu3 == num_variable_names)
+  if (file_ind_uu3 == num_variable_names)
     throw BlacklightException("Unable to locate \"velz\" values in data file.");
 
   // Check that all necessary magnetic field components are present
-  for (athenak_ind_bb1 = 0; athenak_ind_bb1 < num_variable_names; athenak_ind_bb1++)
-    if (variable_names[athenak_ind_bb1] == "bcc1")
+  for (file_ind_bb1 = 0; file_ind_bb1 < num_variable_names; file_ind_bb1++)
+    if (variable_names[file_ind_bb1] == "bcc1")
       break;
-  if (athenak_ind_bb1 == num_variable_names)
+  if (file_ind_bb1 == num_variable_names)
     throw BlacklightException("Unable to locate \"bcc1\" values in data file.");
-  for (athenak_ind_bb2 = 0; athenak_ind_bb2 < num_variable_names; athenak_ind_bb2++)
-    if (variable_names[athenak_ind_bb2] == "bcc2")
+  for (file_ind_bb2 = 0; file_ind_bb2 < num_variable_names; file_ind_bb2++)
+    if (variable_names[file_ind_bb2] == "bcc2")
       break;
-  if (athenak_ind_bb2 == num_variable_names)
+  if (file_ind_bb2 == num_variable_names)
     throw BlacklightException("Unable to locate \"bcc2\" values in data file.");
-  for (athenak_ind_bb3 = 0; athenak_ind_bb3 < num_variable_names; athenak_ind_bb3++)
-    if (variable_names[athenak_ind_bb3] == "bcc3")
+  for (file_ind_bb3 = 0; file_ind_bb3 < num_variable_names; file_ind_bb3++)
+    if (variable_names[file_ind_bb3] == "bcc3")
       break;
-  if (athenak_ind_bb3 == num_variable_names)
+  if (file_ind_bb3 == num_variable_names)
     throw BlacklightException("Unable to locate \"bcc3\" values in data file.");
 
   // Set indices for internal arrays
-  ind_rho = 0;
-  ind_uu1 = 1;
-  ind_uu2 = 2;
-  ind_uu3 = 3;
-  ind_pgas = 4;
-  ind_bb1 = 5;
-  ind_bb2 = 6;
-  ind_bb3 = 7;
-  ind_kappa = 8;
+  SetCompactIndices();
   return;
 }
 
@@ -1304,7 +1362,8 @@ void SimulationReader::VerifyVariablesAthenaK()
 // Inputs: (none)
 // Outputs: (none)
 // Notes:
-//   Sets indices locating specific variables among primitives.
+//   Sets indices locating specific variables in file.
+//   Sets indices locating specific variables among compact primitives.
 //   Sets plasma_gamma.
 //   Assumes metadata set.
 void SimulationReader::VerifyVariablesHarm()
@@ -1319,56 +1378,59 @@ void SimulationReader::VerifyVariablesHarm()
     throw BlacklightException("Inconsistency in number of primitive variables.");
 
   // Check that all necessary primitives are present
-  for (ind_rho = 0; ind_rho < num_variable_names; ind_rho++)
-    if (variable_names[ind_rho] == "RHO")
+  for (file_ind_rho = 0; file_ind_rho < num_variable_names; file_ind_rho++)
+    if (variable_names[file_ind_rho] == "RHO")
       break;
-  if (ind_rho == num_variable_names)
+  if (file_ind_rho == num_variable_names)
     throw BlacklightException("Unable to locate \"RHO\" slice of \"prims\" in data file.");
-  for (ind_pgas = 0; ind_pgas < num_variable_names; ind_pgas++)
-    if (variable_names[ind_pgas] == "UU")
+  for (file_ind_pgas = 0; file_ind_pgas < num_variable_names; file_ind_pgas++)
+    if (variable_names[file_ind_pgas] == "UU")
       break;
-  if (ind_pgas == num_variable_names)
+  if (file_ind_pgas == num_variable_names)
     throw BlacklightException("Unable to locate \"UU\" slice of \"prims\" in data file.");
   if (plasma_model == PlasmaModel::code_kappa)
   {
-    for (ind_kappa = 0; ind_kappa < num_variable_names; ind_kappa++)
-      if (variable_names[ind_kappa] == simulation_kappa_name)
+    for (file_ind_kappa = 0; file_ind_kappa < num_variable_names; file_ind_kappa++)
+      if (variable_names[file_ind_kappa] == simulation_kappa_name)
         break;
-    if (ind_kappa == num_variable_names)
+    if (file_ind_kappa == num_variable_names)
       throw
           BlacklightException("Unable to locate electron entropy slice of \"prims\" in data file.");
   }
-  for (ind_uu1 = 0; ind_uu1 < num_variable_names; ind_uu1++)
-    if (variable_names[ind_uu1] == "U1")
+  for (file_ind_uu1 = 0; file_ind_uu1 < num_variable_names; file_ind_uu1++)
+    if (variable_names[file_ind_uu1] == "U1")
       break;
-  if (ind_uu1 == num_variable_names)
+  if (file_ind_uu1 == num_variable_names)
     throw BlacklightException("Unable to locate \"U1\" slice of \"prims\" in data file.");
-  for (ind_uu2 = 0; ind_uu2 < num_variable_names; ind_uu2++)
-    if (variable_names[ind_uu2] == "U2")
+  for (file_ind_uu2 = 0; file_ind_uu2 < num_variable_names; file_ind_uu2++)
+    if (variable_names[file_ind_uu2] == "U2")
       break;
-  if (ind_uu2 == num_variable_names)
+  if (file_ind_uu2 == num_variable_names)
     throw BlacklightException("Unable to locate \"U2\" slice of \"prims\" in data file.");
-  for (ind_uu3 = 0; ind_uu3 < num_variable_names; ind_uu3++)
-    if (variable_names[ind_uu3] == "U3")
+  for (file_ind_uu3 = 0; file_ind_uu3 < num_variable_names; file_ind_uu3++)
+    if (variable_names[file_ind_uu3] == "U3")
       break;
-  if (ind_uu3 == num_variable_names)
+  if (file_ind_uu3 == num_variable_names)
     throw BlacklightException("Unable to locate \"U3\" slice of \"prims\" in data file.");
-  for (ind_bb1 = 0; ind_bb1 < num_variable_names; ind_bb1++)
-    if (variable_names[ind_bb1] == "B1")
+  for (file_ind_bb1 = 0; file_ind_bb1 < num_variable_names; file_ind_bb1++)
+    if (variable_names[file_ind_bb1] == "B1")
       break;
-  if (ind_bb1 == num_variable_names)
+  if (file_ind_bb1 == num_variable_names)
     throw BlacklightException("Unable to locate \"B1\" slice of \"prims\" in data file.");
-  for (ind_bb2 = 0; ind_bb2 < num_variable_names; ind_bb2++)
-    if (variable_names[ind_bb2] == "B2")
+  for (file_ind_bb2 = 0; file_ind_bb2 < num_variable_names; file_ind_bb2++)
+    if (variable_names[file_ind_bb2] == "B2")
       break;
-  if (ind_bb2 == num_variable_names)
+  if (file_ind_bb2 == num_variable_names)
     throw BlacklightException("Unable to locate \"B2\" slice of \"prims\" in data file.");
-  for (ind_bb3 = 0; ind_bb3 < num_variable_names; ind_bb3++)
-    if (variable_names[ind_bb3] == "B3")
+  for (file_ind_bb3 = 0; file_ind_bb3 < num_variable_names; file_ind_bb3++)
+    if (variable_names[file_ind_bb3] == "B3")
       break;
-  if (ind_bb3 == num_variable_names)
+  if (file_ind_bb3 == num_variable_names)
     throw BlacklightException("Unable to locate \"B3\" slice of \"prims\" in data file.");
 
+  // Set indices for internal arrays
+  SetCompactIndices();
+
   // Check adiabatic indices
   Array<double> gamma;
   try
@@ -1430,3 +1492,243 @@ void SimulationReader::VerifyVariablesHarm()
   }
   return;
 }
+
+//--------------------------------------------------------------------------------------------------
+
+// Function to set locations of needed variables within compact primitive arrays
+// Inputs: (none)
+// Outputs: (none)
+// Notes:
+//   Sets ind_rho, ind_pgas, ind_kappa, ind_uu1, ind_uu2, ind_uu3, ind_bb1, ind_bb2, and ind_bb3.
+//   Sets num_prim_read to 9 if electron entropy is needed, and 8 otherwise.
+//   Only variables used by the radiation integrator are stored, regardless of how many variables
+//       are present in the file.
+void SimulationReader::SetCompactIndices()
+{
+  ind_rho = 0;
+  ind_uu1 = 1;
+  ind_uu2 = 2;
+  ind_uu3 = 3;
+  ind_pgas = 4;
+  ind_bb1 = 5;
+  ind_bb2 = 6;
+  ind_bb3 = 7;
+  ind_kappa = 8;
+  num_prim_read = plasma_model == PlasmaModel::code_kappa ? 9 : 8;
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function to allocate arrays of cell values
+// Inputs:
+//   n5, n4, n3, n2, n1: dimensions of arrays
+// Outputs: (none)
+// Notes:
+//   With single-precision storage, allocates all num_arrays elements of prim.
+//   With reduced-precision storage, allocates all num_arrays elements of prim_packed, as well as
+//       prim[0] as a temporary buffer for the first file to be read.
+//   With interleaved storage, allocates only prim[0] as a buffer for the first file to be read, as
+//       well as all num_arrays elements of prim_packed in interleaved layout if needed.
+//   Records dimensions of arrays as read, as well as number of values stored per cell when
+//       interleaved, which is padded to a multiple of 32 bytes.
+void SimulationReader::AllocatePrimitives(int n5, int n4, int n3, int n2, int n1)
+{
+  // Record dimensions
+  prim_dims[0] = n5;
+  prim_dims[1] = n4;
+  prim_dims[2] = n3;
+  prim_dims[3] = n2;
+  prim_dims[4] = n1;
+  int values_per_line = simulation_precision == SimulationPrecision::single ? 8 : 16;
+  prim_stride = (n5 + values_per_line - 1) / values_per_line * values_per_line;
+
+  // Allocate arrays
+  if (simulation_precision == SimulationPrecision::single and not simulation_interleave)
+    for (int n = 0; n < num_arrays; n++)
+      prim[n].Allocate(n5, n4, n3, n2, n1);
+  else
+    prim[0].Allocate(n5, n4, n3, n2, n1);
+  if (simulation_precision != SimulationPrecision::single)
+    for (int n = 0; n < num_arrays; n++)
+    {
+      if (simulation_interleave)
+        prim_packed[n].Allocate(n4, n3, n2, n1, prim_stride);
+      else
+        prim_packed[n].Allocate(n5, n4, n3, n2, n1);
+    }
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function to convert cell values to interleaved layout
+// Inputs:
+//   n: index of array to convert
+// Outputs: (none)
+// Notes:
+//   Replaces prim[n], with dimensions (variable, block, k, j, i), by an array with dimensions
+//       (block, k, j, i, prim_stride), with unused values set to 0.
+//   Pads values for each cell to a multiple of 32 bytes, so that all variables needed at a cell
+//       can be gathered from as few cache lines as possible.
+void SimulationReader::InterleavePrimitives(int n)
+{
+  int num_vars = prim[n].n5;
+  long int num_cells = prim[n].n_tot / num_vars;
+  Array<float> prim_interleaved(prim[n].n4, prim[n].n3, prim[n].n2, prim[n].n1, prim_stride);
+  #pragma omp parallel for schedule(static)
+  for (long int ind = 0; ind < num_cells; ind++)
+    for (int var = 0; var < prim_stride; var++)
+      prim_interleaved.data[ind * prim_stride + var] =
+          var < num_vars ? prim[n].data[var * num_cells + ind] : 0.0f;
+  prim[n].Swap(prim_interleaved);
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function to convert cell values to reduced precision
+// Inputs:
+//   n: index of array to convert
+// Outputs: (none)
+// Notes:
+//   Sets prim_packed[n] from prim[n] and deallocates the latter.
+//   Works with either layout of prim[n], setting padding values to 0 in interleaved layout.
+//   Density, pressure, and electron entropy are treated as positive quantities; all others use a
+//       floating-point encoding even with SimulationPrecision::log16.
+//   On first call, reports the largest relative error incurred for each variable, as well as any
+//       values that could not be represented.
+void SimulationReader::PackPrimitives(int n)
+{
+  // Convert values
+  int num_vars = simulation_interleave ? prim_stride : prim[n].n5;
+  long int num_cells = prim[n].n_tot / num_vars;
+  long int num_lost_total = 0;
+  for (int var = 0; var < num_vars; var++)
+  {
+    // Clear padding
+    if (var >= prim_dims[0])
+    {
+      #pragma omp parallel for schedule(static)
+      for (long int ind = 0; ind < num_cells; ind++)
+        prim_packed[n].data[ind * prim_stride + var] = 0;
+      continue;
+    }
+
+    // Convert variable
+    bool positive = var == ind_rho or var == ind_pgas
+        or (plasma_model == PlasmaModel::code_kappa and var == ind_kappa);
+    double max_error = 0.0;
+    long int num_lost = 0;
+    #pragma omp parallel for schedule(static) reduction(max: max_error) reduction(+: num_lost)
+    for (long int ind = 0; ind < num_cells; ind++)
+    {
+      long int ind_full = simulation_interleave ? ind * prim_stride + var : var * num_cells + ind;
+      float val = prim[n].data[ind_full];
+      std::uint16_t code = EncodeReduced(val, simulation_precision, positive);
+      prim_packed[n].data[ind_full] = code;
+      if (first_time and std::isfinite(val) and val != 0.0f)
+      {
+        float val_new = DecodeReduced(code, simulation_precision, positive);
+        if (not std::isfinite(val_new) or val_new == 0.0f)
+          num_lost++;
+        else
+          max_error = std::max(max_error,
+              std::abs(static_cast<double>(val_new) / static_cast<double>(val) - 1.0));
+      }
+    }
+
+    // Report accuracy
+    if (first_time)
+    {
+      std::string var_name = var == ind_rho ? "rho" : var == ind_pgas ? "pgas"
+          : var == ind_uu1 ? "uu1" : var == ind_uu2 ? "uu2" : var == ind_uu3 ? "uu3"
+          : var == ind_bb1 ? "bb1" : var == ind_bb2 ? "bb2" : var == ind_bb3 ? "bb3"
+          : positive ? "kappa" : std::to_string(var);
+      std::ostringstream message;
+      message << "Reduced-precision storage of " << var_name << ": max relative error ";
+      message << max_error;
+      if (num_lost > 0)
+        message << ", " << num_lost << " values overflowed or underflowed";
+      std::cout << message.str() << std::endl;
+      num_lost_total += num_lost;
+    }
+  }
+  if (num_lost_total > 0)
+    BlacklightWarning("Some cell values cannot be represented at selected precision.");
+
+  // Free single-precision values
+  prim[n].Deallocate();
+  return;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for choosing number of x^1-planes of cell data to read at once
+// Inputs:
+//   plane_size: number of values in single plane in file
+// Outputs:
+//   returned value: number of planes to read together
+// Notes:
+//   Slabs are limited to 2^22 values (16 MiB) unless a single plane is larger.
+int SimulationReader::SlabPlanes(long int plane_size)
+{
+  const long int slab_size_max = 4194304;
+  return static_cast<int>(std::max(slab_size_max / plane_size, 1L));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for transposing slab of cell data into primitive array
+// Inputs:
+//   slab: values for consecutive x^1-planes, with indices (i,j,k,variable) and variable fastest
+//   i_start: index of first plane of slab within primitives
+//   num_vars: number of variables to set
+//   file_inds: indices of variables (along n1) within slab
+//   prim_inds: indices of variables (along n5) within primitives to be set
+// Outputs:
+//   primitives: array set at given variable indices for planes covered by slab
+// Notes:
+//   Assumes primitives contains a single block with n3 and n2 matching slab.
+//   Converts internal energy to pressure for variable ind_pgas.
+//   Works on tiles in (k,i) so that strided reads and writes both stay in cache.
+void SimulationReader::TransposePrimitives(const Array<float> &slab, int i_start, int num_vars,
+    const int *file_inds, const int *prim_inds, Array<float> &primitives)
+{
+  // Prepare tiles
+  const int tile_size = 32;
+  int num_planes = slab.n4;
+  int n3 = primitives.n3;
+  int n2 = primitives.n2;
+  float pgas_factor = static_cast<float>(plasma_gamma - 1.0);
+
+  // Transpose values
+  #pragma omp parallel for schedule(static) collapse(2)
+  for (int j = 0; j < n2; j++)
+    for (int k_tile = 0; k_tile < n3; k_tile += tile_size)
+    {
+      int k_end = std::min(k_tile + tile_size, n3);
+      for (int i_tile = 0; i_tile < num_planes; i_tile += tile_size)
+      {
+        int i_end = std::min(i_tile + tile_size, num_planes);
+        for (int ind = 0; ind < num_vars; ind++)
+        {
+          int file_ind = file_inds[ind];
+          int prim_ind = prim_inds[ind];
+          if (prim_ind == ind_pgas)
+          {
+            for (int k = k_tile; k < k_end; k++)
+              for (int i = i_tile; i < i_end; i++)
+                primitives(prim_ind,0,k,j,i_start+i) = slab(i,j,k,file_ind) * pgas_factor;
+          }
+          else
+          {
+            for (int k = k_tile; k < k_end; k++)
+              for (int i = i_tile; i < i_end; i++)
+                primitives(prim_ind,0,k,j,i_start+i) = slab(i,j,k,file_ind);
+          }
+        }
+      }
+    }
+  return;
+}
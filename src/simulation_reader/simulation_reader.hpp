@@ -4,6 +4,7 @@
 #define SIMULATION_READER_H_
 
 // C++ headers
+#include <cstdint>  // uint16_t
 #include <fstream>  // ifstream
 #include <iosfwd>   // streampos
 #include <string>   // string
@@ -41,6 +42,13 @@ struct SimulationReader
   double simulation_m_msun;
   double simulation_rho_cgs;
   std::string simulation_kappa_name;
+  SimulationPrecision simulation_precision;
+  bool simulation_interleave;
+  std::string simulation_sks_map_file;
+
+  // Input data - radial range that can be sampled
+  double radial_r_min;
+  double radial_r_max;
 
   // Input data - slow-light parameters
   bool slow_light_on;
@@ -69,9 +77,6 @@ struct SimulationReader
   int athenak_location_size;
   int athenak_variable_size;
   std::streampos athenak_data_offset;
-  int athenak_ind_rho, athenak_ind_pgas, athenak_ind_kappa;
-  int athenak_ind_uu1, athenak_ind_uu2, athenak_ind_uu3;
-  int athenak_ind_bb1, athenak_ind_bb2, athenak_ind_bb3;
   int athenak_block_nx;
   int athenak_block_ny;
   int athenak_block_nz;
@@ -91,6 +96,10 @@ struct SimulationReader
   Array<int> num_variables;
   int ind_hydro;
   int ind_bb;
+  int file_ind_rho, file_ind_pgas, file_ind_kappa;
+  int file_ind_uu1, file_ind_uu2, file_ind_uu3;
+  int file_ind_bb1, file_ind_bb2, file_ind_bb3;
+  int num_prim_read;
   int ind_rho, ind_pgas, ind_kappa;
   int ind_u0, ind_uu1, ind_uu2, ind_uu3;
   int ind_b0, ind_bb1, ind_bb2, ind_bb3;
@@ -110,6 +119,9 @@ struct SimulationReader
   const int sks_map_n2 = 2048;
   const int sks_map_max_iter = 1000;
   const double sks_map_tol = 1.0e-8;
+  double grid_r_in, grid_r_out;
+  int radial_i_start = 0;
+  const int radial_margin = 2;
 
   // Data
   int n_3_root;
@@ -120,7 +132,9 @@ struct SimulationReader
   Array<double> x2v_alt;
   double *time;
   Array<float> *prim;
-  Array<float> prim_transpose;
+  Array<std::uint16_t> *prim_packed;
+  int prim_dims[5];
+  int prim_stride;
 
   // External function
   double Read(int snapshot);
@@ -132,12 +146,23 @@ struct SimulationReader
   void VerifyVariablesAthena();
   void VerifyVariablesAthenaK();
   void VerifyVariablesHarm();
+  void SetCompactIndices();
+  void AllocatePrimitives(int n5, int n4, int n3, int n2, int n1);
+  void InterleavePrimitives(int n);
+  void PackPrimitives(int n);
+  int SlabPlanes(long int plane_size);
+  void TransposePrimitives(const Array<float> &slab, int i_start, int num_vars,
+      const int *file_inds, const int *prim_inds, Array<float> &primitives);
 
   // Internal functions - simulation_geometry.cpp
+  void PruneRadialRange();
   void ConvertCoordinates();
   void ConvertPrimitives3(Array<float> &primitives);
   void ConvertPrimitives4(Array<float> &primitives);
   void GenerateSKSMap(double r_in, double r_out);
+  double InvertSKSTheta(double x1, double theta, double x2_guess);
+  bool LoadSKSMap();
+  void SaveSKSMap();
   void GetSKSCoordinates(double x1, double x2, double x3, double *p_r, double *p_theta,
       double *p_phi);
   void SetJacobianFactors(double x1, double x2, double *p_dr_dx1, double *p_dth_dx1,
@@ -155,6 +180,9 @@ struct SimulationReader
       unsigned long int data_segment_address);
   void ReadHDF5DataObjectHeader(unsigned long int data_object_header_address,
       unsigned char **p_datatype_raw, unsigned char **p_dataspace_raw, unsigned char **p_data_raw);
+  void ReadHDF5DataObjectHeader(unsigned long int data_object_header_address,
+      unsigned char **p_datatype_raw, unsigned char **p_dataspace_raw,
+      unsigned long int *p_data_address, unsigned long int *p_data_size);
   static void ReadHDF5DataspaceDims(const unsigned char *dataspace_raw, unsigned long int **p_dims,
       int *p_num_dims);
 
@@ -163,6 +191,10 @@ struct SimulationReader
       int *p_array_length);
   void ReadHDF5IntArray(const char *name, Array<int> &int_array);
   void ReadHDF5FloatArray(const char *name, Array<float> &float_array);
+  void ReadHDF5FloatArraySlices(const char *name, int num_slices, const int *file_inds,
+      const int *array_inds, Array<float> &float_array);
+  void ReadHDF5FloatArrayTransposed(const char *name, int i_start, int num_vars,
+      const int *file_inds, const int *array_inds, Array<float> &float_array);
   void ReadHDF5FloatArray(const char *name, Array<double> &double_array);
   void ReadHDF5DoubleArray(const char *name, Array<double> &double_array);
   static void SetHDF5StringArray(const unsigned char *datatype_raw,
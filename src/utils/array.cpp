@@ -3,6 +3,7 @@
 // C++ headers
 #include <complex>  // complex
 #include <cstddef>  // size_t
+#include <cstdint>  // uint16_t
 #include <cstring>  // memcpy
 #include <limits>   // numeric_limits
 
@@ -14,6 +15,8 @@
 template struct Array<bool>;
 template struct Array<char>;
 template struct Array<int>;
+template struct Array<long int>;
+template struct Array<std::uint16_t>;
 template struct Array<float>;
 template struct Array<double>;
 template struct Array<std::complex<double>>;
@@ -0,0 +1,197 @@
+// Blacklight reduced-precision utilities
+
+// C++ headers
+#include <cmath>    // exp2, isnan, log2, round
+#include <cstdint>  // int32_t, uint16_t, uint32_t
+#include <cstring>  // memcpy
+
+// Blacklight headers
+#include "reduced_precision.hpp"
+#include "../blacklight.hpp"  // enums
+
+// Constants for logarithmic encoding
+namespace Log16
+{
+  constexpr float log2_min = -64.0f;
+  constexpr float log2_max = 64.0f;
+  constexpr float log2_step = (log2_max - log2_min) / 65534.0f;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for converting single-precision value to IEEE half precision
+// Inputs:
+//   val: value to convert
+// Outputs:
+//   returned value: bits of half-precision representation
+// Notes:
+//   Rounds to nearest, with ties going to even.
+//   Values beyond the half-precision range become infinite; values too small become 0.
+//   Preserves signs, infinities, and NaNs.
+std::uint16_t EncodeHalf(float val)
+{
+  std::uint32_t bits;
+  std::memcpy(&bits, &val, 4);
+  std::uint32_t sign = (bits >> 16) & 0x8000u;
+  std::uint32_t exponent_single = (bits >> 23) & 0xffu;
+  std::uint32_t mantissa = bits & 0x7fffffu;
+  if (exponent_single == 0xffu)
+    return static_cast<std::uint16_t>(sign | 0x7c00u | (mantissa != 0 ? 0x0200u : 0u));
+  std::int32_t exponent = static_cast<std::int32_t>(exponent_single) - 127 + 15;
+  if (exponent >= 31)
+    return static_cast<std::uint16_t>(sign | 0x7c00u);
+  if (exponent <= 0)
+  {
+    if (exponent < -10)
+      return static_cast<std::uint16_t>(sign);
+    mantissa |= 0x800000u;
+    std::uint32_t shift = static_cast<std::uint32_t>(14 - exponent);
+    std::uint32_t half_bits = mantissa >> shift;
+    std::uint32_t remainder = mantissa & ((1u << shift) - 1u);
+    std::uint32_t halfway = 1u << (shift - 1u);
+    if (remainder > halfway or (remainder == halfway and (half_bits & 1u)))
+      half_bits++;
+    return static_cast<std::uint16_t>(sign | half_bits);
+  }
+  std::uint32_t half_bits = sign | (static_cast<std::uint32_t>(exponent) << 10) | (mantissa >> 13);
+  std::uint32_t remainder = mantissa & 0x1fffu;
+  if (remainder > 0x1000u or (remainder == 0x1000u and (half_bits & 1u)))
+    half_bits++;
+  return static_cast<std::uint16_t>(half_bits);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for converting IEEE half-precision value to single precision
+// Inputs:
+//   code: bits of half-precision representation
+// Outputs:
+//   returned value: exactly represented single-precision value
+float DecodeHalf(std::uint16_t code)
+{
+  std::uint32_t sign = (code & 0x8000u) << 16;
+  std::uint32_t exponent = (code >> 10) & 0x1fu;
+  std::uint32_t mantissa = code & 0x03ffu;
+  if (exponent == 0)
+  {
+    float val = static_cast<float>(mantissa) * 5.9604644775390625e-8f;
+    return sign != 0 ? -val : val;
+  }
+  std::uint32_t bits;
+  if (exponent == 31)
+    bits = sign | 0x7f800000u | (mantissa << 13);
+  else
+    bits = sign | ((exponent + 112u) << 23) | (mantissa << 13);
+  float val;
+  std::memcpy(&val, &bits, 4);
+  return val;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for converting single-precision value to bfloat16
+// Inputs:
+//   val: value to convert
+// Outputs:
+//   returned value: bits of bfloat16 representation
+// Notes:
+//   Rounds to nearest, with ties going to even.
+//   Retains full single-precision exponent range.
+std::uint16_t EncodeBfloat16(float val)
+{
+  std::uint32_t bits;
+  std::memcpy(&bits, &val, 4);
+  if (std::isnan(val))
+    return static_cast<std::uint16_t>((bits >> 16) | 0x0040u);
+  bits += 0x7fffu + ((bits >> 16) & 1u);
+  return static_cast<std::uint16_t>(bits >> 16);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for converting bfloat16 value to single precision
+// Inputs:
+//   code: bits of bfloat16 representation
+// Outputs:
+//   returned value: exactly represented single-precision value
+float DecodeBfloat16(std::uint16_t code)
+{
+  std::uint32_t bits = static_cast<std::uint32_t>(code) << 16;
+  float val;
+  std::memcpy(&val, &bits, 4);
+  return val;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for converting positive single-precision value to logarithmic 16-bit code
+// Inputs:
+//   val: value to convert
+// Outputs:
+//   returned value: 16-bit code
+// Notes:
+//   Code 0 is reserved for nonpositive values (and NaN).
+//   Codes 1 through 65535 uniformly cover log_2(val) in [-64, 64], clamping values outside this
+//       range, for a maximum relative error of about 7e-4.
+std::uint16_t EncodeLog16(float val)
+{
+  if (not (val > 0.0f))
+    return 0;
+  float code = std::round((std::log2(val) - Log16::log2_min) / Log16::log2_step);
+  code = code < 0.0f ? 0.0f : code > 65534.0f ? 65534.0f : code;
+  return static_cast<std::uint16_t>(static_cast<std::uint32_t>(code) + 1u);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for converting logarithmic 16-bit code to single precision
+// Inputs:
+//   code: 16-bit code
+// Outputs:
+//   returned value: single-precision value
+float DecodeLog16(std::uint16_t code)
+{
+  if (code == 0)
+    return 0.0f;
+  return std::exp2(Log16::log2_min + static_cast<float>(code - 1) * Log16::log2_step);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for converting single-precision value to selected 16-bit representation
+// Inputs:
+//   val: value to convert
+//   precision: selected representation (must not be SimulationPrecision::single)
+//   positive: flag indicating quantity is physically positive (e.g. density or pressure)
+// Outputs:
+//   returned value: 16-bit code
+// Notes:
+//   With SimulationPrecision::log16, quantities that are not positive use bfloat16.
+std::uint16_t EncodeReduced(float val, SimulationPrecision precision, bool positive)
+{
+  if (precision == SimulationPrecision::half)
+    return EncodeHalf(val);
+  if (precision == SimulationPrecision::log16 and positive)
+    return EncodeLog16(val);
+  return EncodeBfloat16(val);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for converting selected 16-bit representation to single precision
+// Inputs:
+//   code: 16-bit code
+//   precision: selected representation (must not be SimulationPrecision::single)
+//   positive: flag indicating quantity is physically positive (e.g. density or pressure)
+// Outputs:
+//   returned value: single-precision value
+// Notes:
+//   Inverse of EncodeReduced().
+float DecodeReduced(std::uint16_t code, SimulationPrecision precision, bool positive)
+{
+  if (precision == SimulationPrecision::half)
+    return DecodeHalf(code);
+  if (precision == SimulationPrecision::log16 and positive)
+    return DecodeLog16(code);
+  return DecodeBfloat16(code);
+}
@@ -0,0 +1,26 @@
+// Blacklight reduced-precision utilities
+
+#ifndef REDUCED_PRECISION_H_
+#define REDUCED_PRECISION_H_
+
+// C++ headers
+#include <cstdint>  // uint16_t
+
+// Blacklight headers
+#include "../blacklight.hpp"  // enums
+
+//--------------------------------------------------------------------------------------------------
+
+// Functions for converting between single precision and 16-bit representations
+std::uint16_t EncodeHalf(float val);
+float DecodeHalf(std::uint16_t code);
+std::uint16_t EncodeBfloat16(float val);
+float DecodeBfloat16(std::uint16_t code);
+std::uint16_t EncodeLog16(float val);
+float DecodeLog16(std::uint16_t code);
+
+// Functions for converting quantities according to selected precision
+std::uint16_t EncodeReduced(float val, SimulationPrecision precision, bool positive);
+float DecodeReduced(std::uint16_t code, SimulationPrecision precision, bool positive);
+
+#endif
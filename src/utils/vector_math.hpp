@@ -0,0 +1,219 @@
+// Blacklight vectorizable elementary functions
+
+#ifndef VECTOR_MATH_H_
+#define VECTOR_MATH_H_
+
+// C++ headers
+#include <cstdint>  // uint64_t
+#include <cstring>  // memcpy
+#include <limits>   // numeric_limits
+
+//--------------------------------------------------------------------------------------------------
+
+// Notes:
+//   These functions are defined inline and avoid branches and library calls, so that loops calling
+//       them can be vectorized with "#pragma omp simd" without needing -ffast-math.
+//   Results agree with the standard library to within a few units in the last place for normal
+//       arguments, but are not bit-for-bit identical.
+//   Subnormal inputs and outputs are not treated accurately.
+
+// Constants for elementary functions
+namespace VectorMath
+{
+  constexpr double log2_e = 1.4426950408889634;
+  constexpr double ln_2_hi = 6.93147180369123816490e-01;
+  constexpr double ln_2_lo = 1.90821492927058770002e-10;
+  constexpr double shifter = 6755399441055744.0;
+  constexpr double exp_min = -708.0;
+  constexpr double exp_max = 709.0;
+  constexpr double expm1_series_max = 0.34657359027997264;
+  constexpr double two_52 = 4503599627370496.0;
+  constexpr std::uint64_t two_52_bits = 0x4330000000000000;
+  constexpr std::uint64_t mantissa_mask = 0x000fffffffffffff;
+  constexpr std::uint64_t one_bits = 0x3ff0000000000000;
+  constexpr double sqrt2 = 1.4142135623730951;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for reinterpreting double as bits
+// Inputs:
+//   x: value
+// Outputs:
+//   returned value: bits of x
+#pragma omp declare simd
+inline std::uint64_t VectorBits(double x)
+{
+  std::uint64_t bits;
+  std::memcpy(&bits, &x, sizeof(bits));
+  return bits;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for reinterpreting bits as double
+// Inputs:
+//   bits: bits of value
+// Outputs:
+//   returned value: value with given bits
+#pragma omp declare simd
+inline double VectorFromBits(std::uint64_t bits)
+{
+  double x;
+  std::memcpy(&x, &bits, sizeof(x));
+  return x;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for evaluating exponential
+// Inputs:
+//   x: argument
+// Outputs:
+//   returned value: e^x
+// Notes:
+//   Reduces argument to x = k ln(2) + r with |r| <= ln(2)/2 and uses degree-13 Taylor polynomial.
+//   Returns 0 for x < -708 and infinity for x > 709.
+#pragma omp declare simd
+inline double VectorExp(double x)
+{
+  // Reduce argument
+  double x_clamped = x < VectorMath::exp_min ? VectorMath::exp_min : x;
+  x_clamped = x_clamped > VectorMath::exp_max ? VectorMath::exp_max : x_clamped;
+  double k_shifted = x_clamped * VectorMath::log2_e + VectorMath::shifter;
+  double k = k_shifted - VectorMath::shifter;
+  double r = x_clamped - k * VectorMath::ln_2_hi - k * VectorMath::ln_2_lo;
+
+  // Evaluate polynomial
+  double p = 1.0 / 6227020800.0;
+  p = p * r + 1.0 / 479001600.0;
+  p = p * r + 1.0 / 39916800.0;
+  p = p * r + 1.0 / 3628800.0;
+  p = p * r + 1.0 / 362880.0;
+  p = p * r + 1.0 / 40320.0;
+  p = p * r + 1.0 / 5040.0;
+  p = p * r + 1.0 / 720.0;
+  p = p * r + 1.0 / 120.0;
+  p = p * r + 1.0 / 24.0;
+  p = p * r + 1.0 / 6.0;
+  p = p * r + 0.5;
+  p = p * r + 1.0;
+  p = p * r + 1.0;
+
+  // Scale by power of 2
+  double scale = VectorFromBits((VectorBits(k_shifted) + 1023) << 52);
+  double result = p * scale;
+  result = x < VectorMath::exp_min ? 0.0 : result;
+  result = x > VectorMath::exp_max ? std::numeric_limits<double>::infinity() : result;
+  return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for evaluating exponential minus 1
+// Inputs:
+//   x: argument
+// Outputs:
+//   returned value: e^x - 1
+// Notes:
+//   Uses degree-13 Taylor polynomial for |x| <= ln(2)/2 in order to retain precision for small x.
+#pragma omp declare simd
+inline double VectorExpm1(double x)
+{
+  double p = 1.0 / 6227020800.0;
+  p = p * x + 1.0 / 479001600.0;
+  p = p * x + 1.0 / 39916800.0;
+  p = p * x + 1.0 / 3628800.0;
+  p = p * x + 1.0 / 362880.0;
+  p = p * x + 1.0 / 40320.0;
+  p = p * x + 1.0 / 5040.0;
+  p = p * x + 1.0 / 720.0;
+  p = p * x + 1.0 / 120.0;
+  p = p * x + 1.0 / 24.0;
+  p = p * x + 1.0 / 6.0;
+  p = p * x + 0.5;
+  p = p * x + 1.0;
+  p = p * x;
+  bool series = x >= -VectorMath::expm1_series_max and x <= VectorMath::expm1_series_max;
+  return series ? p : VectorExp(x) - 1.0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for evaluating natural logarithm
+// Inputs:
+//   x: argument
+// Outputs:
+//   returned value: ln(x)
+// Notes:
+//   Writes x = 2^k m with m in [sqrt(1/2), sqrt(2)) and uses series
+//       ln(m) = 2 (s + s^3/3 + s^5/5 + ...) with s = (m - 1) / (m + 1).
+//   Returns negative infinity for 0, infinity for infinity, and NaN for negative or NaN x.
+#pragma omp declare simd
+inline double VectorLog(double x)
+{
+  // Extract exponent and mantissa
+  std::uint64_t bits = VectorBits(x);
+  std::uint64_t exponent = bits >> 52;
+  double m = VectorFromBits((bits & VectorMath::mantissa_mask) | VectorMath::one_bits);
+  double k = VectorFromBits(VectorMath::two_52_bits | exponent) - VectorMath::two_52 - 1023.0;
+  bool high = m > VectorMath::sqrt2;
+  m = high ? 0.5 * m : m;
+  k = high ? k + 1.0 : k;
+
+  // Evaluate series
+  double f = m - 1.0;
+  double s = f / (2.0 + f);
+  double z = s * s;
+  double p = 1.0 / 21.0;
+  p = p * z + 1.0 / 19.0;
+  p = p * z + 1.0 / 17.0;
+  p = p * z + 1.0 / 15.0;
+  p = p * z + 1.0 / 13.0;
+  p = p * z + 1.0 / 11.0;
+  p = p * z + 1.0 / 9.0;
+  p = p * z + 1.0 / 7.0;
+  p = p * z + 1.0 / 5.0;
+  p = p * z + 1.0 / 3.0;
+  double series = 2.0 * s + 2.0 * s * z * p;
+
+  // Combine parts and handle special cases
+  double result = k * VectorMath::ln_2_hi + (series + k * VectorMath::ln_2_lo);
+  result = x == std::numeric_limits<double>::infinity() ? x : result;
+  result = x == 0.0 ? -std::numeric_limits<double>::infinity() : result;
+  result = x < 0.0 or x != x ? std::numeric_limits<double>::quiet_NaN() : result;
+  return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for evaluating power
+// Inputs:
+//   x: base
+//   y: exponent
+// Outputs:
+//   returned value: x^y
+// Notes:
+//   Only valid for x > 0, or x = 0 with y != 0.
+#pragma omp declare simd
+inline double VectorPow(double x, double y)
+{
+  return VectorExp(y * VectorLog(x));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Function for evaluating cube root
+// Inputs:
+//   x: argument
+// Outputs:
+//   returned value: x^(1/3)
+// Notes:
+//   Only valid for x >= 0.
+#pragma omp declare simd
+inline double VectorCbrt(double x)
+{
+  return VectorExp(VectorLog(x) / 3.0);
+}
+
+#endif